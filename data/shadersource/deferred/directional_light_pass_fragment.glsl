@@ -19,6 +19,10 @@ uniform mat4 shadow_view_projection_bias;
 uniform sampler2D depth_texture;
 uniform sampler2D normal_specular_texture;
 
+#ifdef COMPACT_GBUFFER
+#include "gbuffer_encoding.glsl"
+#endif
+
 // Shadow texture for shadow mapping
 uniform sampler2DShadow shadow_map;
 
@@ -47,6 +51,13 @@ void main(void)
 		return;
 	}
 
+#ifdef COMPACT_GBUFFER
+	// Packed bits must not be filtered
+	vec3 surface_normal_world;
+	float specular;
+	unpackNormalSpecular(texelFetch(normal_specular_texture, ivec2(gl_FragCoord.xy), 0).xy,
+		surface_normal_world, specular);
+#else
 	// Temp storage for single texture fetch
 	vec4 temp = texture(normal_specular_texture, normalized_screen_coordinates);
 
@@ -55,6 +66,7 @@ void main(void)
 
 	// Specularity value
 	float specular = temp.w;
+#endif
 
 	// Lambertian factor based on surface normal
 	float lambert_factor = max(0.0, dot(surface_normal_world, -light_direction));
@@ -4,20 +4,29 @@ in vec2 uv;
 smooth in vec3 vertexWorldSpace;
 smooth in vec3 normalVectorWorldSpace;
 
-// Material textures
+// Material textures, missing maps are replaced by constants
+#ifdef HAS_DIFFUSE_MAP
 uniform sampler2D diffuse_texture;
+#endif
+#ifdef HAS_NORMAL_MAP
 uniform sampler2D normal_texture;
+#endif
+#ifdef HAS_SPECULAR_MAP
 uniform sampler2D specular_texture;
+#endif
+#ifdef HAS_GLOW_MAP
 uniform sampler2D glow_texture;
-
-// Actually not needed here
-uniform sampler2D alpha_texture;
+#endif
 
 // Diffuse color and glow value
 layout(location = 0) out vec4 diffuse_glow;
 // Normals and specular value
 layout(location = 1) out vec4 normal_specular;
 
+#ifdef COMPACT_GBUFFER
+#include "gbuffer_encoding.glsl"
+#endif
+
 mat3 cotangent_frame( vec3 N, vec3 p, vec2 uv )
 {
     // get edge vectors of the pixel triangle
@@ -37,28 +46,52 @@ mat3 cotangent_frame( vec3 N, vec3 p, vec2 uv )
     return mat3( T * invmax, B * invmax, N );
 }
 
+#ifdef HAS_NORMAL_MAP
 vec3 perturb_normal( vec3 N, vec3 V, vec2 texcoord )
 {
-    vec3 map = texture( normal_texture, texcoord ).xyz;
-    map = map * 255./127. - 128./127.;
+    // Only x and y are used, z is reconstructed for two channel compressed normal maps
+    vec3 map;
+    map.xy = texture( normal_texture, texcoord ).xy * 255./127. - 128./127.;
+    map.z = sqrt( max( 0.0, 1.0 - dot( map.xy, map.xy ) ) );
     mat3 TBN = cotangent_frame( N, -V, texcoord );
     return normalize( TBN * map );
 }
+#endif
 
 void main(void)
 {
+#ifdef HAS_DIFFUSE_MAP
 	vec3 color = texture(diffuse_texture, uv).rgb;
-	vec3 normal = texture(normal_texture, uv).rgb;
-	
+#else
+	// Deep pink signals missing diffuse texture
+	vec3 color = vec3(238.0, 18.0, 137.0) / 255.0;
+#endif
+
+#ifdef HAS_SPECULAR_MAP
 	float specular = texture(specular_texture, uv).r;
+#else
+	float specular = 0.0;
+#endif
+
+#ifdef HAS_GLOW_MAP
 	float glow = texture(glow_texture, uv).r;
-	//float alpha = texture(alpha_texture, uv).r;
+#else
+	float glow = 0.0;
+#endif
 
 	// Write diffuse map with glow
 	diffuse_glow.rgb = color;
 	diffuse_glow.a = glow;
 	
-	// normal.rgb = textureNormal;
-    normal_specular.rgb = perturb_normal(normalVectorWorldSpace, vertexWorldSpace, uv);
+#ifdef HAS_NORMAL_MAP
+    vec3 normal = perturb_normal(normalVectorWorldSpace, vertexWorldSpace, uv);
+#else
+    vec3 normal = normalize(normalVectorWorldSpace);
+#endif
+#ifdef COMPACT_GBUFFER
+	normal_specular = vec4(packNormalSpecular(normal, specular), 0.0, 0.0);
+#else
+	normal_specular.rgb = normal;
 	normal_specular.a = specular;
+#endif
 }
\ No newline at end of file
@@ -15,6 +15,9 @@ uniform mat4 scale;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Depth pre-pass and geometry pass must compute equal depth values
+invariant gl_Position;
+
 // Texture coordinate
 out vec2 uv;
 // Nornal vector
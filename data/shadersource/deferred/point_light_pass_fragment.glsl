@@ -22,6 +22,10 @@ uniform mat4 inverse_view_projection;
 uniform sampler2D depth_texture;
 uniform sampler2D normal_specular_texture;
 
+#ifdef COMPACT_GBUFFER
+#include "gbuffer_encoding.glsl"
+#endif
+
 uniform samplerCube shadow_cube;
 
 vec3 getWorldPosition(vec2 uv) 
@@ -38,14 +42,22 @@ void main(void)
 	vec2 normalized_screen_coordinates = vec2(gl_FragCoord.x / screen_width, gl_FragCoord.y / screen_height);
 	// Calculate world position of affected fragment
 	vec3 fragment_world_position = getWorldPosition(normalized_screen_coordinates);
+#ifdef COMPACT_GBUFFER
+	// Packed bits must not be filtered
+	vec3 surface_normal_world;
+	float specular;
+	unpackNormalSpecular(texelFetch(normal_specular_texture, ivec2(gl_FragCoord.xy), 0).xy,
+		surface_normal_world, specular);
+#else
 	// Temp storage for single texture fetch
 	vec4 temp = texture(normal_specular_texture, normalized_screen_coordinates);
-		
+
 	// Store world space normal vector
 	vec3 surface_normal_world = normalize(temp.xyz);
 
 	// Specularity value
 	float specular = temp.w;
+#endif
 	
 	// Light direction vector from light to fragment
 	vec3 light_direction = light_position - fragment_world_position;
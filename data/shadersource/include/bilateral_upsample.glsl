@@ -0,0 +1,32 @@
+#pragma once
+
+// Relative depth difference, at which a low resolution sample has half its bilinear weight
+const float upsampleDepthTolerance = 0.1;
+
+// Bilateral upsample of an effect rendered at 1/factor of the screen resolution
+// The four nearest low resolution texels are weighted bilinearly and by the similarity of their
+// depth to the linear depth of the fragment, so effects do not bleed across depth edges.
+// The low resolution depth texture stores linear depth in alpha, see depth_downsample_fragment.
+vec3 bilateralUpsample(sampler2D effectTexture, sampler2D lowDepthTexture, int factor, float depth)
+{
+	ivec2 maxTexel = textureSize(effectTexture, 0) - 1;
+	vec2 position = gl_FragCoord.xy / float(factor) - 0.5;
+	vec2 base = floor(position);
+	vec2 fraction = position - base;
+
+	vec3 color = vec3(0.0);
+	float totalWeight = 0.0;
+	for (int i = 0; i < 4; ++i)
+	{
+		vec2 offset = vec2(float(i % 2), float(i / 2));
+		ivec2 texel = clamp(ivec2(base + offset), ivec2(0), maxTexel);
+
+		vec2 bilinear = mix(1.0 - fraction, fraction, offset);
+		float difference = (texelFetch(lowDepthTexture, texel, 0).w - depth) / (depth * upsampleDepthTolerance);
+		float weight = bilinear.x * bilinear.y / (1.0 + difference * difference);
+
+		color += texelFetch(effectTexture, texel, 0).xyz * weight;
+		totalWeight += weight;
+	}
+	return color / max(totalWeight, 0.00001);
+}
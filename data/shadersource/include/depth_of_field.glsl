@@ -0,0 +1,38 @@
+#pragma once
+
+// Depth of field parameters
+uniform float focus_near; // Closest non-blurry distance
+uniform float blur_near; // Max blur at near distance
+
+uniform float focus_far; // Furthest non-blurry distance
+uniform float blur_far; // Max blur at far distance
+
+// World position of camera
+uniform vec3 camera_position;
+
+// Transforms to camera coords
+uniform mat4 inverse_view_projection;
+
+vec3 getWorldPosition(vec2 uv, float z)
+{
+	vec4 sPos = vec4(uv * 2.0 - 1.0, z * 2.0 - 1.0, 1.0);
+	sPos = inverse_view_projection * sPos;
+	return (sPos.xyz / sPos.w);
+}
+
+// Returns blend factor of the blurred scene for a fragment with the depth
+float getDepthOfFieldBlur(vec2 uv, float z)
+{
+	// Distance to viewer
+	float distance = distance(getWorldPosition(uv, z), camera_position);
+
+	if (distance < focus_near)
+	{
+		return min(1.0, blur_near / distance);
+	}
+	else if (distance > focus_far)
+	{
+		return min(1.0, (distance - focus_far) / (blur_far - focus_far));
+	}
+	return 0.0;
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+// Fog type is selected by the shader variant, FOG_LINEAR, FOG_EXP or FOG_EXP2
+// Without fog type the color is returned unchanged
+vec3 applyFog(vec3 color, float d)
+{
+    float n = 0.01f;
+    float f = 1000.0f;
+    float z = (2.0 * n * f) / (f + n - d * (f-n));
+    
+    float fogN = 0.0f;
+    float fogF = 50.0f;
+    float fogD = 0.02f;
+    
+#if defined(FOG_LINEAR)
+    float fogFactor = (fogF - z) / (fogF - fogN);
+#elif defined(FOG_EXP)
+    float fogFactor = exp(-fogD*z);
+#elif defined(FOG_EXP2)
+    float fogFactor = exp(-pow(fogD*z, 2.0f));
+#else
+    float fogFactor = 1.0f;
+#endif
+    
+    return mix(color, vec3(0.7, 0.6, 0.5), 1.0f - clamp(fogFactor, 0.5f, 1.0f));
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+// Compact g-buffer layout, see GBufferEncoding.h for the matching CPU reference
+// Normals are octahedral encoded with 12 bit per axis, the 8 bit specular value is split into
+// the low 4 bits of both 16 bit channels
+
+vec2 signNotZero(vec2 v)
+{
+	return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Maps unit vector to [0-1] octahedral coordinates
+vec2 encodeOctahedral(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 e = n.xy;
+	if (n.z < 0.0)
+	{
+		// Fold lower hemisphere over the diagonals
+		e = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+	}
+	return e * 0.5 + 0.5;
+}
+
+// Maps [0-1] octahedral coordinates to unit vector
+vec3 decodeOctahedral(vec2 e)
+{
+	e = e * 2.0 - 1.0;
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+	}
+	return normalize(n);
+}
+
+// Returns values for a 16 bit unsigned normalized two channel target
+vec2 packNormalSpecular(vec3 normal, float specular)
+{
+	uvec2 n = uvec2(round(clamp(encodeOctahedral(normal), 0.0, 1.0) * 4095.0));
+	uint s = uint(round(clamp(specular, 0.0, 1.0) * 255.0));
+	return vec2((n << 4u) | uvec2(s >> 4u, s & 15u)) / 65535.0;
+}
+
+// Unpacks a texel, must be fetched without filtering
+void unpackNormalSpecular(vec2 texel, out vec3 normal, out float specular)
+{
+	uvec2 v = uvec2(round(texel * 65535.0));
+	normal = decodeOctahedral(vec2(v >> 4u) / 4095.0);
+	specular = float(((v.x & 15u) << 4u) | (v.y & 15u)) / 255.0;
+}
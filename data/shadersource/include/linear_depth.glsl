@@ -0,0 +1,11 @@
+#pragma once
+
+// Transforms to camera coords
+uniform mat4 inverse_projection;
+
+// Returns distance along the view direction for a depth buffer value
+float getLinearDepth(float z)
+{
+	vec4 position = inverse_projection * vec4(0.0, 0.0, z * 2.0 - 1.0, 1.0);
+	return -position.z / position.w;
+}
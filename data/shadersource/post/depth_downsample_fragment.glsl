@@ -0,0 +1,50 @@
+#version 330 core
+
+// Depth aware downsample of the scene for reduced resolution effects
+// Each output pixel covers a block of downsample_factor x downsample_factor scene pixels, whose
+// corners are fetched. Only corners near the closest depth are averaged, so foreground and
+// background colors do not mix. The closest linear depth is stored in alpha for the bilateral
+// upsample of the effects.
+#include "linear_depth.glsl"
+
+// Input textures
+uniform sampler2D scene_texture;
+uniform sampler2D depth_texture;
+
+// Size of a block in scene pixels
+uniform int downsample_factor;
+
+// Relative depth difference of averaged corners
+const float depthTolerance = 0.1;
+
+// Output color with linear depth
+layout(location = 0) out vec4 color;
+
+void main(void)
+{
+	ivec2 base = ivec2(gl_FragCoord.xy) * downsample_factor;
+	ivec2 maxTexel = textureSize(scene_texture, 0) - 1;
+	int last = downsample_factor - 1;
+	ivec2 texels[4] = ivec2[4](base, base + ivec2(last, 0), base + ivec2(0, last), base + ivec2(last));
+
+	float depths[4];
+	float nearest = 1.0e20;
+	for (int i = 0; i < 4; ++i)
+	{
+		texels[i] = min(texels[i], maxTexel);
+		depths[i] = getLinearDepth(texelFetch(depth_texture, texels[i], 0).x);
+		nearest = min(nearest, depths[i]);
+	}
+
+	vec3 sum = vec3(0.0);
+	float count = 0.0;
+	for (int i = 0; i < 4; ++i)
+	{
+		if (depths[i] - nearest <= nearest * depthTolerance)
+		{
+			sum += texelFetch(scene_texture, texels[i], 0).xyz;
+			count += 1.0;
+		}
+	}
+	color = vec4(sum / count, nearest);
+}
@@ -0,0 +1,67 @@
+#version 330 core
+
+// Merged post processing pass
+// Effects are selected by the shader variant:
+// FOG_LINEAR, FOG_EXP or FOG_EXP2 for fog
+// HAS_DEPTH_OF_FIELD for depth of field composite from the blurred scene
+// HAS_GOD_RAYS for god ray composite
+// LOW_RES_BLUR and LOW_RES_GOD_RAYS for bilateral upsample of reduced resolution effects
+#include "fog.glsl"
+#include "depth_of_field.glsl"
+#include "linear_depth.glsl"
+#include "bilateral_upsample.glsl"
+
+// Input textures
+uniform sampler2D scene_texture;
+uniform sampler2D depth_texture;
+uniform sampler2D blur_texture;
+uniform sampler2D godray_texture;
+
+// Downsampled scenes with linear depth in alpha, used by reduced resolution effects
+uniform sampler2D blur_depth_texture;
+uniform sampler2D godray_depth_texture;
+
+// Resolution divisors of reduced resolution effects
+uniform int blur_downsample;
+uniform int godray_downsample;
+
+// Screen size
+uniform float screen_width;
+uniform float screen_height;
+
+// Output color
+layout(location = 0) out vec3 color;
+
+void main(void)
+{
+	vec2 uv = vec2(gl_FragCoord.x / screen_width, gl_FragCoord.y / screen_height);
+
+	vec3 sceneColor = texture(scene_texture, uv).xyz;
+	float z = texture(depth_texture, uv).x;
+#if defined(LOW_RES_BLUR) || defined(LOW_RES_GOD_RAYS)
+	float linearDepth = getLinearDepth(z);
+#endif
+
+#ifdef HAS_DEPTH_OF_FIELD
+#ifdef LOW_RES_BLUR
+	vec3 blurColor = bilateralUpsample(blur_texture, blur_depth_texture, blur_downsample, linearDepth);
+#else
+	vec3 blurColor = texture(blur_texture, uv).xyz;
+#endif
+	// Fog is linear in the color, so blending before fog matches blending fogged colors
+	sceneColor = mix(sceneColor, blurColor, getDepthOfFieldBlur(uv, z));
+#endif
+
+	sceneColor = applyFog(sceneColor, z);
+
+#ifdef HAS_GOD_RAYS
+#ifdef LOW_RES_GOD_RAYS
+	vec3 godRayColor = bilateralUpsample(godray_texture, godray_depth_texture, godray_downsample, linearDepth);
+#else
+	vec3 godRayColor = texture(godray_texture, uv).xyz;
+#endif
+	sceneColor = clamp(sceneColor + godRayColor, 0.0, 1.0);
+#endif
+
+	color = sceneColor;
+}
\ No newline at end of file
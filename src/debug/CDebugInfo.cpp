@@ -1,5 +1,7 @@
 #include "CDebugInfo.h"
 
+const std::string CDebugInfo::s_defaultPage = "General";
+
 void CDebugInfo::notify(const std::string& level, const std::string& file, unsigned int line,
                         const std::string& function, const std::string& text)
 {
@@ -25,10 +27,40 @@ size_t CDebugInfo::getLogBufferSize() const { return m_logBufferSize; }
 
 void CDebugInfo::setValue(const std::string& key, const std::string& value)
 {
-    m_values[key] = value;
+    setValue(s_defaultPage, key, value);
+}
+
+void CDebugInfo::setValue(const std::string& page, const std::string& key,
+                          const std::string& value)
+{
+    m_pages[page][key] = value;
 }
 
+void CDebugInfo::clearPage(const std::string& page) { m_pages[page].clear(); }
+
+void CDebugInfo::nextPage()
+{
+    if (m_pages.empty())
+    {
+        return;
+    }
+    auto iter = m_pages.upper_bound(m_activePage);
+    if (iter == m_pages.end())
+    {
+        iter = m_pages.begin();
+    }
+    m_activePage = iter->first;
+}
+
+const std::string& CDebugInfo::getActivePage() const { return m_activePage; }
+
 const std::unordered_map<std::string, std::string>& CDebugInfo::getValues() const
 {
-    return m_values;
+    static const std::unordered_map<std::string, std::string> emptyPage;
+    auto iter = m_pages.find(m_activePage);
+    if (iter == m_pages.end())
+    {
+        return emptyPage;
+    }
+    return iter->second;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <list>
+#include <map>
 #include <unordered_map>
 #include <string>
 
@@ -9,6 +10,7 @@
 /**
  * \brief Stores debug data.
  * Stores log events in a ring buffer and key/value debug data pairs.
+ * Key/value pairs are grouped into named pages, only the active page is displayed.
  */
 class CDebugInfo : public ILogListener
 {
@@ -21,11 +23,38 @@ class CDebugInfo : public ILogListener
     void setLogBufferSize(size_t size);
     size_t getLogBufferSize() const;
 
+    /**
+    * \brief Sets value on the default page.
+    */
     void setValue(const std::string& key, const std::string& value);
+
+    /**
+    * \brief Sets value on the specified page, creates the page if needed.
+    */
+    void setValue(const std::string& page, const std::string& key, const std::string& value);
+
+    /**
+    * \brief Removes all values from the page.
+    */
+    void clearPage(const std::string& page);
+
+    /**
+    * \brief Switches to the next page.
+    */
+    void nextPage();
+    const std::string& getActivePage() const;
+
+    /**
+    * \brief Returns values of the active page.
+    */
     const std::unordered_map<std::string, std::string>& getValues() const;
 
+    static const std::string s_defaultPage; /**< Name of the default page. */
+
    private:
     size_t m_logBufferSize = 10;        /**< Maximum number of log events stored. */
     std::list<std::string> m_logBuffer; /**< Log buffer with latest log events. */
-    std::unordered_map<std::string, std::string> m_values; /**< Stores debug key/value pairs. */
+    std::map<std::string, std::unordered_map<std::string, std::string>>
+        m_pages;                              /**< Stores debug key/value pairs per page. */
+    std::string m_activePage = s_defaultPage; /**< Currently displayed page. */
 };
@@ -14,6 +14,7 @@
 
 std::ofstream CLogger::s_stream;
 std::list<ILogListener*> CLogger::s_listeners;
+std::recursive_mutex CLogger::s_mutex;
 
 void CLogger::log(const char* level, const char* file, int line, const char* function,
                   const char* format, ...)
@@ -25,6 +26,9 @@ void CLogger::log(const char* level, const char* file, int line, const char* fun
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
 
+    // Listeners may log themselves
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+
     // Print to standard output
     std::cout << level << ": " << buffer << std::endl;
     // Print to file
@@ -58,6 +62,14 @@ bool CLogger::initLogFile(const std::string& logFile)
     return false;
 }
 
-void CLogger::addListener(ILogListener* l) { s_listeners.push_back(l); }
+void CLogger::addListener(ILogListener* l)
+{
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+    s_listeners.push_back(l);
+}
 
-void CLogger::removeListener(ILogListener* l) { s_listeners.remove(l); }
+void CLogger::removeListener(ILogListener* l)
+{
+    std::lock_guard<std::recursive_mutex> lock(s_mutex);
+    s_listeners.remove(l);
+}
@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <list>
+#include <mutex>
 #include <string>
 
 class ILogListener;
@@ -27,8 +28,7 @@ class CLogger
     static void removeListener(ILogListener* listener);
 
    private:
-    static std::ofstream s_stream; /**< Log file stream. */
-
-    // TODO make access to s_listeners thread safe?
-    static std::list<ILogListener*> s_listeners;
+    static std::ofstream s_stream;               /**< Log file stream. */
+    static std::list<ILogListener*> s_listeners; /**< Registered log listeners. */
+    static std::recursive_mutex s_mutex;         /**< Serializes logging from worker threads. */
 };
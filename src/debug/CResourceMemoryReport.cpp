@@ -0,0 +1,196 @@
+#include "CResourceMemoryReport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+#include <json/json.h>
+
+#include "CDebugInfo.h"
+#include "Log.h"
+
+#include "resource/IResourceManager.h"
+#include "graphics/IGraphicsResourceManager.h"
+
+/**
+* \brief Returns display name of resource type.
+*/
+static const char* getTypeName(EResourceType type)
+{
+    switch (type)
+    {
+    case EResourceType::Mesh:
+        return "Mesh";
+    case EResourceType::Image:
+        return "Image";
+    case EResourceType::String:
+        return "String";
+    case EResourceType::Shader:
+        return "Shader";
+    case EResourceType::Material:
+        return "Material";
+    default:
+        return "Unknown";
+    }
+}
+
+/**
+* \brief Formats byte count as human readable string.
+*/
+static std::string formatBytes(size_t bytes)
+{
+    char buffer[32];
+    if (bytes >= 1024 * 1024)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.2f MB", bytes / (1024.0 * 1024.0));
+    }
+    else
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.2f KB", bytes / 1024.0);
+    }
+    return buffer;
+}
+
+void CResourceMemoryReport::collect(const IResourceManager& resourceManager,
+                                    const IGraphicsResourceManager& graphicsResourceManager)
+{
+    std::vector<SResourceUsage> usage;
+    resourceManager.getResourceUsage(usage);
+
+    m_entries.clear();
+    m_entries.reserve(usage.size());
+    for (const auto& resource : usage)
+    {
+        SEntry entry;
+        entry.m_usage = resource;
+        entry.m_gpuBytes = graphicsResourceManager.getMemoryUsage(resource.m_type, resource.m_id);
+        m_entries.push_back(entry);
+    }
+}
+
+void CResourceMemoryReport::writeToDebugInfo(CDebugInfo& info, const std::string& page,
+                                             unsigned int maxFiles) const
+{
+    info.clearPage(page);
+
+    std::vector<STotal> totals;
+    getTypeTotals(totals);
+    size_t cpuBytes = 0;
+    size_t gpuBytes = 0;
+    for (const auto& total : totals)
+    {
+        info.setValue(page, total.m_name, std::to_string(total.m_count) + " CPU " +
+                                              formatBytes(total.m_cpuBytes) + " GPU " +
+                                              formatBytes(total.m_gpuBytes));
+        cpuBytes += total.m_cpuBytes;
+        gpuBytes += total.m_gpuBytes;
+    }
+    info.setValue(page, "Total", "CPU " + formatBytes(cpuBytes) + " GPU " + formatBytes(gpuBytes));
+
+    // Largest files, keys are prefixed with rank to keep them distinguishable
+    getFileTotals(totals);
+    for (unsigned int i = 0; i < totals.size() && i < maxFiles; ++i)
+    {
+        info.setValue(page, "#" + std::to_string(i + 1) + " " + totals.at(i).m_name,
+                      "CPU " + formatBytes(totals.at(i).m_cpuBytes) + " GPU " +
+                          formatBytes(totals.at(i).m_gpuBytes));
+    }
+}
+
+bool CResourceMemoryReport::saveAsJson(const std::string& file) const
+{
+    Json::Value root;
+
+    std::vector<STotal> totals;
+    getTypeTotals(totals);
+    for (const auto& total : totals)
+    {
+        Json::Value node;
+        node["type"] = total.m_name;
+        node["count"] = total.m_count;
+        node["cpu_bytes"] = Json::UInt64(total.m_cpuBytes);
+        node["gpu_bytes"] = Json::UInt64(total.m_gpuBytes);
+        root["types"].append(node);
+    }
+
+    getFileTotals(totals);
+    for (const auto& total : totals)
+    {
+        Json::Value node;
+        node["file"] = total.m_name;
+        node["count"] = total.m_count;
+        node["cpu_bytes"] = Json::UInt64(total.m_cpuBytes);
+        node["gpu_bytes"] = Json::UInt64(total.m_gpuBytes);
+        root["files"].append(node);
+    }
+
+    for (const auto& entry : m_entries)
+    {
+        Json::Value node;
+        node["type"] = getTypeName(entry.m_usage.m_type);
+        node["id"] = Json::Int64(entry.m_usage.m_id);
+        node["file"] = entry.m_usage.m_file;
+        node["references"] = entry.m_usage.m_references;
+        node["cpu_bytes"] = Json::UInt64(entry.m_usage.m_cpuBytes);
+        node["gpu_bytes"] = Json::UInt64(entry.m_gpuBytes);
+        root["resources"].append(node);
+    }
+
+    std::ofstream ofs(file);
+    if (!ofs.is_open())
+    {
+        LOG_ERROR("Failed to open memory report file %s for writing.", file.c_str());
+        return false;
+    }
+    Json::StyledStreamWriter writer;
+    writer.write(ofs, root);
+    LOG_INFO("Saved resource memory report to %s.", file.c_str());
+    return true;
+}
+
+void CResourceMemoryReport::getTypeTotals(std::vector<STotal>& totals) const
+{
+    totals.clear();
+    for (EResourceType type : {EResourceType::Mesh, EResourceType::Image, EResourceType::String,
+                               EResourceType::Shader, EResourceType::Material})
+    {
+        STotal total = {getTypeName(type), 0, 0, 0};
+        for (const auto& entry : m_entries)
+        {
+            if (entry.m_usage.m_type == type)
+            {
+                ++total.m_count;
+                total.m_cpuBytes += entry.m_usage.m_cpuBytes;
+                total.m_gpuBytes += entry.m_gpuBytes;
+            }
+        }
+        totals.push_back(total);
+    }
+}
+
+void CResourceMemoryReport::getFileTotals(std::vector<STotal>& totals) const
+{
+    std::map<std::string, STotal> files;
+    for (const auto& entry : m_entries)
+    {
+        // Resources created at runtime have no source file
+        const std::string& name =
+            entry.m_usage.m_file.empty() ? "<created>" : entry.m_usage.m_file;
+        STotal& total = files[name];
+        total.m_name = name;
+        ++total.m_count;
+        total.m_cpuBytes += entry.m_usage.m_cpuBytes;
+        total.m_gpuBytes += entry.m_gpuBytes;
+    }
+
+    totals.clear();
+    for (const auto& file : files)
+    {
+        totals.push_back(file.second);
+    }
+    std::sort(totals.begin(), totals.end(), [](const STotal& lhs, const STotal& rhs)
+              {
+                  return lhs.m_cpuBytes + lhs.m_gpuBytes > rhs.m_cpuBytes + rhs.m_gpuBytes;
+              });
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "resource/SResourceUsage.h"
+
+class CDebugInfo;
+class IResourceManager;
+class IGraphicsResourceManager;
+
+/**
+ * \brief Memory usage report for loaded resources.
+ * Combines CPU side usage from the resource manager with GPU side usage from the graphics
+ * resource manager and aggregates it per resource type and per source file.
+ */
+class CResourceMemoryReport
+{
+   public:
+    /**
+    * \brief Collects current memory usage from resource managers.
+    */
+    void collect(const IResourceManager& resourceManager,
+                 const IGraphicsResourceManager& graphicsResourceManager);
+
+    /**
+    * \brief Writes per type totals and the largest files to a debug info page.
+    */
+    void writeToDebugInfo(CDebugInfo& info, const std::string& page,
+                          unsigned int maxFiles = 10) const;
+
+    /**
+    * \brief Writes full report as json file.
+    */
+    bool saveAsJson(const std::string& file) const;
+
+   private:
+    /**
+    * \brief Memory usage of resource with GPU side usage.
+    */
+    struct SEntry
+    {
+        SResourceUsage m_usage; /**< CPU side usage. */
+        size_t m_gpuBytes;      /**< GPU side usage. */
+    };
+
+    /**
+    * \brief Aggregated memory usage.
+    */
+    struct STotal
+    {
+        std::string m_name;   /**< Resource type or file name. */
+        unsigned int m_count; /**< Number of resources. */
+        size_t m_cpuBytes;    /**< CPU memory in bytes. */
+        size_t m_gpuBytes;    /**< GPU memory in bytes. */
+    };
+
+    /**
+    * \brief Aggregates entries per resource type.
+    */
+    void getTypeTotals(std::vector<STotal>& totals) const;
+
+    /**
+    * \brief Aggregates entries per file, sorted by total size in descending order.
+    */
+    void getFileTotals(std::vector<STotal>& totals) const;
+
+    std::vector<SEntry> m_entries; /**< Collected resource entries. */
+};
@@ -1,14 +1,18 @@
 #include "RTRDemo.h"
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // Debug
 #include "debug/CDebugInfo.h"
+#include "debug/CResourceMemoryReport.h"
 #include "debug/Log.h"
 
 // Graphics
 #include "graphics/renderer/core/RendererCoreConfig.h"
+#include "graphics/renderer/core/CUploadQueue.h"
 #include "graphics/renderer/debug/RendererDebug.h"
 
 #include <GLFW/glfw3.h>
@@ -26,6 +30,8 @@
 #include "graphics/scene/CScene.h"
 #include "graphics/window/CGlfwWindow.h"
 #include "graphics/resource/CGraphicsResourceManager.h"
+#include "graphics/resource/CTextureStreamer.h"
+#include "graphics/resource/CShaderBinaryCache.h"
 
 #include "util/TimeStamp.h"
 #include "graphics/CDebugInfoDisplay.h"
@@ -75,14 +81,87 @@ int RTRDemo::init(const std::string& configFile)
         return 1;
     }
 
+    // Mount optional asset pack, loose files are used for everything not in the pack
+    std::string packFile = m_config.getValue("resource", "pack", "");
+    if (!packFile.empty() && !m_resourceManager->mountPack(packFile))
+    {
+        LOG_WARNING("Failed to mount pack file %s, loading loose files only.", packFile.c_str());
+    }
+
+    // Memory budgets for unreferenced cached resources
+    size_t cpuBudget = m_config.getValue("resource", "cpu_budget_mb", 0);
+    size_t gpuBudget = m_config.getValue("resource", "gpu_budget_mb", 0);
+    m_resourceManager->setMemoryBudget(cpuBudget * 1024 * 1024, gpuBudget * 1024 * 1024);
+
+    // CPU side residency of mesh and image data after upload
+    std::string residency = m_config.getValue("resource", "residency", "keep");
+    EResidencyPolicy policy = EResidencyPolicy::Keep;
+    if (residency == "drop")
+    {
+        policy = EResidencyPolicy::DropAfterUpload;
+    }
+    else if (residency == "reload")
+    {
+        policy = EResidencyPolicy::Reload;
+    }
+    else if (residency != "keep")
+    {
+        LOG_WARNING("Unknown resource residency %s, keeping resource data.", residency.c_str());
+    }
+    m_resourceManager->setDefaultResidencyPolicy(EResourceType::Mesh, policy);
+    m_resourceManager->setDefaultResidencyPolicy(EResourceType::Image, policy);
+
+    // Mip generation for uncompressed images
+    std::string mipFilter = m_config.getValue("resource", "mip_filter", "kaiser");
+    if (mipFilter != "box" && mipFilter != "kaiser")
+    {
+        LOG_WARNING("Unknown mip filter %s, using kaiser filter.", mipFilter.c_str());
+    }
+    m_resourceManager->setMipGeneration(mipFilter == "box" ? EMipFilter::Box : EMipFilter::Kaiser,
+                                        m_config.getValue("resource", "mip_cache", 1) != 0);
+
+    // Changed files are reloaded while running
+    m_resourceManager->setHotReload(m_config.getValue("resource", "hot_reload", 0) != 0);
+
 	// Create animation world
 	m_animationWorld = std::make_shared<CAnimationWorld>();
 
+    // Asynchronous texture and buffer uploads through a staging buffer
+    size_t uploadLimit = m_config.getValue("renderer", "upload_limit_kb", 4096);
+    if (m_config.getValue("renderer", "upload_queue", 1) != 0)
+    {
+        size_t stagingSize = m_config.getValue("renderer", "upload_staging_mb", 32);
+        m_uploadQueue =
+            std::make_shared<CUploadQueue>(stagingSize * 1024 * 1024, uploadLimit * 1024);
+    }
+
     // Graphics resource manager, listens to resource manager
     CGraphicsResourceManager* manager = new CGraphicsResourceManager;
+    bool textureStreaming = m_config.getValue("resource", "texture_streaming", 1) != 0;
+    manager->setTextureStreaming(textureStreaming);
+    manager->setUploadQueue(m_uploadQueue);
+
+    // Linked program binaries are cached across runs
+    if (m_config.getValue("renderer", "shader_cache", 1) != 0)
+    {
+        m_shaderCache = std::make_shared<CShaderBinaryCache>("cache/shader/");
+        manager->setShaderCache(m_shaderCache);
+    }
     m_resourceManager->addResourceListener(manager);
     m_graphicsResourceManager.reset(manager);
 
+    // Streams finer texture levels on demand, textures are created with coarse levels only
+    if (textureStreaming)
+    {
+        m_textureStreamer =
+            std::make_shared<CTextureStreamer>(m_resourceManager.get(), manager);
+        size_t textureBudget = m_config.getValue("resource", "texture_budget_mb", 0);
+        m_textureStreamer->setMemoryBudget(textureBudget * 1024 * 1024);
+        m_textureStreamer->setUploadLimit(uploadLimit * 1024);
+        m_textureStreamer->setUploadQueue(m_uploadQueue.get());
+        m_textureStreamer->setMipBias(m_config.getValue("resource", "texture_mip_bias", 0.f));
+    }
+
     // Create renderer
     if (!initRenderer())
     {
@@ -96,6 +175,16 @@ int RTRDemo::init(const std::string& configFile)
         return 1;
     }
 
+    // Scene resources are complete before the first frame
+    if (m_uploadQueue != nullptr)
+    {
+        m_uploadQueue->flush();
+    }
+
+    // Shaders compiled in the background while the scene was loading
+    manager->finishShaderPrograms(true);
+    logShaderTimings(*manager);
+
     m_camera = std::make_shared<CFirstPersonCamera>(
         glm::vec3(0.5f, 0.f, 0.5f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 1.f, 0.f), 45.f,
         4.f / 3.f, 0.01f, 1000.f);
@@ -116,8 +205,11 @@ int RTRDemo::run()
     double f1Cooldown = 0.0;
     double f2Cooldown = 0.0;
     double f3Cooldown = 0.0;
+    double f4Cooldown = 0.0;
     double f5Cooldown = 0.0;
+    double f7Cooldown = 0.0;
     double k1Cooldown = 0.0;
+    double k2Cooldown = 0.0;
     double timeDiff = 0.0;
 
     double fpsCoolDown = 1.f;
@@ -136,8 +228,11 @@ int RTRDemo::run()
         f1Cooldown -= timeDiff;
         f2Cooldown -= timeDiff;
         f3Cooldown -= timeDiff;
+        f4Cooldown -= timeDiff;
         f5Cooldown -= timeDiff;
+        f7Cooldown -= timeDiff;
         k1Cooldown -= timeDiff;
+        k2Cooldown -= timeDiff;
         fpsCoolDown -= timeDiff;
 
         if (fpsCoolDown < 0)
@@ -145,6 +240,14 @@ int RTRDemo::run()
             fpsCoolDown += 1.f;
             lastFrameCount = currentFrameCount;
             currentFrameCount = 0;
+
+            // Memory usage changes slowly, update the report page once per second
+            if (displayDebugInfo)
+            {
+                CResourceMemoryReport report;
+                report.collect(*m_resourceManager, *m_graphicsResourceManager);
+                report.writeToDebugInfo(*m_debugInfo, "Memory");
+            }
         }
 
         if (glfwGetKey(m_window->getGlfwHandle(), GLFW_KEY_1) == GLFW_PRESS && k1Cooldown <= 0.f)
@@ -153,6 +256,21 @@ int RTRDemo::run()
             displayDebugInfo = !displayDebugInfo;
         }
 
+        if (glfwGetKey(m_window->getGlfwHandle(), GLFW_KEY_2) == GLFW_PRESS && k2Cooldown <= 0.f)
+        {
+            k2Cooldown = 0.3f;
+            m_debugInfo->nextPage();
+        }
+
+        if (glfwGetKey(m_window->getGlfwHandle(), GLFW_KEY_F7) == GLFW_PRESS && f7Cooldown <= 0.f)
+        {
+            f7Cooldown = 0.3f;
+            // Dump resource memory usage
+            CResourceMemoryReport report;
+            report.collect(*m_resourceManager, *m_graphicsResourceManager);
+            report.saveAsJson("log/memory_" + createTimeStamp() + ".json");
+        }
+
         if (glfwGetKey(m_window->getGlfwHandle(), GLFW_KEY_F2) == GLFW_PRESS && f2Cooldown <= 0.f)
         {
             f2Cooldown = 0.3f;
@@ -165,6 +283,13 @@ int RTRDemo::run()
             m_renderer = m_forwardRenderer;
         }
         
+        if (glfwGetKey(m_window->getGlfwHandle(), GLFW_KEY_F4) == GLFW_PRESS && f4Cooldown <= 0.f)
+        {
+            f4Cooldown = 0.3f;
+            // Reload scene, unchanged resources are kept and reused
+            loadScene(m_config.getValue("scene", "file", "data/scene/test_1.json"));
+        }
+
         if (glfwGetKey(m_window->getGlfwHandle(), GLFW_KEY_F5) == GLFW_PRESS && f5Cooldown <= 0.f)
         {
             f5Cooldown = 0.3f;
@@ -173,6 +298,19 @@ int RTRDemo::run()
 
         m_cameraController->animate((float)timeDiff);
 
+        // Reloaded resources are uploaded by the upload queue
+        m_resourceManager->updateHotReload();
+
+        if (m_textureStreamer != nullptr)
+        {
+            m_textureStreamer->update(*m_scene.get(), *m_camera.get(), m_window->getHeight());
+        }
+
+        if (m_uploadQueue != nullptr)
+        {
+            m_uploadQueue->update();
+        }
+
         m_renderer->draw(*m_scene.get(), *m_camera.get(), *m_window.get(),
                          *m_graphicsResourceManager.get());
 
@@ -183,6 +321,13 @@ int RTRDemo::run()
             m_debugInfo->setValue("Camera y", std::to_string(m_camera->getPosition().y));
             m_debugInfo->setValue("Camera z", std::to_string(m_camera->getPosition().z));
             m_debugInfo->setValue("FPS", std::to_string(lastFrameCount));
+            if (m_textureStreamer != nullptr)
+            {
+                m_debugInfo->setValue(
+                    "Streamed textures",
+                    std::to_string(m_textureStreamer->getMemoryUsage() / (1024 * 1024)) + " MB, " +
+                        std::to_string(m_textureStreamer->getPendingCount()) + " pending");
+            }
 
             m_debugInfoDisplay->draw(*m_debugInfo.get());
         }
@@ -257,12 +402,35 @@ bool RTRDemo::initRenderer()
 
     // Initialize deferred renderer
     LOG_INFO("Initializing deferred renderer.");
-    m_deferredRenderer.reset(CDeferredRenderer::create(m_resourceManager.get()));
-    if (m_deferredRenderer == nullptr)
+    CDeferredRenderer* deferredRenderer = CDeferredRenderer::create(m_resourceManager.get());
+    if (deferredRenderer == nullptr)
     {
         LOG_ERROR("Failed to initialize deferred renderer.");
         return false;
     }
+    // Fog, depth of field and god rays are composited in a single pass
+    deferredRenderer->setUberPostProcessing(m_config.getValue("renderer", "uber_post", 1) != 0);
+    // Blur and god rays are generated at reduced resolution
+    deferredRenderer->setPostEffectResolution(m_config.getValue("post", "blur_resolution", 2),
+                                              m_config.getValue("post", "god_ray_resolution", 2));
+    // Render resolution is scaled to meet the GPU frame time
+    deferredRenderer->setDynamicResolution(
+        m_config.getValue("renderer", "dynamic_resolution", 0) != 0,
+        m_config.getValue("renderer", "frame_time_ms", 16.6f),
+        m_config.getValue("renderer", "min_resolution_scale", 0.5f));
+    // Normals and specularity are packed into a two channel target
+    deferredRenderer->setCompactGBuffer(m_config.getValue("renderer", "compact_gbuffer", 1) != 0);
+    // Depth is laid down before the g-buffer is written
+    deferredRenderer->setDepthPrepass(m_config.getValue("renderer", "depth_prepass", 1) != 0);
+    // Objects behind occluder meshes are culled on the CPU
+    deferredRenderer->setOcclusionCulling(
+        m_config.getValue("renderer", "occlusion_culling", 1) != 0);
+    // Objects occluded in the previous frame are tested with hardware occlusion queries
+    deferredRenderer->setOcclusionQueries(
+        m_config.getValue("renderer", "occlusion_queries", 0) != 0);
+    // Window sized targets are reallocated on resize events only
+    m_window->addListener(deferredRenderer);
+    m_deferredRenderer.reset(deferredRenderer);
 
     // Initialize forward renderer
     LOG_INFO("Initializing forward renderer.");
@@ -303,19 +471,73 @@ bool RTRDemo::initRenderer()
     return true;
 }
 
-bool RTRDemo::initScene()
+void RTRDemo::logShaderTimings(const CGraphicsResourceManager& manager) const
 {
-    m_scene = std::make_shared<CScene>();
-    CSceneLoader loader(*m_resourceManager);
+    // Shader file names by program id
+    std::vector<SResourceUsage> usage;
+    m_resourceManager->getResourceUsage(usage);
+    std::unordered_map<ResourceId, std::string> files;
+    for (const SResourceUsage& resource : usage)
+    {
+        if (resource.m_type == EResourceType::Shader)
+        {
+            files[resource.m_id] = resource.m_file;
+        }
+    }
+
+    double submitSeconds = 0.;
+    double waitSeconds = 0.;
+    double readySeconds = 0.;
+    for (const auto& timing : manager.getShaderProgramTimings())
+    {
+        auto file = files.find(timing.m_id);
+        LOG_INFO("Shader %s: %s, submit %.2f ms, ready after %.2f ms, waited %.2f ms%s",
+                 file != files.end() ? file->second.c_str() : "created",
+                 timing.m_cached ? "cached binary" : "compiled", timing.m_submitSeconds * 1000.,
+                 timing.m_readySeconds * 1000., timing.m_waitSeconds * 1000.,
+                 timing.m_valid ? "" : ", failed");
+        submitSeconds += timing.m_submitSeconds;
+        waitSeconds += timing.m_waitSeconds;
+        readySeconds = std::max(readySeconds, timing.m_readySeconds);
+    }
+    LOG_INFO("Shader startup: %u programs, submit %.1f ms, waited %.1f ms, all ready after %.1f ms",
+             (unsigned int)manager.getShaderProgramTimings().size(), submitSeconds * 1000.,
+             waitSeconds * 1000., readySeconds * 1000.);
+
+    if (m_shaderCache != nullptr)
+    {
+        LOG_INFO("Shader cache: %u programs loaded from binaries, %u compiled, %.1f ms saved.",
+                 m_shaderCache->getHitCount(), m_shaderCache->getMissCount(),
+                 m_shaderCache->getSavedSeconds() * 1000.);
+    }
+}
 
+bool RTRDemo::initScene()
+{
     // Get startup scene from config
     std::string sceneFile = m_config.getValue("scene", "file", "data/scene/test_1.json");
     LOG_INFO("Loading initial scene from file %s.", sceneFile.c_str());
-    if (!loader.load(sceneFile, *m_scene, *m_animationWorld))
+    return loadScene(sceneFile);
+}
+
+bool RTRDemo::loadScene(const std::string& sceneFile)
+{
+    std::shared_ptr<IScene> scene = std::make_shared<CScene>();
+    std::shared_ptr<CAnimationWorld> animationWorld = std::make_shared<CAnimationWorld>();
+    CSceneLoader loader(*m_resourceManager);
+
+    if (!loader.load(sceneFile, *scene, *animationWorld))
     {
         LOG_ERROR("Failed to load scene file %s.", sceneFile.c_str());
-        m_scene = nullptr;
         return false;
     }
+
+    // Replace active scene and release resources only used by the former scene
+    m_scene = scene;
+    m_animationWorld = animationWorld;
+    std::vector<CResourceHandle> resources;
+    loader.takeResources(resources);
+    m_sceneResources.swap(resources);
+    resources.clear();
     return true;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "io/CIniFile.h"
+#include "resource/CResourceHandle.h"
 
 // GLFW
 struct GLFWwindow;
@@ -22,6 +23,10 @@ class IInputProvider;
 class IControllableCamera;
 class CCameraController;
 class IGraphicsResourceManager;
+class CTextureStreamer;
+class CGraphicsResourceManager;
+class CUploadQueue;
+class CShaderBinaryCache;
 class CAnimationWorld;
 
 // Debug
@@ -52,14 +57,32 @@ class RTRDemo
     bool initRenderer();
     bool initScene();
 
+    /**
+    * \brief Logs startup timing of the shader programs.
+    */
+    void logShaderTimings(const CGraphicsResourceManager& manager) const;
+
+    /**
+    * \brief Loads scene from file and replaces the active scene.
+    * Resources of the former scene are released after the new scene is loaded, so shared
+    * resources are not reloaded.
+    */
+    bool loadScene(const std::string& sceneFile);
+
 	void updateAnimation(float timeDiff);
 
     CIniFile m_config;
 
     std::shared_ptr<IResourceManager> m_resourceManager =
         nullptr; /**< Resource loader and manager. */
+    std::shared_ptr<CUploadQueue> m_uploadQueue =
+        nullptr; /**< Asynchronous uploads, null if uploads are synchronous. */
+    std::shared_ptr<CShaderBinaryCache> m_shaderCache =
+        nullptr; /**< Program binary cache, null if disabled. */
     std::shared_ptr<IGraphicsResourceManager> m_graphicsResourceManager =
         nullptr; /**< Resource manager for graphics resources. */
+    std::shared_ptr<CTextureStreamer> m_textureStreamer =
+        nullptr; /**< Streams texture mip levels, null if streaming is disabled. */
     
 	std::shared_ptr<CGlfwWindow> m_window = nullptr;
 	std::shared_ptr<IInputProvider> m_inputProvider = nullptr;
@@ -68,6 +91,7 @@ class RTRDemo
     std::shared_ptr<IRenderer> m_deferredRenderer = nullptr;         /**< Deferred renderer. */
     std::shared_ptr<IRenderer> m_forwardRenderer = nullptr;          /**< Forward renderer. */
     std::shared_ptr<IScene> m_scene = nullptr;                       /**< Active scene. */
+    std::vector<CResourceHandle> m_sceneResources; /**< Resources used by the active scene. */
     std::shared_ptr<IControllableCamera> m_camera = nullptr;         /**< Active camera. */
     std::shared_ptr<CCameraController> m_cameraController = nullptr; /**< Camera controller. */
 
@@ -74,17 +74,29 @@ CDebugInfoDisplay::CDebugInfoDisplay(std::shared_ptr<IResourceManager> resourceM
 
 bool CDebugInfoDisplay::loadFont(const std::string &path)
 {
-    ResourceId imageId = m_resourceManager->loadImage(path, EColorFormat::RGBA32);
+    ResourceId imageId =
+        m_resourceManager->loadImage(path, EColorFormat::RGBA32, EImageContent::Color);
+    // Font texture is created locally and needs the image data after upload
+    m_resourceManager->setResidencyPolicy(EResourceType::Image, imageId, EResidencyPolicy::Keep);
     std::vector<unsigned char> data;
-    unsigned int width, height;
+    unsigned int width, height, mipCount;
     EColorFormat colorFormat;
-    if (!m_resourceManager->getImage(imageId, data, width, height, colorFormat))
+    if (!m_resourceManager->getImage(imageId, data, width, height, colorFormat, mipCount))
     {
         LOG_ERROR("Error on retrieving data from image.");
         return false;
     }
 
-    m_texture.reset(new CTexture(data, width, height, colorFormat, false));
+    if (mipCount > 1 || colorFormat != EColorFormat::RGBA32)
+    {
+        // Font image has a precomputed mip chain
+        m_texture.reset(new CTexture());
+        m_texture->initMipChain(data, width, height, colorFormat, mipCount);
+    }
+    else
+    {
+        m_texture.reset(new CTexture(data, width, height, colorFormat, false));
+    }
 
     return true;
 }
@@ -156,6 +168,8 @@ void CDebugInfoDisplay::draw(const CDebugInfo &info)
     int hOffsetKeys = 500;
     int hOffsetValues = 650;
     int vOffsetKeyValues = 600;
+    // Page title is displayed above the key/value pairs
+    unsigned int valueLines = (unsigned int) info.getValues().size() + 1;
 
     // ===
     // render overlays
@@ -180,16 +194,16 @@ void CDebugInfoDisplay::draw(const CDebugInfo &info)
 	overlayVertices.push_back((float) hOffsetKeys);
 	overlayVertices.push_back((float) vOffsetKeyValues);
 	overlayVertices.push_back((float) hOffsetKeys);
-	overlayVertices.push_back((float) (vOffsetKeyValues - m_fontSize * info.getValues().size()));
+	overlayVertices.push_back((float) (vOffsetKeyValues - m_fontSize * valueLines));
 	overlayVertices.push_back(800.f);
 	overlayVertices.push_back((float) vOffsetKeyValues);
     
     overlayVertices.push_back(800.f);
 	overlayVertices.push_back((float) vOffsetKeyValues);
 	overlayVertices.push_back((float) hOffsetKeys);
-	overlayVertices.push_back((float) (vOffsetKeyValues - m_fontSize * info.getValues().size()));
+	overlayVertices.push_back((float) (vOffsetKeyValues - m_fontSize * valueLines));
     overlayVertices.push_back(800.f);
-	overlayVertices.push_back((float) (vOffsetKeyValues - m_fontSize * info.getValues().size()));
+	overlayVertices.push_back((float) (vOffsetKeyValues - m_fontSize * valueLines));
     
     m_overlaysBuffer->setData(overlayVertices);
     
@@ -218,7 +232,9 @@ void CDebugInfoDisplay::draw(const CDebugInfo &info)
                       UVs);
     }
 
-    int valueCount = 0;
+    int valueCount = 1;
+    textToBuffers("Page: " + info.getActivePage(), hOffsetKeys,
+                  vOffsetKeyValues - m_fontSize * valueCount, m_fontSize, vertices, UVs);
     for (const auto &keyValuePair : info.getValues())
     {
         ++valueCount;
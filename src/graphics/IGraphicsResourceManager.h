@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 #include "resource/ResourceConfig.h"
 
 class CMesh;
@@ -31,6 +33,7 @@ public:
 
 	/**
 	* \brief Maps id to internal texture object.
+	* Returns null for unloaded image ids.
 	*/
 	virtual CTexture* getTexture(ResourceId) const = 0;
 
@@ -47,4 +50,15 @@ public:
 	virtual CTexture* getDefaultSpecularTexture() const = 0;
 	virtual CTexture* getDefaultGlowTexture() const = 0;
 	virtual CTexture* getDefaultAlphaTexture() const = 0;
+
+	/**
+	* \brief Returns GPU memory in bytes used by the object created from the resource.
+	* Returns 0 for resource types without GPU side storage.
+	*/
+	virtual size_t getMemoryUsage(EResourceType type, ResourceId id) const = 0;
+
+	/**
+	* \brief Returns GPU memory in bytes used by all objects of the resource type.
+	*/
+	virtual size_t getMemoryUsage(EResourceType type) const = 0;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -40,6 +41,21 @@ class IScene
                            const glm::vec3& position, const glm::vec3& rotation,
                            const glm::vec3& scale) = 0;
 
+    /**
+    * \brief Sets model space bounding box of an object, used for occlusion culling.
+    * Objects without bounds are never culled.
+    */
+    virtual void setObjectBounds(SceneObjectId id, const glm::vec3& min,
+                                 const glm::vec3& max) = 0;
+
+    /**
+    * \brief Designates object as occluder for occlusion culling.
+    * \param vertices Model space positions with 3 floats per vertex.
+    * \param indices Triangle list indices.
+    */
+    virtual void setOccluder(SceneObjectId id, const std::vector<float>& vertices,
+                             const std::vector<unsigned int>& indices) = 0;
+
     /**
      * \brief Creates point light in scene and returns id.
      */
@@ -88,4 +104,10 @@ class IScene
      * Returns heap allocated query object. Control is transfered to the calling function.
      */
     virtual ISceneQuery* createQuery(const ICamera& camera) const = 0;
+
+    /**
+    * \brief Creates scene query for specified camera without objects hidden by occluders.
+    * Returns heap allocated query object. Control is transfered to the calling function.
+    */
+    virtual ISceneQuery* createOcclusionCulledQuery(const ICamera& camera) const = 0;
 };
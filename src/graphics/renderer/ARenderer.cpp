@@ -20,6 +20,11 @@ ARenderer::~ARenderer()
 
 void ARenderer::draw(CMesh* mesh)
 {
+    // Buffer data is still waiting in the upload queue
+    if (mesh->isUploadPending())
+    {
+        return;
+    }
     mesh->getVertexArray()->setActive();
 
     // Set primitive draw mode
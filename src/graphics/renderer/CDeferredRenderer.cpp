@@ -1,6 +1,8 @@
 #include "CDeferredRenderer.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <string>
 
 #include <glm/ext.hpp>
@@ -17,13 +19,79 @@
 #include "graphics/resource/CMesh.h"
 #include "graphics/resource/CTexture.h"
 #include "graphics/resource/CShaderProgram.h"
-#include "graphics/renderer/CRenderBuffer.h"
 
 #include "core/RendererCoreConfig.h"
+#include "GBufferEncoding.h"
 
 #include "debug/RendererDebug.h"
 #include "debug/Log.h"
 
+/**
+* \brief Returns fog shader variant for the fog type, 0 without fog.
+*/
+static unsigned int getFogFeatures(FogType type)
+{
+    switch (type)
+    {
+    case FogType::Linear:
+        return 1 << 0;
+    case FogType::Exp:
+        return 1 << 1;
+    case FogType::Exp2:
+        return 1 << 2;
+    default:
+        return 0;
+    }
+}
+
+/**
+* \brief Returns merged post processing shader variant for the enabled effects.
+*/
+static unsigned int getUberPostFeatures(const SFeatureInfo& features)
+{
+    unsigned int mask = getFogFeatures(features.fogType);
+    if (features.dofActive)
+    {
+        mask |= 1 << 3;
+    }
+    if (features.godRayActive || features.renderMode == RenderMode::GodRay)
+    {
+        mask |= 1 << 4;
+    }
+    return mask;
+}
+
+/**
+* \brief Returns geometry pass shader variant for material features and g-buffer layout.
+*/
+static unsigned int getGeometryFeatures(unsigned int materialFeatures, bool compactGBuffer)
+{
+    // Alpha maps are not used by the geometry pass
+    unsigned int mask = materialFeatures & (MaterialDiffuseMap | MaterialNormalMap |
+                                            MaterialSpecularMap | MaterialGlowMap);
+    if (compactGBuffer)
+    {
+        mask |= 1 << 4;
+    }
+    return mask;
+}
+
+/**
+* \brief Returns internal format of the normal and specularity target for the g-buffer layout.
+*/
+static GLint getNormalSpecularFormat(bool compactGBuffer)
+{
+    return compactGBuffer ? GL_RG16 : GL_RGBA16F;
+}
+
+/**
+* \brief Returns size of a reduced resolution target, partially covered pixels are included.
+*/
+static unsigned int getReducedSize(unsigned int size, unsigned int divisor)
+{
+    return (size + divisor - 1) / divisor;
+}
+
 CDeferredRenderer::CDeferredRenderer() { return; }
 
 CDeferredRenderer::~CDeferredRenderer() { return; }
@@ -117,43 +185,151 @@ void CDeferredRenderer::draw(const IScene& scene, const ICamera& camera, const I
     window.setActive();
 
     // Query visible scene objects and lights
-    std::unique_ptr<ISceneQuery> query(std::move(scene.createQuery(camera)));
+    std::unique_ptr<ISceneQuery> query(std::move(
+        m_occlusionCulling ? scene.createOcclusionCulledQuery(camera) : scene.createQuery(camera)));
+
+    // Window sized targets are only reallocated on resize events and on the first frame
+    if (m_resizePending || m_targetWidth == 0)
+    {
+        resizeTargets(m_resizePending ? m_resizeWidth : window.getWidth(),
+                      m_resizePending ? m_resizeHeight : window.getHeight());
+        m_resizePending = false;
+    }
+    unsigned int width = m_targetWidth;
+    unsigned int height = m_targetHeight;
+
+    // Dynamic resolution renders into a scaled region of the window sized targets, which is
+    // upscaled by the display pass
+    m_resolutionScale = 1.f;
+    if (m_dynamicResolution)
+    {
+        float frameTime;
+        if (m_frameTimer.getResult(frameTime) && m_resolutionController.update(frameTime))
+        {
+            LOG_DEBUG("Resolution scale changed to %.2f at %.2f ms GPU frame time.",
+                      m_resolutionController.getScale(), m_resolutionController.getFrameTime());
+        }
+        m_resolutionScale = m_resolutionController.getScale();
+        m_frameTimer.begin();
+    }
+
+    // Passes are scheduled by the render graph, passes which do not contribute to the displayed
+    // image are culled
+    m_renderGraph.reset();
+    m_renderGraph.setRenderScale(m_resolutionScale);
+    RenderTargetId depth = m_renderGraph.importTarget("depth", m_depthTexture);
+    RenderTargetId diffuseGlow = m_renderGraph.importTarget("diffuse glow", m_diffuseGlowTexture);
+    RenderTargetId normalSpecular =
+        m_renderGraph.importTarget("normal specular", m_normalSpecularTexture);
+    RenderTargetId light = m_renderGraph.importTarget("light", m_lightPassTexture);
+    RenderTargetId backBuffer =
+        m_renderGraph.importBackBuffer(window.getWidth(), window.getHeight());
 
     // Geometry pass fills gbuffer
-    geometryPass(scene, camera, window, manager, *query);
+    unsigned int pass = m_renderGraph.addPass(
+        "geometry", [&]() { geometryPass(scene, camera, window, manager, *query); });
+    // TODO Should be retrieved as scene parameters
+    m_renderGraph.write(pass, depth, GL_DEPTH_ATTACHMENT, LoadAction::Clear, glm::vec4(1.f));
+    m_renderGraph.write(pass, diffuseGlow, GL_COLOR_ATTACHMENT0, LoadAction::Clear,
+                        glm::vec4(0.f, 0.f, 0.f, 0.f));
+    glm::vec4 normalSpecularClear(0.5f, 0.5f, 1.f, 0.f);
+    if (m_compactGBuffer)
+    {
+        glm::vec2 packed = packNormalSpecular(glm::vec3(0.f, 0.f, 1.f), 0.f);
+        normalSpecularClear = glm::vec4(packed.x, packed.y, 0.f, 0.f);
+    }
+    m_renderGraph.write(pass, normalSpecular, GL_COLOR_ATTACHMENT1, LoadAction::Clear,
+                        normalSpecularClear);
 
-    // Light pass fills lbuffer
-    lightPass(scene, camera, window, manager, *query);
+    // Light pass fills lbuffer, shadow maps are rendered per light within the pass
+    glm::vec3 ambientColor;
+    float ambientIntensity;
+    scene.getAmbientLight(ambientColor, ambientIntensity);
+    pass = m_renderGraph.addPass(
+        "light", [&]() { lightPass(scene, camera, window, manager, *query); });
+    m_renderGraph.read(pass, depth);
+    m_renderGraph.read(pass, normalSpecular);
+    // Initialize light buffer with ambient light
+    m_renderGraph.write(pass, light, GL_COLOR_ATTACHMENT0, LoadAction::Clear,
+                        glm::vec4(ambientColor * ambientIntensity, 1.f));
 
     // Illumination pass renders lit scene from lbuffer and gbuffer
-    illuminationPass(scene, camera, window, manager, *query);
-
-    // Post processing pass
-    postProcessPass(camera, window, manager, m_illuminationPassTexture);
+    RenderTargetId illumination =
+        m_renderGraph.createTarget("illumination", width, height, GL_RGB);
+    pass = m_renderGraph.addPass(
+        "illumination", [&]() { illuminationPass(scene, camera, window, manager, *query); });
+    m_renderGraph.read(pass, light);
+    m_renderGraph.read(pass, diffuseGlow);
+    m_renderGraph.read(pass, depth);
+    m_renderGraph.write(pass, illumination, GL_COLOR_ATTACHMENT0);
+
+    // Post processing pass, the final image is written to the back buffer by its last pass
+    // Scaled images are upscaled by the display pass instead
+    RenderMode renderMode = camera.getFeatureInfo().renderMode;
+    bool directOutput = renderMode == RenderMode::Final && m_resolutionScale == 1.f;
+    RenderTargetId processed = postProcessPass(camera, window, manager, illumination, depth,
+                                               directOutput ? backBuffer : invalidRenderTarget);
 
-    CFrameBuffer::setDefaultActive();
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
     // Select rendering mode
-    if (camera.getFeatureInfo().renderMode == RenderMode::Color)
+    if (renderMode == RenderMode::Depth)
+    {
+        pass = m_renderGraph.addPass("visualize depth",
+                                     [&]() { visualizeDepthPass(camera, window, manager); });
+        m_renderGraph.read(pass, depth);
+        m_renderGraph.write(pass, backBuffer, GL_COLOR_ATTACHMENT0);
+    }
+    else if (processed != backBuffer)
     {
-        displayPass(window, manager, m_diffuseGlowTexture);
+        RenderTargetId displayed = processed;
+        if (renderMode == RenderMode::Color)
+        {
+            displayed = diffuseGlow;
+        }
+        else if (renderMode == RenderMode::Lights)
+        {
+            displayed = light;
+        }
+        else if (renderMode == RenderMode::Normals)
+        {
+            displayed = normalSpecular;
+        }
+        // Final display pass
+        pass = m_renderGraph.addPass("display", [&, displayed]() {
+            displayPass(window, manager, m_renderGraph.getTexture(displayed));
+        });
+        m_renderGraph.read(pass, displayed);
+        // Display covers the whole back buffer, no clear needed
+        m_renderGraph.write(pass, backBuffer, GL_COLOR_ATTACHMENT0);
     }
-    else if (camera.getFeatureInfo().renderMode == RenderMode::Depth)
+    m_renderGraph.setOutput(backBuffer);
+
+    if (m_renderGraph.compile())
     {
-        visualizeDepthPass(camera, window, manager);
+        m_renderGraph.execute();
     }
-    else if (camera.getFeatureInfo().renderMode == RenderMode::Lights)
+    if (m_dynamicResolution)
     {
-        displayPass(window, manager, m_lightPassTexture);
+        m_frameTimer.end();
     }
-    else if (camera.getFeatureInfo().renderMode == RenderMode::Normals)
+
+    // Steady state frames must not allocate render target storage or frame buffers
+    unsigned int textureAllocations = CTexture::getStorageAllocationCount();
+    unsigned int frameBufferCreations = m_renderGraph.getFrameBufferCreationCount();
+    if (textureAllocations != m_textureAllocations ||
+        frameBufferCreations != m_frameBufferCreations)
     {
-        displayPass(window, manager, m_normalSpecularTexture);
+        LOG_DEBUG("Frame allocated %u textures and %u frame buffers.",
+                  textureAllocations - m_textureAllocations,
+                  frameBufferCreations - m_frameBufferCreations);
+        m_textureAllocations = textureAllocations;
+        m_frameBufferCreations = frameBufferCreations;
+        m_allocationFreeFrames = 0;
     }
-    else  // Final mode
+    else if (++m_allocationFreeFrames == s_steadyStateFrames)
     {
-        // Final display pass
-        displayPass(window, manager, m_postProcessPassOutputTexture);
+        LOG_INFO("No texture or frame buffer allocations for %u frames, %u textures and %u frame "
+                 "buffers allocated in total.",
+                 s_steadyStateFrames, m_textureAllocations, m_frameBufferCreations);
     }
 
     // Post draw error check
@@ -164,6 +340,117 @@ void CDeferredRenderer::draw(const IScene& scene, const ICamera& camera, const I
     }
 }
 
+void CDeferredRenderer::handleResizeEvent(int width, int height)
+{
+    // Minimized windows report zero size, targets are kept
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+    // Applied by the next draw
+    m_resizePending = true;
+    m_resizeWidth = (unsigned int)width;
+    m_resizeHeight = (unsigned int)height;
+}
+
+unsigned int CDeferredRenderer::getAllocationFreeFrameCount() const
+{
+    return m_allocationFreeFrames;
+}
+
+void CDeferredRenderer::setUberPostProcessing(bool enabled)
+{
+    m_uberPostProcessing = enabled;
+    m_reportedPostFeatures = ~0u;
+}
+
+void CDeferredRenderer::setDynamicResolution(bool enabled, float targetFrameTime,
+                                             float minScale)
+{
+    m_dynamicResolution = enabled;
+    m_resolutionController.setTargetFrameTime(targetFrameTime);
+    m_resolutionController.setScaleRange(std::max(0.1f, std::min(1.f, minScale)), 1.f);
+}
+
+void CDeferredRenderer::setPostEffectResolution(unsigned int blurDivisor,
+                                                unsigned int godRayDivisor)
+{
+    auto validate = [](unsigned int divisor, const char* effect) -> unsigned int {
+        if (divisor != 1 && divisor != 2 && divisor != 4)
+        {
+            LOG_WARNING("Invalid %s resolution divisor %u, using full resolution.", effect,
+                        divisor);
+            return 1;
+        }
+        return divisor;
+    };
+    m_blurResolutionDivisor = validate(blurDivisor, "blur");
+    m_godRayResolutionDivisor = validate(godRayDivisor, "god ray");
+    m_reportedPostFeatures = ~0u;
+}
+
+void CDeferredRenderer::setCompactGBuffer(bool enabled)
+{
+    if (enabled == m_compactGBuffer)
+    {
+        return;
+    }
+    m_compactGBuffer = enabled;
+
+    // Replace target with the format of the layout, size is kept
+    unsigned int width = m_normalSpecularTexture->getWidth();
+    unsigned int height = m_normalSpecularTexture->getHeight();
+    std::shared_ptr<CTexture> texture = std::make_shared<CTexture>();
+    if (!texture->init(width, height, getNormalSpecularFormat(enabled)))
+    {
+        LOG_ERROR("Failed to create normal specular texture for the %s g-buffer layout.",
+                  enabled ? "compact" : "default");
+        m_compactGBuffer = !enabled;
+        return;
+    }
+    m_normalSpecularTexture = texture;
+
+    // Frame buffers may reference the replaced texture
+    m_renderGraph.releaseResources();
+}
+
+void CDeferredRenderer::setDepthPrepass(bool enabled)
+{
+    m_depthPrepass = enabled;
+    m_overdrawReportFrames = 0;
+}
+
+void CDeferredRenderer::setOcclusionCulling(bool enabled)
+{
+    m_occlusionCulling = enabled;
+}
+
+void CDeferredRenderer::setOcclusionQueries(bool enabled)
+{
+    m_occlusionQueryCulling = enabled;
+    m_overdrawReportFrames = 0;
+}
+
+void CDeferredRenderer::resizeTargets(unsigned int width, unsigned int height)
+{
+    if (width == m_targetWidth && height == m_targetHeight)
+    {
+        return;
+    }
+    LOG_DEBUG("Resizing deferred renderer targets to %u, %u.", width, height);
+    m_targetWidth = width;
+    m_targetHeight = height;
+
+    // Gbuffer and lbuffer are imported into the render graph
+    m_depthTexture->resize(width, height);
+    m_diffuseGlowTexture->resize(width, height);
+    m_normalSpecularTexture->resize(width, height);
+    m_lightPassTexture->resize(width, height);
+
+    // Pooled textures have the previous size and frame buffers may reference replaced textures
+    m_renderGraph.releaseResources();
+}
+
 CDeferredRenderer* CDeferredRenderer::create(IResourceManager* manager)
 {
     CDeferredRenderer* renderer = new CDeferredRenderer;
@@ -180,22 +467,9 @@ void CDeferredRenderer::geometryPass(const IScene& scene, const ICamera& camera,
                                      const IWindow& window, const IGraphicsResourceManager& manager,
                                      ISceneQuery& query)
 {
-    // Set framebuffer
-    m_geometryBuffer.setActive(GL_FRAMEBUFFER);
-    // Clear buffer
-    // TODO Should be retrieved as scene parameters
-    // Diffuse, glow
-    GLfloat diffuseGlow[] = {0.f, 0.f, 0.f, 0.f};
-    GLfloat normalSpecular[] = {0.5f, 0.5f, 1.f, 0.f};
-    glClearBufferfv(GL_COLOR, 0, diffuseGlow);
-    // Normal, specular
-    glClearBufferfv(GL_COLOR, 1, normalSpecular);
-
-    // Clear
-    glClear(GL_DEPTH_BUFFER_BIT);
-
-    // Geometry pass, uses gbuffer fbo
-    CShaderProgram* geometryPassShader = manager.getShaderProgram(m_geometryPassShaderId);
+    // Geometry pass, gbuffer is bound and cleared by the render graph
+    // Shader variant is selected per material
+    CShaderProgram* geometryPassShader = nullptr;
 
     // Depth
     glEnable(GL_DEPTH_TEST);
@@ -208,20 +482,25 @@ void CDeferredRenderer::geometryPass(const IScene& scene, const ICamera& camera,
     // Winding order, standard is counter-clockwise
     glFrontFace(GL_CCW);
 
-    // Reset viewport
-    glViewport(0, 0, window.getWidth(), window.getHeight());
-    m_geometryBuffer.resize(window.getWidth(), window.getHeight());
-
     // Set view and projection matrices
     m_transformer.setViewMatrix(camera.getView());
     m_transformer.setProjectionMatrix(camera.getProjection());
 
-    // Send view/projection to default shader
-    geometryPassShader->setUniform(viewMatrixUniformName, m_transformer.getViewMatrix());
-    geometryPassShader->setUniform(projectionMatrixUniformName,
-                                   m_transformer.getProjectionMatrix());
+    // Collect visible objects, objects occluded in the previous frame are drawn last
+    m_geometryDraws.clear();
+    m_occludedDraws.clear();
+    float nearMargin = 0.f;
+    if (m_occlusionQueryCulling)
+    {
+        m_occlusionQueries.beginFrame();
 
-    // Traverse visible objects
+        // Distance of the near plane corners to the camera, boxes closer to the camera may be
+        // clipped by the near plane
+        const glm::mat4& projection = camera.getProjection();
+        float zNear = projection[3][2] / (projection[2][2] - 1.f);
+        nearMargin = zNear * std::sqrt(1.f + 1.f / (projection[0][0] * projection[0][0]) +
+                                       1.f / (projection[1][1] * projection[1][1]));
+    }
     while (query.hasNextObject())
     {
         // Get next visible object
@@ -230,38 +509,183 @@ void CDeferredRenderer::geometryPass(const IScene& scene, const ICamera& camera,
         // Object attributes
         ResourceId meshId = -1;
         ResourceId materialId = -1;
-        glm::vec3 position;
-        glm::vec3 rotation;
-        glm::vec3 scale;
+        SGeometryDraw object;
+        object.m_id = id;
 
         // Retrieve object data
-        if (!scene.getObject(id, meshId, materialId, position, rotation, scale))
+        if (!scene.getObject(id, meshId, materialId, object.m_position, object.m_rotation,
+                             object.m_scale))
         {
             // Invalid id
             LOG_ERROR("Invalid scene object id %l.", id);
+            continue;
+        }
+
+        // Resolve ids
+        object.m_mesh = manager.getMesh(meshId);
+        object.m_material = manager.getMaterial(materialId);
+        if (object.m_mesh == nullptr || object.m_material == nullptr)
+        {
+            // Resources have been unloaded
+            continue;
+        }
+        if (object.m_material->hasCustomShader())
+        {
+            // Custom shaders not supported
+            LOG_WARNING("Deferred renderer does not support custom material shaders.");
+            continue;
+        }
+
+        // Camera looks along negative z in view space
+        object.m_depth = -(camera.getView() * glm::vec4(object.m_position, 1.f)).z;
+
+        // Box around the bounding sphere, objects with boxes near the camera are always drawn
+        glm::vec3 scale = glm::abs(object.m_scale);
+        object.m_extent =
+            object.m_mesh->getBoundingRadius() * std::max(scale.x, std::max(scale.y, scale.z));
+        glm::vec3 offset = glm::abs(camera.getPosition() - object.m_position);
+        if (std::max(offset.x, std::max(offset.y, offset.z)) <= object.m_extent + nearMargin)
+        {
+            object.m_extent = 0.f;
+        }
+        if (m_occlusionQueryCulling && object.m_extent > 0.f &&
+            !m_occlusionQueries.isVisible(id))
+        {
+            m_occludedDraws.push_back(object);
         }
         else
         {
-            // Resolve ids
-            CMesh* mesh = manager.getMesh(meshId);
-            CMaterial* material = manager.getMaterial(materialId);
+            m_geometryDraws.push_back(object);
+        }
+    }
 
-            // Set transformations
-            m_transformer.setPosition(position);
-            m_transformer.setRotation(rotation);
-            m_transformer.setScale(scale);
+    // Front to back, so early depth tests reject hidden fragments
+    std::sort(m_geometryDraws.begin(), m_geometryDraws.end(),
+              [](const SGeometryDraw& lhs, const SGeometryDraw& rhs) {
+                  return lhs.m_depth < rhs.m_depth;
+              });
 
-            if (material->hasCustomShader())
-            {
-                // Custom shaders not supported
-                LOG_WARNING("Deferred renderer does not support custom material shaders.");
-            }
-            else
-            {
-                // Forward draw call
-                draw(mesh, m_transformer.getTranslationMatrix(), m_transformer.getRotationMatrix(),
-                     m_transformer.getScaleMatrix(), material, manager, geometryPassShader);
-            }
+    // Draws object with the cheapest variant, which only samples the maps of the material
+    auto drawObject = [&](const SGeometryDraw& object)
+    {
+        // Set transformations
+        m_transformer.setPosition(object.m_position);
+        m_transformer.setRotation(object.m_rotation);
+        m_transformer.setScale(object.m_scale);
+
+        CShaderProgram* shader = m_geometryPassShaders.getShaderProgram(
+            getGeometryFeatures(object.m_material->getFeatures(), m_compactGBuffer), manager);
+        if (shader == nullptr)
+        {
+            return;
+        }
+        if (shader != geometryPassShader)
+        {
+            // Send view/projection on variant change
+            geometryPassShader = shader;
+            geometryPassShader->setUniform(viewMatrixUniformName, m_transformer.getViewMatrix());
+            geometryPassShader->setUniform(projectionMatrixUniformName,
+                                           m_transformer.getProjectionMatrix());
+        }
+
+        // Forward draw call
+        draw(object.m_mesh, m_transformer.getTranslationMatrix(), m_transformer.getRotationMatrix(),
+             m_transformer.getScaleMatrix(), object.m_material, manager, geometryPassShader);
+    };
+
+    // Depth only pre-pass with the shadow map shader
+    CShaderProgram* prepassShader = nullptr;
+    if (m_depthPrepass)
+    {
+        prepassShader = manager.getShaderProgram(m_shadowMapPassShaderId);
+        if (prepassShader == nullptr)
+        {
+            LOG_ERROR("Shader program for depth pre-pass could not be retrieved.");
+        }
+    }
+    if (prepassShader != nullptr)
+    {
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        prepassShader->setUniform(viewMatrixUniformName, m_transformer.getViewMatrix());
+        prepassShader->setUniform(projectionMatrixUniformName,
+                                  m_transformer.getProjectionMatrix());
+
+        m_prepassSamples.begin();
+        for (const SGeometryDraw& object : m_geometryDraws)
+        {
+            m_transformer.setPosition(object.m_position);
+            m_transformer.setRotation(object.m_rotation);
+            m_transformer.setScale(object.m_scale);
+            draw(object.m_mesh, m_transformer.getTranslationMatrix(),
+                 m_transformer.getRotationMatrix(), m_transformer.getScaleMatrix(),
+                 object.m_material, manager, prepassShader);
+        }
+        m_prepassSamples.end();
+
+        // Material shaders only run for the visible surface
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    m_geometrySamples.begin();
+    for (const SGeometryDraw& object : m_geometryDraws)
+    {
+        drawObject(object);
+    }
+    m_geometrySamples.end();
+
+    // Restore default depth state, depth clears depend on the depth mask
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+
+    // Occlusion queries can not be nested in the sample counters
+    if (m_occlusionQueryCulling)
+    {
+        queryOcclusion(manager);
+
+        // Objects occluded in the previous frame are drawn if their bounding box passed the depth
+        // test, the GPU does not wait for unfinished queries and draws them in that case
+        for (const SGeometryDraw& object : m_occludedDraws)
+        {
+            GLuint occlusionQuery = m_occlusionQueries.getQuery(object.m_id);
+            glBeginConditionalRender(occlusionQuery, GL_QUERY_NO_WAIT);
+            drawObject(object);
+            glEndConditionalRender();
+        }
+    }
+
+    // Fragments per pixel of the rendered region
+    float pixels = m_targetWidth * m_resolutionScale * m_targetHeight * m_resolutionScale;
+    GLuint64 samples = 0;
+    if (m_prepassSamples.getResult(samples))
+    {
+        m_prepassOverdraw = samples / pixels;
+    }
+    if (m_geometrySamples.getResult(samples))
+    {
+        m_geometryOverdraw = samples / pixels;
+    }
+    if (++m_overdrawReportFrames >= s_overdrawReportInterval)
+    {
+        m_overdrawReportFrames = 0;
+        if (prepassShader != nullptr)
+        {
+            // Without pre-pass the material shaders would run for every fragment passing the
+            // pre-pass depth test
+            LOG_INFO("Geometry pass shades %.2f fragments per pixel, %.2f without depth pre-pass.",
+                     m_geometryOverdraw, m_prepassOverdraw);
+        }
+        else
+        {
+            LOG_INFO("Geometry pass shades %.2f fragments per pixel.", m_geometryOverdraw);
+        }
+        if (m_occlusionQueryCulling)
+        {
+            LOG_INFO("Occlusion queries: %u queried, %u culled, %u visible again in the last "
+                     "frame.",
+                     m_occlusionQueries.getQueriedCount(), m_occlusionQueries.getCulledCount(),
+                     m_occlusionQueries.getRevisibleCount());
         }
     }
 
@@ -271,9 +695,59 @@ void CDeferredRenderer::geometryPass(const IScene& scene, const ICamera& camera,
     {
         LOG_ERROR("GL Error: %s", error.c_str());
     }
+}
 
-    // Disable geometry buffer
-    m_geometryBuffer.setInactive(GL_FRAMEBUFFER);
+void CDeferredRenderer::queryOcclusion(const IGraphicsResourceManager& manager)
+{
+    // Bounding boxes are drawn with the position only shadow map shader
+    CShaderProgram* boxShader = manager.getShaderProgram(m_shadowMapPassShaderId);
+    CMesh* boxMesh = manager.getMesh(m_occlusionBoxMeshId);
+    if (boxShader == nullptr || boxMesh == nullptr)
+    {
+        LOG_ERROR("Resources for occlusion queries could not be retrieved.");
+        return;
+    }
+    if (boxMesh->isUploadPending())
+    {
+        // Empty queries would report all objects as occluded
+        return;
+    }
+
+    // Depth test only, equal depth passes as boxes may touch the surface of their object
+    // Back faces are drawn as well, front faces may be clipped by the far plane
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDepthFunc(GL_LEQUAL);
+    glDisable(GL_CULL_FACE);
+
+    boxShader->setActive();
+    boxShader->setUniform(viewMatrixUniformName, m_transformer.getViewMatrix());
+    boxShader->setUniform(projectionMatrixUniformName, m_transformer.getProjectionMatrix());
+
+    // Occluded objects are queried every frame, visible objects at an interval
+    for (const std::vector<SGeometryDraw>* draws : {&m_geometryDraws, &m_occludedDraws})
+    {
+        for (const SGeometryDraw& object : *draws)
+        {
+            if (object.m_extent <= 0.f || !m_occlusionQueries.needsQuery(object.m_id))
+            {
+                continue;
+            }
+            // Unit cube spans [-1, 1]
+            boxShader->setUniform(modelMatrixUniformName,
+                                  glm::translate(object.m_position) *
+                                      glm::scale(glm::vec3(object.m_extent)));
+            m_occlusionQueries.begin(object.m_id);
+            ARenderer::draw(boxMesh);
+            m_occlusionQueries.end();
+        }
+    }
+
+    // Restore state of the geometry pass
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    glEnable(GL_CULL_FACE);
 }
 
 // TODO extract in own file(s)
@@ -324,7 +798,6 @@ void CDeferredRenderer::shadowMapPass(const IScene& scene, const ICamera& camera
 
     // Reset viewport
     glViewport(0, 0, 4000, 4000);
-    m_shadowMapBuffer.resize(4000, 4000);
 
     // Stores active transformations
     CTransformer transformer;
@@ -365,6 +838,11 @@ void CDeferredRenderer::shadowMapPass(const IScene& scene, const ICamera& camera
             // Resolve ids
             CMesh* mesh = manager.getMesh(meshId);
             CMaterial* material = manager.getMaterial(materialId);
+            if (mesh == nullptr || material == nullptr)
+            {
+                // Resources have been unloaded
+                continue;
+            }
 
             // Set transformations
             transformer.setPosition(position);
@@ -487,6 +965,11 @@ void CDeferredRenderer::shadowCubePass(const IScene& scene, const ICamera& camer
                 // Resolve ids
                 CMesh* mesh = manager.getMesh(meshId);
                 CMaterial* material = manager.getMaterial(materialId);
+                if (mesh == nullptr || material == nullptr)
+                {
+                    // Resources have been unloaded
+                    continue;
+                }
 
                 CTransformer transformer;
 
@@ -519,22 +1002,7 @@ void CDeferredRenderer::shadowCubePass(const IScene& scene, const ICamera& camer
 void CDeferredRenderer::lightPass(const IScene& scene, const ICamera& camera, const IWindow& window,
                                   const IGraphicsResourceManager& manager, ISceneQuery& query)
 {
-    // Prepare light pass frame buffer
-    glViewport(0, 0, window.getWidth(), window.getHeight());
-    // Resize
-    m_lightPassFrameBuffer.resize(window.getWidth(), window.getHeight());
-    // Enable light buffer
-    m_lightPassFrameBuffer.setActive(GL_FRAMEBUFFER);
-
-    // Retrieve ambient light
-    glm::vec3 ambientColor;
-    float ambientIntensity;
-    scene.getAmbientLight(ambientColor, ambientIntensity);
-    // Initialize light buffer with ambient light
-    glClearColor(ambientColor.x * ambientIntensity, ambientColor.y * ambientIntensity,
-                 ambientColor.z * ambientIntensity, 1.f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
+    // Light buffer is bound and initialized with ambient light by the render graph
     // No depth testing for light volumes
     glDisable(GL_DEPTH_TEST);
     // Additive blending for light accumulation
@@ -547,9 +1015,8 @@ void CDeferredRenderer::lightPass(const IScene& scene, const ICamera& camera, co
     // Draw directional lights
     directionalLightPass(scene, camera, window, manager, query);
 
-    // Reset state and cleanup
+    // Reset state
     glDisable(GL_BLEND);
-    m_lightPassFrameBuffer.setInactive(GL_FRAMEBUFFER);
 }
 
 void CDeferredRenderer::pointLightPass(const IScene& scene, const ICamera& camera,
@@ -557,7 +1024,8 @@ void CDeferredRenderer::pointLightPass(const IScene& scene, const ICamera& camer
                                        const IGraphicsResourceManager& manager, ISceneQuery& query)
 {
     // Point light pass
-    CShaderProgram* pointLightPassShader = manager.getShaderProgram(m_pointLightPassShaderId);
+    CShaderProgram* pointLightPassShader =
+        m_pointLightPassShaders.getShaderProgram(m_compactGBuffer ? 1 : 0, manager);
     if (pointLightPassShader == nullptr)
     {
         LOG_ERROR("Shader program for point light pass could not be retrieved.");
@@ -596,9 +1064,8 @@ void CDeferredRenderer::pointLightPass(const IScene& scene, const ICamera& camer
             StaticCamera shadowCamera = StaticCamera(glm::mat4(), shadowProj, position);
             shadowCubePass(scene, shadowCamera, window, manager);
 
-            // Prepare light pass frame buffer
-            glViewport(0, 0, window.getWidth(), window.getHeight());
-            m_lightPassFrameBuffer.setActive(GL_FRAMEBUFFER);
+            // Bind light buffer again after shadow cube pass
+            m_renderGraph.setTargetsActive();
 
             // No depth testing for light volumes
             glDisable(GL_DEPTH_TEST);
@@ -634,7 +1101,7 @@ void CDeferredRenderer::pointLightPass(const IScene& scene, const ICamera& camer
 
             // Inverse view-projection
             pointLightPassShader->setUniform(inverseViewProjectionMatrixUniformName,
-                                             m_transformer.getInverseViewProjectionMatrix());
+                                             getInverseViewProjectionMatrix());
 
             m_transformer.setPosition(position);
             // Scale is calculated from light radius
@@ -666,7 +1133,7 @@ void CDeferredRenderer::directionalLightPass(const IScene& scene, const ICamera&
 {
     // Restrieve shader
     CShaderProgram* directionalLightPassShader =
-        manager.getShaderProgram(m_directionalLightPassShaderId);
+        m_directionalLightPassShaders.getShaderProgram(m_compactGBuffer ? 1 : 0, manager);
     if (directionalLightPassShader == nullptr)
     {
         LOG_ERROR("Shader program for directional light pass could not be retrieved.");
@@ -709,9 +1176,8 @@ void CDeferredRenderer::directionalLightPass(const IScene& scene, const ICamera&
             // Render shadow map
             shadowMapPass(scene, shadowCamera, window, manager);
 
-            // Prepare light pass frame buffer
-            m_lightPassFrameBuffer.setActive(GL_FRAMEBUFFER);
-            glViewport(0, 0, window.getWidth(), window.getHeight());
+            // Bind light buffer again after shadow map pass
+            m_renderGraph.setTargetsActive();
 
             // No depth testing for light volumes
             glDisable(GL_DEPTH_TEST);
@@ -749,7 +1215,7 @@ void CDeferredRenderer::directionalLightPass(const IScene& scene, const ICamera&
 
             // Inverse view-projection
             directionalLightPassShader->setUniform(inverseViewProjectionMatrixUniformName,
-                                                   m_transformer.getInverseViewProjectionMatrix());
+                                                   getInverseViewProjectionMatrix());
 
             // Shadow ViewProjectionBias
             glm::mat4 shadowViewProjBiasMatrix =
@@ -778,11 +1244,6 @@ void CDeferredRenderer::illuminationPass(const IScene& scene, const ICamera& cam
                                          const IGraphicsResourceManager& manager,
                                          ISceneQuery& query)
 {
-    // Reset viewport
-    glViewport(0, 0, window.getWidth(), window.getHeight());
-    m_illumationPassFrameBuffer.resize(window.getWidth(), window.getHeight());
-    // TODO Clear illumination pass buffer?
-
     // Get illumination shader
     CShaderProgram* illuminationShader = manager.getShaderProgram(m_illuminationPassShaderId);
     if (illuminationShader == nullptr)
@@ -817,95 +1278,427 @@ void CDeferredRenderer::illuminationPass(const IScene& scene, const ICamera& cam
     illuminationShader->setUniform(screenWidthUniformName, (float)window.getWidth());
     illuminationShader->setUniform(screenHeightUniformName, (float)window.getHeight());
 
-    // Draw into frame buffer
-    m_illumationPassFrameBuffer.setActive(GL_FRAMEBUFFER);
+    // Draw into target bound by the render graph
     ARenderer::draw(quadMesh);
-    m_illumationPassFrameBuffer.setInactive(GL_FRAMEBUFFER);
 }
 
-void CDeferredRenderer::postProcessPass(const ICamera& camera, const IWindow& window,
-                                        const IGraphicsResourceManager& manager,
-                                        const std::shared_ptr<CTexture>& texture)
+glm::mat4 CDeferredRenderer::getInverseViewProjectionMatrix() const
 {
-    // Reset viewport
-    glViewport(0, 0, window.getWidth(), window.getHeight());
-    // Resize frame buffer
-    m_postProcessPassFrameBuffer0.resize(window.getWidth(), window.getHeight());
-    m_postProcessPassFrameBuffer1.resize(window.getWidth(), window.getHeight());
-    m_postProcessPassFrameBuffer2.resize(window.getWidth(), window.getHeight());
+    // Screen space passes reconstruct positions from texture coordinates, which only cover the
+    // scaled render region, so they are mapped to the full device coordinate range first
+    float inverseScale = 1.f / m_resolutionScale;
+    glm::mat4 regionToDevice(1.f);
+    regionToDevice[0][0] = inverseScale;
+    regionToDevice[1][1] = inverseScale;
+    regionToDevice[3][0] = inverseScale - 1.f;
+    regionToDevice[3][1] = inverseScale - 1.f;
+    return m_transformer.getInverseViewProjectionMatrix() * regionToDevice;
+}
 
-    // Pass 1: fxaa
-    m_postProcessPassFrameBuffer0.setActive(GL_FRAMEBUFFER);
-    if (camera.getFeatureInfo().fxaaActive)
-    {
-        fxaaPass(window, manager, texture);
+RenderTargetId CDeferredRenderer::postProcessPass(const ICamera& camera, const IWindow& window,
+                                                  const IGraphicsResourceManager& manager,
+                                                  RenderTargetId scene, RenderTargetId depth,
+                                                  RenderTargetId output)
+{
+    const SFeatureInfo& features = camera.getFeatureInfo();
+    unsigned int width = window.getWidth();
+    unsigned int height = window.getHeight();
+    bool fog = features.fogType != FogType::None;
+    bool godRayMode = features.renderMode == RenderMode::GodRay;
+    bool godRays = features.godRayActive || godRayMode;
+    unsigned int blurDivisor = features.dofActive ? m_blurResolutionDivisor : 1;
+    unsigned int godRayDivisor = godRays ? m_godRayResolutionDivisor : 1;
+
+    // Pixels drawn by the separate and the merged chain
+    unsigned int separatePasses = (features.fxaaActive ? 1 : 0) + (fog ? 1 : 0) +
+                                  (features.dofActive ? 3 : 0) + (godRays ? 2 : 0);
+    unsigned int featureMask = getUberPostFeatures(features) | (features.fxaaActive ? 1 << 7 : 0) |
+                               blurDivisor << 8 | godRayDivisor << 12;
+    if (m_uberPostProcessing && featureMask != m_reportedPostFeatures)
+    {
+        m_reportedPostFeatures = featureMask;
+        float screenPixels = width * height / 1000000.f;
+        float mergedPixels = (features.fxaaActive ? screenPixels : 0.f) +
+                             (fog || features.dofActive || godRays ? screenPixels : 0.f);
+        // Each reduced resolution is downsampled once
+        if (blurDivisor > 1)
+        {
+            mergedPixels += screenPixels / (blurDivisor * blurDivisor);
+        }
+        if (godRayDivisor > 1 && godRayDivisor != blurDivisor)
+        {
+            mergedPixels += screenPixels / (godRayDivisor * godRayDivisor);
+        }
+        if (features.dofActive)
+        {
+            mergedPixels += 2 * screenPixels / (blurDivisor * blurDivisor);
+        }
+        if (godRays)
+        {
+            mergedPixels += screenPixels / (godRayDivisor * godRayDivisor);
+        }
+        LOG_INFO("Merged post processing draws %.2f instead of %.2f MPixel per frame.",
+                 mergedPixels, separatePasses * screenPixels);
     }
-    else
-    {
-        // Passthrough
-        passthroughPass(window, manager, texture);
+
+    // Each pass writes a new transient target, disabled effects add no copy
+    // The last pass writes the output target if given
+    auto createTarget = [&](const std::string& name, bool last) -> RenderTargetId {
+        if (last && output != invalidRenderTarget && !godRayMode)
+        {
+            return output;
+        }
+        return m_renderGraph.createTarget(name, width, height, GL_RGB);
+    };
+    unsigned int pass;
+
+    // Pass 1: fxaa
+    if (features.fxaaActive)
+    {
+        RenderTargetId target = createTarget("fxaa", !fog && !features.dofActive && !godRays);
+        pass = m_renderGraph.addPass("fxaa", [this, &window, &manager, scene]() {
+            fxaaPass(window, manager, m_renderGraph.getTexture(scene));
+        });
+        m_renderGraph.read(pass, scene);
+        m_renderGraph.write(pass, target, GL_COLOR_ATTACHMENT0);
+        scene = target;
+    }
+
+    if (m_uberPostProcessing)
+    {
+        // Blur and god rays are generated from the anti-aliased scene and composited together
+        // with fog in a single pass
+        // Reduced resolution effects are generated from a downsampled scene, effects with the
+        // same resolution share it
+        RenderTargetId halfScene = invalidRenderTarget;
+        RenderTargetId quarterScene = invalidRenderTarget;
+        auto getEffectInput = [&](unsigned int divisor) -> RenderTargetId {
+            if (divisor == 1)
+            {
+                return scene;
+            }
+            RenderTargetId& downsampled = divisor == 2 ? halfScene : quarterScene;
+            if (downsampled == invalidRenderTarget)
+            {
+                downsampled = addDepthDownsamplePass(window, manager, scene, depth, divisor);
+            }
+            return downsampled;
+        };
+
+        RenderTargetId blur = invalidRenderTarget;
+        RenderTargetId blurDepth = invalidRenderTarget;
+        if (features.dofActive)
+        {
+            RenderTargetId input = getEffectInput(blurDivisor);
+            unsigned int blurWidth = getReducedSize(width, blurDivisor);
+            unsigned int blurHeight = getReducedSize(height, blurDivisor);
+            RenderTargetId blurVertical =
+                m_renderGraph.createTarget("blur vertical", blurWidth, blurHeight, GL_RGB);
+            blur = m_renderGraph.createTarget("blur", blurWidth, blurHeight, GL_RGB);
+            addGaussBlurPasses(window, manager, input, blurVertical, blur);
+            if (input != scene)
+            {
+                blurDepth = input;
+            }
+        }
+        RenderTargetId godRayTarget = invalidRenderTarget;
+        RenderTargetId godRayDepth = invalidRenderTarget;
+        if (godRays)
+        {
+            RenderTargetId input = getEffectInput(godRayDivisor);
+            godRayTarget = m_renderGraph.createTarget(
+                "god rays", getReducedSize(width, godRayDivisor),
+                getReducedSize(height, godRayDivisor), GL_RGB);
+            addGodRayPass(window, manager, input, depth, godRayTarget);
+            // Godray debug mode
+            if (godRayMode)
+            {
+                return godRayTarget;
+            }
+            if (input != scene)
+            {
+                godRayDepth = input;
+            }
+        }
+        if (!fog && !features.dofActive && !godRays)
+        {
+            return scene;
+        }
+
+        RenderTargetId target = createTarget("merged post", true);
+        pass = m_renderGraph.addPass("merged post", [this, &camera, &window, &manager, scene, blur,
+                                                     blurDepth, godRayTarget, godRayDepth]() {
+            // Disabled effects and full resolution effects have no texture
+            auto getTexture = [this](RenderTargetId target) {
+                return target != invalidRenderTarget ? m_renderGraph.getTexture(target)
+                                                     : std::shared_ptr<CTexture>();
+            };
+            uberPostPass(camera, window, manager, m_renderGraph.getTexture(scene),
+                         getTexture(blur), getTexture(blurDepth), getTexture(godRayTarget),
+                         getTexture(godRayDepth));
+        });
+        m_renderGraph.read(pass, scene);
+        m_renderGraph.read(pass, depth);
+        for (RenderTargetId effect : {blur, blurDepth, godRayTarget, godRayDepth})
+        {
+            if (effect != invalidRenderTarget)
+            {
+                m_renderGraph.read(pass, effect);
+            }
+        }
+        m_renderGraph.write(pass, target, GL_COLOR_ATTACHMENT0);
+        return target;
     }
 
     // Pass 2: fog
     // TODO Fog parameter
-    m_postProcessPassFrameBuffer1.setActive(GL_FRAMEBUFFER);
-    fogPass(camera, window, manager, m_postProcessPassTexture0);
-    // Foggy scene in tex1
+    if (fog)
+    {
+        RenderTargetId target = createTarget("fog", !features.dofActive && !godRays);
+        pass = m_renderGraph.addPass("fog", [this, &camera, &window, &manager, scene]() {
+            fogPass(camera, window, manager, m_renderGraph.getTexture(scene));
+        });
+        m_renderGraph.read(pass, scene);
+        m_renderGraph.read(pass, depth);
+        m_renderGraph.write(pass, target, GL_COLOR_ATTACHMENT0);
+        scene = target;
+    }
 
     // Pass 3: dof
-	m_postProcessPassFrameBuffer0.setActive(GL_FRAMEBUFFER);
-    if (camera.getFeatureInfo().dofActive)
+    if (features.dofActive)
     {
         // Pass 3.1: gauss blur
-        gaussBlurVerticalPass(window, manager, m_postProcessPassTexture1);
-        // Blurred in tex0
-
-        m_postProcessPassFrameBuffer2.setActive(GL_FRAMEBUFFER);
-        gaussBlurHorizontalPass(window, manager, m_postProcessPassTexture0);
-        // Blurred in tex 2
+        RenderTargetId blurVertical = createTarget("blur vertical", false);
+        RenderTargetId blur = createTarget("blur", false);
+        addGaussBlurPasses(window, manager, scene, blurVertical, blur);
 
         // TODO DOF parameter
-        m_postProcessPassFrameBuffer0.setActive(GL_FRAMEBUFFER);
-        depthOfFieldPass(camera, window, manager, m_postProcessPassTexture1,
-                         m_postProcessPassTexture2);
-    }
-    else
-    {
-        // Passthrough
-        passthroughPass(window, manager, texture);
-    }
-    // Processed scene in tex 0
-
-	if (camera.getFeatureInfo().godRayActive || camera.getFeatureInfo().renderMode == RenderMode::GodRay)
-	{
-		// TODO God ray pass disabled, not working as intended
-		// God ray pass 1
-		m_postProcessPassFrameBuffer1.setActive(GL_FRAMEBUFFER);
-		godRayPass1(window, manager, m_postProcessPassTexture0);
-		// God ray texture in tex 1
-
-		// Godray debug mode
-		if (camera.getFeatureInfo().renderMode == RenderMode::GodRay)
-		{
-			// Return generated godray texture
-			m_postProcessPassOutputTexture = m_postProcessPassTexture1;
-			return;
-		}
-
-		// God ray pass 2
-		m_postProcessPassFrameBuffer2.setActive(GL_FRAMEBUFFER);
-		godRayPass2(window, manager, m_postProcessPassTexture0, m_postProcessPassTexture1);
-	}
-	else
-	{
-		// Passthrough into tex 2
-		m_postProcessPassFrameBuffer2.setActive(GL_FRAMEBUFFER);
-		passthroughPass(window, manager, texture);
-	}
-
-    // Set output texture
-    m_postProcessPassOutputTexture = m_postProcessPassTexture2;
-	return;
+        RenderTargetId target = createTarget("dof", !godRays);
+        pass = m_renderGraph.addPass(
+            "depth of field", [this, &camera, &window, &manager, scene, blur]() {
+                depthOfFieldPass(camera, window, manager, m_renderGraph.getTexture(scene),
+                                 m_renderGraph.getTexture(blur));
+            });
+        m_renderGraph.read(pass, scene);
+        m_renderGraph.read(pass, blur);
+        m_renderGraph.read(pass, depth);
+        m_renderGraph.write(pass, target, GL_COLOR_ATTACHMENT0);
+        scene = target;
+    }
+
+    // Pass 4: god rays
+    if (godRays)
+    {
+        // TODO God ray pass disabled, not working as intended
+        RenderTargetId godRayTarget = createTarget("god rays", false);
+        addGodRayPass(window, manager, scene, depth, godRayTarget);
+
+        // Godray debug mode
+        if (godRayMode)
+        {
+            // Return generated godray texture
+            return godRayTarget;
+        }
+
+        RenderTargetId target = createTarget("god ray", true);
+        pass = m_renderGraph.addPass(
+            "god ray 2", [this, &window, &manager, scene, godRayTarget]() {
+                godRayPass2(window, manager, m_renderGraph.getTexture(scene),
+                            m_renderGraph.getTexture(godRayTarget));
+            });
+        m_renderGraph.read(pass, scene);
+        m_renderGraph.read(pass, godRayTarget);
+        m_renderGraph.write(pass, target, GL_COLOR_ATTACHMENT0);
+        scene = target;
+    }
+    return scene;
+}
+
+void CDeferredRenderer::addGaussBlurPasses(const IWindow& window,
+                                           const IGraphicsResourceManager& manager,
+                                           RenderTargetId scene, RenderTargetId blurVertical,
+                                           RenderTargetId blur)
+{
+    unsigned int pass = m_renderGraph.addPass(
+        "gauss blur vertical", [this, &window, &manager, scene]() {
+            gaussBlurVerticalPass(window, manager, m_renderGraph.getTexture(scene));
+        });
+    m_renderGraph.read(pass, scene);
+    m_renderGraph.write(pass, blurVertical, GL_COLOR_ATTACHMENT0);
+
+    pass = m_renderGraph.addPass(
+        "gauss blur horizontal", [this, &window, &manager, blurVertical]() {
+            gaussBlurHorizontalPass(window, manager, m_renderGraph.getTexture(blurVertical));
+        });
+    m_renderGraph.read(pass, blurVertical);
+    m_renderGraph.write(pass, blur, GL_COLOR_ATTACHMENT0);
+}
+
+RenderTargetId CDeferredRenderer::addDepthDownsamplePass(const IWindow& window,
+                                                         const IGraphicsResourceManager& manager,
+                                                         RenderTargetId scene, RenderTargetId depth,
+                                                         unsigned int divisor)
+{
+    // Linear depth is stored in alpha, needs float precision
+    RenderTargetId downsampled = m_renderGraph.createTarget(
+        "downsampled scene", getReducedSize(window.getWidth(), divisor),
+        getReducedSize(window.getHeight(), divisor), GL_RGBA16F);
+    unsigned int pass = m_renderGraph.addPass(
+        "depth downsample", [this, &window, &manager, scene, divisor]() {
+            depthDownsamplePass(window, manager, m_renderGraph.getTexture(scene), divisor);
+        });
+    m_renderGraph.read(pass, scene);
+    m_renderGraph.read(pass, depth);
+    m_renderGraph.write(pass, downsampled, GL_COLOR_ATTACHMENT0);
+    return downsampled;
+}
+
+void CDeferredRenderer::addGodRayPass(const IWindow& window,
+                                      const IGraphicsResourceManager& manager,
+                                      RenderTargetId scene, RenderTargetId depth,
+                                      RenderTargetId godRays)
+{
+    unsigned int pass = m_renderGraph.addPass(
+        "god ray 1", [this, &window, &manager, scene]() {
+            godRayPass1(window, manager, m_renderGraph.getTexture(scene));
+        });
+    m_renderGraph.read(pass, scene);
+    m_renderGraph.read(pass, depth);
+    m_renderGraph.write(pass, godRays, GL_COLOR_ATTACHMENT0);
+}
+
+void CDeferredRenderer::uberPostPass(const ICamera& camera, const IWindow& window,
+                                     const IGraphicsResourceManager& manager,
+                                     const std::shared_ptr<CTexture>& sceneTexture,
+                                     const std::shared_ptr<CTexture>& blurTexture,
+                                     const std::shared_ptr<CTexture>& blurDepthTexture,
+                                     const std::shared_ptr<CTexture>& godRayTexture,
+                                     const std::shared_ptr<CTexture>& godRayDepthTexture)
+{
+    // Get shader variant for the enabled effects and their resolution
+    unsigned int variant = getUberPostFeatures(camera.getFeatureInfo());
+    if (blurDepthTexture != nullptr)
+    {
+        variant |= 1 << 5;
+    }
+    if (godRayDepthTexture != nullptr)
+    {
+        variant |= 1 << 6;
+    }
+    CShaderProgram* shader = m_uberPostPassShaders.getShaderProgram(variant, manager);
+    if (shader == nullptr)
+    {
+        LOG_ERROR("Shader program for merged post processing pass could not be retrieved.");
+        return;
+    }
+
+    // Get screen space quad
+    CMesh* quadMesh = manager.getMesh(m_postProcessScreenQuadId);
+    if (quadMesh == nullptr)
+    {
+        LOG_ERROR("Mesh object for merged post processing pass could not be retrieved.");
+        return;
+    }
+
+    // Input scene texture
+    sceneTexture->setActive(uberPostPassSceneTextureUnit);
+    shader->setUniform(sceneTextureUniformName, uberPostPassSceneTextureUnit);
+
+    // Input depth texture
+    m_depthTexture->setActive(uberPostPassDepthTextureUnit);
+    shader->setUniform(depthTextureUniformName, uberPostPassDepthTextureUnit);
+
+    // Depth-of-field composite
+    if (blurTexture != nullptr)
+    {
+        blurTexture->setActive(uberPostPassBlurTextureUnit);
+        shader->setUniform(blurTextureUniformName, uberPostPassBlurTextureUnit);
+
+        shader->setUniform(blurNearUniformName, camera.getFeatureInfo().dofNearBlur);
+        shader->setUniform(focusNearUniformName, camera.getFeatureInfo().dofNearFocus);
+        shader->setUniform(focusFarUniformName, camera.getFeatureInfo().dofFarFocus);
+        shader->setUniform(blurFarUniformName, camera.getFeatureInfo().dofFarBlur);
+        shader->setUniform(cameraPositionUniformName, camera.getPosition());
+        shader->setUniform(inverseViewProjectionMatrixUniformName,
+                           getInverseViewProjectionMatrix());
+    }
+
+    // Downsampled scene of reduced resolution blur
+    if (blurDepthTexture != nullptr)
+    {
+        blurDepthTexture->setActive(uberPostPassBlurDepthTextureUnit);
+        shader->setUniform(blurDepthTextureUniformName, uberPostPassBlurDepthTextureUnit);
+        shader->setUniform(blurDownsampleUniformName, (int)m_blurResolutionDivisor);
+    }
+
+    // God ray composite
+    if (godRayTexture != nullptr)
+    {
+        godRayTexture->setActive(uberPostPassGodRayTextureUnit);
+        shader->setUniform(godRayTextureUniformName, uberPostPassGodRayTextureUnit);
+    }
+
+    // Downsampled scene of reduced resolution god rays
+    if (godRayDepthTexture != nullptr)
+    {
+        godRayDepthTexture->setActive(uberPostPassGodRayDepthTextureUnit);
+        shader->setUniform(godRayDepthTextureUniformName, uberPostPassGodRayDepthTextureUnit);
+        shader->setUniform(godRayDownsampleUniformName, (int)m_godRayResolutionDivisor);
+    }
+
+    // Linear depth for bilateral upsample
+    if (blurDepthTexture != nullptr || godRayDepthTexture != nullptr)
+    {
+        shader->setUniform(inverseProjectionMatrixUniformName,
+                           m_transformer.getInverseProjectionMatrix());
+    }
+
+    /// Screen size
+    shader->setUniform(screenWidthUniformName, (float)window.getWidth());
+    shader->setUniform(screenHeightUniformName, (float)window.getHeight());
+
+    // Perform pass
+    ARenderer::draw(quadMesh);
+}
+
+void CDeferredRenderer::depthDownsamplePass(const IWindow& window,
+                                            const IGraphicsResourceManager& manager,
+                                            const std::shared_ptr<CTexture>& sceneTexture,
+                                            unsigned int divisor)
+{
+    // Get shader
+    CShaderProgram* shader = manager.getShaderProgram(m_depthDownsamplePassShaderId);
+    if (shader == nullptr)
+    {
+        LOG_ERROR("Shader program for depth downsample pass could not be retrieved.");
+        return;
+    }
+
+    // Get screen space quad
+    CMesh* quadMesh = manager.getMesh(m_postProcessScreenQuadId);
+    if (quadMesh == nullptr)
+    {
+        LOG_ERROR("Mesh object for depth downsample pass could not be retrieved.");
+        return;
+    }
+
+    // Input scene texture
+    sceneTexture->setActive(depthDownsamplePassSceneTextureUnit);
+    shader->setUniform(sceneTextureUniformName, depthDownsamplePassSceneTextureUnit);
+
+    // Input depth texture
+    m_depthTexture->setActive(depthDownsamplePassDepthTextureUnit);
+    shader->setUniform(depthTextureUniformName, depthDownsamplePassDepthTextureUnit);
+
+    // Inverse projection for linear depth
+    shader->setUniform(inverseProjectionMatrixUniformName,
+                       m_transformer.getInverseProjectionMatrix());
+
+    // Scene pixels per downsampled pixel and axis
+    shader->setUniform(downsampleFactorUniformName, (int)divisor);
+
+    // Perform pass
+    ARenderer::draw(quadMesh);
 }
 
 void CDeferredRenderer::fxaaPass(const IWindow& window, const IGraphicsResourceManager& manager,
@@ -942,8 +1735,9 @@ void CDeferredRenderer::fogPass(const ICamera& camera, const IWindow& window,
                                 const IGraphicsResourceManager& manager,
                                 const std::shared_ptr<CTexture>& texture)
 {
-    // Get fog shader
-    CShaderProgram* fogShader = manager.getShaderProgram(m_fogPassShaderId);
+    // Get fog shader variant for the fog type
+    CShaderProgram* fogShader = m_fogPassShaders.getShaderProgram(
+        getFogFeatures(camera.getFeatureInfo().fogType), manager);
     if (fogShader == nullptr)
     {
         LOG_ERROR("Shader program for fog pass could not be retrieved.");
@@ -969,26 +1763,6 @@ void CDeferredRenderer::fogPass(const ICamera& camera, const IWindow& window,
     fogShader->setUniform(screenWidthUniformName, (float)window.getWidth());
     fogShader->setUniform(screenHeightUniformName, (float)window.getHeight());
 
-    int fogType = 0;
-    switch (camera.getFeatureInfo().fogType)
-    {
-    case FogType::None:
-        fogType = 0;
-        break;
-    case FogType::Linear:
-        fogType = 1;
-        break;
-    case FogType::Exp:
-        fogType = 2;
-        break;
-    case FogType::Exp2:
-        fogType = 3;
-        break;
-    default:
-        fogType = 0;
-    }
-    fogShader->setUniform(fogPassTypeUniformName, fogType);
-
     ARenderer::draw(quadMesh);
 }
 
@@ -1016,12 +1790,13 @@ void CDeferredRenderer::gaussBlurVerticalPass(const IWindow& window,
     texture->setActive(gaussBlurVerticalPassInputTextureUnit);
     shader->setUniform(sceneTextureUniformName, gaussBlurVerticalPassInputTextureUnit);
 
-    // Blur parameter
-    shader->setUniform(blurStrengthUniformName, 3.f);
+    // Blur parameter, the radius is kept in screen pixels for reduced resolution input
+    shader->setUniform(blurStrengthUniformName,
+                       3.f * texture->getWidth() / (float)window.getWidth());
 
-    /// Screen size
-    shader->setUniform(screenWidthUniformName, (float)window.getWidth());
-    shader->setUniform(screenHeightUniformName, (float)window.getHeight());
+    /// Target size, which matches the input size
+    shader->setUniform(screenWidthUniformName, (float)texture->getWidth());
+    shader->setUniform(screenHeightUniformName, (float)texture->getHeight());
 
     // Perform pass
     ARenderer::draw(quadMesh);
@@ -1051,12 +1826,13 @@ void CDeferredRenderer::gaussBlurHorizontalPass(const IWindow& window,
     texture->setActive(gaussBlurHoriontalPassInputTextureUnit);
     shader->setUniform(sceneTextureUniformName, gaussBlurHoriontalPassInputTextureUnit);
 
-    // Blur parameter
-    shader->setUniform(blurStrengthUniformName, 3.f);
+    // Blur parameter, the radius is kept in screen pixels for reduced resolution input
+    shader->setUniform(blurStrengthUniformName,
+                       3.f * texture->getWidth() / (float)window.getWidth());
 
-    /// Screen size
-    shader->setUniform(screenWidthUniformName, (float)window.getWidth());
-    shader->setUniform(screenHeightUniformName, (float)window.getHeight());
+    /// Target size, which matches the input size
+    shader->setUniform(screenWidthUniformName, (float)texture->getWidth());
+    shader->setUniform(screenHeightUniformName, (float)texture->getHeight());
 
     // Perform pass
     ARenderer::draw(quadMesh);
@@ -1106,7 +1882,7 @@ void CDeferredRenderer::depthOfFieldPass(const ICamera& camera, const IWindow& w
 
     // Transformation
     shader->setUniform(inverseViewProjectionMatrixUniformName,
-                       m_transformer.getInverseViewProjectionMatrix());
+                       getInverseViewProjectionMatrix());
 
     /// Screen size
     shader->setUniform(screenWidthUniformName, (float)window.getWidth());
@@ -1121,6 +1897,8 @@ void CDeferredRenderer::displayPass(const IWindow& window, const IGraphicsResour
 {
     // Set main FBO active
     CFrameBuffer::setDefaultActive();
+    // May directly follow the geometry pass in debug render modes
+    glDisable(GL_DEPTH_TEST);
     passthroughPass(window, manager, texture);
 }
 
@@ -1151,9 +1929,9 @@ void CDeferredRenderer::passthroughPass(const IWindow& window,
     texture->setActive(displayPassSceneTextureUnit);
     displayShader->setUniform(sceneTextureUniformName, displayPassSceneTextureUnit);
 
-    // Screen parameters
-    displayShader->setUniform(screenWidthUniformName, (float)window.getWidth());
-    displayShader->setUniform(screenHeightUniformName, (float)window.getHeight());
+    // Screen parameters, the scaled render region of the texture is upscaled to the screen
+    displayShader->setUniform(screenWidthUniformName, window.getWidth() / m_resolutionScale);
+    displayShader->setUniform(screenHeightUniformName, window.getHeight() / m_resolutionScale);
 
     ARenderer::draw(quadMesh);
 }
@@ -1189,12 +1967,12 @@ void CDeferredRenderer::godRayPass1(const IWindow& window, const IGraphicsResour
     shader->setUniform(inverseProjectionMatrixUniformName,
                        m_transformer.getInverseProjectionMatrix());
 
-    // Light position
-    shader->setUniform(lightPositionScreenUniformName, glm::vec2(0.5, 0.5));
+    // Light position in the scaled render region
+    shader->setUniform(lightPositionScreenUniformName, glm::vec2(0.5f * m_resolutionScale));
 
-    /// Screen size
-    shader->setUniform(screenWidthUniformName, (float)window.getWidth());
-    shader->setUniform(screenHeightUniformName, (float)window.getHeight());
+    /// Target size, which matches the input size
+    shader->setUniform(screenWidthUniformName, (float)texture->getWidth());
+    shader->setUniform(screenHeightUniformName, (float)texture->getHeight());
 
     // Perform pass
     ARenderer::draw(quadMesh);
@@ -1255,13 +2033,16 @@ void CDeferredRenderer::visualizeDepthPass(const ICamera& camera, const IWindow&
         return;
     }
 
+    // Directly follows the geometry pass
+    glDisable(GL_DEPTH_TEST);
+
     // Depth texture
     m_depthTexture->setActive(visualizeDepthPassDepthTextureUnit);
     shader->setUniform(depthTextureUniformName, visualizeDepthPassDepthTextureUnit);
 
-    /// Screen size
-    shader->setUniform(screenWidthUniformName, (float)window.getWidth());
-    shader->setUniform(screenHeightUniformName, (float)window.getHeight());
+    /// Screen size, the scaled render region of the depth texture is upscaled to the screen
+    shader->setUniform(screenWidthUniformName, window.getWidth() / m_resolutionScale);
+    shader->setUniform(screenHeightUniformName, window.getHeight() / m_resolutionScale);
 
     // camera parameters
     // TODO Replace
@@ -1306,60 +2087,33 @@ void CDeferredRenderer::draw(CMesh* mesh, const glm::mat4& translation, const gl
     }
 
     // Send material textures to shader
+    // Missing maps are constants in the shader variants, see EMaterialFeature
     if (material->hasDiffuse())
     {
         material->getDiffuse()->setActive(diffuseTextureUnit);
+        shader->setUniform(diffuseTextureUniformName, diffuseTextureUnit);
     }
-    else
-    {
-        manager.getDefaultDiffuseTexture()->setActive(diffuseTextureUnit);
-    }
-    shader->setUniform(diffuseTextureUniformName, diffuseTextureUnit);
-
     if (material->hasNormal())
     {
         material->getNormal()->setActive(normalTextureUnit);
+        shader->setUniform(normalTextureUniformName, normalTextureUnit);
     }
-    else
-    {
-        // Use default texture
-        manager.getDefaultNormalTexture()->setActive(normalTextureUnit);
-    }
-    shader->setUniform(normalTextureUniformName, normalTextureUnit);
-
     if (material->hasSpecular())
     {
         material->getSpecular()->setActive(specularTextureUnit);
+        shader->setUniform(specularTextureUniformName, specularTextureUnit);
     }
-    else
-    {
-        // Use default texture
-        manager.getDefaultSpecularTexture()->setActive(specularTextureUnit);
-    }
-    shader->setUniform(specularTextureUniformName, specularTextureUnit);
-
     if (material->hasGlow())
     {
         material->getGlow()->setActive(glowTextureUnit);
+        shader->setUniform(glowTextureUniformName, glowTextureUnit);
     }
-    else
-    {
-        // Use default texture
-        manager.getDefaultGlowTexture()->setActive(glowTextureUnit);
-    }
-    shader->setUniform(glowTextureUniformName, glowTextureUnit);
-
     // TODO Sort materials with alpha texture for blending.
     if (material->hasAlpha())
     {
         material->getAlpha()->setActive(alphaTextureUnit);
+        shader->setUniform(alphaTextureUniformName, alphaTextureUnit);
     }
-    else
-    {
-        // Use default texture
-        manager.getDefaultAlphaTexture()->setActive(alphaTextureUnit);
-    }
-    shader->setUniform(alphaTextureUniformName, alphaTextureUnit);
 
     if (hasGLError(error))
     {
@@ -1383,23 +2137,38 @@ bool CDeferredRenderer::initGeometryPass(IResourceManager* manager)
     // TODO Read file name from config?
     // Geometry pass shader for filling gbuffer
     std::string geometryPassShaderFile("data/shader/deferred/geometry_pass.ini");
-    m_geometryPassShaderId = manager->loadShader(geometryPassShaderFile);
+    m_geometryPassShaders.init(manager, geometryPassShaderFile,
+                               {"HAS_DIFFUSE_MAP", "HAS_NORMAL_MAP", "HAS_SPECULAR_MAP",
+                                "HAS_GLOW_MAP", "COMPACT_GBUFFER"});
 
-    // Check if ok
-    if (m_geometryPassShaderId == invalidResource)
+    // Check if ok, the variant with all maps is the most common one
+    unsigned int allMaps =
+        MaterialDiffuseMap | MaterialNormalMap | MaterialSpecularMap | MaterialGlowMap;
+    if (m_geometryPassShaders.get(getGeometryFeatures(allMaps, m_compactGBuffer)) ==
+        invalidResource)
     {
         LOG_ERROR("Failed to initialize the shader from file %s.", geometryPassShaderFile.c_str());
         return false;
     }
 
+    // Unit cube for bounding boxes of occlusion queries
+    std::string boxMesh = "data/mesh/cube.obj";
+    m_occlusionBoxMeshId = manager->loadMesh(boxMesh);
+    if (m_occlusionBoxMeshId == invalidResource)
+    {
+        LOG_ERROR("Failed to load occlusion query box mesh %s.", boxMesh.c_str());
+        return false;
+    }
+
     // Init gbuffer
     // Diffuse texture, stores base color and glow mask.
     m_diffuseGlowTexture = std::make_shared<CTexture>();
     m_diffuseGlowTexture->init(800, 600, GL_RGBA);
 
     // Normal texture, store x and y, z normals and specularity.
+    // The compact layout stores octahedral encoded normals with packed specularity instead.
     m_normalSpecularTexture = std::make_shared<CTexture>();
-    m_normalSpecularTexture->init(800, 600, GL_RGBA16F);
+    m_normalSpecularTexture->init(800, 600, getNormalSpecularFormat(m_compactGBuffer));
 
     // Depth texture
     m_depthTexture = std::make_shared<CTexture>();
@@ -1413,29 +2182,8 @@ bool CDeferredRenderer::initGeometryPass(IResourceManager* manager)
         return false;
     }
 
-    // Total 96 bit per pixel
-    m_geometryBuffer.attach(m_depthTexture, GL_DEPTH_ATTACHMENT);
-    m_geometryBuffer.attach(m_diffuseGlowTexture, GL_COLOR_ATTACHMENT0);
-    m_geometryBuffer.attach(m_normalSpecularTexture, GL_COLOR_ATTACHMENT1);
-
-    // Error check
-    if (hasGLError(error))
-    {
-        LOG_ERROR("GL Error: %s", error.c_str());
-        return false;
-    }
-
-    LOG_INFO("GBuffer state: %s.", m_geometryBuffer.getState().c_str());
-
-    // Reset framebuffer
-    m_geometryBuffer.setInactive(GL_FRAMEBUFFER);
-
-    // Error check
-    if (hasGLError(error))
-    {
-        LOG_ERROR("GL Error: %s", error.c_str());
-        return false;
-    }
+    // Total 120 bit per pixel, 88 bit with the compact layout, frame buffer is created by the
+    // render graph
     return true;
 }
 
@@ -1583,10 +2331,10 @@ bool CDeferredRenderer::initPointLightPass(IResourceManager* manager)
 {
     // Point light shader
     std::string pointLightPassShaderFile("data/shader/deferred/point_light_pass.ini");
-    m_pointLightPassShaderId = manager->loadShader(pointLightPassShaderFile);
+    m_pointLightPassShaders.init(manager, pointLightPassShaderFile, {"COMPACT_GBUFFER"});
 
     // Check if ok
-    if (m_pointLightPassShaderId == invalidResource)
+    if (m_pointLightPassShaders.get(m_compactGBuffer ? 1 : 0) == invalidResource)
     {
         LOG_ERROR("Failed to initialize the shader from file %s.",
                   pointLightPassShaderFile.c_str());
@@ -1602,24 +2350,14 @@ bool CDeferredRenderer::initPointLightPass(IResourceManager* manager)
         return false;
     }
 
-    // Attach texture for light data
+    // Texture for light data
+    // No depth attachment, depth values from geometry pass are used
     m_lightPassTexture = std::make_shared<CTexture>();
     if (!m_lightPassTexture->init(800, 600, GL_RGBA16F))
     {
-        LOG_ERROR("Failed to create color texture for light pass frame buffer.");
+        LOG_ERROR("Failed to create color texture for light pass.");
         return false;
     }
-    m_lightPassFrameBuffer.attach(m_lightPassTexture, GL_COLOR_ATTACHMENT0);
-
-    // Attach depth buffer
-    // Depth gets discarded, depth values from geometry pass are used
-    std::shared_ptr<CRenderBuffer> depthBuffer = std::make_shared<CRenderBuffer>();
-    if (!depthBuffer->init(800, 600, GL_DEPTH_COMPONENT))
-    {
-        LOG_ERROR("Failed to create depth buffer for light pass frame buffer.");
-        return false;
-    }
-    m_lightPassFrameBuffer.attach(depthBuffer, GL_DEPTH_ATTACHMENT);
     return true;
 }
 
@@ -1628,10 +2366,11 @@ bool CDeferredRenderer::initDirectionalLightPass(IResourceManager* manager)
     // Uses same frame buffer as point light pass
     // Directional light shader
     std::string directionalLightPassShaderFile("data/shader/deferred/directional_light_pass.ini");
-    m_directionalLightPassShaderId = manager->loadShader(directionalLightPassShaderFile);
+    m_directionalLightPassShaders.init(manager, directionalLightPassShaderFile,
+                                       {"COMPACT_GBUFFER"});
 
     // Check if ok
-    if (m_directionalLightPassShaderId == invalidResource)
+    if (m_directionalLightPassShaders.get(m_compactGBuffer ? 1 : 0) == invalidResource)
     {
         LOG_ERROR("Failed to initialize the shader from file %s.",
                   directionalLightPassShaderFile.c_str());
@@ -1694,24 +2433,6 @@ bool CDeferredRenderer::initIlluminationPass(IResourceManager* manager)
         return false;
     }
 
-    // FBO
-    m_illuminationPassTexture = std::make_shared<CTexture>();
-    if (!m_illuminationPassTexture->init(800, 600, GL_RGB))
-    {
-        LOG_ERROR("Failed to initialize illumination pass texture.");
-        return false;
-    }
-    m_illumationPassFrameBuffer.attach(m_illuminationPassTexture, GL_COLOR_ATTACHMENT0);
-
-    // TODO Check FBO
-
-    // Error check
-    if (hasGLError(error))
-    {
-        LOG_ERROR("GL Error: %s", error.c_str());
-        return false;
-    }
-
     return true;
 }
 
@@ -1766,39 +2487,23 @@ bool CDeferredRenderer::initPostProcessPass(IResourceManager* manager)
         return false;
     }
 
-    // Init post processing FBOs
-    // Texture 0
-    m_postProcessPassTexture0 = std::make_shared<CTexture>();
-    if (!m_postProcessPassTexture0->init(800, 600, GL_RGB))
-    {
-        LOG_ERROR("Failed to initialize post process pass texture 0.");
-        return false;
-    }
-
-    // Texture 1
-    m_postProcessPassTexture1 = std::make_shared<CTexture>();
-    if (!m_postProcessPassTexture1->init(800, 600, GL_RGB))
+    if (!initDepthOfFieldPass(manager))
     {
-        LOG_ERROR("Failed to initialize post process pass texture 1.");
+        LOG_ERROR("Failed to initialize depth of field pass.");
         return false;
     }
 
-    // Texture 2
-    m_postProcessPassTexture2 = std::make_shared<CTexture>();
-    if (!m_postProcessPassTexture2->init(800, 600, GL_RGB))
+    // Merged post processing
+    if (!initUberPostPass(manager))
     {
-        LOG_ERROR("Failed to initialize post process pass texture 2.");
+        LOG_ERROR("Failed to initialize merged post processing pass.");
         return false;
     }
 
-    m_postProcessPassFrameBuffer0.attach(m_postProcessPassTexture0, GL_COLOR_ATTACHMENT0);
-    m_postProcessPassFrameBuffer1.attach(m_postProcessPassTexture1, GL_COLOR_ATTACHMENT0);
-    m_postProcessPassFrameBuffer2.attach(m_postProcessPassTexture2, GL_COLOR_ATTACHMENT0);
-    // TODO Depth attachment required?
-
-    if (!initDepthOfFieldPass(manager))
+    // Reduced resolution effects
+    if (!initDepthDownsamplePass(manager))
     {
-        LOG_ERROR("Failed to initialize depth of field pass.");
+        LOG_ERROR("Failed to initialize depth downsample pass.");
         return false;
     }
     return true;
@@ -1866,9 +2571,9 @@ bool CDeferredRenderer::initFogPass(IResourceManager* manager)
 {
     // Fog shader
     std::string fogShaderFile = "data/shader/post/fog_pass.ini";
-    m_fogPassShaderId = manager->loadShader(fogShaderFile);
+    m_fogPassShaders.init(manager, fogShaderFile, {"FOG_LINEAR", "FOG_EXP", "FOG_EXP2"});
     // Check if ok
-    if (m_fogPassShaderId == invalidResource)
+    if (m_fogPassShaders.get(getFogFeatures(FogType::Linear)) == invalidResource)
     {
         LOG_ERROR("Failed to initialize the shader from file %s.", fogShaderFile.c_str());
         return false;
@@ -1876,6 +2581,38 @@ bool CDeferredRenderer::initFogPass(IResourceManager* manager)
     return true;
 }
 
+bool CDeferredRenderer::initUberPostPass(IResourceManager* manager)
+{
+    // Merged post processing shader, variants are selected by the enabled effects
+    std::string uberPostShaderFile = "data/shader/post/uber_post_pass.ini";
+    m_uberPostPassShaders.init(
+        manager, uberPostShaderFile,
+        {"FOG_LINEAR", "FOG_EXP", "FOG_EXP2", "HAS_DEPTH_OF_FIELD", "HAS_GOD_RAYS", "LOW_RES_BLUR",
+         "LOW_RES_GOD_RAYS"});
+    // Check if ok
+    if (m_uberPostPassShaders.get(getUberPostFeatures(SFeatureInfo())) == invalidResource)
+    {
+        LOG_ERROR("Failed to initialize the shader from file %s.", uberPostShaderFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CDeferredRenderer::initDepthDownsamplePass(IResourceManager* manager)
+{
+    // Depth aware downsample shader
+    std::string depthDownsampleShaderFile = "data/shader/post/depth_downsample_pass.ini";
+    m_depthDownsamplePassShaderId = manager->loadShader(depthDownsampleShaderFile);
+    // Check if ok
+    if (m_depthDownsamplePassShaderId == invalidResource)
+    {
+        LOG_ERROR("Failed to initialize the shader from file %s.",
+                  depthDownsampleShaderFile.c_str());
+        return false;
+    }
+    return true;
+}
+
 bool CDeferredRenderer::initGodRayPass1(IResourceManager* manager)
 {
     // Get shader
@@ -2,16 +2,26 @@
 
 #include <memory>
 #include <list>
+#include <vector>
 
 // Required by inheritance
 #include "ARenderer.h"
 
+#include "CDynamicResolution.h"
 #include "CFrameBuffer.h"
+#include "CRenderGraph.h"
 #include "SRenderRequest.h"
 #include "CTransformer.h"
+#include "CShaderVariants.h"
 
 #include "resource/ResourceConfig.h"
 
+#include "graphics/window/CGlfwWindow.h"
+
+#include "core/CGpuTimer.h"
+#include "core/COcclusionQueries.h"
+#include "core/CSampleCounter.h"
+
 #include "pass/CScreenQuadPass.h"
 
 class CShaderProgram;
@@ -21,7 +31,7 @@ class ISceneQuery;
 /**
 * \brief Deferred renderer implementation.
 */
-class CDeferredRenderer : public ARenderer
+class CDeferredRenderer : public ARenderer, public IGlfwWindowListener
 {
    public:
     CDeferredRenderer();
@@ -32,15 +42,103 @@ class CDeferredRenderer : public ARenderer
     void draw(const IScene& scene, const ICamera& camera, const IWindow& window,
               const IGraphicsResourceManager& manager);
 
+    /**
+    * \brief Sets whether fog, depth of field and god rays are composited in a single pass.
+    * Blur and god rays are then generated from the scene before fog is applied. Enabled by
+    * default.
+    */
+    void setUberPostProcessing(bool enabled);
+
+    /**
+    * \brief Sets resolution divisors of the blur for depth of field and of the god rays.
+    * Valid divisors are 1 for full, 2 for half and 4 for quarter resolution. Reduced resolution
+    * effects are generated from a depth aware downsample of the scene and bilaterally upsampled
+    * by the merged post processing pass, separate passes always use full resolution.
+    */
+    void setPostEffectResolution(unsigned int blurDivisor, unsigned int godRayDivisor);
+
+    /**
+    * \brief Sets whether the render resolution is scaled to meet a GPU frame time.
+    * Geometry, lighting and post processing render into a scaled region of the window sized
+    * targets, which is upscaled to the window by the display pass. Targets keep their size, so
+    * scale changes do not reallocate. Disabled by default.
+    * \param targetFrameTime GPU frame time in milliseconds.
+    * \param minScale Lowest resolution scale per axis.
+    */
+    void setDynamicResolution(bool enabled, float targetFrameTime, float minScale);
+
+    /**
+    * \brief Sets whether the g-buffer uses the compact layout.
+    * The compact layout stores octahedral encoded normals and specularity packed into a two
+    * channel 16 bit target instead of a four channel half float target, which halves the
+    * g-buffer data read by light passes. Disabled by default.
+    */
+    void setCompactGBuffer(bool enabled);
+
+    /**
+    * \brief Sets whether the geometry pass lays down depth in a depth only pre-pass.
+    * The g-buffer is then only written for the visible surface of each pixel, the material
+    * shaders run with an equal depth test. Objects are drawn front to back in any case. Fragments
+    * shaded per pixel are measured and logged. Disabled by default.
+    */
+    void setDepthPrepass(bool enabled);
+
+    /**
+    * \brief Sets whether scene objects hidden behind occluder meshes are culled on the CPU.
+    * Occluders are rasterized into a low resolution depth buffer, which bounding boxes of the
+    * visible objects are tested against. Shadow maps are not affected. Disabled by default.
+    */
+    void setOcclusionCulling(bool enabled);
+
+    /**
+    * \brief Sets whether the geometry pass culls objects with hardware occlusion queries.
+    * Objects occluded in the previous frame are skipped and their bounding boxes are queried
+    * after the visible objects have been drawn. They are then drawn with conditional rendering,
+    * so objects becoming visible do not appear a frame late. Visible objects are queried at an
+    * interval. Counters of queried, culled and again visible objects are logged with the
+    * overdraw. Disabled by default.
+    */
+    void setOcclusionQueries(bool enabled);
+
+    /**
+    * \brief Reallocates window sized targets with the next draw.
+    * Targets are allocated with the window size on the first draw and only reallocated on
+    * resize events afterwards.
+    */
+    void handleResizeEvent(int width, int height) override;
+
+    /**
+    * \brief Returns number of consecutive frames, which did not allocate textures or frame
+    * buffers.
+    */
+    unsigned int getAllocationFreeFrameCount() const;
+
     static CDeferredRenderer* create(IResourceManager* manager);
 
    protected:
+    /**
+    * \brief Resizes gbuffer and lbuffer and releases render graph resources of the old size.
+    */
+    void resizeTargets(unsigned int width, unsigned int height);
+
+    /**
+    * \brief Returns inverse view projection for texture coordinates of the scaled render region.
+    */
+    glm::mat4 getInverseViewProjectionMatrix() const;
+
     /**
     * \brief Writes geometry data into g-buffer.
+    * Visible objects are sorted front to back, so early depth tests reject hidden fragments.
     */
     void geometryPass(const IScene& scene, const ICamera& camera, const IWindow& window,
                       const IGraphicsResourceManager& manager, ISceneQuery& query);
 
+    /**
+    * \brief Issues occlusion queries for bounding boxes of the geometry pass draws.
+    * Boxes are tested against the depth of the drawn objects without writing to the g-buffer.
+    */
+    void queryOcclusion(const IGraphicsResourceManager& manager);
+
     /**
     * \brief Performs shadow map calculation.
     */
@@ -78,11 +176,56 @@ class CDeferredRenderer : public ARenderer
                           const IGraphicsResourceManager& manager, ISceneQuery& query);
 
     /**
-    * \brief Performs post processing of lit scene.
+    * \brief Adds post processing passes of the lit scene to the render graph.
+    * Returns target with the processed scene.
+    * \param output Target written by the last pass, transient targets are used if invalid.
     */
-    void postProcessPass(const ICamera& camera, const IWindow& window,
-                         const IGraphicsResourceManager& manager,
-                         const std::shared_ptr<CTexture>& texture);
+    RenderTargetId postProcessPass(const ICamera& camera, const IWindow& window,
+                                   const IGraphicsResourceManager& manager, RenderTargetId scene,
+                                   RenderTargetId depth, RenderTargetId output);
+
+    /**
+    * \brief Adds vertical and horizontal gauss blur passes of the scene to the render graph.
+    */
+    void addGaussBlurPasses(const IWindow& window, const IGraphicsResourceManager& manager,
+                            RenderTargetId scene, RenderTargetId blurVertical,
+                            RenderTargetId blur);
+
+    /**
+    * \brief Adds depth aware downsample pass of the scene to the render graph.
+    * Returns target with the downsampled scene and its linear depth as alpha.
+    */
+    RenderTargetId addDepthDownsamplePass(const IWindow& window,
+                                          const IGraphicsResourceManager& manager,
+                                          RenderTargetId scene, RenderTargetId depth,
+                                          unsigned int divisor);
+
+    /**
+    * \brief Adds god ray generation pass to the render graph.
+    */
+    void addGodRayPass(const IWindow& window, const IGraphicsResourceManager& manager,
+                       RenderTargetId scene, RenderTargetId depth, RenderTargetId godRays);
+
+    /**
+    * \brief Merged post processing pass.
+    * Applies depth of field composite, fog and god ray composite in a single full screen pass.
+    * Blur and god ray textures are nullptr if the effect is disabled. Their depth textures are
+    * the downsampled scenes of reduced resolution effects and nullptr for full resolution.
+    */
+    void uberPostPass(const ICamera& camera, const IWindow& window,
+                      const IGraphicsResourceManager& manager,
+                      const std::shared_ptr<CTexture>& sceneTexture,
+                      const std::shared_ptr<CTexture>& blurTexture,
+                      const std::shared_ptr<CTexture>& blurDepthTexture,
+                      const std::shared_ptr<CTexture>& godRayTexture,
+                      const std::shared_ptr<CTexture>& godRayDepthTexture);
+
+    /**
+    * \brief Depth aware downsample pass for reduced resolution effects.
+    */
+    void depthDownsamplePass(const IWindow& window, const IGraphicsResourceManager& manager,
+                             const std::shared_ptr<CTexture>& sceneTexture,
+                             unsigned int divisor);
 
     void fogPass(const ICamera& camera, const IWindow&, const IGraphicsResourceManager& manager,
                  const std::shared_ptr<CTexture>& texture);
@@ -196,6 +339,16 @@ class CDeferredRenderer : public ARenderer
     */
     bool initFogPass(IResourceManager* manager);
 
+    /**
+    * \brief Initializes merged post processing pass.
+    */
+    bool initUberPostPass(IResourceManager* manager);
+
+    /**
+    * \brief Initializes depth aware downsample pass for reduced resolution effects.
+    */
+    bool initDepthDownsamplePass(IResourceManager* manager);
+
     bool initGodRayPass1(IResourceManager* manager);
     bool initGodRayPass2(IResourceManager* manager);
 
@@ -213,15 +366,69 @@ class CDeferredRenderer : public ARenderer
    private:
     CTransformer m_transformer; /**< Stores current transformation matrices. */
 
+    // Window sized targets
+    unsigned int m_targetWidth = 0;  /**< Width of allocated targets, 0 before the first draw. */
+    unsigned int m_targetHeight = 0; /**< Height of allocated targets. */
+    bool m_resizePending = false;    /**< Resize event has not been applied yet. */
+    unsigned int m_resizeWidth = 0;  /**< Width of the last resize event. */
+    unsigned int m_resizeHeight = 0; /**< Height of the last resize event. */
+
+    // Allocation counters
+    unsigned int m_textureAllocations = 0;   /**< Texture allocations until the last frame. */
+    unsigned int m_frameBufferCreations = 0; /**< Frame buffers created until the last frame. */
+    unsigned int m_allocationFreeFrames = 0; /**< Consecutive frames without allocations. */
+    static const unsigned int s_steadyStateFrames =
+        600; /**< Allocation free frames until steady state is reported. */
+
+    // Dynamic resolution
+    bool m_dynamicResolution = false;          /**< Resolution is scaled by GPU frame time. */
+    float m_resolutionScale = 1.f;             /**< Render resolution scale of the frame. */
+    CDynamicResolution m_resolutionController; /**< Adjusts the scale to the frame time. */
+    CGpuTimer m_frameTimer;                    /**< Measures GPU time of the frame. */
+
     // Geometry pass
     // TODO Put into geometry pass class
-    CFrameBuffer m_geometryBuffer;                      /**< GBuffer. */
     std::shared_ptr<CTexture> m_depthTexture = nullptr; /**< Depth texture attachment. */
     std::shared_ptr<CTexture> m_diffuseGlowTexture =
         nullptr; /**< Diffuse texture with glow as alpha. */
     std::shared_ptr<CTexture>
         m_normalSpecularTexture; /**< Normal texture with specularity as alpha. */
-    ResourceId m_geometryPassShaderId = -1;
+    CShaderVariants m_geometryPassShaders; /**< Variants by material features and layout. */
+    bool m_compactGBuffer = false; /**< Normals and specularity are packed into two channels. */
+
+    /**
+    * \brief Object drawn by the geometry pass.
+    */
+    struct SGeometryDraw
+    {
+        SceneObjectId m_id;    /**< Scene object. */
+        CMesh* m_mesh;         /**< Mesh to draw. */
+        CMaterial* m_material; /**< Material of the mesh. */
+        glm::vec3 m_position;  /**< World position. */
+        glm::vec3 m_rotation;  /**< Rotation. */
+        glm::vec3 m_scale;     /**< Scale. */
+        float m_depth;         /**< View depth of the position, used for sorting. */
+        float m_extent;        /**< Half size of the queried box, 0 if not queried. */
+    };
+    std::vector<SGeometryDraw> m_geometryDraws; /**< Draws of the frame, kept for reuse. */
+    std::vector<SGeometryDraw> m_occludedDraws; /**< Draws occluded in the previous frame. */
+
+    // Depth pre-pass
+    bool m_depthPrepass = false;     /**< Depth is laid down before the material shaders run. */
+    CSampleCounter m_prepassSamples; /**< Counts fragments passing the pre-pass depth test. */
+    CSampleCounter m_geometrySamples; /**< Counts fragments shaded by the geometry pass. */
+    float m_prepassOverdraw = 0.f;  /**< Last measured pre-pass fragments per pixel. */
+    float m_geometryOverdraw = 0.f; /**< Last measured shaded fragments per pixel. */
+    unsigned int m_overdrawReportFrames = 0; /**< Frames since overdraw was last reported. */
+    static const unsigned int s_overdrawReportInterval =
+        300; /**< Frames between overdraw reports. */
+
+    bool m_occlusionCulling = false; /**< Objects hidden by occluders are culled on the CPU. */
+
+    // Hardware occlusion queries
+    bool m_occlusionQueryCulling = false; /**< Objects are culled with occlusion queries. */
+    COcclusionQueries m_occlusionQueries; /**< Query state per scene object. */
+    ResourceId m_occlusionBoxMeshId = -1; /**< Unit cube for bounding box queries. */
 
     // Shadow map pass
     ResourceId m_shadowMapPassShaderId = -1;
@@ -238,33 +445,22 @@ class CDeferredRenderer : public ARenderer
 
     // Light pass common resources
     // TODO Put into light pass class
-    CFrameBuffer m_lightPassFrameBuffer; /**< Stores lit scene and depth. */
-    std::shared_ptr<CTexture> m_lightPassTexture = nullptr;
+    std::shared_ptr<CTexture> m_lightPassTexture = nullptr; /**< Stores lit scene. */
 
     // Point light pass
-    ResourceId m_pointLightPassShaderId = -1;
+    CShaderVariants m_pointLightPassShaders; /**< Variants by g-buffer layout. */
     ResourceId m_pointLightSphereId = -1;
 
     // Directional light pass
-    ResourceId m_directionalLightPassShaderId = -1;
+    CShaderVariants m_directionalLightPassShaders; /**< Variants by g-buffer layout. */
     ResourceId m_directionalLightScreenQuadId = -1;
 
     // Illumination pass
     ResourceId m_illuminationPassShaderId = -1;
     ResourceId m_illuminationPassScreenQuadId = -1;
-    CFrameBuffer m_illumationPassFrameBuffer;
-    std::shared_ptr<CTexture> m_illuminationPassTexture = nullptr;
 
     // Post processing pass
     ResourceId m_postProcessScreenQuadId = -1;
-    CFrameBuffer m_postProcessPassFrameBuffer0;
-    CFrameBuffer m_postProcessPassFrameBuffer1;
-    CFrameBuffer m_postProcessPassFrameBuffer2;
-
-    std::shared_ptr<CTexture> m_postProcessPassTexture0 = nullptr;
-    std::shared_ptr<CTexture> m_postProcessPassTexture1 = nullptr;
-    std::shared_ptr<CTexture> m_postProcessPassTexture2 = nullptr;
-    std::shared_ptr<CTexture> m_postProcessPassOutputTexture = nullptr;
 
     // Gauss blur pass
     ResourceId m_gaussBlurVerticalShaderId = -1;
@@ -274,11 +470,21 @@ class CDeferredRenderer : public ARenderer
     ResourceId m_fxaaPassShaderId = -1;
 
     // Fog pass
-    ResourceId m_fogPassShaderId = -1;
+    CShaderVariants m_fogPassShaders; /**< Variants by fog type. */
 
     // Depth-of-field pass
     ResourceId m_depthOfFieldPassShaderId = -1;
 
+    // Merged post processing pass
+    CShaderVariants m_uberPostPassShaders;     /**< Variants by enabled effects. */
+    bool m_uberPostProcessing = true;          /**< Effects are composited in a single pass. */
+    unsigned int m_reportedPostFeatures = ~0u; /**< Effects of the last fill rate report. */
+
+    // Reduced resolution effects
+    ResourceId m_depthDownsamplePassShaderId = -1;
+    unsigned int m_blurResolutionDivisor = 2;   /**< Resolution divisor of the blur. */
+    unsigned int m_godRayResolutionDivisor = 2; /**< Resolution divisor of the god rays. */
+
     // Godray pass
     ResourceId m_godRayPass1ShaderId = -1;
     ResourceId m_godRayPass2ShaderId = -1;
@@ -291,5 +497,6 @@ class CDeferredRenderer : public ARenderer
 
     // Fullscreen draw pass
     CScreenQuadPass m_screenQuadPass;
+    CRenderGraph m_renderGraph; /**< Schedules screen space passes and their targets. */
     std::list<SRenderRequest> m_customShaderMeshes; /**< Render requests with custom shaders. */
 };
@@ -0,0 +1,68 @@
+#include "CDynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+* \brief Weight of a new frame time in the average.
+*/
+static const float frameTimeSmoothing = 0.2f;
+
+/**
+* \brief Scales are multiples of the step, changes below half a step are ignored.
+*/
+static const float scaleStep = 0.05f;
+
+void CDynamicResolution::setTargetFrameTime(float milliseconds)
+{
+    m_targetFrameTime = milliseconds;
+}
+
+void CDynamicResolution::setScaleRange(float minScale, float maxScale)
+{
+    m_minScale = std::min(minScale, maxScale);
+    m_maxScale = maxScale;
+    m_scale = m_maxScale;
+    m_frameTime = 0.f;
+    m_measuredFrames = 0;
+}
+
+bool CDynamicResolution::update(float frameTime)
+{
+    // Measurements of frames in flight at a scale change were taken at the previous scale
+    ++m_measuredFrames;
+    if (m_measuredFrames <= s_latencyFrames)
+    {
+        return false;
+    }
+    // Average filters noise of single frames
+    if (m_measuredFrames == s_latencyFrames + 1)
+    {
+        m_frameTime = frameTime;
+    }
+    else
+    {
+        m_frameTime += (frameTime - m_frameTime) * frameTimeSmoothing;
+    }
+    if (m_measuredFrames < s_latencyFrames + s_settleFrames || m_frameTime <= 0.f)
+    {
+        return false;
+    }
+
+    // Frame time is assumed to be proportional to the number of pixels
+    float scale = m_scale * std::sqrt(m_targetFrameTime / m_frameTime);
+    scale = std::round(scale / scaleStep) * scaleStep;
+    scale = std::max(m_minScale, std::min(m_maxScale, scale));
+    if (std::abs(scale - m_scale) < scaleStep * 0.5f)
+    {
+        return false;
+    }
+    m_scale = scale;
+    // Average restarts with frames of the new scale
+    m_measuredFrames = 0;
+    return true;
+}
+
+float CDynamicResolution::getScale() const { return m_scale; }
+
+float CDynamicResolution::getFrameTime() const { return m_frameTime; }
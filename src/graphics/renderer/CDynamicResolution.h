@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+* \brief Controls the render resolution scale by the measured frame time.
+* The scale applies to both axes, so the frame time is assumed to change with its square. The
+* scale is steered towards the value, which meets the target frame time. Frame times are
+* averaged, scales are quantized and changes wait for frames measured at the current scale to
+* avoid oscillation.
+*/
+class CDynamicResolution
+{
+   public:
+    /**
+    * \brief Sets frame time in milliseconds the scale is adjusted to.
+    */
+    void setTargetFrameTime(float milliseconds);
+
+    /**
+    * \brief Sets range of the scale, the maximum is used initially.
+    */
+    void setScaleRange(float minScale, float maxScale);
+
+    /**
+    * \brief Adjusts the scale to a measured frame time in milliseconds.
+    * Returns true if the scale changed.
+    */
+    bool update(float frameTime);
+
+    /**
+    * \brief Returns scale of the render resolution per axis.
+    */
+    float getScale() const;
+
+    /**
+    * \brief Returns averaged frame time in milliseconds.
+    */
+    float getFrameTime() const;
+
+   private:
+    float m_targetFrameTime = 16.6f;   /**< Frame time the scale is adjusted to. */
+    float m_minScale = 0.5f;           /**< Lowest scale. */
+    float m_maxScale = 1.f;            /**< Highest scale. */
+    float m_scale = 1.f;               /**< Current scale. */
+    float m_frameTime = 0.f;           /**< Averaged frame time, 0 if not measured yet. */
+    unsigned int m_measuredFrames = 0; /**< Frames measured since the last scale change. */
+
+    static const unsigned int s_latencyFrames =
+        4; /**< Measurements ignored after a change, frames still in flight. */
+    static const unsigned int s_settleFrames =
+        8; /**< Frames averaged at a scale before it changes again. */
+};
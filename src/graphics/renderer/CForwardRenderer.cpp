@@ -112,6 +112,11 @@ void CForwardRenderer::draw(const IScene& scene, const ICamera& camera, const IW
 			// Resolve ids
 			CMesh* mesh = manager.getMesh(meshId);
 			CMaterial* material = manager.getMaterial(materialId);
+			if (mesh == nullptr || material == nullptr)
+			{
+				// Resources have been unloaded
+				continue;
+			}
 
 			// Create matrices
 			glm::mat4 translationMatrix = glm::translate(position);
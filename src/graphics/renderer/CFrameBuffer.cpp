@@ -1,5 +1,6 @@
 #include "CFrameBuffer.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "graphics/resource/CTexture.h"
@@ -85,7 +86,11 @@ void CFrameBuffer::resize(unsigned int width, unsigned int height)
 {
     for (auto& entry : m_textures)
     {
-        entry.second->resize(width, height);
+        // Textures with immutable storage are replaced and reattached
+        if (entry.second->resize(width, height))
+        {
+            attach(entry.second, entry.first);
+        }
     }
     for (auto& entry : m_renderBuffers)
     {
@@ -107,7 +112,8 @@ void CFrameBuffer::attach(const std::shared_ptr<CTexture>& texture, GLenum attac
     glFramebufferTexture(GL_FRAMEBUFFER, attachment, texture->getId(), 0);
     // Add color attachments to draw buffers
     if (attachment != GL_DEPTH_ATTACHMENT && attachment != GL_STENCIL_ATTACHMENT &&
-        attachment != GL_DEPTH_STENCIL_ATTACHMENT)
+        attachment != GL_DEPTH_STENCIL_ATTACHMENT &&
+        std::find(m_drawBuffers.begin(), m_drawBuffers.end(), attachment) == m_drawBuffers.end())
     {
         m_drawBuffers.push_back(attachment);
     }
@@ -129,7 +135,8 @@ void CFrameBuffer::attach(const std::shared_ptr<CRenderBuffer>& renderBuffer, GL
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderBuffer->getId());
     // Add color attachments to draw buffers
     if (attachment != GL_DEPTH_ATTACHMENT && attachment != GL_STENCIL_ATTACHMENT &&
-        attachment != GL_DEPTH_STENCIL_ATTACHMENT)
+        attachment != GL_DEPTH_STENCIL_ATTACHMENT &&
+        std::find(m_drawBuffers.begin(), m_drawBuffers.end(), attachment) == m_drawBuffers.end())
     {
         m_drawBuffers.push_back(attachment);
     }
@@ -0,0 +1,504 @@
+#include "CRenderGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "CFrameBuffer.h"
+
+#include "graphics/resource/CTexture.h"
+
+#include "debug/Log.h"
+
+CRenderGraph::CRenderGraph() { return; }
+
+CRenderGraph::~CRenderGraph() { return; }
+
+void CRenderGraph::reset()
+{
+    m_targets.clear();
+    m_passes.clear();
+    m_output = invalidRenderTarget;
+    m_compiled = false;
+    m_executingPass = -1;
+    m_renderScale = 1.f;
+    trimPool();
+}
+
+RenderTargetId CRenderGraph::createTarget(const std::string& name, unsigned int width,
+                                          unsigned int height, GLint format)
+{
+    STarget target;
+    target.m_name = name;
+    target.m_width = width;
+    target.m_height = height;
+    target.m_format = format;
+    target.m_transient = true;
+    target.m_backBuffer = false;
+    target.m_firstPass = -1;
+    target.m_lastPass = -1;
+    target.m_pooledTexture = -1;
+    m_targets.push_back(target);
+    return (RenderTargetId)m_targets.size() - 1;
+}
+
+RenderTargetId CRenderGraph::importTarget(const std::string& name,
+                                          const std::shared_ptr<CTexture>& texture)
+{
+    assert(texture != nullptr);
+    STarget target;
+    target.m_name = name;
+    target.m_width = texture->getWidth();
+    target.m_height = texture->getHeight();
+    target.m_format = 0;
+    target.m_transient = false;
+    target.m_backBuffer = false;
+    target.m_texture = texture;
+    target.m_firstPass = -1;
+    target.m_lastPass = -1;
+    target.m_pooledTexture = -1;
+    m_targets.push_back(target);
+    return (RenderTargetId)m_targets.size() - 1;
+}
+
+RenderTargetId CRenderGraph::importBackBuffer(unsigned int width, unsigned int height)
+{
+    STarget target;
+    target.m_name = "back buffer";
+    target.m_width = width;
+    target.m_height = height;
+    target.m_format = 0;
+    target.m_transient = false;
+    target.m_backBuffer = true;
+    target.m_firstPass = -1;
+    target.m_lastPass = -1;
+    target.m_pooledTexture = -1;
+    m_targets.push_back(target);
+    return (RenderTargetId)m_targets.size() - 1;
+}
+
+unsigned int CRenderGraph::addPass(const std::string& name, const std::function<void()>& execute)
+{
+    SPass pass;
+    pass.m_name = name;
+    pass.m_execute = execute;
+    pass.m_culled = false;
+    m_passes.push_back(pass);
+    return (unsigned int)m_passes.size() - 1;
+}
+
+void CRenderGraph::read(unsigned int pass, RenderTargetId target)
+{
+    assert(pass < m_passes.size());
+    assert(target >= 0 && target < (RenderTargetId)m_targets.size());
+    m_passes[pass].m_reads.push_back(target);
+}
+
+void CRenderGraph::write(unsigned int pass, RenderTargetId target, GLenum attachment,
+                         LoadAction load, const glm::vec4& clearValue)
+{
+    assert(pass < m_passes.size());
+    assert(target >= 0 && target < (RenderTargetId)m_targets.size());
+    SWrite write;
+    write.m_target = target;
+    write.m_attachment = attachment;
+    write.m_load = load;
+    write.m_clearValue = clearValue;
+    m_passes[pass].m_writes.push_back(write);
+}
+
+void CRenderGraph::setRenderScale(float scale) { m_renderScale = scale; }
+
+void CRenderGraph::setOutput(RenderTargetId target)
+{
+    assert(target >= 0 && target < (RenderTargetId)m_targets.size());
+    m_output = target;
+}
+
+bool CRenderGraph::compile()
+{
+    m_compiled = false;
+    if (m_output == invalidRenderTarget)
+    {
+        LOG_ERROR("Render graph has no output target.");
+        return false;
+    }
+
+    // The back buffer can not be combined with textures in a frame buffer
+    for (const SPass& pass : m_passes)
+    {
+        bool backBuffer = false;
+        bool texture = false;
+        for (const SWrite& write : pass.m_writes)
+        {
+            if (m_targets[write.m_target].m_backBuffer)
+            {
+                backBuffer = true;
+            }
+            else
+            {
+                texture = true;
+            }
+        }
+        if (backBuffer && texture)
+        {
+            LOG_ERROR("Render graph pass %s writes back buffer and textures.", pass.m_name.c_str());
+            return false;
+        }
+    }
+
+    cull();
+
+    // Lifetimes of targets over live passes
+    for (unsigned int i = 0; i < m_passes.size(); ++i)
+    {
+        const SPass& pass = m_passes[i];
+        if (pass.m_culled)
+        {
+            continue;
+        }
+        for (RenderTargetId id : pass.m_reads)
+        {
+            STarget& target = m_targets[id];
+            if (target.m_firstPass == -1)
+            {
+                if (target.m_transient)
+                {
+                    LOG_WARNING("Render graph pass %s reads target %s before it is written.",
+                                pass.m_name.c_str(), target.m_name.c_str());
+                }
+                target.m_firstPass = i;
+            }
+            target.m_lastPass = i;
+        }
+        for (const SWrite& write : pass.m_writes)
+        {
+            STarget& target = m_targets[write.m_target];
+            if (target.m_firstPass == -1)
+            {
+                target.m_firstPass = i;
+            }
+            target.m_lastPass = i;
+        }
+    }
+    // Output stays valid after execution
+    m_targets[m_output].m_lastPass = (int)m_passes.size();
+
+    // Assign pooled textures, textures are free again after the last pass using them
+    for (SPooledTexture& pooled : m_pool)
+    {
+        pooled.m_inUse = false;
+    }
+    m_transientTargetCount = 0;
+    for (unsigned int i = 0; i < m_passes.size(); ++i)
+    {
+        const SPass& pass = m_passes[i];
+        if (pass.m_culled)
+        {
+            continue;
+        }
+        std::vector<RenderTargetId> targets = pass.m_reads;
+        for (const SWrite& write : pass.m_writes)
+        {
+            targets.push_back(write.m_target);
+        }
+        for (RenderTargetId id : targets)
+        {
+            STarget& target = m_targets[id];
+            if (target.m_transient && target.m_pooledTexture == -1)
+            {
+                if (!acquire(target))
+                {
+                    return false;
+                }
+                ++m_transientTargetCount;
+            }
+        }
+        for (RenderTargetId id : targets)
+        {
+            STarget& target = m_targets[id];
+            if (target.m_transient && target.m_lastPass == (int)i)
+            {
+                m_pool[target.m_pooledTexture].m_inUse = false;
+            }
+        }
+    }
+
+    m_compiled = true;
+    return true;
+}
+
+void CRenderGraph::execute()
+{
+    if (!m_compiled)
+    {
+        LOG_ERROR("Render graph executed without successful compile.");
+        return;
+    }
+
+    for (unsigned int i = 0; i < m_passes.size(); ++i)
+    {
+        const SPass& pass = m_passes[i];
+        if (pass.m_culled)
+        {
+            continue;
+        }
+
+        m_executingPass = (int)i;
+        setTargetsActive(pass);
+        clear(pass, i);
+        pass.m_execute();
+    }
+    m_executingPass = -1;
+    CFrameBuffer::setDefaultActive();
+}
+
+void CRenderGraph::setTargetsActive()
+{
+    assert(m_executingPass != -1);
+    setTargetsActive(m_passes[m_executingPass]);
+}
+
+const std::shared_ptr<CTexture>& CRenderGraph::getTexture(RenderTargetId target) const
+{
+    assert(target >= 0 && target < (RenderTargetId)m_targets.size());
+    return m_targets[target].m_texture;
+}
+
+unsigned int CRenderGraph::getCulledPassCount() const { return m_culledPassCount; }
+
+unsigned int CRenderGraph::getTransientTargetCount() const { return m_transientTargetCount; }
+
+unsigned int CRenderGraph::getPooledTextureCount() const { return (unsigned int)m_pool.size(); }
+
+unsigned int CRenderGraph::getFrameBufferCreationCount() const { return m_frameBufferCreations; }
+
+void CRenderGraph::cull()
+{
+    // Walk passes backwards and keep the ones writing targets needed by later passes
+    std::vector<bool> required(m_targets.size(), false);
+    required[m_output] = true;
+    m_culledPassCount = 0;
+    for (unsigned int i = (unsigned int)m_passes.size(); i > 0; --i)
+    {
+        SPass& pass = m_passes[i - 1];
+        pass.m_culled = true;
+        for (const SWrite& write : pass.m_writes)
+        {
+            if (required[write.m_target])
+            {
+                pass.m_culled = false;
+            }
+        }
+        if (pass.m_culled)
+        {
+            ++m_culledPassCount;
+            continue;
+        }
+
+        // Overwritten contents are not needed from earlier passes, kept contents are
+        for (const SWrite& write : pass.m_writes)
+        {
+            required[write.m_target] = write.m_load == LoadAction::Load;
+        }
+        for (RenderTargetId id : pass.m_reads)
+        {
+            required[id] = true;
+        }
+    }
+}
+
+bool CRenderGraph::acquire(STarget& target)
+{
+    for (unsigned int i = 0; i < m_pool.size(); ++i)
+    {
+        SPooledTexture& pooled = m_pool[i];
+        if (!pooled.m_inUse && pooled.m_width == target.m_width &&
+            pooled.m_height == target.m_height && pooled.m_format == target.m_format)
+        {
+            pooled.m_inUse = true;
+            pooled.m_unusedFrames = 0;
+            target.m_texture = pooled.m_texture;
+            target.m_pooledTexture = i;
+            return true;
+        }
+    }
+
+    // No free texture fits, create new one
+    std::shared_ptr<CTexture> texture = std::make_shared<CTexture>();
+    if (!texture->init(target.m_width, target.m_height, target.m_format))
+    {
+        LOG_ERROR("Failed to create texture for render target %s.", target.m_name.c_str());
+        return false;
+    }
+    SPooledTexture pooled;
+    pooled.m_texture = texture;
+    pooled.m_width = target.m_width;
+    pooled.m_height = target.m_height;
+    pooled.m_format = target.m_format;
+    pooled.m_inUse = true;
+    pooled.m_unusedFrames = 0;
+    m_pool.push_back(pooled);
+    LOG_DEBUG("Render graph texture %ux%u created for target %s, %u pooled textures.",
+              target.m_width, target.m_height, target.m_name.c_str(), (unsigned int)m_pool.size());
+
+    target.m_texture = texture;
+    target.m_pooledTexture = (int)m_pool.size() - 1;
+    return true;
+}
+
+CFrameBuffer* CRenderGraph::getFrameBuffer(const SPass& pass)
+{
+    FrameBufferKey key;
+    for (const SWrite& write : pass.m_writes)
+    {
+        const STarget& target = m_targets[write.m_target];
+        if (target.m_backBuffer)
+        {
+            return nullptr;
+        }
+        key.push_back(std::make_pair(write.m_attachment, target.m_texture->getId()));
+    }
+    // Color attachments sort before depth attachments
+    std::sort(key.begin(), key.end());
+
+    auto iter = m_frameBuffers.find(key);
+    if (iter != m_frameBuffers.end())
+    {
+        return iter->second.get();
+    }
+
+    // Create frame buffer for the combination of textures
+    std::unique_ptr<CFrameBuffer> frameBuffer(new CFrameBuffer);
+    bool hasColor = false;
+    for (const auto& entry : key)
+    {
+        for (const SWrite& write : pass.m_writes)
+        {
+            if (write.m_attachment == entry.first)
+            {
+                frameBuffer->attach(m_targets[write.m_target].m_texture, write.m_attachment);
+            }
+        }
+        if (entry.first != GL_DEPTH_ATTACHMENT && entry.first != GL_STENCIL_ATTACHMENT &&
+            entry.first != GL_DEPTH_STENCIL_ATTACHMENT)
+        {
+            hasColor = true;
+        }
+    }
+    frameBuffer->setActive(GL_FRAMEBUFFER);
+    if (!hasColor)
+    {
+        // Depth only
+        glDrawBuffer(GL_NONE);
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_ERROR("Render graph frame buffer for pass %s incomplete: %s.", pass.m_name.c_str(),
+                  frameBuffer->getState().c_str());
+    }
+    CFrameBuffer* result = frameBuffer.get();
+    m_frameBuffers[key] = std::move(frameBuffer);
+    ++m_frameBufferCreations;
+    return result;
+}
+
+void CRenderGraph::setTargetsActive(const SPass& pass)
+{
+    CFrameBuffer* frameBuffer = getFrameBuffer(pass);
+    if (frameBuffer != nullptr)
+    {
+        frameBuffer->setActive(GL_FRAMEBUFFER);
+    }
+    else
+    {
+        CFrameBuffer::setDefaultActive();
+    }
+    const STarget& target = m_targets[pass.m_writes.front().m_target];
+    if (target.m_backBuffer)
+    {
+        glViewport(0, 0, target.m_width, target.m_height);
+    }
+    else
+    {
+        // Scaled region starts at the origin, textures keep their size
+        glViewport(0, 0, std::max(1u, (unsigned int)(target.m_width * m_renderScale + 0.5f)),
+                   std::max(1u, (unsigned int)(target.m_height * m_renderScale + 0.5f)));
+    }
+}
+
+void CRenderGraph::clear(const SPass& pass, unsigned int passIndex)
+{
+    for (const SWrite& write : pass.m_writes)
+    {
+        const STarget& target = m_targets[write.m_target];
+        // Contents of transient targets are undefined on first write
+        bool clear = write.m_load == LoadAction::Clear ||
+                     (write.m_load == LoadAction::Load && target.m_transient &&
+                      target.m_firstPass == (int)passIndex);
+        if (!clear)
+        {
+            continue;
+        }
+
+        if (write.m_attachment == GL_DEPTH_ATTACHMENT)
+        {
+            glDepthMask(GL_TRUE);
+            glClearBufferfv(GL_DEPTH, 0, &write.m_clearValue.x);
+        }
+        else
+        {
+            // Draw buffers are ordered by attachment
+            GLint drawBuffer = 0;
+            for (const SWrite& other : pass.m_writes)
+            {
+                if (other.m_attachment < write.m_attachment)
+                {
+                    ++drawBuffer;
+                }
+            }
+            glClearBufferfv(GL_COLOR, drawBuffer, &write.m_clearValue.x);
+        }
+    }
+}
+
+void CRenderGraph::releaseResources()
+{
+    assert(m_executingPass == -1);
+    m_frameBuffers.clear();
+    m_pool.clear();
+}
+
+void CRenderGraph::trimPool()
+{
+    for (auto iter = m_pool.begin(); iter != m_pool.end();)
+    {
+        iter->m_inUse = false;
+        ++iter->m_unusedFrames;
+        if (iter->m_unusedFrames <= s_maxUnusedFrames)
+        {
+            ++iter;
+            continue;
+        }
+
+        // Drop frame buffers with the texture attached
+        GLuint textureId = iter->m_texture->getId();
+        for (auto frameBuffer = m_frameBuffers.begin(); frameBuffer != m_frameBuffers.end();)
+        {
+            bool attached = false;
+            for (const auto& entry : frameBuffer->first)
+            {
+                attached |= entry.second == textureId;
+            }
+            if (attached)
+            {
+                frameBuffer = m_frameBuffers.erase(frameBuffer);
+            }
+            else
+            {
+                ++frameBuffer;
+            }
+        }
+        LOG_DEBUG("Render graph texture %ux%u released.", iter->m_width, iter->m_height);
+        iter = m_pool.erase(iter);
+    }
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "core/RendererCoreConfig.h"
+
+class CTexture;
+class CFrameBuffer;
+
+typedef int RenderTargetId;
+const RenderTargetId invalidRenderTarget = -1;
+
+/**
+* \brief Treatment of previous target contents by a writing pass.
+*/
+enum class LoadAction
+{
+    DontCare, /**< Pass overwrites every pixel, previous contents are not needed. */
+    Clear,    /**< Target is cleared before the pass. */
+    Load      /**< Pass keeps previous contents, e.g. for blending. */
+};
+
+/**
+* \brief Declarative graph of render passes for one frame.
+* Passes are added every frame together with the render targets they read and write. Compiling
+* the graph culls passes, which do not contribute to the output target, and assigns textures to
+* transient targets from a pool. Transient targets with equal size and format, which are not
+* alive at the same time, share a texture. Targets are only cleared if a pass requests it or
+* keeps contents of a transient target, which are undefined on first use. Pooled textures and
+* frame buffers are kept between frames and released after being unused for some frames.
+*/
+class CRenderGraph
+{
+   public:
+    CRenderGraph();
+    ~CRenderGraph();
+
+    /**
+    * \brief Removes passes and targets of the previous frame, pooled textures are kept.
+    */
+    void reset();
+
+    /**
+    * \brief Adds transient target, which is only valid while executing passes using it.
+    */
+    RenderTargetId createTarget(const std::string& name, unsigned int width, unsigned int height,
+                                GLint format);
+
+    /**
+    * \brief Adds target owned outside of the graph, e.g. a g-buffer texture.
+    * Contents of imported targets persist between frames.
+    */
+    RenderTargetId importTarget(const std::string& name, const std::shared_ptr<CTexture>& texture);
+
+    /**
+    * \brief Adds default frame buffer as target.
+    */
+    RenderTargetId importBackBuffer(unsigned int width, unsigned int height);
+
+    /**
+    * \brief Adds pass and returns its index.
+    * The function is called on execution with the written targets bound as frame buffer and the
+    * viewport set to their scaled size.
+    */
+    unsigned int addPass(const std::string& name, const std::function<void()>& execute);
+
+    /**
+    * \brief Declares that the pass samples the target.
+    */
+    void read(unsigned int pass, RenderTargetId target);
+
+    /**
+    * \brief Declares that the pass renders into the target.
+    * \param clearValue Clear color, the first component is used as depth for depth attachments.
+    */
+    void write(unsigned int pass, RenderTargetId target, GLenum attachment,
+               LoadAction load = LoadAction::DontCare,
+               const glm::vec4& clearValue = glm::vec4(0.f));
+
+    /**
+    * \brief Sets scale of the rendered region of all targets except the back buffer.
+    * Used for dynamic resolution, the region starts at the origin and textures are not resized.
+    * Reset to 1 for each frame.
+    */
+    void setRenderScale(float scale);
+
+    /**
+    * \brief Sets target, which passes have to contribute to in order to be executed.
+    */
+    void setOutput(RenderTargetId target);
+
+    /**
+    * \brief Culls passes and assigns textures to transient targets.
+    */
+    bool compile();
+
+    /**
+    * \brief Executes passes, which were not culled, in order of addition.
+    */
+    void execute();
+
+    /**
+    * \brief Binds targets of the executing pass again.
+    * Used by passes, which render into other frame buffers in between, e.g. shadow maps.
+    */
+    void setTargetsActive();
+
+    /**
+    * \brief Returns texture of a target, valid after compile.
+    * Returns nullptr for the back buffer.
+    */
+    const std::shared_ptr<CTexture>& getTexture(RenderTargetId target) const;
+
+    /**
+    * \brief Returns number of passes culled by the last compile.
+    */
+    unsigned int getCulledPassCount() const;
+
+    /**
+    * \brief Returns number of transient targets used by the last compile.
+    */
+    unsigned int getTransientTargetCount() const;
+
+    /**
+    * \brief Returns number of pooled textures.
+    */
+    unsigned int getPooledTextureCount() const;
+
+    /**
+    * \brief Returns number of frame buffers created since construction.
+    */
+    unsigned int getFrameBufferCreationCount() const;
+
+    /**
+    * \brief Releases pooled textures and cached frame buffers.
+    * Used when the sizes of targets change, e.g. on window resize, instead of waiting for unused
+    * resources to be trimmed.
+    */
+    void releaseResources();
+
+   private:
+    /**
+    * \brief Target declared for the frame.
+    */
+    struct STarget
+    {
+        std::string m_name;                  /**< Name for debug output. */
+        unsigned int m_width;                /**< Width in pixels. */
+        unsigned int m_height;               /**< Height in pixels. */
+        GLint m_format;                      /**< Internal format of transient targets. */
+        bool m_transient;                    /**< Texture is taken from the pool. */
+        bool m_backBuffer;                   /**< Target is the default frame buffer. */
+        std::shared_ptr<CTexture> m_texture; /**< Assigned texture. */
+        int m_firstPass;                     /**< First live pass accessing the target. */
+        int m_lastPass;                      /**< Last live pass accessing the target. */
+        int m_pooledTexture;                 /**< Index of the assigned pooled texture. */
+    };
+
+    /**
+    * \brief Write access of a pass.
+    */
+    struct SWrite
+    {
+        RenderTargetId m_target; /**< Written target. */
+        GLenum m_attachment;     /**< Frame buffer attachment. */
+        LoadAction m_load;       /**< Treatment of previous contents. */
+        glm::vec4 m_clearValue;  /**< Clear color or depth. */
+    };
+
+    /**
+    * \brief Pass declared for the frame.
+    */
+    struct SPass
+    {
+        std::string m_name;                  /**< Name for debug output. */
+        std::function<void()> m_execute;     /**< Draws the pass. */
+        std::vector<RenderTargetId> m_reads; /**< Sampled targets. */
+        std::vector<SWrite> m_writes;        /**< Rendered targets. */
+        bool m_culled;                       /**< Pass does not contribute to the output. */
+    };
+
+    /**
+    * \brief Texture shared by transient targets.
+    */
+    struct SPooledTexture
+    {
+        std::shared_ptr<CTexture> m_texture; /**< Texture object. */
+        unsigned int m_width;                /**< Width in pixels. */
+        unsigned int m_height;               /**< Height in pixels. */
+        GLint m_format;                      /**< Internal format. */
+        bool m_inUse;                        /**< Assigned to a live target. */
+        unsigned int m_unusedFrames;         /**< Frames since the texture was last assigned. */
+    };
+
+    typedef std::vector<std::pair<GLenum, GLuint>> FrameBufferKey;
+
+    /**
+    * \brief Marks passes, which do not contribute to the output, as culled.
+    */
+    void cull();
+
+    /**
+    * \brief Assigns a free pooled texture to the target, creates one if none fits.
+    */
+    bool acquire(STarget& target);
+
+    /**
+    * \brief Returns cached frame buffer with the textures of the writes attached.
+    */
+    CFrameBuffer* getFrameBuffer(const SPass& pass);
+
+    /**
+    * \brief Binds frame buffer of the pass and sets viewport to the scaled target size.
+    */
+    void setTargetsActive(const SPass& pass);
+
+    /**
+    * \brief Clears written targets as requested by the load actions.
+    */
+    void clear(const SPass& pass, unsigned int passIndex);
+
+    /**
+    * \brief Releases pooled textures, which were not used for several frames.
+    */
+    void trimPool();
+
+    std::vector<STarget> m_targets;                /**< Targets of the current frame. */
+    std::vector<SPass> m_passes;                   /**< Passes in order of execution. */
+    RenderTargetId m_output = invalidRenderTarget; /**< Output target. */
+    bool m_compiled = false;                       /**< Graph has been compiled successfully. */
+    int m_executingPass = -1;                      /**< Index of the executing pass. */
+    float m_renderScale = 1.f;                     /**< Scale of the rendered target region. */
+    unsigned int m_culledPassCount = 0;            /**< Passes culled by the last compile. */
+    unsigned int m_transientTargetCount = 0;       /**< Transient targets of the last compile. */
+    unsigned int m_frameBufferCreations = 0;       /**< Frame buffers created in total. */
+
+    std::vector<SPooledTexture> m_pool; /**< Textures for transient targets. */
+    std::map<FrameBufferKey, std::unique_ptr<CFrameBuffer>>
+        m_frameBuffers; /**< Frame buffers by attached textures. */
+
+    static const unsigned int s_maxUnusedFrames =
+        60; /**< Frames until unused pooled textures are released. */
+};
@@ -0,0 +1,63 @@
+#include "CShaderVariants.h"
+
+#include "resource/IResourceManager.h"
+#include "graphics/IGraphicsResourceManager.h"
+#include "debug/Log.h"
+
+void CShaderVariants::init(IResourceManager* manager, const std::string& file,
+                           const std::vector<std::string>& featureDefines)
+{
+    m_resourceManager = manager;
+    m_file = file;
+    m_featureDefines = featureDefines;
+    m_variants.clear();
+}
+
+ResourceId CShaderVariants::get(unsigned int features)
+{
+    // Drop bits without define, so equal variants share one id
+    features &= (1u << m_featureDefines.size()) - 1;
+    auto entry = m_variants.find(features);
+    if (entry != m_variants.end())
+    {
+        return entry->second;
+    }
+
+    std::vector<std::string> defines;
+    for (unsigned int i = 0; i < m_featureDefines.size(); ++i)
+    {
+        if (features & (1u << i))
+        {
+            defines.push_back(m_featureDefines.at(i));
+        }
+    }
+
+    // Failed variants are cached too, to log the error once
+    ResourceId id = invalidResource;
+    if (m_resourceManager != nullptr)
+    {
+        id = m_resourceManager->loadShader(m_file, defines);
+    }
+    if (id == invalidResource)
+    {
+        LOG_ERROR("Failed to load variant 0x%x of shader %s.", features, m_file.c_str());
+    }
+    m_variants[features] = id;
+    return id;
+}
+
+CShaderProgram* CShaderVariants::getShaderProgram(unsigned int features,
+                                                  const IGraphicsResourceManager& manager)
+{
+    ResourceId id = get(features);
+    if (id == invalidResource)
+    {
+        return nullptr;
+    }
+    return manager.getShaderProgram(id);
+}
+
+unsigned int CShaderVariants::getVariantCount() const
+{
+    return (unsigned int)m_variants.size();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "resource/ResourceConfig.h"
+
+class IResourceManager;
+class IGraphicsResourceManager;
+class CShaderProgram;
+
+/**
+* \brief Specialized variants of a shader program, selected by a feature mask.
+* Bit i of the mask injects the i-th feature define into all stage sources, so unused features
+* are compiled out instead of branched over at runtime. Variants are loaded on first request and
+* cached by mask. Bits without a feature define are ignored.
+*/
+class CShaderVariants
+{
+   public:
+    /**
+    * \brief Sets shader program file and the feature defines in bit order.
+    * The resource manager must outlive the variants.
+    */
+    void init(IResourceManager* manager, const std::string& file,
+              const std::vector<std::string>& featureDefines);
+
+    /**
+    * \brief Returns shader resource id of the variant, loads the variant on first request.
+    * Returns invalidResource if the variant fails to load.
+    */
+    ResourceId get(unsigned int features);
+
+    /**
+    * \brief Returns shader program of the variant or nullptr on error.
+    */
+    CShaderProgram* getShaderProgram(unsigned int features,
+                                     const IGraphicsResourceManager& manager);
+
+    /**
+    * \brief Returns number of loaded variants.
+    */
+    unsigned int getVariantCount() const;
+
+   private:
+    IResourceManager* m_resourceManager = nullptr; /**< Loads variants. */
+    std::string m_file;                            /**< Shader program file. */
+    std::vector<std::string> m_featureDefines;     /**< Define per feature bit. */
+    std::unordered_map<unsigned int, ResourceId>
+        m_variants; /**< Variant ids by feature mask. */
+};
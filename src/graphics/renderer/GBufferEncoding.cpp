@@ -0,0 +1,55 @@
+#include "GBufferEncoding.h"
+
+#include <cmath>
+
+static glm::vec2 signNotZero(const glm::vec2& v)
+{
+    return glm::vec2(v.x >= 0.f ? 1.f : -1.f, v.y >= 0.f ? 1.f : -1.f);
+}
+
+static unsigned int quantize(float value, unsigned int maximum)
+{
+    return (unsigned int)std::floor(glm::clamp(value, 0.f, 1.f) * maximum + 0.5f);
+}
+
+glm::vec2 encodeOctahedral(const glm::vec3& normal)
+{
+    glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    glm::vec2 e(n.x, n.y);
+    if (n.z < 0.f)
+    {
+        // Fold lower hemisphere over the diagonals
+        e = (glm::vec2(1.f) - glm::abs(glm::vec2(n.y, n.x))) * signNotZero(e);
+    }
+    return e * 0.5f + 0.5f;
+}
+
+glm::vec3 decodeOctahedral(const glm::vec2& encoded)
+{
+    glm::vec2 e = encoded * 2.f - 1.f;
+    glm::vec3 n(e.x, e.y, 1.f - std::abs(e.x) - std::abs(e.y));
+    if (n.z < 0.f)
+    {
+        glm::vec2 folded = (glm::vec2(1.f) - glm::abs(glm::vec2(n.y, n.x))) * signNotZero(e);
+        n.x = folded.x;
+        n.y = folded.y;
+    }
+    return glm::normalize(n);
+}
+
+glm::vec2 packNormalSpecular(const glm::vec3& normal, float specular)
+{
+    glm::vec2 e = encodeOctahedral(normal);
+    unsigned int s = quantize(specular, 255);
+    unsigned int x = (quantize(e.x, 4095) << 4) | (s >> 4);
+    unsigned int y = (quantize(e.y, 4095) << 4) | (s & 15);
+    return glm::vec2(x, y) / 65535.f;
+}
+
+void unpackNormalSpecular(const glm::vec2& packed, glm::vec3& normal, float& specular)
+{
+    unsigned int x = quantize(packed.x, 65535);
+    unsigned int y = quantize(packed.y, 65535);
+    normal = decodeOctahedral(glm::vec2(x >> 4, y >> 4) / 4095.f);
+    specular = (((x & 15) << 4) | (y & 15)) / 255.f;
+}
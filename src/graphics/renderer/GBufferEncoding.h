@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/**
+* \brief Maps unit vector to octahedral coordinates in [0-1].
+* The upper hemisphere is projected onto the inner diamond, the lower one folded over its
+* diagonals. Reference for gbuffer_encoding.glsl.
+*/
+glm::vec2 encodeOctahedral(const glm::vec3& normal);
+
+/**
+* \brief Maps octahedral coordinates in [0-1] to unit vector.
+*/
+glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+
+/**
+* \brief Packs normal and specular value into two 16 bit unsigned normalized channels.
+* Each channel stores 12 bit of the octahedral normal and 4 bit of the 8 bit specular value.
+* Returns the normalized channel values, e.g. for clearing the compact g-buffer.
+*/
+glm::vec2 packNormalSpecular(const glm::vec3& normal, float specular);
+
+/**
+* \brief Unpacks normalized channel values written by packNormalSpecular.
+*/
+void unpackNormalSpecular(const glm::vec2& packed, glm::vec3& normal, float& specular);
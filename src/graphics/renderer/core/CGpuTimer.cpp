@@ -0,0 +1,69 @@
+#include "CGpuTimer.h"
+
+CGpuTimer::CGpuTimer()
+{
+    for (unsigned int i = 0; i < s_queryCount; ++i)
+    {
+        m_queries[i] = 0;
+        m_pending[i] = false;
+    }
+}
+
+CGpuTimer::~CGpuTimer()
+{
+    if (m_initialized)
+    {
+        glDeleteQueries(s_queryCount, m_queries);
+    }
+}
+
+void CGpuTimer::begin()
+{
+    // Queries are created on first use, when a context is current
+    if (!m_initialized)
+    {
+        glGenQueries(s_queryCount, m_queries);
+        m_initialized = true;
+    }
+    // Skip measurement until the oldest result has been read
+    if (m_running || m_pending[m_next])
+    {
+        return;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+    m_running = true;
+}
+
+void CGpuTimer::end()
+{
+    if (!m_running)
+    {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    m_pending[m_next] = true;
+    m_next = (m_next + 1) % s_queryCount;
+    m_running = false;
+}
+
+bool CGpuTimer::getResult(float& milliseconds)
+{
+    bool result = false;
+    // Results are available in order, read all finished queries
+    while (m_pending[m_oldest])
+    {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(m_queries[m_oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE)
+        {
+            break;
+        }
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(m_queries[m_oldest], GL_QUERY_RESULT, &nanoseconds);
+        milliseconds = nanoseconds / 1000000.f;
+        m_pending[m_oldest] = false;
+        m_oldest = (m_oldest + 1) % s_queryCount;
+        result = true;
+    }
+    return result;
+}
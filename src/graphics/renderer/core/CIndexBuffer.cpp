@@ -1,11 +1,14 @@
 #include "CIndexBuffer.h"
 
 #include <cassert>
+#include <memory>
 
+#include "graphics/renderer/core/CUploadQueue.h"
 #include "graphics/renderer/debug/RendererDebug.h"
 #include "debug/Log.h"
 
-CIndexBuffer::CIndexBuffer(const std::vector<unsigned int>& indices, GLenum usage)
+CIndexBuffer::CIndexBuffer(const std::vector<unsigned int>& indices, GLenum usage,
+                           CUploadQueue* uploadQueue)
     : m_bufferId(0), m_size(0), m_valid(false)
 {
     if (indices.empty())
@@ -16,9 +19,27 @@ CIndexBuffer::CIndexBuffer(const std::vector<unsigned int>& indices, GLenum usag
     glGenBuffers(1, &m_bufferId);
     // Unchecked bind
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_bufferId);
-    // Set data
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(),
-                 usage);
+    if (uploadQueue == nullptr)
+    {
+        // Set data
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
+                     indices.data(), usage);
+    }
+    else
+    {
+        // Allocate storage, the data follows from the upload queue
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), nullptr,
+                     usage);
+        std::shared_ptr<std::vector<unsigned int>> copy =
+            std::make_shared<std::vector<unsigned int>>(indices);
+        uploadQueue->addBufferUpload(m_bufferId, copy, copy->data(),
+                                     copy->size() * sizeof(unsigned int), [this]()
+                                     {
+                                         m_uploadPending = false;
+                                     });
+        m_uploadQueue = uploadQueue;
+        m_uploadPending = true;
+    }
     m_size = (unsigned int)indices.size();
     // TODO Check error
     // Unbind
@@ -34,7 +55,14 @@ CIndexBuffer::CIndexBuffer(const std::vector<unsigned int>& indices, GLenum usag
     m_valid = true;
 }
 
-CIndexBuffer::~CIndexBuffer() { glDeleteBuffers(1, &m_bufferId); }
+CIndexBuffer::~CIndexBuffer()
+{
+    if (m_uploadPending)
+    {
+        m_uploadQueue->cancelBuffer(m_bufferId);
+    }
+    glDeleteBuffers(1, &m_bufferId);
+}
 
 void CIndexBuffer::setActive() const
 {
@@ -48,4 +76,6 @@ bool CIndexBuffer::isValid() const { return m_valid; }
 
 GLuint CIndexBuffer::getId() const { return m_bufferId; }
 
-unsigned int CIndexBuffer::getSize() const { return m_size; }
\ No newline at end of file
+unsigned int CIndexBuffer::getSize() const { return m_size; }
+
+bool CIndexBuffer::isUploadPending() const { return m_uploadPending; }
\ No newline at end of file
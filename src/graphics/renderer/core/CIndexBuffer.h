@@ -4,13 +4,19 @@
 
 #include "RendererCoreConfig.h"
 
+class CUploadQueue;
+
 /**
 * \brief Represents an index buffer.
 */
 class CIndexBuffer
 {
    public:
-    CIndexBuffer(const std::vector<unsigned int>& indices, GLenum usage = GL_STATIC_DRAW);
+    /**
+    * \brief Creates index buffer, optionally uploaded asynchronously by the upload queue.
+    */
+    CIndexBuffer(const std::vector<unsigned int>& indices, GLenum usage = GL_STATIC_DRAW,
+                 CUploadQueue* uploadQueue = nullptr);
 
     CIndexBuffer(const CIndexBuffer& rhs) = delete;
 
@@ -38,8 +44,15 @@ class CIndexBuffer
 
     unsigned int getSize() const;
 
+    /**
+    * \brief Returns whether the data has not been uploaded yet.
+    */
+    bool isUploadPending() const;
+
    private:
     GLuint m_bufferId;
     unsigned int m_size;
     bool m_valid;
+    CUploadQueue* m_uploadQueue = nullptr; /**< Queue of the pending upload. */
+    bool m_uploadPending = false;          /**< Data is waiting in the upload queue. */
 };
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "COcclusionQueries.h"
+
+COcclusionQueries::COcclusionQueries() {}
+
+COcclusionQueries::~COcclusionQueries()
+{
+    for (const auto& entry : m_states)
+    {
+        if (entry.second.m_query != 0)
+        {
+            glDeleteQueries(1, &entry.second.m_query);
+        }
+    }
+}
+
+void COcclusionQueries::beginFrame()
+{
+    // Extensions are checked on first use, when a context is current
+    // Conservative queries are core since 4.3
+    if (m_frame == 0 && FLEXT_ARB_ES3_compatibility)
+    {
+        m_target = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+    }
+    ++m_frame;
+    m_queriedCount = 0;
+    m_culledCount = 0;
+    m_revisibleCount = 0;
+
+    for (auto iter = m_states.begin(); iter != m_states.end();)
+    {
+        SState& state = iter->second;
+        if (state.m_pending)
+        {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(state.m_query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available != GL_FALSE)
+            {
+                GLuint result = GL_FALSE;
+                glGetQueryObjectuiv(state.m_query, GL_QUERY_RESULT, &result);
+                state.m_pending = false;
+                if (result != GL_FALSE && !state.m_visible)
+                {
+                    ++m_revisibleCount;
+                }
+                state.m_visible = result != GL_FALSE;
+            }
+        }
+
+        // Objects removed from the scene are never in view again
+        if (m_frame - state.m_lastFrame > s_maxUnusedFrames)
+        {
+            if (state.m_query != 0)
+            {
+                glDeleteQueries(1, &state.m_query);
+            }
+            iter = m_states.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+bool COcclusionQueries::isVisible(SceneObjectId id)
+{
+    auto iter = m_states.find(id);
+    if (iter == m_states.end())
+    {
+        iter = m_states.insert(std::make_pair(id, SState())).first;
+    }
+    SState& state = iter->second;
+
+    // Visibility is only coherent for objects, which stay in view
+    if (state.m_lastFrame + 1 < m_frame)
+    {
+        state.m_visible = true;
+    }
+    state.m_lastFrame = m_frame;
+
+    if (!state.m_visible)
+    {
+        ++m_culledCount;
+    }
+    return state.m_visible;
+}
+
+bool COcclusionQueries::needsQuery(SceneObjectId id) const
+{
+    auto iter = m_states.find(id);
+    if (iter == m_states.end() || iter->second.m_pending)
+    {
+        return false;
+    }
+    // Visible objects are spread over the interval
+    return !iter->second.m_visible || (m_frame + id) % s_visibleQueryInterval == 0;
+}
+
+void COcclusionQueries::begin(SceneObjectId id)
+{
+    auto iter = m_states.find(id);
+    if (iter == m_states.end() || iter->second.m_pending || m_activeQuery != 0)
+    {
+        return;
+    }
+    SState& state = iter->second;
+
+    // Queries are created on first use
+    if (state.m_query == 0)
+    {
+        glGenQueries(1, &state.m_query);
+    }
+    glBeginQuery(m_target, state.m_query);
+    state.m_pending = true;
+    m_activeQuery = state.m_query;
+    ++m_queriedCount;
+}
+
+void COcclusionQueries::end()
+{
+    if (m_activeQuery == 0)
+    {
+        return;
+    }
+    glEndQuery(m_target);
+    m_activeQuery = 0;
+}
+
+GLuint COcclusionQueries::getQuery(SceneObjectId id) const
+{
+    auto iter = m_states.find(id);
+    return iter == m_states.end() ? 0 : iter->second.m_query;
+}
+
+unsigned int COcclusionQueries::getQueriedCount() const { return m_queriedCount; }
+
+unsigned int COcclusionQueries::getCulledCount() const { return m_culledCount; }
+
+unsigned int COcclusionQueries::getRevisibleCount() const { return m_revisibleCount; }
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "RendererCoreConfig.h"
+
+#include "graphics/SceneConfig.h"
+
+/**
+* \brief Per object occlusion queries with temporal coherence.
+* Objects keep the visibility of their latest finished query. Results are read at the start of a
+* frame if they are available, so the CPU never waits for the GPU. Objects occluded in the
+* previous frame are queried every frame, visible objects only at an interval, as they usually
+* stay visible. Objects, which were not in view in the previous frame, are assumed visible.
+* Conservative queries are used if supported, they only report false positives.
+*/
+class COcclusionQueries
+{
+   public:
+    COcclusionQueries();
+    COcclusionQueries(const COcclusionQueries& rhs) = delete;
+
+    /**
+    * \brief Frees all GPU resources.
+    */
+    ~COcclusionQueries();
+
+    COcclusionQueries& operator=(const COcclusionQueries& rhs) = delete;
+
+    /**
+    * \brief Starts a frame, reads finished results and resets the frame counters.
+    * Queries of objects, which were not in view for a long time, are released.
+    */
+    void beginFrame();
+
+    /**
+    * \brief Marks object as in view for this frame and returns whether it is assumed visible.
+    * Counts the object as culled if it is not visible.
+    */
+    bool isVisible(SceneObjectId id);
+
+    /**
+    * \brief Returns whether a query should be issued for the object in this frame.
+    * Objects with a pending query are not queried again.
+    */
+    bool needsQuery(SceneObjectId id) const;
+
+    /**
+    * \brief Starts query of the object, the following commands should draw its bounds.
+    */
+    void begin(SceneObjectId id);
+
+    /**
+    * \brief Ends query started by begin.
+    */
+    void end();
+
+    /**
+    * \brief Returns latest query of the object for conditional rendering, 0 if there is none.
+    */
+    GLuint getQuery(SceneObjectId id) const;
+
+    /**
+    * \brief Returns number of queries issued in the current frame.
+    */
+    unsigned int getQueriedCount() const;
+
+    /**
+    * \brief Returns number of objects in view, which were not assumed visible in this frame.
+    */
+    unsigned int getCulledCount() const;
+
+    /**
+    * \brief Returns number of objects, which became visible again with results of this frame.
+    */
+    unsigned int getRevisibleCount() const;
+
+   private:
+    /**
+    * \brief Query state of an object.
+    */
+    struct SState
+    {
+        GLuint m_query = 0;          /**< Query object, created on first query. */
+        bool m_visible = true;       /**< Result of the latest finished query. */
+        bool m_pending = false;      /**< Query has been issued, result not read yet. */
+        unsigned int m_lastFrame = 0; /**< Frame the object was last in view. */
+    };
+
+    static const unsigned int s_visibleQueryInterval = 8; /**< Frames between visible queries. */
+    static const unsigned int s_maxUnusedFrames =
+        600; /**< Frames out of view until the query is released. */
+
+    std::unordered_map<SceneObjectId, SState> m_states; /**< States by object. */
+    GLenum m_target = GL_ANY_SAMPLES_PASSED;           /**< Query target. */
+    unsigned int m_frame = 0;                           /**< Current frame. */
+    GLuint m_activeQuery = 0;                           /**< Query started by begin. */
+    unsigned int m_queriedCount = 0;                    /**< Queries issued this frame. */
+    unsigned int m_culledCount = 0;                     /**< Objects culled this frame. */
+    unsigned int m_revisibleCount = 0;                  /**< Objects visible again this frame. */
+};
@@ -0,0 +1,67 @@
+#include "CSampleCounter.h"
+
+CSampleCounter::CSampleCounter()
+{
+    for (unsigned int i = 0; i < s_queryCount; ++i)
+    {
+        m_queries[i] = 0;
+        m_pending[i] = false;
+    }
+}
+
+CSampleCounter::~CSampleCounter()
+{
+    if (m_initialized)
+    {
+        glDeleteQueries(s_queryCount, m_queries);
+    }
+}
+
+void CSampleCounter::begin()
+{
+    // Queries are created on first use, when a context is current
+    if (!m_initialized)
+    {
+        glGenQueries(s_queryCount, m_queries);
+        m_initialized = true;
+    }
+    // Skip measurement until the oldest result has been read
+    if (m_running || m_pending[m_next])
+    {
+        return;
+    }
+    glBeginQuery(GL_SAMPLES_PASSED, m_queries[m_next]);
+    m_running = true;
+}
+
+void CSampleCounter::end()
+{
+    if (!m_running)
+    {
+        return;
+    }
+    glEndQuery(GL_SAMPLES_PASSED);
+    m_pending[m_next] = true;
+    m_next = (m_next + 1) % s_queryCount;
+    m_running = false;
+}
+
+bool CSampleCounter::getResult(GLuint64& samples)
+{
+    bool result = false;
+    // Results are available in order, read all finished queries
+    while (m_pending[m_oldest])
+    {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(m_queries[m_oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE)
+        {
+            break;
+        }
+        glGetQueryObjectui64v(m_queries[m_oldest], GL_QUERY_RESULT, &samples);
+        m_pending[m_oldest] = false;
+        m_oldest = (m_oldest + 1) % s_queryCount;
+        result = true;
+    }
+    return result;
+}
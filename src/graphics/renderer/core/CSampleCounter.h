@@ -0,0 +1,48 @@
+#pragma once
+
+#include "RendererCoreConfig.h"
+
+/**
+* \brief Counts samples passing the depth test for a command sequence with occlusion queries.
+* Queries are kept in a ring and their results are read frames later, when they are available, so
+* the CPU never waits for the GPU. Measurements are skipped while all queries are pending.
+*/
+class CSampleCounter
+{
+   public:
+    CSampleCounter();
+    CSampleCounter(const CSampleCounter& rhs) = delete;
+
+    /**
+    * \brief Frees all GPU resources.
+    */
+    ~CSampleCounter();
+
+    CSampleCounter& operator=(const CSampleCounter& rhs) = delete;
+
+    /**
+    * \brief Starts counting samples of the following commands.
+    */
+    void begin();
+
+    /**
+    * \brief Ends counting started by begin.
+    */
+    void end();
+
+    /**
+    * \brief Returns the most recent finished sample count.
+    * Returns false if no measurement finished since the last call.
+    */
+    bool getResult(GLuint64& samples);
+
+   private:
+    static const unsigned int s_queryCount = 4; /**< Measurements in flight. */
+
+    GLuint m_queries[s_queryCount]; /**< Occlusion query objects. */
+    bool m_pending[s_queryCount];   /**< Query has been ended, result not read yet. */
+    unsigned int m_next = 0;        /**< Query used by the next measurement. */
+    unsigned int m_oldest = 0;      /**< Oldest pending query. */
+    bool m_running = false;         /**< Measurement has been started. */
+    bool m_initialized = false;     /**< Query objects have been created. */
+};
@@ -0,0 +1,384 @@
+#include "CUploadQueue.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "graphics/renderer/debug/RendererDebug.h"
+#include "debug/Log.h"
+
+CUploadQueue::CUploadQueue(size_t stagingSize, size_t frameLimit)
+    : m_stagingSize(stagingSize), m_frameLimit(frameLimit), m_workers(1)
+{
+    glGenBuffers(1, &m_stagingBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+    if (FLEXT_ARB_buffer_storage)
+    {
+        // Coherent mapping, writes of the worker are visible to copies issued afterwards
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_stagingSize, nullptr, flags);
+        m_mapping =
+            static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_stagingSize,
+                                                         flags));
+        if (m_mapping == nullptr)
+        {
+            // Storage is immutable, start over with a mutable buffer
+            LOG_WARNING("Failed to map staging buffer persistently.");
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glDeleteBuffers(1, &m_stagingBuffer);
+            glGenBuffers(1, &m_stagingBuffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+        }
+    }
+    if (m_mapping == nullptr)
+    {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, m_stagingSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    std::string error;
+    if (hasGLError(error))
+    {
+        LOG_ERROR("GL Error: %s", error.c_str());
+    }
+    LOG_INFO("Upload queue with %.1f MB %s staging buffer.", m_stagingSize / (1024.0 * 1024.0),
+             m_mapping != nullptr ? "persistently mapped" : "unsynchronized mapped");
+}
+
+CUploadQueue::~CUploadQueue()
+{
+    // Workers write into the mapping
+    m_workers.wait();
+    if (m_mapping != nullptr)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    for (const SFence& fence : m_fences)
+    {
+        glDeleteSync(fence.m_sync);
+    }
+    glDeleteBuffers(1, &m_stagingBuffer);
+}
+
+void CUploadQueue::addTextureUpload(GLuint texture, GLint level, GLsizei width, GLsizei height,
+                                    GLenum internalFormat, GLenum externalFormat,
+                                    bool compressed, std::shared_ptr<const void> owner,
+                                    const void* data, size_t size,
+                                    std::function<void()> onUpload)
+{
+    std::unique_ptr<SUpload> upload(new SUpload);
+    upload->m_texture = true;
+    upload->m_target = texture;
+    upload->m_level = level;
+    upload->m_width = width;
+    upload->m_height = height;
+    upload->m_internalFormat = internalFormat;
+    upload->m_externalFormat = externalFormat;
+    upload->m_compressed = compressed;
+    upload->m_owner = std::move(owner);
+    upload->m_data = data;
+    upload->m_size = size;
+    upload->m_onUpload = std::move(onUpload);
+    upload->m_allocated = false;
+    upload->m_direct = false;
+    upload->m_stagingOffset = 0;
+    upload->m_stagingBytes = 0;
+    upload->m_staged = false;
+    upload->m_cancelled = false;
+    m_pendingBytes += size;
+    m_uploads.push_back(std::move(upload));
+}
+
+void CUploadQueue::addBufferUpload(GLuint buffer, std::shared_ptr<const void> owner,
+                                   const void* data, size_t size, std::function<void()> onUpload)
+{
+    std::unique_ptr<SUpload> upload(new SUpload);
+    upload->m_texture = false;
+    upload->m_target = buffer;
+    upload->m_level = 0;
+    upload->m_width = 0;
+    upload->m_height = 0;
+    upload->m_internalFormat = 0;
+    upload->m_externalFormat = 0;
+    upload->m_compressed = false;
+    upload->m_owner = std::move(owner);
+    upload->m_data = data;
+    upload->m_size = size;
+    upload->m_onUpload = std::move(onUpload);
+    upload->m_allocated = false;
+    upload->m_direct = false;
+    upload->m_stagingOffset = 0;
+    upload->m_stagingBytes = 0;
+    upload->m_staged = false;
+    upload->m_cancelled = false;
+    m_pendingBytes += size;
+    m_uploads.push_back(std::move(upload));
+}
+
+void CUploadQueue::cancelTexture(GLuint texture)
+{
+    for (const auto& upload : m_uploads)
+    {
+        if (upload->m_texture && upload->m_target == texture)
+        {
+            upload->m_cancelled = true;
+        }
+    }
+}
+
+void CUploadQueue::cancelBuffer(GLuint buffer)
+{
+    for (const auto& upload : m_uploads)
+    {
+        if (!upload->m_texture && upload->m_target == buffer)
+        {
+            upload->m_cancelled = true;
+        }
+    }
+}
+
+void CUploadQueue::update()
+{
+    retireFences();
+    stageUploads();
+    issueUploads(m_frameLimit);
+}
+
+void CUploadQueue::flush()
+{
+    while (!m_uploads.empty())
+    {
+        retireFences();
+        stageUploads();
+        m_workers.wait();
+        size_t pendingUploads = m_uploads.size();
+        issueUploads(0);
+
+        // Staging buffer is full, wait for the GPU to consume the oldest copies
+        if (m_uploads.size() == pendingUploads && !m_fences.empty())
+        {
+            glClientWaitSync(m_fences.front().m_sync, GL_SYNC_FLUSH_COMMANDS_BIT,
+                             GL_TIMEOUT_IGNORED);
+        }
+    }
+}
+
+size_t CUploadQueue::getPendingBytes() const { return m_pendingBytes; }
+
+bool CUploadQueue::isPersistent() const { return m_mapping != nullptr; }
+
+bool CUploadQueue::allocate(size_t size, size_t& offset, size_t& bytes)
+{
+    // Keep ranges aligned for fast copies
+    size = (size + 15) & ~static_cast<size_t>(15);
+    if (m_stagingUsed == 0)
+    {
+        m_stagingHead = 0;
+    }
+
+    // Ranges are released in allocation order, the free range starts at the head
+    size_t tail = (m_stagingHead + m_stagingSize - m_stagingUsed) % m_stagingSize;
+    if (m_stagingUsed < m_stagingSize && m_stagingHead >= tail)
+    {
+        // Free space at the end and at the start of the buffer
+        if (m_stagingSize - m_stagingHead >= size)
+        {
+            offset = m_stagingHead;
+            bytes = size;
+        }
+        else if (tail >= size)
+        {
+            // Skip the end of the buffer
+            offset = 0;
+            bytes = m_stagingSize - m_stagingHead + size;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else if (tail - m_stagingHead >= size)
+    {
+        offset = m_stagingHead;
+        bytes = size;
+    }
+    else
+    {
+        return false;
+    }
+    m_stagingHead = (offset + size) % m_stagingSize;
+    m_stagingUsed += bytes;
+    return true;
+}
+
+void CUploadQueue::retireFences()
+{
+    while (!m_fences.empty())
+    {
+        GLenum status = glClientWaitSync(m_fences.front().m_sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        glDeleteSync(m_fences.front().m_sync);
+        m_stagingUsed -= m_fences.front().m_bytes;
+        m_fences.pop_front();
+    }
+}
+
+void CUploadQueue::stageUploads()
+{
+    for (const auto& entry : m_uploads)
+    {
+        SUpload& upload = *entry;
+        if (upload.m_allocated || upload.m_direct || upload.m_cancelled)
+        {
+            continue;
+        }
+
+        // Uploads larger than the staging buffer are copied from client memory
+        if (upload.m_size > m_stagingSize)
+        {
+            upload.m_direct = true;
+            upload.m_staged = true;
+            continue;
+        }
+        if (!allocate(upload.m_size, upload.m_stagingOffset, upload.m_stagingBytes))
+        {
+            // Uploads are issued in order, later ones would have to wait anyway
+            return;
+        }
+        upload.m_allocated = true;
+
+        if (m_mapping != nullptr)
+        {
+            SUpload* stagedUpload = &upload;
+            unsigned char* target = m_mapping + upload.m_stagingOffset;
+            m_workers.addTask([stagedUpload, target]()
+                              {
+                                  std::memcpy(target, stagedUpload->m_data, stagedUpload->m_size);
+                                  stagedUpload->m_staged = true;
+                              });
+            continue;
+        }
+
+        // Without persistent mapping the range is filled on this thread, the fence guarantees
+        // that the GPU no longer reads it
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+        void* target = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, upload.m_stagingOffset,
+                                        upload.m_size, GL_MAP_WRITE_BIT |
+                                                           GL_MAP_INVALIDATE_RANGE_BIT |
+                                                           GL_MAP_UNSYNCHRONIZED_BIT);
+        if (target != nullptr)
+        {
+            std::memcpy(target, upload.m_data, upload.m_size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        else
+        {
+            LOG_WARNING("Failed to map staging buffer range, uploading from client memory.");
+            upload.m_direct = true;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload.m_staged = true;
+    }
+}
+
+void CUploadQueue::issueUploads(size_t limit)
+{
+    size_t issued = 0;
+    size_t stagingBytes = 0;
+    while (!m_uploads.empty())
+    {
+        SUpload& upload = *m_uploads.front();
+
+        // Wait for the worker before the staging range is given back
+        if (upload.m_allocated && !upload.m_staged)
+        {
+            break;
+        }
+        if (!upload.m_cancelled)
+        {
+            if (!upload.m_staged)
+            {
+                break;
+            }
+            if (limit != 0 && issued != 0 && issued + upload.m_size > limit)
+            {
+                break;
+            }
+            issue(upload);
+            issued += upload.m_size;
+        }
+
+        std::unique_ptr<SUpload> finished = std::move(m_uploads.front());
+        m_uploads.pop_front();
+        m_pendingBytes -= finished->m_size;
+        stagingBytes += finished->m_stagingBytes;
+        if (!finished->m_cancelled && finished->m_onUpload)
+        {
+            finished->m_onUpload();
+        }
+    }
+
+    if (stagingBytes != 0)
+    {
+        SFence fence = {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), stagingBytes};
+        m_fences.push_back(fence);
+    }
+}
+
+void CUploadQueue::issue(SUpload& upload)
+{
+    // Offsets into the bound unpack or read buffer are passed as pointers
+    bool staged = upload.m_allocated && !upload.m_direct;
+    const void* source =
+        staged ? reinterpret_cast<const void*>(static_cast<uintptr_t>(upload.m_stagingOffset))
+               : upload.m_data;
+
+    if (upload.m_texture)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staged ? m_stagingBuffer : 0);
+        glBindTexture(GL_TEXTURE_2D, upload.m_target);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (upload.m_compressed)
+        {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, upload.m_level, 0, 0, upload.m_width,
+                                      upload.m_height, upload.m_internalFormat,
+                                      (GLsizei)upload.m_size, source);
+        }
+        else
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, upload.m_level, 0, 0, upload.m_width, upload.m_height,
+                            upload.m_externalFormat, GL_UNSIGNED_BYTE, source);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else if (staged)
+    {
+        // Copy buffer targets do not change vertex array state
+        glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, upload.m_target);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, upload.m_stagingOffset, 0,
+                            upload.m_size);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    else
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, upload.m_target);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, upload.m_size, source);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    std::string error;
+    if (hasGLError(error))
+    {
+        LOG_ERROR("GL Error: %s", error.c_str());
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "RendererCoreConfig.h"
+#include "util/CThreadPool.h"
+
+/**
+* \brief Asynchronous upload of texture and buffer data through a staging buffer.
+* Upload data is copied into a ring shaped pixel unpack buffer and transferred to the target
+* objects with buffer to texture or buffer to buffer copies, which do not block on client memory.
+* With ARB_buffer_storage the staging buffer is mapped persistently and filled by a worker
+* thread, otherwise the ranges are mapped unsynchronized and filled on the render thread.
+* Copies are issued in submission order and limited to a number of bytes per frame. Fences
+* release staging memory once the GPU has consumed the copies.
+* All functions must be called on the thread owning the GL context.
+*/
+class CUploadQueue
+{
+   public:
+    /**
+    * \brief Creates staging buffer.
+    * \param stagingSize Size of the staging buffer in bytes.
+    * \param frameLimit Bytes copied per frame, 0 for unlimited. At least one upload is issued
+    *                   per frame.
+    */
+    CUploadQueue(size_t stagingSize, size_t frameLimit);
+
+    /**
+    * \brief Finishes staging and deletes staging buffer and fences.
+    */
+    ~CUploadQueue();
+
+    CUploadQueue(const CUploadQueue&) = delete;
+    CUploadQueue& operator=(const CUploadQueue&) = delete;
+
+    /**
+    * \brief Queues upload of a 2D texture level.
+    * The level storage must be defined already. The owner keeps the data alive until the upload
+    * has been staged. The callback is invoked on the render thread after the copy has been
+    * issued, the level may be used by following GL commands from then on.
+    */
+    void addTextureUpload(GLuint texture, GLint level, GLsizei width, GLsizei height,
+                          GLenum internalFormat, GLenum externalFormat, bool compressed,
+                          std::shared_ptr<const void> owner, const void* data, size_t size,
+                          std::function<void()> onUpload);
+
+    /**
+    * \brief Queues upload to the start of a buffer object.
+    * The buffer storage must be defined already, see addTextureUpload for the callback.
+    */
+    void addBufferUpload(GLuint buffer, std::shared_ptr<const void> owner, const void* data,
+                         size_t size, std::function<void()> onUpload);
+
+    /**
+    * \brief Drops pending uploads to the texture or buffer without invoking callbacks.
+    * Must be called before a target with pending uploads is deleted.
+    */
+    void cancelTexture(GLuint texture);
+    void cancelBuffer(GLuint buffer);
+
+    /**
+    * \brief Stages queued data, issues copies within the frame limit and releases staging
+    * memory of finished copies. Called once per frame.
+    */
+    void update();
+
+    /**
+    * \brief Issues all queued uploads regardless of the frame limit.
+    */
+    void flush();
+
+    /**
+    * \brief Returns number of bytes waiting to be issued.
+    */
+    size_t getPendingBytes() const;
+
+    /**
+    * \brief Returns whether the staging buffer is mapped persistently.
+    */
+    bool isPersistent() const;
+
+   private:
+    /**
+    * \brief Queued upload.
+    */
+    struct SUpload
+    {
+        bool m_texture;                      /**< Target is a texture, a buffer otherwise. */
+        GLuint m_target;                     /**< Target object. */
+        GLint m_level;                       /**< Texture level. */
+        GLsizei m_width;                     /**< Texture level width. */
+        GLsizei m_height;                    /**< Texture level height. */
+        GLenum m_internalFormat;             /**< Texture internal format. */
+        GLenum m_externalFormat;             /**< Texture pixel format if uncompressed. */
+        bool m_compressed;                   /**< Texture data is block compressed. */
+        std::shared_ptr<const void> m_owner; /**< Keeps the data alive. */
+        const void* m_data;                  /**< Upload data. */
+        size_t m_size;                       /**< Size of the upload data in bytes. */
+        std::function<void()> m_onUpload;    /**< Invoked after the copy has been issued. */
+        bool m_allocated;                    /**< Staging range has been allocated. */
+        bool m_direct;                       /**< Data is copied from client memory. */
+        size_t m_stagingOffset;              /**< Offset of the data in the staging buffer. */
+        size_t m_stagingBytes;               /**< Allocated bytes including wrap padding. */
+        std::atomic<bool> m_staged;          /**< Data has been copied to the staging buffer. */
+        bool m_cancelled;                    /**< Target has been deleted. */
+    };
+
+    /**
+    * \brief Staging memory in use by issued copies.
+    */
+    struct SFence
+    {
+        GLsync m_sync;  /**< Signaled once the copies have been executed. */
+        size_t m_bytes; /**< Staging bytes released on signal. */
+    };
+
+    /**
+    * \brief Allocates staging range, returns false if the staging buffer is full.
+    */
+    bool allocate(size_t size, size_t& offset, size_t& bytes);
+
+    /**
+    * \brief Releases staging memory of finished copies.
+    */
+    void retireFences();
+
+    /**
+    * \brief Allocates staging ranges for queued uploads and starts copying the data.
+    */
+    void stageUploads();
+
+    /**
+    * \brief Issues staged uploads in submission order until the byte limit is reached.
+    */
+    void issueUploads(size_t limit);
+
+    /**
+    * \brief Issues copy of a single upload from the staging buffer or client memory.
+    */
+    void issue(SUpload& upload);
+
+    GLuint m_stagingBuffer = 0;          /**< Staging buffer object. */
+    unsigned char* m_mapping = nullptr;  /**< Persistent mapping, null without buffer storage. */
+    size_t m_stagingSize;                /**< Size of the staging buffer. */
+    size_t m_stagingHead = 0;            /**< Offset of the next allocation. */
+    size_t m_stagingUsed = 0;            /**< Allocated bytes, including wrap padding. */
+    size_t m_frameLimit;                 /**< Bytes issued per frame, 0 for unlimited. */
+    size_t m_pendingBytes = 0;           /**< Bytes of queued uploads. */
+    std::deque<std::unique_ptr<SUpload>> m_uploads; /**< Queued uploads in submission order. */
+    std::deque<SFence> m_fences;                    /**< Fences in submission order. */
+    CThreadPool m_workers; /**< Copies data into the persistently mapped staging buffer. */
+};
@@ -1,11 +1,14 @@
 #include "CVertexBuffer.h"
 
 #include <cassert>
+#include <memory>
 
+#include "graphics/renderer/core/CUploadQueue.h"
 #include "graphics/renderer/debug/RendererDebug.h"
 #include "debug/Log.h"
 
-CVertexBuffer::CVertexBuffer(const std::vector<float>& data, GLenum usage)
+CVertexBuffer::CVertexBuffer(const std::vector<float>& data, GLenum usage,
+                             CUploadQueue* uploadQueue)
     : m_bufferId(0), m_valid(false), m_size((unsigned int)data.size()), m_usage(usage)
 {
     if (data.empty())
@@ -17,8 +20,24 @@ CVertexBuffer::CVertexBuffer(const std::vector<float>& data, GLenum usage)
     glGenBuffers(1, &m_bufferId);
     // Unchecked bind
     glBindBuffer(GL_ARRAY_BUFFER, m_bufferId);
-    // Set data
-    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), usage);
+    if (uploadQueue == nullptr)
+    {
+        // Set data
+        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), usage);
+    }
+    else
+    {
+        // Allocate storage, the data follows from the upload queue
+        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), nullptr, usage);
+        std::shared_ptr<std::vector<float>> copy = std::make_shared<std::vector<float>>(data);
+        uploadQueue->addBufferUpload(m_bufferId, copy, copy->data(), copy->size() * sizeof(float),
+                                     [this]()
+                                     {
+                                         m_uploadPending = false;
+                                     });
+        m_uploadQueue = uploadQueue;
+        m_uploadPending = true;
+    }
     setInactive();
     // TODO Check error
     std::string error;
@@ -30,7 +49,14 @@ CVertexBuffer::CVertexBuffer(const std::vector<float>& data, GLenum usage)
     m_valid = true;
 }
 
-CVertexBuffer::~CVertexBuffer() { glDeleteBuffers(1, &m_bufferId); }
+CVertexBuffer::~CVertexBuffer()
+{
+    if (m_uploadPending)
+    {
+        m_uploadQueue->cancelBuffer(m_bufferId);
+    }
+    glDeleteBuffers(1, &m_bufferId);
+}
 
 void CVertexBuffer::setActive() const
 {
@@ -46,6 +72,8 @@ GLuint CVertexBuffer::getId() const { return m_bufferId; }
 
 unsigned int CVertexBuffer::getSize() const { return m_size; }
 
+bool CVertexBuffer::isUploadPending() const { return m_uploadPending; }
+
 CVertexBuffer::CVertexBuffer(GLenum usage)
     : m_bufferId(0), m_valid(false), m_size(0), m_usage(usage)
 {
@@ -64,6 +92,7 @@ void CVertexBuffer::setData(const std::vector<float>& data)
     glBindBuffer(GL_ARRAY_BUFFER, m_bufferId);
     // Set data
     glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), m_usage);
+    m_size = (unsigned int)data.size();
     setInactive();
     std::string error;
     if (hasGLError(error))
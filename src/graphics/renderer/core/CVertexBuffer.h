@@ -4,6 +4,8 @@
 
 #include "RendererCoreConfig.h"
 
+class CUploadQueue;
+
 /*
 * \brief Manages an OpenGL VBO in VRAM.
 * Stores float triples (x, y, z) and uses static draw modifier.
@@ -15,8 +17,10 @@ class CVertexBuffer
     * \brief Creates buffer object from float data.
     * \param data Float buffer data.
     * \param usage Buffer usage.
+    * \param uploadQueue Optional queue for asynchronous upload of the data.
     */
-    CVertexBuffer(const std::vector<float>& data, GLenum usage = GL_STATIC_DRAW);
+    CVertexBuffer(const std::vector<float>& data, GLenum usage = GL_STATIC_DRAW,
+                  CUploadQueue* uploadQueue = nullptr);
     CVertexBuffer(const CVertexBuffer& rhs) = delete;
 
     /**
@@ -48,6 +52,11 @@ class CVertexBuffer
     * \brief Returns number of elements in the buffer.
     */
     unsigned int getSize() const;
+
+    /**
+    * \brief Returns whether the data has not been uploaded yet.
+    */
+    bool isUploadPending() const;
     
     // TODO we might want to have a CMutableVertexBuffer or something similar
     CVertexBuffer(GLenum usage = GL_STATIC_DRAW);
@@ -59,4 +68,6 @@ class CVertexBuffer
     bool m_valid;
     unsigned int m_size;
     GLenum m_usage;
+    CUploadQueue* m_uploadQueue = nullptr; /**< Queue of the pending upload. */
+    bool m_uploadPending = false;          /**< Data is waiting in the upload queue. */
 };
@@ -40,8 +40,10 @@ const std::string blurFarUniformName = "blur_far";
 // Blur parameters
 const std::string blurStrengthUniformName = "blur_strength";
 
-// Fog parameters
-const std::string fogPassTypeUniformName = "fog_type";
+// Reduced resolution effect parameters
+const std::string downsampleFactorUniformName = "downsample_factor";
+const std::string blurDownsampleUniformName = "blur_downsample";
+const std::string godRayDownsampleUniformName = "godray_downsample";
 
 // View and perspective matrix uniform names
 const std::string viewMatrixUniformName = "view";
@@ -113,6 +115,18 @@ const GLint depthOfFieldPassSceneTextureUnit = 0;
 const GLint depthOfFieldPassBlurTextureUnit = 1;
 const GLint depthOfFieldPassDepthTextureUnit = 2;
 
+// Texture units for merged post processing pass
+const GLint uberPostPassSceneTextureUnit = 0;
+const GLint uberPostPassDepthTextureUnit = 1;
+const GLint uberPostPassBlurTextureUnit = 2;
+const GLint uberPostPassGodRayTextureUnit = 3;
+const GLint uberPostPassBlurDepthTextureUnit = 4;
+const GLint uberPostPassGodRayDepthTextureUnit = 5;
+
+// Texture units for depth aware downsample pass
+const GLint depthDownsamplePassSceneTextureUnit = 0;
+const GLint depthDownsamplePassDepthTextureUnit = 1;
+
 // Texture units for depth texture visualization pass
 const GLint visualizeDepthPassDepthTextureUnit = 0;
 
@@ -131,6 +145,8 @@ const std::string shadowCubeTextureUniformName = "shadow_cube";
 const std::string sceneTextureUniformName = "scene_texture";
 const std::string blurTextureUniformName = "blur_texture";
 const std::string godRayTextureUniformName = "godray_texture";
+const std::string blurDepthTextureUniformName = "blur_depth_texture";
+const std::string godRayDepthTextureUniformName = "godray_depth_texture";
 
 // Generic texture names
 const std::string texture0UniformName = "texture0";
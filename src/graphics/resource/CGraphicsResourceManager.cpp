@@ -1,15 +1,22 @@
 #include "CGraphicsResourceManager.h"
 
 #include <cassert>
+#include <chrono>
 #include <string>
 
 #include "resource/IResourceManager.h"
+#include "graphics/resource/CTextureStreamer.h"
 #include "debug/Log.h"
 
 CGraphicsResourceManager::CGraphicsResourceManager()
 {
 	// Create default textures
 	initDefaultTextures();
+	// Let the driver choose the number of compiler threads for submitted shaders
+	if (FLEXT_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
 	return;
 }
 
@@ -93,13 +100,16 @@ CMesh* CGraphicsResourceManager::getMesh(ResourceId id) const
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_meshes.find(id);
+	// Resolve id
+	auto entry = m_meshes.get(id);
 
-	// Id must exist
+	// Stale ids of unloaded meshes resolve to nullptr
 	// TODO Allow mesh loading if not found?
-	assert(iter != m_meshes.end());
-	return iter->second.get();
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+	return entry->get();
 }
 
 CMaterial* CGraphicsResourceManager::getMaterial(ResourceId id) const
@@ -109,13 +119,16 @@ CMaterial* CGraphicsResourceManager::getMaterial(ResourceId id) const
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_materials.find(id);
+	// Resolve id
+	auto entry = m_materials.get(id);
 
-	// Id must exist
+	// Stale ids of unloaded materials resolve to nullptr
 	// TODO Allow material loading if not found?
-	assert(iter != m_materials.end());
-	return iter->second.get();
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+	return entry->get();
 }
 
 CTexture* CGraphicsResourceManager::getTexture(ResourceId id) const
@@ -125,13 +138,16 @@ CTexture* CGraphicsResourceManager::getTexture(ResourceId id) const
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_textures.find(id);
+	// Resolve id
+	auto entry = m_textures.get(id);
 
-	// Id must exist
+	// Unloaded ids are looked up by the texture streamer
 	// TODO Allow texture loading if not found?
-	assert(iter != m_textures.end());
-	return iter->second.get();
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+	return entry->get();
 }
 
 CShaderProgram* CGraphicsResourceManager::getShaderProgram(ResourceId id) const
@@ -141,17 +157,29 @@ CShaderProgram* CGraphicsResourceManager::getShaderProgram(ResourceId id) const
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_shaderPrograms.find(id);
+	// Resolve id
+	auto entry = m_shaderPrograms.get(id);
 
 	// Id must exist
 	// TODO Allow shader loading if not found?
-	if (iter == m_shaderPrograms.end())
+	if (entry == nullptr)
 	{
-		LOG_ERROR("The requested shader program id %i has not been loaded.", id);
+		LOG_ERROR("The requested shader program id %lli has not been loaded.", (long long)id);
 		return nullptr;
 	}
-	return iter->second.get();
+	// Programs are finished on first use
+	if ((*entry)->isPending())
+	{
+		for (auto pending = m_pendingPrograms.begin(); pending != m_pendingPrograms.end(); ++pending)
+		{
+			if (pending->m_id == id)
+			{
+				finishShaderProgram(pending);
+				break;
+			}
+		}
+	}
+	return entry->get();
 }
 
 
@@ -180,6 +208,92 @@ CTexture* CGraphicsResourceManager::getDefaultAlphaTexture() const
 	return m_defaultAlphaTexture.get();
 }
 
+size_t CGraphicsResourceManager::getMemoryUsage(EResourceType type, ResourceId id) const
+{
+	switch (type)
+	{
+	case EResourceType::Image:
+	{
+		auto entry = m_textures.get(id);
+		return entry == nullptr ? 0 : (*entry)->getMemorySize();
+	}
+	case EResourceType::Mesh:
+	{
+		auto entry = m_meshes.get(id);
+		return entry == nullptr ? 0 : (*entry)->getMemorySize();
+	}
+	default:
+		// Materials, strings and shaders have no significant GPU storage
+		return 0;
+	}
+}
+
+size_t CGraphicsResourceManager::getMemoryUsage(EResourceType type) const
+{
+	size_t bytes = 0;
+	switch (type)
+	{
+	case EResourceType::Image:
+		m_textures.forEach([&bytes](ResourceId id, const std::unique_ptr<CTexture>& texture)
+		{
+			bytes += texture->getMemorySize();
+		});
+		break;
+	case EResourceType::Mesh:
+		m_meshes.forEach([&bytes](ResourceId id, const std::unique_ptr<CMesh>& mesh)
+		{
+			bytes += mesh->getMemorySize();
+		});
+		break;
+	default:
+		break;
+	}
+	return bytes;
+}
+
+void CGraphicsResourceManager::setTextureStreaming(bool enabled)
+{
+	m_textureStreaming = enabled;
+}
+
+void CGraphicsResourceManager::setUploadQueue(std::shared_ptr<CUploadQueue> uploadQueue)
+{
+	m_uploadQueue = uploadQueue;
+}
+
+void CGraphicsResourceManager::setShaderCache(std::shared_ptr<CShaderBinaryCache> shaderCache)
+{
+	m_shaderCache = shaderCache;
+}
+
+bool CGraphicsResourceManager::isShaderCacheAvailable() const
+{
+	return m_shaderCache != nullptr && m_shaderCache->isAvailable();
+}
+
+void CGraphicsResourceManager::finishShaderPrograms(bool wait)
+{
+	auto pending = m_pendingPrograms.begin();
+	while (pending != m_pendingPrograms.end())
+	{
+		const std::unique_ptr<CShaderProgram>* program = m_shaderPrograms.get(pending->m_id);
+		if (wait || program == nullptr || (*program)->isComplete())
+		{
+			pending = finishShaderProgram(pending);
+		}
+		else
+		{
+			++pending;
+		}
+	}
+}
+
+const std::vector<CGraphicsResourceManager::SShaderProgramTiming>&
+CGraphicsResourceManager::getShaderProgramTimings() const
+{
+	return m_shaderTimings;
+}
+
 TShaderObject<GL_VERTEX_SHADER>* CGraphicsResourceManager::getVertexShaderObject(ResourceId id) const
 {
 	// Invalid id
@@ -187,13 +301,13 @@ TShaderObject<GL_VERTEX_SHADER>* CGraphicsResourceManager::getVertexShaderObject
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_vertexShader.find(id);
+	// Resolve id
+	auto entry = m_vertexShader.get(id);
 
 	// Id must exist
 	// TODO Allow shader loading if not found?
-	assert(iter != m_vertexShader.end());
-	return iter->second.get();
+	assert(entry != nullptr);
+	return entry->get();
 }
 
 TShaderObject<GL_TESS_CONTROL_SHADER>* CGraphicsResourceManager::getTessControlShaderObject(ResourceId id) const
@@ -203,13 +317,13 @@ TShaderObject<GL_TESS_CONTROL_SHADER>* CGraphicsResourceManager::getTessControlS
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_tessConstrolShader.find(id);
+	// Resolve id
+	auto entry = m_tessConstrolShader.get(id);
 
 	// Id must exist
 	// TODO Allow shader loading if not found?
-	assert(iter != m_tessConstrolShader.end());
-	return iter->second.get();
+	assert(entry != nullptr);
+	return entry->get();
 }
 
 TShaderObject<GL_TESS_EVALUATION_SHADER>* CGraphicsResourceManager::getTessEvalShaderObject(ResourceId id) const
@@ -219,13 +333,13 @@ TShaderObject<GL_TESS_EVALUATION_SHADER>* CGraphicsResourceManager::getTessEvalS
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_tessEvalShader.find(id);
+	// Resolve id
+	auto entry = m_tessEvalShader.get(id);
 
 	// Id must exist
 	// TODO Allow shader loading if not found?
-	assert(iter != m_tessEvalShader.end());
-	return iter->second.get();
+	assert(entry != nullptr);
+	return entry->get();
 }
 
 TShaderObject<GL_GEOMETRY_SHADER>* CGraphicsResourceManager::getGeometryShaderObject(ResourceId id) const
@@ -235,13 +349,13 @@ TShaderObject<GL_GEOMETRY_SHADER>* CGraphicsResourceManager::getGeometryShaderOb
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_geometryShader.find(id);
+	// Resolve id
+	auto entry = m_geometryShader.get(id);
 
 	// Id must exist
 	// TODO Allow shader loading if not found?
-	assert(iter != m_geometryShader.end());
-	return iter->second.get();
+	assert(entry != nullptr);
+	return entry->get();
 }
 
 TShaderObject<GL_FRAGMENT_SHADER>* CGraphicsResourceManager::getFragmentShaderObject(ResourceId id) const
@@ -251,13 +365,13 @@ TShaderObject<GL_FRAGMENT_SHADER>* CGraphicsResourceManager::getFragmentShaderOb
 	{
 		return nullptr;
 	}
-	// Search for id
-	auto iter = m_fragmentShader.find(id);
+	// Resolve id
+	auto entry = m_fragmentShader.get(id);
 
 	// Id must exist
 	// TODO Allow shader loading if not found?
-	assert(iter != m_fragmentShader.end());
-	return iter->second.get();
+	assert(entry != nullptr);
+	return entry->get();
 }
 
 bool CGraphicsResourceManager::loadVertexShader(ResourceId id, IResourceManager* resourceManager)
@@ -268,7 +382,7 @@ bool CGraphicsResourceManager::loadVertexShader(ResourceId id, IResourceManager*
 		return true;
 	}
 	// Already loaded
-	if (m_vertexShader.count(id) != 0)
+	if (m_vertexShader.contains(id))
 	{
 		return true;
 	}
@@ -279,16 +393,15 @@ bool CGraphicsResourceManager::loadVertexShader(ResourceId id, IResourceManager*
 	{
 		return false;
 	}
-	std::unique_ptr<TShaderObject<GL_VERTEX_SHADER>> shader(
-		new TShaderObject<GL_VERTEX_SHADER>(text));
-	// Check compile error
-	if (!shader->isValid())
+	// Compile status is checked when the programs using the shader are finished
+	std::unique_ptr<TShaderObject<GL_VERTEX_SHADER>> shader(new TShaderObject<GL_VERTEX_SHADER>);
+	if (!shader->submit(text))
 	{
-		LOG_ERROR("%s", shader->getErrorString().c_str());
+		LOG_ERROR("Failed to create shader object for string id %lli.", (long long)id);
 		return false;
 	}
-	// Move to map
-	m_vertexShader[id] = std::move(shader);
+	// Move to storage
+	m_vertexShader.insert(id, std::move(shader));
 	return true;
 }
 
@@ -300,7 +413,7 @@ bool CGraphicsResourceManager::loadTessControlShader(ResourceId id, IResourceMan
 		return true;
 	}
 	// Already loaded
-	if (m_tessConstrolShader.count(id) != 0)
+	if (m_tessConstrolShader.contains(id))
 	{
 		return true;
 	}
@@ -311,16 +424,15 @@ bool CGraphicsResourceManager::loadTessControlShader(ResourceId id, IResourceMan
 	{
 		return false;
 	}
-	std::unique_ptr<TShaderObject<GL_TESS_CONTROL_SHADER>> shader(
-		new TShaderObject<GL_TESS_CONTROL_SHADER>(text));
-	// Check compile error
-	if (!shader->isValid())
+	// Compile status is checked when the programs using the shader are finished
+	std::unique_ptr<TShaderObject<GL_TESS_CONTROL_SHADER>> shader(new TShaderObject<GL_TESS_CONTROL_SHADER>);
+	if (!shader->submit(text))
 	{
-		LOG_ERROR("%s", shader->getErrorString().c_str());
+		LOG_ERROR("Failed to create shader object for string id %lli.", (long long)id);
 		return false;
 	}
-	// Move to map
-	m_tessConstrolShader[id] = std::move(shader);
+	// Move to storage
+	m_tessConstrolShader.insert(id, std::move(shader));
 	return true;
 }
 
@@ -332,7 +444,7 @@ bool CGraphicsResourceManager::loadTessEvalShader(ResourceId id, IResourceManage
 		return true;
 	}
 	// Already loaded
-	if (m_tessEvalShader.count(id) != 0)
+	if (m_tessEvalShader.contains(id))
 	{
 		return true;
 	}
@@ -343,16 +455,15 @@ bool CGraphicsResourceManager::loadTessEvalShader(ResourceId id, IResourceManage
 	{
 		return false;
 	}
-	std::unique_ptr<TShaderObject<GL_TESS_EVALUATION_SHADER>> shader(
-		new TShaderObject<GL_TESS_EVALUATION_SHADER>(text));
-	// Check compile error
-	if (!shader->isValid())
+	// Compile status is checked when the programs using the shader are finished
+	std::unique_ptr<TShaderObject<GL_TESS_EVALUATION_SHADER>> shader(new TShaderObject<GL_TESS_EVALUATION_SHADER>);
+	if (!shader->submit(text))
 	{
-		LOG_ERROR("%s", shader->getErrorString().c_str());
+		LOG_ERROR("Failed to create shader object for string id %lli.", (long long)id);
 		return false;
 	}
-	// Move to map
-	m_tessEvalShader[id] = std::move(shader);
+	// Move to storage
+	m_tessEvalShader.insert(id, std::move(shader));
 	return true;
 }
 
@@ -364,7 +475,7 @@ bool CGraphicsResourceManager::loadGeometryShader(ResourceId id, IResourceManage
 		return true;
 	}
 	// Already loaded
-	if (m_geometryShader.count(id) != 0)
+	if (m_geometryShader.contains(id))
 	{
 		return true;
 	}
@@ -375,16 +486,15 @@ bool CGraphicsResourceManager::loadGeometryShader(ResourceId id, IResourceManage
 	{
 		return false;
 	}
-	std::unique_ptr<TShaderObject<GL_GEOMETRY_SHADER>> shader(
-		new TShaderObject<GL_GEOMETRY_SHADER>(text));
-	// Check compile error
-	if (!shader->isValid())
+	// Compile status is checked when the programs using the shader are finished
+	std::unique_ptr<TShaderObject<GL_GEOMETRY_SHADER>> shader(new TShaderObject<GL_GEOMETRY_SHADER>);
+	if (!shader->submit(text))
 	{
-		LOG_ERROR("%s", shader->getErrorString().c_str());
+		LOG_ERROR("Failed to create shader object for string id %lli.", (long long)id);
 		return false;
 	}
-	// Move to map
-	m_geometryShader[id] = std::move(shader);
+	// Move to storage
+	m_geometryShader.insert(id, std::move(shader));
 	return true;
 }
 
@@ -396,7 +506,7 @@ bool CGraphicsResourceManager::loadFragmentShader(ResourceId id, IResourceManage
 		return true;
 	}
 	// Already loaded
-	if (m_fragmentShader.count(id) != 0)
+	if (m_fragmentShader.contains(id))
 	{
 		return true;
 	}
@@ -407,16 +517,15 @@ bool CGraphicsResourceManager::loadFragmentShader(ResourceId id, IResourceManage
 	{
 		return false;
 	}
-	std::unique_ptr<TShaderObject<GL_FRAGMENT_SHADER>> shader(
-		new TShaderObject<GL_FRAGMENT_SHADER>(text));
-	// Check compile error
-	if (!shader->isValid())
+	// Compile status is checked when the programs using the shader are finished
+	std::unique_ptr<TShaderObject<GL_FRAGMENT_SHADER>> shader(new TShaderObject<GL_FRAGMENT_SHADER>);
+	if (!shader->submit(text))
 	{
-		LOG_ERROR("%s", shader->getErrorString().c_str());
+		LOG_ERROR("Failed to create shader object for string id %lli.", (long long)id);
 		return false;
 	}
-	// Move to map
-	m_fragmentShader[id] = std::move(shader);
+	// Move to storage
+	m_fragmentShader.insert(id, std::move(shader));
 	return true;
 }
 
@@ -427,34 +536,41 @@ void CGraphicsResourceManager::handleImageEvent(ResourceId id, EListenerEvent ev
 	unsigned int width;
 	unsigned int height;
 	EColorFormat format;
+	unsigned int mipCount;
+	std::unique_ptr<CTexture> texture;
 
 	switch (event)
 	{
 	case EListenerEvent::Create:
-		assert(m_textures.count(id) == 0 && "Texture id already exists");
+		assert(!m_textures.contains(id) && "Texture id already exists");
 
-		if (!resourceManager->getImage(id, data, width, height, format))
+		if (!resourceManager->getImage(id, data, width, height, format, mipCount))
 		{
 			assert(false && "Failed to access image resource");
 		}
-		// Create new texture
-		m_textures[id] =
-			std::move(std::unique_ptr<CTexture>(new CTexture(data, width, height, format)));
+		// Create new texture, uses the stored mip chain if available
+		texture.reset(new CTexture());
+		if (!initTexture(*texture, data, width, height, format, mipCount))
+		{
+			LOG_ERROR("Failed to initialize texture from image id %lli.", (long long)id);
+		}
+		m_textures.insert(id, std::move(texture));
 		break;
 
 	case EListenerEvent::Change:
-		assert(m_textures.count(id) == 1 && "Texture id does not exist");
+		assert(m_textures.contains(id) && "Texture id does not exist");
 
-		if (!resourceManager->getImage(id, data, width, height, format))
+		if (!resourceManager->getImage(id, data, width, height, format, mipCount))
 		{
 			assert(false && "Failed to access image resource");
 		}
 		// Reinitialize texture on change
-		m_textures.at(id)->init(data, width, height, format);
+		initTexture(**m_textures.get(id), data, width, height, format, mipCount);
 		break;
 
 	case EListenerEvent::Delete:
-		// Keep texture?
+		// Materials referencing the texture are deleted before the image is unloaded
+		m_textures.erase(id);
 		break;
 
 	default:
@@ -462,6 +578,32 @@ void CGraphicsResourceManager::handleImageEvent(ResourceId id, EListenerEvent ev
 	}
 }
 
+bool CGraphicsResourceManager::initTexture(CTexture& texture, std::vector<unsigned char>& data,
+	unsigned int width, unsigned int height, EColorFormat format, unsigned int mipCount)
+{
+	// Coarse levels are uploaded right away, finer ones by the streamer or the upload queue
+	bool deferLevels = m_textureStreaming || m_uploadQueue != nullptr;
+	if (!texture.initMipChain(data, width, height, format, mipCount,
+		deferLevels ? CTextureStreamer::getResidentLevel(mipCount) : 0))
+	{
+		return false;
+	}
+	if (m_textureStreaming || m_uploadQueue == nullptr || !texture.isValid() ||
+		texture.getBaseLevel() == 0)
+	{
+		return true;
+	}
+	std::shared_ptr<std::vector<unsigned char>> chain =
+		std::make_shared<std::vector<unsigned char>>();
+	chain->swap(data);
+	if (!texture.queueMipLevels(chain, 0, *m_uploadQueue))
+	{
+		// Uploaded format differs from the stored chain, upload all levels directly
+		return texture.initMipChain(*chain, width, height, format, mipCount);
+	}
+	return true;
+}
+
 void CGraphicsResourceManager::handleMeshEvent(ResourceId id, EListenerEvent event,
 	IResourceManager* resourceManager)
 {
@@ -474,30 +616,30 @@ void CGraphicsResourceManager::handleMeshEvent(ResourceId id, EListenerEvent eve
 	switch (event)
 	{
 	case EListenerEvent::Create:
-		assert(m_meshes.count(id) == 0 && "Mesh id already exists");
+		assert(!m_meshes.contains(id) && "Mesh id already exists");
 
 		if (!resourceManager->getMesh(id, vertices, indices, normals, uvs, type))
 		{
 			assert(false && "Failed to access mesh resource");
 		}
-		// Create new texture
-		m_meshes[id] =
-			std::move(std::unique_ptr<CMesh>(new CMesh(vertices, indices, normals, uvs, type)));
+		// Create new mesh
+		m_meshes.insert(id, std::unique_ptr<CMesh>(new CMesh(vertices, indices, normals, uvs, type,
+			m_uploadQueue.get())));
 		break;
 
 	case EListenerEvent::Change:
-		assert(m_meshes.count(id) == 1 && "Mesh id does not exist");
+		assert(m_meshes.contains(id) && "Mesh id does not exist");
 
 		if (!resourceManager->getMesh(id, vertices, indices, normals, uvs, type))
 		{
 			assert(false && "Failed to access mesh resource");
 		}
 		// Reinitialize mesh on change
-		m_meshes.at(id)->init(vertices, indices, normals, uvs, type);
+		(*m_meshes.get(id))->init(vertices, indices, normals, uvs, type, m_uploadQueue.get());
 		break;
 
 	case EListenerEvent::Delete:
-		// Keep mesh?
+		m_meshes.erase(id);
 		break;
 
 	default:
@@ -518,7 +660,7 @@ void CGraphicsResourceManager::handleMaterialEvent(ResourceId id, EListenerEvent
 	switch (event)
 	{
 	case EListenerEvent::Create:
-		assert(m_materials.count(id) == 0 && "Material id already exists");
+		assert(!m_materials.contains(id) && "Material id already exists");
 
 		if (!resourceManager->getMaterial(id, diffuse, normal, specular, glow, alpha, customShader))
 		{
@@ -526,13 +668,13 @@ void CGraphicsResourceManager::handleMaterialEvent(ResourceId id, EListenerEvent
 		}
 
 		// Create new material
-		m_materials[id] = std::move(std::unique_ptr<CMaterial>(
+		m_materials.insert(id, std::unique_ptr<CMaterial>(
 			new CMaterial(getTexture(diffuse), getTexture(normal), getTexture(specular),
 			getTexture(glow), getTexture(alpha), getShaderProgram(customShader))));
 		break;
 
 	case EListenerEvent::Change:
-		assert(m_materials.count(id) == 1 && "Material id does not exist");
+		assert(m_materials.contains(id) && "Material id does not exist");
 
 		if (!resourceManager->getMaterial(id, diffuse, normal, specular, glow, alpha, customShader))
 		{
@@ -540,13 +682,13 @@ void CGraphicsResourceManager::handleMaterialEvent(ResourceId id, EListenerEvent
 		}
 
 		// Reinitialize material on change
-		m_materials.at(id)->init(getTexture(diffuse), getTexture(normal), getTexture(specular),
+		(*m_materials.get(id))->init(getTexture(diffuse), getTexture(normal), getTexture(specular),
 			getTexture(glow), getTexture(alpha),
 			getShaderProgram(customShader));
 		break;
 
 	case EListenerEvent::Delete:
-		// Keep material?
+		m_materials.erase(id);
 		break;
 
 	default:
@@ -567,7 +709,7 @@ void CGraphicsResourceManager::handleShaderEvent(ResourceId id, EListenerEvent e
 	{
 	case EListenerEvent::Create:
 		// TODO Replace assert with log statement and global error handler
-		assert(m_shaderPrograms.count(id) == 0 && "Shader id already exists");
+		assert(!m_shaderPrograms.contains(id) && "Shader id already exists");
 
 		// Load shader source ids
 		if (!resourceManager->getShader(id, vertex, tessControl, tessEval, geometry, fragment))
@@ -576,30 +718,21 @@ void CGraphicsResourceManager::handleShaderEvent(ResourceId id, EListenerEvent e
 			assert(false && "Failed to access shader resource");
 		}
 
-		// Load shader objects from source
-		if (!loadVertexShader(vertex, resourceManager) ||
-			!loadTessControlShader(tessControl, resourceManager) ||
-			!loadTessEvalShader(tessEval, resourceManager) ||
-			!loadGeometryShader(geometry, resourceManager) ||
-			!loadFragmentShader(fragment, resourceManager))
-		{
-			// TODO Log error
-			return;
-		}
-
-		// Add create shader program
-		m_shaderPrograms[id] = std::move(std::unique_ptr<CShaderProgram>(new CShaderProgram(
-			getVertexShaderObject(vertex), getTessControlShaderObject(tessControl),
-			getTessEvalShaderObject(tessEval), getGeometryShaderObject(geometry),
-			getFragmentShaderObject(fragment))));
-
+		loadShaderProgram(id, vertex, tessControl, tessEval, geometry, fragment, resourceManager);
 		break;
 
 	case EListenerEvent::Change:
-		// TODO Implement
+		if (!resourceManager->getShader(id, vertex, tessControl, tessEval, geometry, fragment))
+		{
+			LOG_ERROR("Failed to access changed shader id %lli.", (long long)id);
+			break;
+		}
+		reloadShaderProgram(id, vertex, tessControl, tessEval, geometry, fragment,
+			resourceManager);
+		break;
 
 	case EListenerEvent::Delete:
-		// TODO Keep shader?
+		m_shaderPrograms.erase(id);
 		break;
 
 	default:
@@ -608,8 +741,205 @@ void CGraphicsResourceManager::handleShaderEvent(ResourceId id, EListenerEvent e
 	}
 }
 
+bool CGraphicsResourceManager::loadShaderProgram(ResourceId id, ResourceId vertex,
+	ResourceId tessControl, ResourceId tessEval, ResourceId geometry, ResourceId fragment,
+	IResourceManager* resourceManager)
+{
+	auto start = std::chrono::steady_clock::now();
+	std::unique_ptr<CShaderProgram> program(new CShaderProgram);
+
+	// Load linked program from the binary cache, keyed by the preprocessed sources
+	uint64_t cacheKey = 0;
+	if (m_shaderCache != nullptr)
+	{
+		cacheKey = getShaderCacheKey(vertex, tessControl, tessEval, geometry, fragment,
+			resourceManager);
+		if (m_shaderCache->load(cacheKey, *program))
+		{
+			double seconds = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+			m_shaderTimings.push_back({ id, seconds, seconds, 0., true, true });
+			m_shaderPrograms.insert(id, std::move(program));
+			return true;
+		}
+	}
+
+	// Submit compile and link, the status is queried once the program is finished
+	if (!loadVertexShader(vertex, resourceManager) ||
+		!loadTessControlShader(tessControl, resourceManager) ||
+		!loadTessEvalShader(tessEval, resourceManager) ||
+		!loadGeometryShader(geometry, resourceManager) ||
+		!loadFragmentShader(fragment, resourceManager) ||
+		!program->submit(getVertexShaderObject(vertex), getTessControlShaderObject(tessControl),
+			getTessEvalShaderObject(tessEval), getGeometryShaderObject(geometry),
+			getFragmentShaderObject(fragment), isShaderCacheAvailable()))
+	{
+		LOG_ERROR("Failed to create shader program id %lli.", (long long)id);
+		return false;
+	}
+
+	SPendingProgram pending;
+	pending.m_id = id;
+	pending.m_vertex = vertex;
+	pending.m_tessControl = tessControl;
+	pending.m_tessEval = tessEval;
+	pending.m_geometry = geometry;
+	pending.m_fragment = fragment;
+	pending.m_cacheKey = cacheKey;
+	pending.m_start = start;
+	pending.m_submitSeconds =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	m_pendingPrograms.push_back(pending);
+	m_shaderPrograms.insert(id, std::move(program));
+	return true;
+}
+
+/**
+* \brief Replaces source string numbers of shader includes in an info log by file names.
+*/
+static std::string mapSourceNames(const std::string& infoLog,
+	const std::list<IResourceManager*>& managers)
+{
+	// Includes are numbered by the manager, which preprocessed the sources
+	return managers.empty() ? infoLog : managers.front()->mapShaderSourceNames(infoLog);
+}
+
+/**
+* \brief Finishes compile of a shader object and logs the error, if the compile failed.
+*/
+template <typename TShader>
+static void finishShader(const std::unique_ptr<TShader>* shader,
+	const std::list<IResourceManager*>& managers)
+{
+	if (shader != nullptr && !(*shader)->finish())
+	{
+		LOG_ERROR("%s", mapSourceNames((*shader)->getErrorString(), managers).c_str());
+	}
+}
+
+std::list<CGraphicsResourceManager::SPendingProgram>::iterator
+CGraphicsResourceManager::finishShaderProgram(std::list<SPendingProgram>::iterator pending) const
+{
+	const std::unique_ptr<CShaderProgram>* entry = m_shaderPrograms.get(pending->m_id);
+	if (entry == nullptr)
+	{
+		// Deleted before it was finished
+		return m_pendingPrograms.erase(pending);
+	}
+	CShaderProgram& program = **entry;
+
+	auto waitStart = std::chrono::steady_clock::now();
+	bool valid = program.finish();
+	auto end = std::chrono::steady_clock::now();
+	double readySeconds = std::chrono::duration<double>(end - pending->m_start).count();
+
+	if (!valid)
+	{
+		LOG_ERROR("Failed to link shader program id %lli: %s", (long long)pending->m_id,
+			mapSourceNames(program.getErrorString(), m_registeredManagers).c_str());
+	}
+
+	// Stages are finished with the program, compile errors are logged after the link error
+	finishShader(m_vertexShader.get(pending->m_vertex), m_registeredManagers);
+	finishShader(m_tessConstrolShader.get(pending->m_tessControl), m_registeredManagers);
+	finishShader(m_tessEvalShader.get(pending->m_tessEval), m_registeredManagers);
+	finishShader(m_geometryShader.get(pending->m_geometry), m_registeredManagers);
+	finishShader(m_fragmentShader.get(pending->m_fragment), m_registeredManagers);
+
+	if (valid && m_shaderCache != nullptr)
+	{
+		m_shaderCache->save(pending->m_cacheKey, program, readySeconds);
+	}
+
+	m_shaderTimings.push_back({ pending->m_id, pending->m_submitSeconds, readySeconds,
+		std::chrono::duration<double>(end - waitStart).count(), false, valid });
+	return m_pendingPrograms.erase(pending);
+}
+
+bool CGraphicsResourceManager::reloadShaderProgram(ResourceId id, ResourceId vertex,
+	ResourceId tessControl, ResourceId tessEval, ResourceId geometry, ResourceId fragment,
+	IResourceManager* resourceManager)
+{
+	// Previous submission is finished first, the program is rebuilt in place
+	for (auto pending = m_pendingPrograms.begin(); pending != m_pendingPrograms.end();)
+	{
+		pending = pending->m_id == id ? finishShaderProgram(pending) : std::next(pending);
+	}
+	std::unique_ptr<CShaderProgram>* entry = m_shaderPrograms.get(id);
+	if (entry == nullptr)
+	{
+		// Initial load failed, load as new program
+		return loadShaderProgram(id, vertex, tessControl, tessEval, geometry, fragment,
+			resourceManager);
+	}
+
+	// Changed stages have been released by their string events and are compiled again
+	auto start = std::chrono::steady_clock::now();
+	CShaderProgram& program = **entry;
+	bool valid = loadVertexShader(vertex, resourceManager) &&
+		loadTessControlShader(tessControl, resourceManager) &&
+		loadTessEvalShader(tessEval, resourceManager) &&
+		loadGeometryShader(geometry, resourceManager) &&
+		loadFragmentShader(fragment, resourceManager) &&
+		program.init(getVertexShaderObject(vertex), getTessControlShaderObject(tessControl),
+			getTessEvalShaderObject(tessEval), getGeometryShaderObject(geometry),
+			getFragmentShaderObject(fragment), isShaderCacheAvailable());
+	if (!valid)
+	{
+		// Failed link keeps the previous program, users of the program are not affected
+		LOG_ERROR("Failed to rebuild shader program id %lli, keeping the previous program. %s",
+			(long long)id, mapSourceNames(program.getErrorString(), m_registeredManagers).c_str());
+	}
+
+	// Stages are finished with the program, compile errors are logged after the link error
+	finishShader(m_vertexShader.get(vertex), m_registeredManagers);
+	finishShader(m_tessConstrolShader.get(tessControl), m_registeredManagers);
+	finishShader(m_tessEvalShader.get(tessEval), m_registeredManagers);
+	finishShader(m_geometryShader.get(geometry), m_registeredManagers);
+	finishShader(m_fragmentShader.get(fragment), m_registeredManagers);
+	if (!valid)
+	{
+		return false;
+	}
+
+	double seconds =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (m_shaderCache != nullptr)
+	{
+		m_shaderCache->save(getShaderCacheKey(vertex, tessControl, tessEval, geometry, fragment,
+			resourceManager), program, seconds);
+	}
+	LOG_INFO("Rebuilt shader program id %lli in %.2f ms.", (long long)id, seconds * 1000.);
+	return true;
+}
+
+uint64_t CGraphicsResourceManager::getShaderCacheKey(ResourceId vertex, ResourceId tessControl,
+	ResourceId tessEval, ResourceId geometry, ResourceId fragment,
+	IResourceManager* resourceManager) const
+{
+	std::vector<std::string> sources;
+	for (ResourceId stage : { vertex, tessControl, tessEval, geometry, fragment })
+	{
+		sources.emplace_back();
+		if (stage != invalidResource)
+		{
+			resourceManager->getString(stage, sources.back());
+		}
+	}
+	return m_shaderCache->computeKey(sources);
+}
+
 void CGraphicsResourceManager::handleStringEvent(ResourceId id, EListenerEvent event,
 	IResourceManager* resourceManager)
 {
-	// Does not need processing, shader events handle source loading
+	// Shader events handle source loading, only compiled shader objects need to be released
+	// Changed sources are compiled again by the change events of the shaders using them
+	if (event == EListenerEvent::Delete || event == EListenerEvent::Change)
+	{
+		m_vertexShader.erase(id);
+		m_tessConstrolShader.erase(id);
+		m_tessEvalShader.erase(id);
+		m_geometryShader.erase(id);
+		m_fragmentShader.erase(id);
+	}
 }
@@ -1,21 +1,39 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <list>
-#include <unordered_map>
+#include <vector>
 
 #include "resource/IResourceListener.h"
+#include "resource/TResourceStorage.h"
 #include "graphics/IGraphicsResourceManager.h"
 
 #include "graphics/resource/CTexture.h"
 #include "graphics/resource/CMaterial.h"
 #include "graphics/resource/CMesh.h"
 #include "graphics/resource/TShaderObject.h"
+#include "graphics/renderer/core/CUploadQueue.h"
 #include "graphics/resource/CShaderProgram.h"
+#include "graphics/resource/CShaderBinaryCache.h"
 
 class CGraphicsResourceManager : public IGraphicsResourceManager, public IResourceListener
 {
    public:
+    /**
+    * \brief Startup timing of a shader program.
+    */
+    struct SShaderProgramTiming
+    {
+        ResourceId m_id;        /**< Shader program id. */
+        double m_submitSeconds; /**< Time spent submitting sources or loading the binary. */
+        double m_readySeconds;  /**< Time from submission until the program was finished. */
+        double m_waitSeconds;   /**< Time blocked on the driver while finishing. */
+        bool m_cached;          /**< Loaded from the program binary cache. */
+        bool m_valid;           /**< Program compiled and linked successfully. */
+    };
+
     /**
     * \brief Sets resource callbacks.
     */
@@ -77,6 +95,45 @@ class CGraphicsResourceManager : public IGraphicsResourceManager, public IResour
     CTexture* getDefaultGlowTexture() const;
     CTexture* getDefaultAlphaTexture() const;
 
+    /**
+    * \brief Returns GPU memory usage of textures and meshes.
+    */
+    size_t getMemoryUsage(EResourceType type, ResourceId id) const;
+    size_t getMemoryUsage(EResourceType type) const;
+
+    /**
+    * \brief Enables texture streaming.
+    * Textures with a precomputed mip chain are created with the coarse levels only, finer levels
+    * are loaded by a texture streamer on demand.
+    */
+    void setTextureStreaming(bool enabled);
+
+    /**
+    * \brief Sets queue for asynchronous uploads of new textures and meshes.
+    * Without a queue, resource data is uploaded on creation.
+    */
+    void setUploadQueue(std::shared_ptr<CUploadQueue> uploadQueue);
+
+    /**
+    * \brief Sets cache for linked program binaries.
+    * Without a cache, programs are compiled from source on creation.
+    */
+    void setShaderCache(std::shared_ptr<CShaderBinaryCache> shaderCache);
+
+    /**
+    * \brief Finishes submitted shader programs.
+    * Programs are compiled and linked by the driver in the background and finished on first
+    * access by getShaderProgram otherwise.
+    * \param wait Waits for all programs if true, otherwise finishes only programs, which have
+    *             completed, see CShaderProgram::isComplete.
+    */
+    void finishShaderPrograms(bool wait);
+
+    /**
+    * \brief Returns timings of the finished shader programs in finishing order.
+    */
+    const std::vector<SShaderProgramTiming>& getShaderProgramTimings() const;
+
    protected:
     /**
     * \brief Maps id to internal vertex shader object.
@@ -139,6 +196,13 @@ class CGraphicsResourceManager : public IGraphicsResourceManager, public IResour
     */
     void handleImageEvent(ResourceId, EListenerEvent event, IResourceManager* resourceManager);
 
+    /**
+    * \brief Initializes texture from image data for the streaming and upload settings.
+    * The data may be moved into the upload queue.
+    */
+    bool initTexture(CTexture& texture, std::vector<unsigned char>& data, unsigned int width,
+                     unsigned int height, EColorFormat format, unsigned int mipCount);
+
     /**
     * \brief Handles resource events for mesh resources.
     */
@@ -156,40 +220,97 @@ class CGraphicsResourceManager : public IGraphicsResourceManager, public IResour
 
     /**
     * \brief Handles resource events for string resources.
-    * Stubbed as the renderer does not need string events.
-    * TODO Consider hot reloading of shader source code and on-the-fly
-    * recompiling of shader objects/programs
+    * Delete and change events release compiled shader objects, change events of the dependent
+    * shaders compile the changed sources again.
     */
     void handleStringEvent(ResourceId, EListenerEvent event, IResourceManager* resourceManager);
 
-    std::unordered_map<ResourceId, std::unique_ptr<CMesh>>
+    /**
+    * \brief Shader program with a submitted link.
+    */
+    struct SPendingProgram
+    {
+        ResourceId m_id;          /**< Shader program id. */
+        ResourceId m_vertex;      /**< Vertex shader string id. */
+        ResourceId m_tessControl; /**< Tessellation control shader string id. */
+        ResourceId m_tessEval;    /**< Tessellation evaluation shader string id. */
+        ResourceId m_geometry;    /**< Geometry shader string id. */
+        ResourceId m_fragment;    /**< Fragment shader string id. */
+        uint64_t m_cacheKey;      /**< Program binary cache key. */
+        std::chrono::steady_clock::time_point m_start; /**< Submission time. */
+        double m_submitSeconds; /**< Time spent submitting. */
+    };
+
+    /**
+    * \brief Loads shader program from the cached binary or submits the stage sources.
+    */
+    bool loadShaderProgram(ResourceId id, ResourceId vertex, ResourceId tessControl,
+                           ResourceId tessEval, ResourceId geometry, ResourceId fragment,
+                           IResourceManager* resourceManager);
+
+    /**
+    * \brief Rebuilds a loaded shader program from changed stage sources.
+    * The program object is kept, so users of the program see the new program. If a stage fails
+    * to compile or the program fails to link, the previous program stays in use.
+    */
+    bool reloadShaderProgram(ResourceId id, ResourceId vertex, ResourceId tessControl,
+                             ResourceId tessEval, ResourceId geometry, ResourceId fragment,
+                             IResourceManager* resourceManager);
+
+    /**
+    * \brief Returns whether linked programs are stored in the program binary cache.
+    */
+    bool isShaderCacheAvailable() const;
+
+    /**
+    * \brief Returns program binary cache key of the stage sources.
+    */
+    uint64_t getShaderCacheKey(ResourceId vertex, ResourceId tessControl, ResourceId tessEval,
+                               ResourceId geometry, ResourceId fragment,
+                               IResourceManager* resourceManager) const;
+
+    /**
+    * \brief Waits for a submitted program, logs errors and stores the binary in the cache.
+    * Returns the next pending program.
+    */
+    std::list<SPendingProgram>::iterator finishShaderProgram(
+        std::list<SPendingProgram>::iterator pending) const;
+
+    std::shared_ptr<CShaderBinaryCache> m_shaderCache = nullptr; /**< Program binary cache. */
+    std::shared_ptr<CUploadQueue> m_uploadQueue =
+        nullptr; /**< Upload queue, outlives the textures and meshes using it. */
+
+    TResourceStorage<std::unique_ptr<CMesh>>
         m_meshes; /**< Maps mesh id from resource manager to GPU side mesh. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<CTexture>>
+    TResourceStorage<std::unique_ptr<CTexture>>
         m_textures; /**< Maps image id from resource manager to GPU side texture. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<CMaterial>>
+    TResourceStorage<std::unique_ptr<CMaterial>>
         m_materials; /**< Maps material id from resource manager to cached material. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<TShaderObject<GL_VERTEX_SHADER>>>
+    TResourceStorage<std::unique_ptr<TShaderObject<GL_VERTEX_SHADER>>>
         m_vertexShader; /**< Maps string resource ids to compiled vertex shader objects. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<TShaderObject<GL_TESS_CONTROL_SHADER>>>
+    TResourceStorage<std::unique_ptr<TShaderObject<GL_TESS_CONTROL_SHADER>>>
         m_tessConstrolShader; /**< Maps string resource ids to compiled tessellation control
                                                   shader objects. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<TShaderObject<GL_TESS_EVALUATION_SHADER>>>
+    TResourceStorage<std::unique_ptr<TShaderObject<GL_TESS_EVALUATION_SHADER>>>
         m_tessEvalShader; /**< Maps string resource ids to compiled tessellation evaluation shader
                                           objects. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<TShaderObject<GL_GEOMETRY_SHADER>>>
+    TResourceStorage<std::unique_ptr<TShaderObject<GL_GEOMETRY_SHADER>>>
         m_geometryShader; /**< Maps string resource ids to compiled geometry shader objects. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<TShaderObject<GL_FRAGMENT_SHADER>>>
+    TResourceStorage<std::unique_ptr<TShaderObject<GL_FRAGMENT_SHADER>>>
         m_fragmentShader; /**< Maps string resource ids to compiled fragment shader objects. */
 
-    std::unordered_map<ResourceId, std::unique_ptr<CShaderProgram>>
+    TResourceStorage<std::unique_ptr<CShaderProgram>>
         m_shaderPrograms; /**< Maps resource ids to linked shader programs. */
+    mutable std::list<SPendingProgram>
+        m_pendingPrograms; /**< Submitted programs, finished on first access. */
+    mutable std::vector<SShaderProgramTiming> m_shaderTimings; /**< Finished program timings. */
 
     std::unique_ptr<CTexture> m_defaultDiffuseTexture = nullptr;  /**< Default diffuse texture. */
     std::unique_ptr<CTexture> m_defaultNormalTexture = nullptr;   /**< Default normal texture. */
@@ -197,6 +318,8 @@ class CGraphicsResourceManager : public IGraphicsResourceManager, public IResour
     std::unique_ptr<CTexture> m_defaultGlowTexture = nullptr;     /**< Default glow texture. */
     std::unique_ptr<CTexture> m_defaultAlphaTexture = nullptr;    /**< Default alpha texture. */
 
+    bool m_textureStreaming = false; /**< New textures are created with coarse levels only. */
+
     std::list<IResourceManager*>
         m_registeredManagers; /**< Resource managers, this listener is attached to. */
 };
@@ -71,6 +71,13 @@ bool CMaterial::hasAlpha() const { return m_alphaTexture != nullptr; }
 
 bool CMaterial::hasCustomShader() const { return m_customShader != nullptr; }
 
+unsigned int CMaterial::getFeatures() const
+{
+    return (hasDiffuse() ? MaterialDiffuseMap : 0) | (hasNormal() ? MaterialNormalMap : 0) |
+           (hasSpecular() ? MaterialSpecularMap : 0) | (hasGlow() ? MaterialGlowMap : 0) |
+           (hasAlpha() ? MaterialAlphaMap : 0);
+}
+
 const CTexture* CMaterial::getDiffuse() const { return m_diffuseTexture; }
 
 const CTexture* CMaterial::getNormal() const { return m_normalTexture; }
@@ -5,6 +5,18 @@
 #include "CTexture.h"
 #include "CShaderProgram.h"
 
+/**
+ * \brief Material texture maps as feature bits for shader variants.
+ */
+enum EMaterialFeature : unsigned int
+{
+    MaterialDiffuseMap = 1 << 0,  /**< Has diffuse texture. */
+    MaterialNormalMap = 1 << 1,   /**< Has normal texture. */
+    MaterialSpecularMap = 1 << 2, /**< Has specular texture. */
+    MaterialGlowMap = 1 << 3,     /**< Has glow texture. */
+    MaterialAlphaMap = 1 << 4     /**< Has alpha texture. */
+};
+
 /**
  * \brief Material class.
  *
@@ -26,6 +38,11 @@ class CMaterial
     bool hasAlpha() const;
     bool hasCustomShader() const;
 
+    /**
+    * \brief Returns mask of the available texture maps, see EMaterialFeature.
+    */
+    unsigned int getFeatures() const;
+
     const CTexture* getDiffuse() const;
     const CTexture* getNormal() const;
     const CTexture* getSpecular() const;
@@ -4,10 +4,13 @@
 #include "graphics/renderer/core/RendererCoreConfig.h"
 #include "graphics/renderer/debug/RendererDebug.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 CMesh::CMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
-             const std::vector<float>& normals, const std::vector<float>& uvs, EPrimitiveType type)
+             const std::vector<float>& normals, const std::vector<float>& uvs, EPrimitiveType type,
+             CUploadQueue* uploadQueue)
     : m_vertices(nullptr),
       m_indices(nullptr),
       m_normals(nullptr),
@@ -15,38 +18,38 @@ CMesh::CMesh(const std::vector<float>& vertices, const std::vector<unsigned int>
       m_vao(nullptr),
       m_type(EPrimitiveType::Invalid)
 {
-    init(vertices, indices, normals, uvs, type);
+    init(vertices, indices, normals, uvs, type, uploadQueue);
 }
 
 CMesh::~CMesh() { return; }
 
 bool CMesh::init(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
                  const std::vector<float>& normals, const std::vector<float>& uvs,
-                 EPrimitiveType type)
+                 EPrimitiveType type, CUploadQueue* uploadQueue)
 {
     if (vertices.empty() || type == EPrimitiveType::Invalid)
     {
         return false;
     }
     // Set vertex data
-    m_vertices.reset(new CVertexBuffer(vertices));
+    m_vertices.reset(new CVertexBuffer(vertices, GL_STATIC_DRAW, uploadQueue));
 
     if (!indices.empty())
     {
         // Set indices
-        m_indices.reset(new CIndexBuffer(indices));
+        m_indices.reset(new CIndexBuffer(indices, GL_STATIC_DRAW, uploadQueue));
     }
 
     if (!normals.empty())
     {
         // Set normals
-        m_normals.reset(new CVertexBuffer(normals));
+        m_normals.reset(new CVertexBuffer(normals, GL_STATIC_DRAW, uploadQueue));
     }
 
     if (!uvs.empty())
     {
         // Set uvs
-        m_uvs.reset(new CVertexBuffer(uvs));
+        m_uvs.reset(new CVertexBuffer(uvs, GL_STATIC_DRAW, uploadQueue));
     }
 
     // Create new vertex array object to store buffer state
@@ -55,6 +58,16 @@ bool CMesh::init(const std::vector<float>& vertices, const std::vector<unsigned
     // Set primitive type
     m_type = type;
 
+    // Bounding sphere for screen size estimates
+    float radiusSquared = 0.f;
+    for (size_t i = 0; i + 2 < vertices.size(); i += 3)
+    {
+        radiusSquared = std::max(radiusSquared, vertices[i] * vertices[i] +
+                                                    vertices[i + 1] * vertices[i + 1] +
+                                                    vertices[i + 2] * vertices[i + 2]);
+    }
+    m_boundingRadius = std::sqrt(radiusSquared);
+
     // Initialize state
     m_vao->setActive();
 
@@ -115,6 +128,38 @@ const std::unique_ptr<CVertexBuffer>& CMesh::getNormalBuffer() const { return m_
 
 const std::unique_ptr<CVertexBuffer>& CMesh::getUVBuffer() const { return m_uvs; }
 
+size_t CMesh::getMemorySize() const
+{
+    size_t size = 0;
+    if (m_vertices != nullptr)
+    {
+        size += m_vertices->getSize() * sizeof(float);
+    }
+    if (m_indices != nullptr)
+    {
+        size += m_indices->getSize() * sizeof(unsigned int);
+    }
+    if (m_normals != nullptr)
+    {
+        size += m_normals->getSize() * sizeof(float);
+    }
+    if (m_uvs != nullptr)
+    {
+        size += m_uvs->getSize() * sizeof(float);
+    }
+    return size;
+}
+
+bool CMesh::isUploadPending() const
+{
+    return (m_vertices != nullptr && m_vertices->isUploadPending()) ||
+           (m_indices != nullptr && m_indices->isUploadPending()) ||
+           (m_normals != nullptr && m_normals->isUploadPending()) ||
+           (m_uvs != nullptr && m_uvs->isUploadPending());
+}
+
+float CMesh::getBoundingRadius() const { return m_boundingRadius; }
+
 const EPrimitiveType CMesh::getPrimitiveType() const { return m_type; }
 
 const std::unique_ptr<CVertexArrayObject>& CMesh::getVertexArray() const { return m_vao; }
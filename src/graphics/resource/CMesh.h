@@ -9,6 +9,8 @@
 #include "graphics/renderer/core/CIndexBuffer.h"
 #include "graphics/renderer/core/CVertexArrayObject.h"
 
+class CUploadQueue;
+
 /**
 * \brief Contains mesh data (vertices, faces, normals and uv data).
 *
@@ -20,7 +22,8 @@ class CMesh
 {
    public:
     CMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
-          const std::vector<float>& normals, const std::vector<float>& uvs, EPrimitiveType type);
+          const std::vector<float>& normals, const std::vector<float>& uvs, EPrimitiveType type,
+          CUploadQueue* uploadQueue = nullptr);
 
     CMesh(const CMesh&) = delete;
     CMesh& operator=(const CMesh&) = delete;
@@ -32,10 +35,16 @@ class CMesh
 
     /**
     * \brief Initializes mesh with data.
+    * Buffer data is uploaded asynchronously if an upload queue is passed.
     */
     bool init(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
               const std::vector<float>& normals, const std::vector<float>& uvs,
-              EPrimitiveType type);
+              EPrimitiveType type, CUploadQueue* uploadQueue = nullptr);
+
+    /**
+    * \brief Returns whether buffer data has not been uploaded yet.
+    */
+    bool isUploadPending() const;
 
     /**
     * \brief Returns whether or not an index buffer has been set.
@@ -62,6 +71,16 @@ class CMesh
     */
     const std::unique_ptr<CVertexBuffer>& getUVBuffer() const;
 
+    /**
+    * \brief Returns GPU memory size of all buffers in bytes.
+    */
+    size_t getMemorySize() const;
+
+    /**
+    * \brief Returns radius of the bounding sphere around the mesh origin.
+    */
+    float getBoundingRadius() const;
+
     /**
     * \brief Returns primitive type of the mesh.
     */
@@ -91,4 +110,5 @@ class CMesh
     std::unique_ptr<CVertexBuffer> m_uvs;      /**< Texture coordinates. */
     std::unique_ptr<CVertexArrayObject> m_vao; /**< Vertex array object. */
     EPrimitiveType m_type;                     /**< Mesh primitive type. */
+    float m_boundingRadius = 0.f;              /**< Largest vertex distance from origin. */
 };
@@ -0,0 +1,130 @@
+#include "CShaderBinaryCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include "graphics/renderer/core/RendererCoreConfig.h"
+#include "graphics/resource/CShaderProgram.h"
+#include "util/Hash.h"
+#include "debug/Log.h"
+
+CShaderBinaryCache::CShaderBinaryCache(const std::string& directory)
+    : m_directory(directory), m_driverHash(fnv1aOffsetBasis), m_available(false)
+{
+    // Binaries are only valid for the driver, which created them
+    const GLenum driverStrings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (GLenum name : driverStrings)
+    {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        if (value != nullptr)
+        {
+            m_driverHash = hashFnv1a(std::string(value), m_driverHash);
+        }
+    }
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    m_available = formatCount > 0;
+    if (!m_available)
+    {
+        LOG_INFO("Program binaries are not supported by the driver, shader cache disabled.");
+    }
+}
+
+bool CShaderBinaryCache::isAvailable() const { return m_available; }
+
+uint64_t CShaderBinaryCache::computeKey(const std::vector<std::string>& sources) const
+{
+    uint64_t key = m_driverHash;
+    for (const std::string& source : sources)
+    {
+        // Size separates the stages
+        uint64_t size = source.size();
+        key = hashFnv1a(&size, sizeof(size), key);
+        key = hashFnv1a(source, key);
+    }
+    return key;
+}
+
+bool CShaderBinaryCache::load(uint64_t key, CShaderProgram& program)
+{
+    if (!m_available)
+    {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream ifs(getFile(key), std::ios::binary);
+    SHeader header;
+    if (!ifs.is_open() || !ifs.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.m_magic != s_magic || header.m_version != s_version || header.m_key != key)
+    {
+        return false;
+    }
+    std::vector<unsigned char> binary(header.m_size);
+    if (!ifs.read(reinterpret_cast<char*>(binary.data()), binary.size()))
+    {
+        LOG_DEBUG("Truncated shader cache file %s.", getFile(key).c_str());
+        return false;
+    }
+    if (!program.initBinary(header.m_format, binary))
+    {
+        LOG_DEBUG("Program binary %s rejected by driver, compiling from source.",
+                  getFile(key).c_str());
+        return false;
+    }
+
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (header.m_compileSeconds > seconds)
+    {
+        m_savedSeconds += header.m_compileSeconds - seconds;
+    }
+    ++m_hits;
+    return true;
+}
+
+void CShaderBinaryCache::save(uint64_t key, const CShaderProgram& program, double compileSeconds)
+{
+    ++m_misses;
+    if (!m_available)
+    {
+        return;
+    }
+
+    std::vector<unsigned char> binary;
+    GLenum format;
+    if (!program.getBinary(format, binary))
+    {
+        return;
+    }
+
+    SHeader header;
+    header.m_magic = s_magic;
+    header.m_version = s_version;
+    header.m_key = key;
+    header.m_format = format;
+    header.m_size = (uint32_t)binary.size();
+    header.m_compileSeconds = compileSeconds;
+
+    std::ofstream ofs(getFile(key), std::ios::binary);
+    if (!ofs.is_open() || !ofs.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+        !ofs.write(reinterpret_cast<const char*>(binary.data()), binary.size()))
+    {
+        LOG_DEBUG("Failed to write shader cache file %s.", getFile(key).c_str());
+    }
+}
+
+unsigned int CShaderBinaryCache::getHitCount() const { return m_hits; }
+
+unsigned int CShaderBinaryCache::getMissCount() const { return m_misses; }
+
+double CShaderBinaryCache::getSavedSeconds() const { return m_savedSeconds; }
+
+std::string CShaderBinaryCache::getFile(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return m_directory + name;
+}
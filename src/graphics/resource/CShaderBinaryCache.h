@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class CShaderProgram;
+
+/**
+* \brief On disk cache of linked program binaries.
+* Programs are keyed by the hash of their preprocessed stage sources and the GL vendor, renderer
+* and version strings, so driver updates and source changes create new entries. Binaries the
+* driver rejects are treated as misses and replaced after compiling from source.
+* Requires a current GL context on construction.
+*/
+class CShaderBinaryCache
+{
+   public:
+    /**
+    * \brief Creates cache in the directory, which must exist.
+    */
+    CShaderBinaryCache(const std::string& directory);
+
+    /**
+    * \brief Returns whether the driver supports program binaries.
+    */
+    bool isAvailable() const;
+
+    /**
+    * \brief Computes cache key from the preprocessed stage sources.
+    * Unused stages are passed as empty strings.
+    */
+    uint64_t computeKey(const std::vector<std::string>& sources) const;
+
+    /**
+    * \brief Initializes program from the cached binary, returns false on a miss.
+    */
+    bool load(uint64_t key, CShaderProgram& program);
+
+    /**
+    * \brief Stores binary of a program compiled from source.
+    * \param compileSeconds Time spent compiling and linking, used to report the time saved.
+    */
+    void save(uint64_t key, const CShaderProgram& program, double compileSeconds);
+
+    /**
+    * \brief Returns number of programs loaded from binaries.
+    */
+    unsigned int getHitCount() const;
+
+    /**
+    * \brief Returns number of programs compiled from source.
+    */
+    unsigned int getMissCount() const;
+
+    /**
+    * \brief Returns compile time saved by loaded binaries in seconds.
+    */
+    double getSavedSeconds() const;
+
+   private:
+    /**
+    * \brief Header of a cache file, followed by the program binary.
+    */
+    struct SHeader
+    {
+        uint32_t m_magic;        /**< Identifies cache files. */
+        uint32_t m_version;      /**< Cache file version. */
+        uint64_t m_key;          /**< Cache key of the program. */
+        uint32_t m_format;       /**< Driver binary format. */
+        uint32_t m_size;         /**< Size of the binary in bytes. */
+        double m_compileSeconds; /**< Compile time from source. */
+    };
+
+    /**
+    * \brief Returns cache file of a key.
+    */
+    std::string getFile(uint64_t key) const;
+
+    std::string m_directory;    /**< Cache directory. */
+    uint64_t m_driverHash;      /**< Hash of the driver strings. */
+    bool m_available;           /**< Driver supports program binaries. */
+    unsigned int m_hits = 0;    /**< Programs loaded from binaries. */
+    unsigned int m_misses = 0;  /**< Programs compiled from source. */
+    double m_savedSeconds = 0.; /**< Compile time saved. */
+
+    static const uint32_t s_magic = 0x42505452;  /**< "RTPB" in little endian. */
+    static const uint32_t s_version = 1;         /**< Current cache file version. */
+};
@@ -9,18 +9,24 @@
 
 GLuint CShaderProgram::s_activeShaderProgram = 0;
 
+CShaderProgram::CShaderProgram() : m_programId(0), m_pendingId(0), m_valid(false) {}
+
 CShaderProgram::CShaderProgram(TShaderObject<GL_VERTEX_SHADER>* vertex,
                                TShaderObject<GL_TESS_CONTROL_SHADER>* tessControl,
                                TShaderObject<GL_TESS_EVALUATION_SHADER>* tessEval,
                                TShaderObject<GL_GEOMETRY_SHADER>* geometry,
                                TShaderObject<GL_FRAGMENT_SHADER>* fragment)
-    : m_programId(0), m_valid(false)
+    : m_programId(0), m_pendingId(0), m_valid(false)
 {
     init(vertex, tessControl, tessEval, geometry, fragment);
 }
 
 CShaderProgram::~CShaderProgram()
 {
+    if (m_pendingId != 0)
+    {
+        glDeleteProgram(m_pendingId);
+    }
     if (m_valid)
     {
         glDeleteProgram(m_programId);
@@ -31,37 +37,60 @@ bool CShaderProgram::init(TShaderObject<GL_VERTEX_SHADER>* vertex,
                           TShaderObject<GL_TESS_CONTROL_SHADER>* tessControl,
                           TShaderObject<GL_TESS_EVALUATION_SHADER>* tessEval,
                           TShaderObject<GL_GEOMETRY_SHADER>* geometry,
-                          TShaderObject<GL_FRAGMENT_SHADER>* fragment)
+                          TShaderObject<GL_FRAGMENT_SHADER>* fragment, bool retrievable)
 {
     // Needs vertex shader
-    if (vertex == nullptr || !vertex->isValid())
+    if (vertex == nullptr || !vertex->finish())
     {
         return false;
     }
     // Need fragment shader
-    if (fragment == nullptr || !fragment->isValid())
+    if (fragment == nullptr || !fragment->finish())
     {
         return false;
     }
 
     // Check if any of the other shaders are invalid
     // nullptr signals unused stage
-    if (geometry != nullptr && !geometry->isValid())
+    if (geometry != nullptr && !geometry->finish())
     {
         return false;
     }
-    else if (tessControl != nullptr && !tessControl->isValid())
+    else if (tessControl != nullptr && !tessControl->finish())
     {
         return false;
     }
-    else if (tessEval != nullptr && !tessEval->isValid())
+    else if (tessEval != nullptr && !tessEval->finish())
     {
         return false;
     }
 
+    return submit(vertex, tessControl, tessEval, geometry, fragment, retrievable) && finish();
+}
+
+bool CShaderProgram::submit(TShaderObject<GL_VERTEX_SHADER>* vertex,
+                            TShaderObject<GL_TESS_CONTROL_SHADER>* tessControl,
+                            TShaderObject<GL_TESS_EVALUATION_SHADER>* tessEval,
+                            TShaderObject<GL_GEOMETRY_SHADER>* geometry,
+                            TShaderObject<GL_FRAGMENT_SHADER>* fragment, bool retrievable)
+{
+    m_infoLog.clear();
+
+    // Needs vertex and fragment shader, compile errors are reported by the link
+    if (vertex == nullptr || fragment == nullptr)
+    {
+        return false;
+    }
+
+    // Replace unfinished link
+    if (m_pendingId != 0)
+    {
+        glDeleteProgram(m_pendingId);
+        m_pendingId = 0;
+    }
+
     // Create program id
     GLuint programId = glCreateProgram();
-    // Attach shader objects after checking validity
 
     // Needed stages
     glAttachShader(programId, vertex->getId());
@@ -80,8 +109,44 @@ bool CShaderProgram::init(TShaderObject<GL_VERTEX_SHADER>* vertex,
         glAttachShader(programId, tessEval->getId());
     }
 
-    // Link program
+    // Link program, status is queried in finish
+    // Retrievable programs may be less optimized, the hint is only set for the binary cache
+    if (retrievable)
+    {
+        glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(programId);
+    m_pendingId = programId;
+    return true;
+}
+
+bool CShaderProgram::isPending() const { return m_pendingId != 0; }
+
+bool CShaderProgram::isComplete() const
+{
+    if (m_pendingId == 0)
+    {
+        return true;
+    }
+    if (!FLEXT_KHR_parallel_shader_compile)
+    {
+        // Without the extension the status can only be queried by waiting for the link
+        return false;
+    }
+    GLint complete = GL_TRUE;
+    glGetProgramiv(m_pendingId, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+bool CShaderProgram::finish()
+{
+    if (m_pendingId == 0)
+    {
+        return m_valid;
+    }
+    GLuint programId = m_pendingId;
+    m_pendingId = 0;
+
     // Check result
     GLint result;
     glGetProgramiv(programId, GL_LINK_STATUS, &result);
@@ -89,7 +154,7 @@ bool CShaderProgram::init(TShaderObject<GL_VERTEX_SHADER>* vertex,
     {
         // Set info log size
         GLint size;
-        glGetShaderiv(programId, GL_INFO_LOG_LENGTH, &size);
+        glGetProgramiv(programId, GL_INFO_LOG_LENGTH, &size);
         if (size > 0)
         {
             // Create buffer
@@ -103,10 +168,72 @@ bool CShaderProgram::init(TShaderObject<GL_VERTEX_SHADER>* vertex,
         return false;
     }
     // New shader program linked successfully
-    // Delete old shader object
+    setProgram(programId);
+    return true;
+}
+
+bool CShaderProgram::initBinary(GLenum format, const std::vector<unsigned char>& binary)
+{
+    m_infoLog.clear();
+    if (binary.empty())
+    {
+        return false;
+    }
+
+    GLuint programId = glCreateProgram();
+    glProgramBinary(programId, format, binary.data(), (GLsizei)binary.size());
+    // Drivers reject binaries of other driver versions with a link failure
+    GLint result;
+    glGetProgramiv(programId, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE)
+    {
+        m_infoLog = "Program binary rejected by driver";
+        glDeleteProgram(programId);
+        // Clear error from unknown binary format
+        std::string error;
+        hasGLError(error);
+        return false;
+    }
+    setProgram(programId);
+    return true;
+}
+
+bool CShaderProgram::getBinary(GLenum& format, std::vector<unsigned char>& binary) const
+{
+    if (!m_valid)
+    {
+        return false;
+    }
+    GLint size = 0;
+    glGetProgramiv(m_programId, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+    {
+        return false;
+    }
+    binary.resize(size);
+    GLsizei length = 0;
+    glGetProgramBinary(m_programId, size, &length, &format, binary.data());
+    binary.resize(length);
+
+    std::string error;
+    if (hasGLError(error))
+    {
+        LOG_ERROR("GL Error: %s", error.c_str());
+        return false;
+    }
+    return length > 0;
+}
+
+void CShaderProgram::setProgram(GLuint programId)
+{
+    // Delete old program object
     if (m_valid)
     {
-        glDeleteShader(m_programId);
+        if (s_activeShaderProgram == m_programId)
+        {
+            s_activeShaderProgram = 0;
+        }
+        glDeleteProgram(m_programId);
     }
     // Set new id
     m_programId = programId;
@@ -121,8 +248,6 @@ bool CShaderProgram::init(TShaderObject<GL_VERTEX_SHADER>* vertex,
     {
         LOG_ERROR("GL Error: %s", error.c_str());
     }
-
-    return true;
 }
 
 void CShaderProgram::setActive()
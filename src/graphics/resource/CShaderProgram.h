@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -14,6 +15,11 @@
 class CShaderProgram
 {
    public:
+    /**
+    * \brief Creates invalid shader program, initialized with init, submit or initBinary.
+    */
+    CShaderProgram();
+
     /**
     * \brief Creates shader program from shader objects.
     * Unused shader objects are represented by nullptr. All used shader objects
@@ -41,12 +47,56 @@ class CShaderProgram
     * from the provided shader objects. If creation fails, the shader program will
     * still be valid with the data of the former initialization and an error string
     * can still be retrieved.
+    * \param retrievable Keeps the binary retrievable for the program binary cache.
     */
     bool init(TShaderObject<GL_VERTEX_SHADER>* vertex,
               TShaderObject<GL_TESS_CONTROL_SHADER>* tessControl,
               TShaderObject<GL_TESS_EVALUATION_SHADER>* tessEval,
               TShaderObject<GL_GEOMETRY_SHADER>* geometry,
-              TShaderObject<GL_FRAGMENT_SHADER>* fragment);
+              TShaderObject<GL_FRAGMENT_SHADER>* fragment, bool retrievable = false);
+
+    /**
+    * \brief Starts linking the shader objects without waiting for the result.
+    * Shader objects may still be compiling. The status is queried by finish, so the driver can
+    * compile and link several programs in parallel. Until then the program keeps the data of the
+    * former initialization.
+    * \param retrievable Keeps the binary retrievable for the program binary cache.
+    */
+    bool submit(TShaderObject<GL_VERTEX_SHADER>* vertex,
+                TShaderObject<GL_TESS_CONTROL_SHADER>* tessControl,
+                TShaderObject<GL_TESS_EVALUATION_SHADER>* tessEval,
+                TShaderObject<GL_GEOMETRY_SHADER>* geometry,
+                TShaderObject<GL_FRAGMENT_SHADER>* fragment, bool retrievable = false);
+
+    /**
+    * \brief Returns whether a submitted link has not been finished.
+    */
+    bool isPending() const;
+
+    /**
+    * \brief Returns whether finish can be called without waiting for the driver.
+    * Polls the completion status with KHR_parallel_shader_compile. Without the extension the
+    * status is unknown and only programs without a pending link are complete.
+    */
+    bool isComplete() const;
+
+    /**
+    * \brief Waits for a submitted link and returns validity.
+    * A failed link keeps the former program and sets the error string.
+    */
+    bool finish();
+
+    /**
+    * \brief Initializes the program from a program binary.
+    * Fails if the driver rejects the binary, e.g. after a driver update. The program keeps the
+    * data of the former initialization in that case.
+    */
+    bool initBinary(GLenum format, const std::vector<unsigned char>& binary);
+
+    /**
+    * \brief Retrieves the program binary of a valid program.
+    */
+    bool getBinary(GLenum& format, std::vector<unsigned char>& binary) const;
 
     /**
     * \brief Sets the shader program as active program for vertex processing.
@@ -97,6 +147,11 @@ class CShaderProgram
     void setUniform(const std::string& uniformName, const glm::mat4& m);
 
    private:
+    /**
+    * \brief Replaces program id with a linked program and resets cached state.
+    */
+    void setProgram(GLuint programId);
+
     static GLuint s_activeShaderProgram; /**< Stores currently active shader id to prevent
                                                                              unnecessary calls to
                                             setActive. */
@@ -104,5 +159,6 @@ class CShaderProgram
         m_uniformLocations; /**< Caches uniform location ids. */
     std::string m_infoLog;
     GLuint m_programId;
+    GLuint m_pendingId; /**< Submitted program, 0 if no link is pending. */
     bool m_valid;
 };
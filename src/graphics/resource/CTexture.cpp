@@ -1,11 +1,33 @@
 #include "CTexture.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 
+#include "graphics/renderer/core/CUploadQueue.h"
 #include "graphics/renderer/debug/RendererDebug.h"
 #include <lodepng.h>
 #include "debug/Log.h"
+#include "resource/BlockCompression.h"
+#include "resource/ImageFormat.h"
+
+unsigned int CTexture::s_storageAllocations = 0;
+
+/**
+* \brief Returns sized internal format for immutable storage, unsized formats are not accepted.
+*/
+static GLenum getSizedFormat(GLint format)
+{
+    switch (format)
+    {
+    case GL_RGB:
+        return GL_RGB8;
+    case GL_RGBA:
+        return GL_RGBA8;
+    default:
+        return format;
+    }
+}
 
 CTexture::CTexture() : m_valid(false), m_textureId(0), m_width(0), m_height(0), m_format(0)
 {
@@ -47,6 +69,7 @@ CTexture::CTexture(GLint id, bool hasMipmaps, unsigned int width, unsigned int h
 
 CTexture::~CTexture()
 {
+    cancelUploads();
     if (m_valid)
     {
         glDeleteTextures(1, &m_textureId);
@@ -81,24 +104,392 @@ bool CTexture::init(unsigned int width, unsigned int height, GLint format)
     return init({}, width, height, format, false);
 }
 
-void CTexture::resize(unsigned int width, unsigned int height)
+bool CTexture::initMipChain(const std::vector<unsigned char>& data, unsigned int width,
+                            unsigned int height, EColorFormat format, unsigned int mipCount,
+                            unsigned int firstLevel)
+{
+    if (!isCompressed(format) && mipCount <= 1)
+    {
+        return init(data, width, height, format, true);
+    }
+
+    // Sanity checks
+    if (width == 0 || height == 0 || mipCount == 0 || mipCount > ::getMipCount(width, height) ||
+        data.size() != getMipChainSize(format, width, height, mipCount))
+    {
+        return false;
+    }
+    firstLevel = std::min(firstLevel, mipCount - 1);
+
+    // S3TC is optional, decompress on the CPU without driver support
+    if ((format == EColorFormat::BC1 || format == EColorFormat::BC3) &&
+        !FLEXT_EXT_texture_compression_s3tc)
+    {
+        LOG_WARNING("S3TC texture compression is not supported, decompressing texture.");
+        EColorFormat targetFormat = format == EColorFormat::BC1 ? EColorFormat::RGB24
+                                                                : EColorFormat::RGBA32;
+        unsigned int channels = getChannelCount(targetFormat);
+        std::vector<unsigned char> chain;
+        std::vector<unsigned char> level;
+        const unsigned char* source = data.data();
+        for (unsigned int i = 0; i < mipCount; ++i)
+        {
+            unsigned int levelWidth = getMipSize(width, i);
+            unsigned int levelHeight = getMipSize(height, i);
+            decompressImage(source, levelWidth, levelHeight, format, level);
+            for (size_t texel = 0; texel < level.size(); texel += 4)
+            {
+                chain.insert(chain.end(), level.begin() + texel, level.begin() + texel + channels);
+            }
+            source += getImageSize(format, levelWidth, levelHeight);
+        }
+        return initMipChain(chain, width, height, targetFormat, mipCount, firstLevel);
+    }
+
+    // Set format
+    GLint internalFormat;
+    GLenum externalFormat = 0;
+    switch (format)
+    {
+    case EColorFormat::GreyScale8:
+        internalFormat = GL_R8;
+        externalFormat = GL_RED;
+        break;
+    case EColorFormat::RGB24:
+        internalFormat = GL_RGB8;
+        externalFormat = GL_RGB;
+        break;
+    case EColorFormat::RGBA32:
+        internalFormat = GL_RGBA8;
+        externalFormat = GL_RGBA;
+        break;
+    case EColorFormat::BC1:
+        internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        break;
+    case EColorFormat::BC3:
+        internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        break;
+    case EColorFormat::BC4:
+        internalFormat = GL_COMPRESSED_RED_RGTC1;
+        break;
+    case EColorFormat::BC5:
+        internalFormat = GL_COMPRESSED_RG_RGTC2;
+        break;
+    default:
+        return false;
+    }
+
+    // Create id
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+
+    // Set filters, levels beyond the stored chain are not sampled
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    mipCount > 1 ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipCount - 1);
+
+    // Set wrap mode
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_MIRRORED_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+
+    // Upload levels
+    m_width = width;
+    m_height = height;
+    m_format = internalFormat;
+    m_externalFormat = externalFormat;
+    m_colorFormat = format;
+    uploadMipLevels(data, firstLevel, mipCount);
+
+    // Unbind
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::string error;
+    if (hasGLError(error))
+    {
+        LOG_ERROR("GL Error: %s", error.c_str());
+        glDeleteTextures(1, &textureId);
+        return false;
+    }
+
+    // Clean up previously created id
+    cancelUploads();
+    if (m_textureId != 0)
+    {
+        glDeleteTextures(1, &m_textureId);
+    }
+
+    // Set new texture id
+    m_textureId = textureId;
+    m_hasMipmaps = mipCount > 1;
+    m_bytePerPixel = 0;
+    m_mipCount = mipCount;
+    m_baseLevel = firstLevel;
+    m_chainSize = data.size() - getMipChainSize(format, width, height, firstLevel);
+    m_valid = true;
+    return true;
+}
+
+bool CTexture::loadMipLevels(const std::vector<unsigned char>& data, unsigned int firstLevel)
+{
+    if (!m_valid || m_chainSize == 0 || m_pendingUploads != 0 ||
+        data.size() != getMipChainSize(m_colorFormat, m_width, m_height, m_mipCount))
+    {
+        return false;
+    }
+    if (firstLevel >= m_baseLevel)
+    {
+        return true;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_textureId);
+    uploadMipLevels(data, firstLevel, m_baseLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::string error;
+    if (hasGLError(error))
+    {
+        LOG_ERROR("GL Error: %s", error.c_str());
+        return false;
+    }
+    m_chainSize += getMipChainSize(m_colorFormat, m_width, m_height, m_baseLevel) -
+                   getMipChainSize(m_colorFormat, m_width, m_height, firstLevel);
+    m_baseLevel = firstLevel;
+    return true;
+}
+
+bool CTexture::queueMipLevels(std::shared_ptr<const std::vector<unsigned char>> data,
+                              unsigned int firstLevel, CUploadQueue& queue)
+{
+    if (!m_valid || m_chainSize == 0 || m_pendingUploads != 0 ||
+        data->size() != getMipChainSize(m_colorFormat, m_width, m_height, m_mipCount))
+    {
+        return false;
+    }
+    if (firstLevel >= m_baseLevel)
+    {
+        return true;
+    }
+
+    // Allocate storage, levels below the base level are not sampled until they arrive
+    bool compressed = isCompressed(m_colorFormat);
+    glBindTexture(GL_TEXTURE_2D, m_textureId);
+    for (unsigned int level = firstLevel; level < m_baseLevel; ++level)
+    {
+        unsigned int levelWidth = getMipSize(m_width, level);
+        unsigned int levelHeight = getMipSize(m_height, level);
+        if (compressed)
+        {
+            glCompressedTexImage2D(
+                GL_TEXTURE_2D, level, m_format, levelWidth, levelHeight, 0,
+                (GLsizei)getImageSize(m_colorFormat, levelWidth, levelHeight), nullptr);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, m_format, levelWidth, levelHeight, 0,
+                         m_externalFormat, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::string error;
+    if (hasGLError(error))
+    {
+        LOG_ERROR("GL Error: %s", error.c_str());
+        return false;
+    }
+
+    // Coarse to fine, each arriving level becomes the new base level
+    for (unsigned int level = m_baseLevel; level-- > firstLevel;)
+    {
+        unsigned int levelWidth = getMipSize(m_width, level);
+        unsigned int levelHeight = getMipSize(m_height, level);
+        const unsigned char* levelData =
+            data->data() + getMipChainSize(m_colorFormat, m_width, m_height, level);
+        queue.addTextureUpload(m_textureId, level, levelWidth, levelHeight, m_format,
+                               m_externalFormat, compressed, data, levelData,
+                               getImageSize(m_colorFormat, levelWidth, levelHeight),
+                               [this, level]()
+                               {
+                                   glBindTexture(GL_TEXTURE_2D, m_textureId);
+                                   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+                                   glBindTexture(GL_TEXTURE_2D, 0);
+                                   m_baseLevel = level;
+                                   --m_pendingUploads;
+                               });
+        ++m_pendingUploads;
+    }
+    m_uploadQueue = &queue;
+    m_chainSize += getMipChainSize(m_colorFormat, m_width, m_height, m_baseLevel) -
+                   getMipChainSize(m_colorFormat, m_width, m_height, firstLevel);
+    return true;
+}
+
+bool CTexture::isUploadPending() const { return m_pendingUploads != 0; }
+
+void CTexture::cancelUploads()
+{
+    if (m_pendingUploads != 0)
+    {
+        m_uploadQueue->cancelTexture(m_textureId);
+        m_pendingUploads = 0;
+    }
+}
+
+bool CTexture::evictMipLevels(unsigned int firstLevel)
+{
+    if (!m_valid || m_chainSize == 0 || m_pendingUploads != 0)
+    {
+        return false;
+    }
+    firstLevel = std::min(firstLevel, m_mipCount - 1);
+    if (firstLevel <= m_baseLevel)
+    {
+        return true;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+    for (unsigned int level = m_baseLevel; level < firstLevel; ++level)
+    {
+        if (isCompressed(m_colorFormat))
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, m_format, 0, 0, 0, 0, nullptr);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, m_format, 0, 0, 0, m_externalFormat,
+                         GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::string error;
+    if (hasGLError(error))
+    {
+        LOG_ERROR("GL Error: %s", error.c_str());
+        return false;
+    }
+    m_chainSize -= getMipChainSize(m_colorFormat, m_width, m_height, firstLevel) -
+                   getMipChainSize(m_colorFormat, m_width, m_height, m_baseLevel);
+    m_baseLevel = firstLevel;
+    return true;
+}
+
+unsigned int CTexture::getBaseLevel() const { return m_baseLevel; }
+
+unsigned int CTexture::getMipCount() const { return m_mipCount; }
+
+void CTexture::uploadMipLevels(const std::vector<unsigned char>& data, unsigned int first,
+                               unsigned int last)
+{
+    // Rows of small uncompressed levels are not 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const unsigned char* levelData =
+        data.data() + getMipChainSize(m_colorFormat, m_width, m_height, first);
+    for (unsigned int level = first; level < last; ++level)
+    {
+        unsigned int levelWidth = getMipSize(m_width, level);
+        unsigned int levelHeight = getMipSize(m_height, level);
+        GLsizei levelSize = (GLsizei)getImageSize(m_colorFormat, levelWidth, levelHeight);
+        if (isCompressed(m_colorFormat))
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, m_format, levelWidth, levelHeight, 0,
+                                   levelSize, levelData);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, m_format, levelWidth, levelHeight, 0,
+                         m_externalFormat, GL_UNSIGNED_BYTE, levelData);
+        }
+        levelData += levelSize;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+bool CTexture::resize(unsigned int width, unsigned int height)
 {
     if (m_width == width && m_height == height)
     {
-        return;
+        return false;
     }
     LOG_DEBUG("Texture resize from %u, %u to %u, %u.", m_width, m_height, width, height);
+    if (m_immutable)
+    {
+        // Immutable storage cannot be respecified, the texture object is replaced
+        // Sampling parameters are carried over to the new object
+        const GLenum parameters[] = {GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER,
+                                     GL_TEXTURE_WRAP_S,     GL_TEXTURE_WRAP_T,
+                                     GL_TEXTURE_COMPARE_MODE, GL_TEXTURE_COMPARE_FUNC};
+        const unsigned int parameterCount = sizeof(parameters) / sizeof(parameters[0]);
+        GLint values[parameterCount];
+        glBindTexture(GL_TEXTURE_2D, m_textureId);
+        for (unsigned int i = 0; i < parameterCount; ++i)
+        {
+            glGetTexParameteriv(GL_TEXTURE_2D, parameters[i], &values[i]);
+        }
+        if (!init({}, width, height, m_format, m_hasMipmaps))
+        {
+            LOG_ERROR("Failed to reallocate texture with size %u, %u.", width, height);
+            return false;
+        }
+        glBindTexture(GL_TEXTURE_2D, m_textureId);
+        for (unsigned int i = 0; i < parameterCount; ++i)
+        {
+            glTexParameteri(GL_TEXTURE_2D, parameters[i], values[i]);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return true;
+    }
     glBindTexture(GL_TEXTURE_2D, m_textureId);
     glTexImage2D(GL_TEXTURE_2D, 0, m_format, width, height, 0, m_externalFormat, GL_UNSIGNED_BYTE,
                  nullptr);
     m_width = width;
     m_height = height;
+    ++s_storageAllocations;
+    return false;
 }
 
+unsigned int CTexture::getStorageAllocationCount() { return s_storageAllocations; }
+
+unsigned int CTexture::getWidth() const { return m_width; }
+
+unsigned int CTexture::getHeight() const { return m_height; }
+
+EColorFormat CTexture::getColorFormat() const { return m_colorFormat; }
+
 GLuint CTexture::getId() const { return m_textureId; }
 
 bool CTexture::isValid() const { return m_valid; }
 
+size_t CTexture::getMemorySize() const
+{
+    if (m_chainSize != 0)
+    {
+        return m_chainSize;
+    }
+
+    size_t size = static_cast<size_t>(m_width) * m_height * m_bytePerPixel;
+    if (!m_hasMipmaps || m_width == 1 || m_height == 1)
+    {
+        return size;
+    }
+
+    // Sum up mipmap chain down to 1x1
+    unsigned int width = m_width;
+    unsigned int height = m_height;
+    while (width > 1 || height > 1)
+    {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        size += static_cast<size_t>(width) * height * m_bytePerPixel;
+    }
+    return size;
+}
+
 void CTexture::setActive(GLint textureUnit) const
 {
     assert(isValid());
@@ -142,6 +533,11 @@ bool CTexture::init(const std::vector<unsigned char>& image, unsigned int width,
         m_externalFormat = GL_RG;
         bytePerPixel = 2;
         break;
+    case GL_RG16:  // Red and green component with 16 bit unsigned normalized precision
+        m_externalFormat = GL_RG;
+        bytePerPixel = 4;
+        type = GL_UNSIGNED_SHORT;
+        break;
     case GL_RGB:  // RGB texture with values from 0-255
     case GL_RGB8:
         m_externalFormat = GL_RGB;
@@ -210,11 +606,24 @@ bool CTexture::init(const std::vector<unsigned char>& image, unsigned int width,
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
 
 	// Load data
+	bool immutable = false;
 	if (image.empty())
 	{
 		// No image data, only allocate texture space
-		// TODO As of OpenGL 4.3, glTexStorage should be used for this.
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, m_externalFormat, type, nullptr);
+		// Immutable storage lets the driver skip consistency checks on use, it is replaced by a
+		// new texture object on resize
+		if (FLEXT_ARB_texture_storage)
+		{
+			GLsizei levels = createMipmaps ? ::getMipCount(width, height) : 1;
+			glTexStorage2D(GL_TEXTURE_2D, levels, getSizedFormat(format), width, height);
+			immutable = true;
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, m_externalFormat, type,
+						 nullptr);
+		}
+		++s_storageAllocations;
 	}
 	else
 	{
@@ -241,6 +650,7 @@ bool CTexture::init(const std::vector<unsigned char>& image, unsigned int width,
     }
 
     // Clean up previously created id
+    cancelUploads();
     if (m_textureId != 0)
     {
         glDeleteTextures(1, &m_textureId);
@@ -250,6 +660,12 @@ bool CTexture::init(const std::vector<unsigned char>& image, unsigned int width,
     m_textureId = textureId;
     m_width = width;
     m_height = height;
+    m_bytePerPixel = bytePerPixel;
+    m_chainSize = 0;
+    m_colorFormat = EColorFormat::Invalid;
+    m_mipCount = 1;
+    m_baseLevel = 0;
+    m_immutable = immutable;
     m_valid = true;
     return true;
 }
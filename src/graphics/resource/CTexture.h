@@ -1,10 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "graphics/renderer/core/RendererCoreConfig.h"
 #include "resource/ResourceConfig.h"
 
+class CUploadQueue;
+
 /**
  * \brief Texture class.
  */
@@ -41,9 +44,78 @@ class CTexture
     bool init(unsigned int width, unsigned int height, GLint format);
 
     /**
-    * \brief Resizes texture.
+    * \brief Initializes texture from a precomputed mip chain.
+    * The data contains mipCount levels, starting with the largest level. Block compressed data is
+    * uploaded as is, no mipmaps are generated on upload. Uncompressed data with a single level
+    * falls back to init with mipmap generation.
+    * Only levels from firstLevel on are uploaded, finer levels can be streamed in later with
+    * loadMipLevels.
+    */
+    bool initMipChain(const std::vector<unsigned char>& data, unsigned int width,
+                      unsigned int height, EColorFormat format, unsigned int mipCount,
+                      unsigned int firstLevel = 0);
+
+    /**
+    * \brief Uploads finer mip levels of a texture created with initMipChain.
+    * Levels from firstLevel up to the current base level are taken from the full mip chain data
+    * and the base level is lowered to firstLevel.
+    */
+    bool loadMipLevels(const std::vector<unsigned char>& data, unsigned int firstLevel);
+
+    /**
+    * \brief Queues upload of finer mip levels of a texture created with initMipChain.
+    * Storage for the levels is allocated immediately and the data is uploaded by the queue over
+    * the following frames. The base level is lowered as the levels arrive, coarse to fine.
+    */
+    bool queueMipLevels(std::shared_ptr<const std::vector<unsigned char>> data,
+                        unsigned int firstLevel, CUploadQueue& queue);
+
+    /**
+    * \brief Returns whether queued mip levels have not been uploaded yet.
+    */
+    bool isUploadPending() const;
+
+    /**
+    * \brief Releases mip levels finer than firstLevel of a texture created with initMipChain.
+    * The base level is raised to firstLevel and the released levels are redefined empty, so the
+    * driver can free their storage. The coarsest level is never released. Fails while uploads
+    * are pending.
+    */
+    bool evictMipLevels(unsigned int firstLevel);
+
+    /**
+    * \brief Returns finest uploaded mip level.
+    */
+    unsigned int getBaseLevel() const;
+
+    /**
+    * \brief Returns number of mip levels of the texture.
+    */
+    unsigned int getMipCount() const;
+
+    /**
+    * \brief Resizes texture, contents are undefined afterwards.
+    * Textures with immutable storage are replaced by a new texture object. Returns true if the
+    * texture id changed and the texture has to be attached again.
+    */
+    bool resize(unsigned int width, unsigned int height);
+
+    /**
+    * \brief Returns number of storage allocations of textures without image data.
+    * Counts render target allocations and resizes since startup.
+    */
+    static unsigned int getStorageAllocationCount();
+
+    /**
+    * \brief Returns size of the largest mip level.
+    */
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+
+    /**
+    * \brief Returns color format of the uploaded mip chain, invalid for other textures.
     */
-    void resize(unsigned int width, unsigned int height);
+    EColorFormat getColorFormat() const;
 
     /**
     * \brief Returns texture id.
@@ -55,6 +127,11 @@ class CTexture
     */
     bool isValid() const;
 
+    /**
+    * \brief Returns GPU memory size in bytes, including mipmap levels.
+    */
+    size_t getMemorySize() const;
+
     /**
     * \bref Sets texture active as texture unit.
     */
@@ -70,6 +147,17 @@ class CTexture
               GLint format, bool createMipmaps);
 
    private:
+    /**
+    * \brief Drops queued uploads of the current texture object.
+    */
+    void cancelUploads();
+
+    /**
+    * \brief Uploads mip levels from first up to but excluding last to the bound texture.
+    */
+    void uploadMipLevels(const std::vector<unsigned char>& data, unsigned int first,
+                         unsigned int last);
+
     bool m_valid;
     bool m_hasMipmaps = false;
     GLuint m_textureId;
@@ -77,4 +165,14 @@ class CTexture
     unsigned int m_height;
     GLint m_format;
     GLenum m_externalFormat;
+    unsigned int m_bytePerPixel = 0; /**< Size of a texel in bytes, 0 if unknown. */
+    size_t m_chainSize = 0; /**< Size of uploaded mip chain in bytes, 0 if generated on upload. */
+    EColorFormat m_colorFormat = EColorFormat::Invalid; /**< Format of the uploaded mip chain. */
+    unsigned int m_mipCount = 1;  /**< Number of mip levels of the mip chain. */
+    unsigned int m_baseLevel = 0; /**< Finest uploaded mip level. */
+    CUploadQueue* m_uploadQueue = nullptr; /**< Queue of pending mip level uploads. */
+    unsigned int m_pendingUploads = 0;     /**< Number of queued mip level uploads. */
+    bool m_immutable = false; /**< Storage was allocated with glTexStorage2D. */
+
+    static unsigned int s_storageAllocations; /**< Storage allocations without image data. */
 };
@@ -0,0 +1,414 @@
+#include "CTextureStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "graphics/ICamera.h"
+#include "graphics/IGraphicsResourceManager.h"
+#include "graphics/IScene.h"
+#include "graphics/ISceneQuery.h"
+#include "graphics/renderer/core/CUploadQueue.h"
+#include "graphics/resource/CMesh.h"
+#include "graphics/resource/CTexture.h"
+
+#include "resource/IResourceManager.h"
+#include "resource/ImageFormat.h"
+
+#include "debug/Log.h"
+
+CTextureStreamer::CTextureStreamer(IResourceManager* resourceManager,
+                                   IGraphicsResourceManager* graphicsResourceManager)
+    : m_resourceManager(resourceManager), m_graphicsResourceManager(graphicsResourceManager)
+{
+    return;
+}
+
+CTextureStreamer::~CTextureStreamer()
+{
+    // Loader threads write into the pending reads
+    for (const auto& read : m_pendingReads)
+    {
+        if (!read->m_loaded)
+        {
+            read->m_ready.wait();
+        }
+    }
+}
+
+void CTextureStreamer::setMemoryBudget(size_t bytes) { m_memoryBudget = bytes; }
+
+void CTextureStreamer::setUploadLimit(size_t bytes) { m_uploadLimit = bytes; }
+
+void CTextureStreamer::setMipBias(float bias) { m_mipBias = bias; }
+
+void CTextureStreamer::setUploadQueue(CUploadQueue* uploadQueue) { m_uploadQueue = uploadQueue; }
+
+void CTextureStreamer::update(const IScene& scene, const ICamera& camera,
+                              unsigned int viewportHeight)
+{
+    ++m_frame;
+    updateRequiredLevels(scene, camera, viewportHeight);
+
+    // Forget unloaded textures and sum up memory of the remaining ones
+    m_memoryUsage = 0;
+    for (auto entry = m_textures.begin(); entry != m_textures.end();)
+    {
+        const CTexture* texture = m_graphicsResourceManager->getTexture(entry->first);
+        if (texture == nullptr)
+        {
+            entry = m_textures.erase(entry);
+            continue;
+        }
+        m_memoryUsage += texture->getMemorySize();
+        ++entry;
+    }
+
+    // Budget may have been lowered or textures have been recreated
+    reserve(0);
+
+    uploadLevels();
+    requestLevels();
+}
+
+size_t CTextureStreamer::getMemoryUsage() const { return m_memoryUsage; }
+
+unsigned int CTextureStreamer::getPendingCount() const
+{
+    return (unsigned int)m_pendingReads.size();
+}
+
+unsigned int CTextureStreamer::getResidentLevel(unsigned int mipCount)
+{
+    // Full mip chains end with a 1x1 level, so the level of size s is mipCount - 1 - log2(s)
+    unsigned int residentLevels = 1;
+    while ((1u << (residentLevels - 1)) < s_residentSize)
+    {
+        ++residentLevels;
+    }
+    return mipCount > residentLevels ? mipCount - residentLevels : 0;
+}
+
+void CTextureStreamer::updateRequiredLevels(const IScene& scene, const ICamera& camera,
+                                            unsigned int viewportHeight)
+{
+    // Projected diameter in pixels of the largest visible object per material
+    std::unordered_map<ResourceId, float> materialSizes;
+    float pixelScale = camera.getProjection()[1][1] * viewportHeight;
+    glm::vec3 cameraPosition = camera.getPosition();
+
+    std::unique_ptr<ISceneQuery> query(scene.createQuery(camera));
+    while (query->hasNextObject())
+    {
+        ResourceId meshId = invalidResource;
+        ResourceId materialId = invalidResource;
+        glm::vec3 position;
+        glm::vec3 rotation;
+        glm::vec3 scale;
+        if (!scene.getObject(query->getNextObject(), meshId, materialId, position, rotation,
+                             scale))
+        {
+            continue;
+        }
+        const CMesh* mesh = m_graphicsResourceManager->getMesh(meshId);
+        if (mesh == nullptr || materialId == invalidResource)
+        {
+            continue;
+        }
+
+        float radius = mesh->getBoundingRadius() *
+                       std::max(std::abs(scale.x), std::max(std::abs(scale.y), std::abs(scale.z)));
+        float distance = std::max(glm::length(position - cameraPosition), 0.01f);
+        float size = radius * pixelScale / distance;
+        float& materialSize = materialSizes[materialId];
+        materialSize = std::max(materialSize, size);
+    }
+
+    for (const auto& material : materialSizes)
+    {
+        ResourceId images[5];
+        ResourceId customShader;
+        if (!m_resourceManager->getMaterial(material.first, images[0], images[1], images[2],
+                                            images[3], images[4], customShader))
+        {
+            continue;
+        }
+        for (ResourceId image : images)
+        {
+            const CTexture* texture = m_graphicsResourceManager->getTexture(image);
+            if (image == invalidResource || texture == nullptr || texture->getMipCount() <= 1)
+            {
+                continue;
+            }
+
+            unsigned int level = getRequiredLevel(texture->getMipCount(), material.second);
+            auto entry = m_textures.find(image);
+            if (entry == m_textures.end())
+            {
+                STextureState state = {level, m_frame, true};
+                m_textures.insert(std::make_pair(image, state));
+            }
+            else if (entry->second.m_lastUsedFrame != m_frame)
+            {
+                entry->second.m_requiredLevel = level;
+                entry->second.m_lastUsedFrame = m_frame;
+            }
+            else
+            {
+                entry->second.m_requiredLevel = std::min(entry->second.m_requiredLevel, level);
+            }
+        }
+    }
+}
+
+void CTextureStreamer::uploadLevels()
+{
+    size_t uploaded = 0;
+    for (auto entry = m_pendingReads.begin(); entry != m_pendingReads.end();)
+    {
+        SPendingRead& read = **entry;
+        auto state = m_textures.find(read.m_image);
+        if (!read.m_loaded)
+        {
+            if (read.m_ready.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                ++entry;
+                continue;
+            }
+            read.m_loaded = true;
+            if (!read.m_ready.get())
+            {
+                if (state != m_textures.end())
+                {
+                    state->second.m_streamable = false;
+                }
+                entry = m_pendingReads.erase(entry);
+                continue;
+            }
+        }
+
+        // Texture may have been unloaded or left the view while reading
+        CTexture* texture = m_graphicsResourceManager->getTexture(read.m_image);
+        if (texture == nullptr || state == m_textures.end() ||
+            state->second.m_lastUsedFrame != m_frame)
+        {
+            entry = m_pendingReads.erase(entry);
+            continue;
+        }
+
+        unsigned int target = state->second.m_requiredLevel;
+        if (m_uploadQueue != nullptr)
+        {
+            // Reserve memory for the missing levels, the queue spreads the copies over frames
+            unsigned int firstLevel = texture->getBaseLevel();
+            size_t reserved = 0;
+            while (firstLevel > target)
+            {
+                size_t bytes = getImageSize(read.m_format, getMipSize(read.m_width, firstLevel - 1),
+                                            getMipSize(read.m_height, firstLevel - 1));
+                if (!reserve(bytes))
+                {
+                    break;
+                }
+                m_memoryUsage += bytes;
+                reserved += bytes;
+                --firstLevel;
+            }
+            std::shared_ptr<std::vector<unsigned char>> chain =
+                std::make_shared<std::vector<unsigned char>>();
+            chain->swap(read.m_data);
+            if (firstLevel < texture->getBaseLevel() &&
+                !texture->queueMipLevels(chain, firstLevel, *m_uploadQueue))
+            {
+                m_memoryUsage -= reserved;
+                state->second.m_streamable =
+                    reinitTexture(*texture, *chain, read, firstLevel);
+            }
+            entry = m_pendingReads.erase(entry);
+            continue;
+        }
+
+        // Upload one level at a time, coarse to fine
+        bool done = false;
+        while (!done && texture->getBaseLevel() > target)
+        {
+            unsigned int level = texture->getBaseLevel() - 1;
+            size_t bytes = getImageSize(read.m_format, getMipSize(read.m_width, level),
+                                        getMipSize(read.m_height, level));
+            if (m_uploadLimit != 0 && uploaded != 0 && uploaded + bytes > m_uploadLimit)
+            {
+                break;
+            }
+            if (!reserve(bytes))
+            {
+                // Stay at the coarser level until memory is available
+                done = true;
+                continue;
+            }
+            if (texture->loadMipLevels(read.m_data, level))
+            {
+                m_memoryUsage += bytes;
+                uploaded += bytes;
+                continue;
+            }
+            state->second.m_streamable =
+                reinitTexture(*texture, read.m_data, read, target);
+            uploaded += texture->getMemorySize();
+            done = true;
+        }
+
+        if (done || texture->getBaseLevel() <= target)
+        {
+            entry = m_pendingReads.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+}
+
+bool CTextureStreamer::reinitTexture(CTexture& texture, const std::vector<unsigned char>& data,
+                                     const SPendingRead& read, unsigned int firstLevel)
+{
+    // Uploaded format differs from the stored chain, e.g. decompressed S3TC
+    LOG_DEBUG("Reinitializing streamed texture of image id %lli.", (long long)read.m_image);
+    size_t previousSize = texture.getMemorySize();
+    bool success = texture.initMipChain(data, read.m_width, read.m_height, read.m_format,
+                                        read.m_mipCount, firstLevel);
+    if (!success)
+    {
+        LOG_WARNING("Failed to stream texture of image id %lli.", (long long)read.m_image);
+    }
+    m_memoryUsage += texture.getMemorySize() - previousSize;
+    return success;
+}
+
+void CTextureStreamer::requestLevels()
+{
+    if (m_pendingReads.size() >= s_maxPendingReads)
+    {
+        return;
+    }
+
+    // Largest missing detail first
+    std::vector<std::pair<unsigned int, ResourceId>> requests;
+    for (const auto& entry : m_textures)
+    {
+        const STextureState& state = entry.second;
+        if (state.m_lastUsedFrame != m_frame || !state.m_streamable)
+        {
+            continue;
+        }
+        const CTexture* texture = m_graphicsResourceManager->getTexture(entry.first);
+        if (texture->getBaseLevel() <= state.m_requiredLevel || texture->isUploadPending())
+        {
+            continue;
+        }
+        bool pending = false;
+        for (const auto& read : m_pendingReads)
+        {
+            pending = pending || read->m_image == entry.first;
+        }
+        if (!pending)
+        {
+            requests.push_back(
+                std::make_pair(texture->getBaseLevel() - state.m_requiredLevel, entry.first));
+        }
+    }
+    std::sort(requests.begin(), requests.end(),
+              [](const std::pair<unsigned int, ResourceId>& a,
+                 const std::pair<unsigned int, ResourceId>& b)
+              {
+                  return a.first > b.first;
+              });
+
+    for (const auto& request : requests)
+    {
+        if (m_pendingReads.size() >= s_maxPendingReads)
+        {
+            break;
+        }
+
+        // Reading is pointless if not even the next level fits
+        const CTexture* texture = m_graphicsResourceManager->getTexture(request.second);
+        unsigned int level = texture->getBaseLevel() - 1;
+        size_t bytes =
+            getImageSize(texture->getColorFormat(), getMipSize(texture->getWidth(), level),
+                         getMipSize(texture->getHeight(), level));
+        if (!reserve(bytes))
+        {
+            continue;
+        }
+
+        std::unique_ptr<SPendingRead> read(new SPendingRead);
+        read->m_image = request.second;
+        read->m_width = 0;
+        read->m_height = 0;
+        read->m_format = EColorFormat::Invalid;
+        read->m_mipCount = 0;
+        read->m_loaded = false;
+        read->m_ready =
+            m_resourceManager->readImageAsync(read->m_image, read->m_data, read->m_width,
+                                              read->m_height, read->m_format, read->m_mipCount);
+        m_pendingReads.push_back(std::move(read));
+    }
+}
+
+bool CTextureStreamer::reserve(size_t bytes)
+{
+    if (m_memoryBudget == 0 || m_memoryUsage + bytes <= m_memoryBudget)
+    {
+        return true;
+    }
+
+    // Least recently visible first, visible textures come last
+    std::vector<std::pair<uint64_t, ResourceId>> candidates;
+    for (const auto& entry : m_textures)
+    {
+        candidates.push_back(std::make_pair(entry.second.m_lastUsedFrame, entry.first));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto& candidate : candidates)
+    {
+        CTexture* texture = m_graphicsResourceManager->getTexture(candidate.second);
+        const STextureState& state = m_textures.at(candidate.second);
+
+        // Never evict below the levels loaded on creation
+        unsigned int level = getResidentLevel(texture->getMipCount());
+        if (state.m_lastUsedFrame == m_frame)
+        {
+            level = std::min(level, state.m_requiredLevel);
+        }
+        if (texture->getBaseLevel() >= level)
+        {
+            continue;
+        }
+
+        size_t previousSize = texture->getMemorySize();
+        if (texture->evictMipLevels(level))
+        {
+            m_memoryUsage -= previousSize - texture->getMemorySize();
+        }
+        if (m_memoryUsage + bytes <= m_memoryBudget)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int CTextureStreamer::getRequiredLevel(unsigned int mipCount, float size) const
+{
+    // The level of size s is mipCount - 1 - log2(s), finer levels are never sampled
+    float level = (float)(mipCount - 1) - std::log2(std::max(size, 1.f)) + m_mipBias;
+    if (level <= 0.f)
+    {
+        return 0;
+    }
+    return std::min((unsigned int)level, mipCount - 1);
+}
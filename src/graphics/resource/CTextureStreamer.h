@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "resource/ResourceConfig.h"
+
+class ICamera;
+class IScene;
+class IResourceManager;
+class IGraphicsResourceManager;
+class CTexture;
+class CUploadQueue;
+
+/**
+* \brief Streams texture mip levels by the screen size of visible objects.
+* Textures are created with their coarse levels only, see CGraphicsResourceManager. Every frame
+* the required mip level of each material texture is estimated from the projected size of the
+* visible objects using it. Missing finer levels are read on a loader thread and uploaded over
+* several frames within a byte limit per frame. Finer levels of textures, which are not required,
+* are evicted while the streamed textures exceed the memory budget.
+*/
+class CTextureStreamer
+{
+   public:
+    CTextureStreamer(IResourceManager* resourceManager,
+                     IGraphicsResourceManager* graphicsResourceManager);
+
+    /**
+    * \brief Waits for pending reads.
+    */
+    ~CTextureStreamer();
+
+    /**
+    * \brief Sets GPU memory budget for streamed textures in bytes, 0 for unlimited.
+    */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+    * \brief Sets number of bytes uploaded per frame, 0 for unlimited.
+    * At least one level is uploaded per frame.
+    */
+    void setUploadLimit(size_t bytes);
+
+    /**
+    * \brief Sets queue for asynchronous uploads of streamed levels.
+    * The upload limit of the queue applies instead of the upload limit of the streamer.
+    */
+    void setUploadQueue(CUploadQueue* uploadQueue);
+
+    /**
+    * \brief Sets bias added to the estimated mip level, negative values select finer levels.
+    */
+    void setMipBias(float bias);
+
+    /**
+    * \brief Estimates required levels for the visible objects and streams levels in and out.
+    */
+    void update(const IScene& scene, const ICamera& camera, unsigned int viewportHeight);
+
+    /**
+    * \brief Returns GPU memory of streamed textures in bytes.
+    */
+    size_t getMemoryUsage() const;
+
+    /**
+    * \brief Returns number of textures waiting for data or upload.
+    */
+    unsigned int getPendingCount() const;
+
+    /**
+    * \brief Returns finest level of a mip chain, which is loaded on texture creation.
+    */
+    static unsigned int getResidentLevel(unsigned int mipCount);
+
+   private:
+    /**
+    * \brief Streaming state of a texture.
+    */
+    struct STextureState
+    {
+        unsigned int m_requiredLevel; /**< Finest level required in the last visible frame. */
+        uint64_t m_lastUsedFrame;     /**< Last frame the texture was visible. */
+        bool m_streamable;            /**< Levels can be streamed in. */
+    };
+
+    /**
+    * \brief Image data read for streaming finer levels.
+    */
+    struct SPendingRead
+    {
+        ResourceId m_image;                /**< Image id of the texture. */
+        std::future<bool> m_ready;         /**< Becomes ready once the data is read. */
+        std::vector<unsigned char> m_data; /**< Full mip chain. */
+        unsigned int m_width;              /**< Image width. */
+        unsigned int m_height;             /**< Image height. */
+        EColorFormat m_format;             /**< Color format of the mip chain. */
+        unsigned int m_mipCount;           /**< Number of levels in the mip chain. */
+        bool m_loaded;                     /**< Result of the read has been retrieved. */
+    };
+
+    /**
+    * \brief Updates required levels from the projected size of visible objects.
+    */
+    void updateRequiredLevels(const IScene& scene, const ICamera& camera,
+                              unsigned int viewportHeight);
+
+    /**
+    * \brief Uploads levels of finished reads within the upload limit.
+    */
+    void uploadLevels();
+
+    /**
+    * \brief Recreates texture from the mip chain, if levels can not be added to it.
+    * Returns false if the texture can not be streamed.
+    */
+    bool reinitTexture(CTexture& texture, const std::vector<unsigned char>& data,
+                       const SPendingRead& read, unsigned int firstLevel);
+
+    /**
+    * \brief Starts reads for visible textures, which lack required levels.
+    */
+    void requestLevels();
+
+    /**
+    * \brief Evicts surplus levels until the bytes fit into the budget.
+    * Textures, which were not visible for the longest time, are evicted first. Visible textures
+    * only lose levels finer than required. Returns false if the bytes do not fit.
+    */
+    bool reserve(size_t bytes);
+
+    /**
+    * \brief Returns required level for an object of the projected size in pixels.
+    */
+    unsigned int getRequiredLevel(unsigned int mipCount, float size) const;
+
+    IResourceManager* m_resourceManager;                 /**< Source of image data. */
+    IGraphicsResourceManager* m_graphicsResourceManager; /**< Owner of streamed textures. */
+    size_t m_memoryBudget = 0;                           /**< Memory budget, 0 for unlimited. */
+    size_t m_uploadLimit = 0;                            /**< Bytes per frame, 0 for unlimited. */
+    float m_mipBias = 0.f;                               /**< Bias for required levels. */
+    CUploadQueue* m_uploadQueue = nullptr;               /**< Optional asynchronous uploads. */
+    uint64_t m_frame = 0;                                /**< Current frame. */
+    size_t m_memoryUsage = 0; /**< Memory of streamed textures in the current frame. */
+
+    std::unordered_map<ResourceId, STextureState>
+        m_textures; /**< Streaming state per image id of visible textures. */
+    std::list<std::unique_ptr<SPendingRead>> m_pendingReads; /**< Reads in submission order. */
+
+    static const unsigned int s_residentSize = 64;   /**< Largest size loaded on creation. */
+    static const unsigned int s_maxPendingReads = 4; /**< Reads in flight. */
+};
@@ -14,6 +14,11 @@ template <GLenum ShaderType>
 class TShaderObject
 {
    public:
+    /**
+    * \brief Creates invalid shader object, initialized with init or submit.
+    */
+    TShaderObject();
+
     /**
     * \brief Creates shader object from shader type and source code.
     */
@@ -25,13 +30,32 @@ class TShaderObject
     */
     bool init(const std::string& source);
 
+    /**
+    * \brief Starts compiling new source code without waiting for the result.
+    * The compile status is queried by finish, so the driver can compile several shaders in
+    * parallel. Until then getId returns the new object, which can already be attached to
+    * programs, and the shader keeps the validity of the former initialization.
+    */
+    bool submit(const std::string& source);
+
+    /**
+    * \brief Waits for a submitted compile and returns validity.
+    * A failed compile keeps the former shader object and sets the error string.
+    */
+    bool finish();
+
+    /**
+    * \brief Returns whether a submitted compile has not been finished.
+    */
+    bool isPending() const;
+
     /**
     * \brief Returns compile error string if a previous call to init returned false.
     */
     const std::string& getErrorString() const;
 
     /**
-    * \brief Returns shader object id.
+    * \brief Returns shader object id, the submitted object while a compile is pending.
     */
     GLuint getId() const;
 
@@ -43,12 +67,19 @@ class TShaderObject
    private:
     std::string m_infoLog;
     GLuint m_objectId;
+    GLuint m_pendingId; /**< Submitted object, 0 if no compile is pending. */
     bool m_valid;
 };
 
+template <GLenum ShaderType>
+TShaderObject<ShaderType>::TShaderObject()
+    : m_objectId(0), m_pendingId(0), m_valid(false)
+{
+}
+
 template <GLenum ShaderType>
 TShaderObject<ShaderType>::TShaderObject(const std::string& source)
-    : m_objectId(0), m_valid(false)
+    : m_objectId(0), m_pendingId(0), m_valid(false)
 {
     init(source);
 }
@@ -56,15 +87,29 @@ TShaderObject<ShaderType>::TShaderObject(const std::string& source)
 template <GLenum ShaderType>
 TShaderObject<ShaderType>::~TShaderObject()
 {
+    glDeleteShader(m_pendingId);
     glDeleteShader(m_objectId);
 }
 
 template <GLenum ShaderType>
 bool TShaderObject<ShaderType>::init(const std::string& source)
+{
+    return submit(source) && finish();
+}
+
+template <GLenum ShaderType>
+bool TShaderObject<ShaderType>::submit(const std::string& source)
 {
     // Clean info log
     m_infoLog.clear();
 
+    // Replace unfinished compile
+    if (m_pendingId != 0)
+    {
+        glDeleteShader(m_pendingId);
+        m_pendingId = 0;
+    }
+
     // Create new id
     GLuint objectId = glCreateShader(ShaderType);
     if (objectId == 0)
@@ -77,8 +122,21 @@ bool TShaderObject<ShaderType>::init(const std::string& source)
     const GLchar* sourcePtr = source.data();
     glShaderSource(objectId, 1, &sourcePtr, NULL);
 
-    // Compile
+    // Compile, status is queried in finish
     glCompileShader(objectId);
+    m_pendingId = objectId;
+    return true;
+}
+
+template <GLenum ShaderType>
+bool TShaderObject<ShaderType>::finish()
+{
+    if (m_pendingId == 0)
+    {
+        return m_valid;
+    }
+    GLuint objectId = m_pendingId;
+    m_pendingId = 0;
 
     // Check error
     GLint result;
@@ -128,10 +186,16 @@ const std::string& TShaderObject<ShaderType>::getErrorString() const
     return m_infoLog;
 }
 
+template <GLenum ShaderType>
+bool TShaderObject<ShaderType>::isPending() const
+{
+    return m_pendingId != 0;
+}
+
 template <GLenum ShaderType>
 GLuint TShaderObject<ShaderType>::getId() const
 {
-    return m_objectId;
+    return m_pendingId != 0 ? m_pendingId : m_objectId;
 }
 
 template <GLenum ShaderType>
@@ -0,0 +1,417 @@
+#include "COcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RTR_OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "util/CThreadPool.h"
+
+/**
+* \brief Returns position of the vertex on the near plane between two clip space vertices.
+*/
+static glm::vec4 clipNear(const glm::vec4& inside, const glm::vec4& outside)
+{
+    // Near plane is z = -w
+    float distanceInside = inside.z + inside.w;
+    float distanceOutside = outside.z + outside.w;
+    float t = distanceInside / (distanceInside - distanceOutside);
+    return inside + (outside - inside) * t;
+}
+
+COcclusionBuffer::COcclusionBuffer(unsigned int width, unsigned int height)
+{
+    m_tilesX = std::max(1u, (width + s_tileWidth - 1) / s_tileWidth);
+    m_tilesY = std::max(1u, (height + s_tileHeight - 1) / s_tileHeight);
+    m_width = m_tilesX * s_tileWidth;
+    m_height = m_tilesY * s_tileHeight;
+    m_blocksX = m_width / s_blockSize;
+    m_blocksY = m_height / s_blockSize;
+
+    m_depth.resize(m_width * m_height, 1.f);
+    m_blockDepth.resize(m_blocksX * m_blocksY, 1.f);
+    m_bins.resize(m_tilesX * m_tilesY);
+    setSimd(true);
+}
+
+void COcclusionBuffer::setThreadPool(CThreadPool* pool) { m_pool = pool; }
+
+void COcclusionBuffer::setSimd(bool enabled)
+{
+#ifdef RTR_OCCLUSION_SSE2
+    m_simd = enabled;
+#else
+    (void)enabled;
+#endif
+}
+
+bool COcclusionBuffer::isSimd() const { return m_simd; }
+
+void COcclusionBuffer::begin(const glm::mat4& viewProjection)
+{
+    m_viewProjection = viewProjection;
+    // Storage is kept for the next frame
+    m_triangles.clear();
+    for (auto& bin : m_bins)
+    {
+        bin.clear();
+    }
+}
+
+void COcclusionBuffer::addOccluder(const glm::mat4& model, const std::vector<float>& vertices,
+                                   const std::vector<unsigned int>& indices)
+{
+    glm::mat4 modelViewProjection = m_viewProjection * model;
+    unsigned int vertexCount = (unsigned int)vertices.size() / 3;
+    m_clipVertices.resize(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        m_clipVertices[i] = modelViewProjection * glm::vec4(vertices[i * 3], vertices[i * 3 + 1],
+                                                            vertices[i * 3 + 2], 1.f);
+    }
+
+    for (unsigned int i = 0; i + 2 < indices.size(); i += 3)
+    {
+        if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount ||
+            indices[i + 2] >= vertexCount)
+        {
+            continue;
+        }
+        const glm::vec4* triangle[3] = {&m_clipVertices[indices[i]],
+                                        &m_clipVertices[indices[i + 1]],
+                                        &m_clipVertices[indices[i + 2]]};
+
+        // Clip against the near plane, which keeps w positive
+        glm::vec4 polygon[4];
+        unsigned int polygonSize = 0;
+        for (unsigned int j = 0; j < 3; ++j)
+        {
+            const glm::vec4& current = *triangle[j];
+            const glm::vec4& next = *triangle[(j + 1) % 3];
+            bool currentInside = current.z + current.w >= 0.f;
+            bool nextInside = next.z + next.w >= 0.f;
+            if (currentInside)
+            {
+                polygon[polygonSize++] = current;
+            }
+            if (currentInside != nextInside)
+            {
+                polygon[polygonSize++] =
+                    currentInside ? clipNear(current, next) : clipNear(next, current);
+            }
+        }
+
+        // Triangle fan of the clipped polygon
+        for (unsigned int j = 2; j < polygonSize; ++j)
+        {
+            addTriangle(polygon[0], polygon[j - 1], polygon[j]);
+        }
+    }
+}
+
+void COcclusionBuffer::addTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2)
+{
+    if (v0.w <= 0.f || v1.w <= 0.f || v2.w <= 0.f)
+    {
+        return;
+    }
+
+    // Window coordinates, pixel centers are at half integers
+    glm::vec3 screen[3];
+    const glm::vec4* clip[3] = {&v0, &v1, &v2};
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        float inverseW = 1.f / clip[i]->w;
+        screen[i].x = (clip[i]->x * inverseW * 0.5f + 0.5f) * m_width;
+        screen[i].y = (clip[i]->y * inverseW * 0.5f + 0.5f) * m_height;
+        screen[i].z = clip[i]->z * inverseW * 0.5f + 0.5f;
+    }
+
+    // Back faces and degenerate triangles have no positive area
+    float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) -
+                 (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y);
+    if (!(area > 0.f))
+    {
+        return;
+    }
+
+    // Pixels with centers inside the bounding box
+    float minX = std::min(screen[0].x, std::min(screen[1].x, screen[2].x));
+    float maxX = std::max(screen[0].x, std::max(screen[1].x, screen[2].x));
+    float minY = std::min(screen[0].y, std::min(screen[1].y, screen[2].y));
+    float maxY = std::max(screen[0].y, std::max(screen[1].y, screen[2].y));
+    if (maxX < 0.5f || maxY < 0.5f || minX > m_width - 0.5f || minY > m_height - 0.5f)
+    {
+        return;
+    }
+
+    STriangle triangle;
+    triangle.m_minX = std::max(0, (int)std::ceil(minX - 0.5f));
+    triangle.m_maxX = std::min((int)m_width - 1, (int)std::floor(maxX - 0.5f));
+    triangle.m_minY = std::max(0, (int)std::ceil(minY - 0.5f));
+    triangle.m_maxY = std::min((int)m_height - 1, (int)std::floor(maxY - 0.5f));
+    if (triangle.m_minX > triangle.m_maxX || triangle.m_minY > triangle.m_maxY)
+    {
+        return;
+    }
+
+    // Edge opposite to each vertex, positive on the inner side of counter-clockwise triangles
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        const glm::vec3& a = screen[(i + 1) % 3];
+        const glm::vec3& b = screen[(i + 2) % 3];
+        triangle.m_edges[i][0] = a.y - b.y;
+        triangle.m_edges[i][1] = b.x - a.x;
+        triangle.m_edges[i][2] = -(triangle.m_edges[i][0] * a.x + triangle.m_edges[i][1] * a.y);
+    }
+
+    // Window depth is linear in window coordinates
+    float dz1 = screen[1].z - screen[0].z;
+    float dz2 = screen[2].z - screen[0].z;
+    triangle.m_depth[0] =
+        (dz1 * (screen[2].y - screen[0].y) - dz2 * (screen[1].y - screen[0].y)) / area;
+    triangle.m_depth[1] =
+        (dz2 * (screen[1].x - screen[0].x) - dz1 * (screen[2].x - screen[0].x)) / area;
+    triangle.m_depth[2] =
+        screen[0].z - triangle.m_depth[0] * screen[0].x - triangle.m_depth[1] * screen[0].y;
+
+    unsigned int index = (unsigned int)m_triangles.size();
+    m_triangles.push_back(triangle);
+    for (unsigned int y = triangle.m_minY / s_tileHeight; y <= triangle.m_maxY / s_tileHeight; ++y)
+    {
+        for (unsigned int x = triangle.m_minX / s_tileWidth; x <= triangle.m_maxX / s_tileWidth;
+             ++x)
+        {
+            m_bins[y * m_tilesX + x].push_back(index);
+        }
+    }
+}
+
+void COcclusionBuffer::finish()
+{
+    unsigned int tileCount = m_tilesX * m_tilesY;
+    if (m_pool == nullptr)
+    {
+        for (unsigned int tile = 0; tile < tileCount; ++tile)
+        {
+            rasterizeTile(tile);
+        }
+        return;
+    }
+    // Tiles do not share pixels or blocks
+    for (unsigned int tile = 0; tile < tileCount; ++tile)
+    {
+        m_pool->addTask([this, tile]() { rasterizeTile(tile); });
+    }
+    m_pool->wait();
+}
+
+void COcclusionBuffer::rasterizeTile(unsigned int tile)
+{
+    int tileX = (tile % m_tilesX) * s_tileWidth;
+    int tileY = (tile / m_tilesX) * s_tileHeight;
+
+    // Clear
+    for (unsigned int y = 0; y < s_tileHeight; ++y)
+    {
+        float* row = &m_depth[(tileY + y) * m_width + tileX];
+        std::fill(row, row + s_tileWidth, 1.f);
+    }
+
+    for (unsigned int index : m_bins[tile])
+    {
+        const STriangle& triangle = m_triangles[index];
+        // Rows are processed in steps of 4 pixels from an aligned start
+        int minX = std::max(triangle.m_minX, tileX) & ~3;
+        int maxX = std::min(triangle.m_maxX, tileX + (int)s_tileWidth - 1);
+        int minY = std::max(triangle.m_minY, tileY);
+        int maxY = std::min(triangle.m_maxY, tileY + (int)s_tileHeight - 1);
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            float centerY = y + 0.5f;
+            float* row = &m_depth[y * m_width];
+#ifdef RTR_OCCLUSION_SSE2
+            if (m_simd)
+            {
+                __m128 zero = _mm_setzero_ps();
+                __m128 edgeStepX[3];
+                __m128 edge[3];
+                __m128 centerX =
+                    _mm_add_ps(_mm_set1_ps(minX + 0.5f), _mm_set_ps(3.f, 2.f, 1.f, 0.f));
+                for (unsigned int i = 0; i < 3; ++i)
+                {
+                    __m128 a = _mm_set1_ps(triangle.m_edges[i][0]);
+                    edgeStepX[i] = _mm_mul_ps(a, _mm_set1_ps(4.f));
+                    edge[i] = _mm_add_ps(_mm_mul_ps(a, centerX),
+                                         _mm_set1_ps(triangle.m_edges[i][1] * centerY +
+                                                     triangle.m_edges[i][2]));
+                }
+                __m128 depthStepX = _mm_set1_ps(triangle.m_depth[0] * 4.f);
+                __m128 depth = _mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(triangle.m_depth[0]), centerX),
+                    _mm_set1_ps(triangle.m_depth[1] * centerY + triangle.m_depth[2]));
+
+                for (int x = minX; x <= maxX; x += 4)
+                {
+                    __m128 inside = _mm_and_ps(
+                        _mm_and_ps(_mm_cmpge_ps(edge[0], zero), _mm_cmpge_ps(edge[1], zero)),
+                        _mm_cmpge_ps(edge[2], zero));
+                    if (_mm_movemask_ps(inside) != 0)
+                    {
+                        __m128 previous = _mm_loadu_ps(row + x);
+                        __m128 nearest = _mm_min_ps(previous, depth);
+                        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest),
+                                                         _mm_andnot_ps(inside, previous)));
+                    }
+                    for (unsigned int i = 0; i < 3; ++i)
+                    {
+                        edge[i] = _mm_add_ps(edge[i], edgeStepX[i]);
+                    }
+                    depth = _mm_add_ps(depth, depthStepX);
+                }
+                continue;
+            }
+#endif
+            // Same operations per lane as the SSE2 path, so both write identical depth
+            float edgeStepX[3];
+            float edge[3][4];
+            float depth[4];
+            for (unsigned int lane = 0; lane < 4; ++lane)
+            {
+                float centerX = (minX + 0.5f) + lane;
+                for (unsigned int i = 0; i < 3; ++i)
+                {
+                    edge[i][lane] = triangle.m_edges[i][0] * centerX +
+                                    (triangle.m_edges[i][1] * centerY + triangle.m_edges[i][2]);
+                }
+                depth[lane] = triangle.m_depth[0] * centerX +
+                              (triangle.m_depth[1] * centerY + triangle.m_depth[2]);
+            }
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+                edgeStepX[i] = triangle.m_edges[i][0] * 4.f;
+            }
+            float depthStepX = triangle.m_depth[0] * 4.f;
+
+            for (int x = minX; x <= maxX; x += 4)
+            {
+                for (unsigned int lane = 0; lane < 4; ++lane)
+                {
+                    if (edge[0][lane] >= 0.f && edge[1][lane] >= 0.f && edge[2][lane] >= 0.f)
+                    {
+                        row[x + lane] = std::min(row[x + lane], depth[lane]);
+                    }
+                    for (unsigned int i = 0; i < 3; ++i)
+                    {
+                        edge[i][lane] += edgeStepX[i];
+                    }
+                    depth[lane] += depthStepX;
+                }
+            }
+        }
+    }
+
+    // Farthest depth per block
+    for (unsigned int blockY = 0; blockY < s_tileHeight / s_blockSize; ++blockY)
+    {
+        for (unsigned int blockX = 0; blockX < s_tileWidth / s_blockSize; ++blockX)
+        {
+            unsigned int x0 = tileX + blockX * s_blockSize;
+            unsigned int y0 = tileY + blockY * s_blockSize;
+            float farthest = 0.f;
+            for (unsigned int y = y0; y < y0 + s_blockSize; ++y)
+            {
+                const float* row = &m_depth[y * m_width];
+                for (unsigned int x = x0; x < x0 + s_blockSize; ++x)
+                {
+                    farthest = std::max(farthest, row[x]);
+                }
+            }
+            m_blockDepth[(y0 / s_blockSize) * m_blocksX + x0 / s_blockSize] = farthest;
+        }
+    }
+}
+
+bool COcclusionBuffer::isVisible(const glm::vec3& min, const glm::vec3& max) const
+{
+    // Bounds of the projected corners
+    glm::vec3 ndcMin(1e30f);
+    glm::vec3 ndcMax(-1e30f);
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        glm::vec4 corner = m_viewProjection * glm::vec4(i & 1 ? max.x : min.x,
+                                                        i & 2 ? max.y : min.y,
+                                                        i & 4 ? max.z : min.z, 1.f);
+        // Boxes crossing the near plane cover the camera
+        if (corner.z + corner.w < 0.f || corner.w <= 0.f)
+        {
+            return true;
+        }
+        glm::vec3 ndc(corner.x / corner.w, corner.y / corner.w, corner.z / corner.w);
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+
+    // Outside of the view
+    if (ndcMax.x < -1.f || ndcMax.y < -1.f || ndcMin.x > 1.f || ndcMin.y > 1.f || ndcMin.z > 1.f)
+    {
+        return false;
+    }
+
+    // Pixels overlapped by the projected box
+    auto toPixel = [](float ndc, unsigned int size) -> unsigned int {
+        float pixel = std::floor((ndc * 0.5f + 0.5f) * size);
+        return (unsigned int)std::max(0.f, std::min(size - 1.f, pixel));
+    };
+    unsigned int minX = toPixel(ndcMin.x, m_width);
+    unsigned int maxX = toPixel(ndcMax.x, m_width);
+    unsigned int minY = toPixel(ndcMin.y, m_height);
+    unsigned int maxY = toPixel(ndcMax.y, m_height);
+    float nearest = ndcMin.z * 0.5f + 0.5f;
+
+    for (unsigned int blockY = minY / s_blockSize; blockY <= maxY / s_blockSize; ++blockY)
+    {
+        for (unsigned int blockX = minX / s_blockSize; blockX <= maxX / s_blockSize; ++blockX)
+        {
+            // Block rejects the box if all its pixels are nearer
+            if (nearest > m_blockDepth[blockY * m_blocksX + blockX])
+            {
+                continue;
+            }
+            unsigned int x0 = std::max(minX, blockX * s_blockSize);
+            unsigned int x1 = std::min(maxX, blockX * s_blockSize + s_blockSize - 1);
+            unsigned int y0 = std::max(minY, blockY * s_blockSize);
+            unsigned int y1 = std::min(maxY, blockY * s_blockSize + s_blockSize - 1);
+            for (unsigned int y = y0; y <= y1; ++y)
+            {
+                const float* row = &m_depth[y * m_width];
+                for (unsigned int x = x0; x <= x1; ++x)
+                {
+                    if (nearest <= row[x])
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+float COcclusionBuffer::getDepth(unsigned int x, unsigned int y) const
+{
+    return m_depth[y * m_width + x];
+}
+
+unsigned int COcclusionBuffer::getWidth() const { return m_width; }
+
+unsigned int COcclusionBuffer::getHeight() const { return m_height; }
+
+unsigned int COcclusionBuffer::getTriangleCount() const
+{
+    return (unsigned int)m_triangles.size();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class CThreadPool;
+
+/**
+* \brief Low resolution CPU depth buffer for software occlusion culling.
+* Occluder triangles are transformed, clipped against the near plane and binned into screen tiles.
+* Tiles are rasterized independently with SSE2 if available, optionally on worker threads, and
+* reduced to a hierarchical depth buffer, which stores the farthest depth per block of pixels.
+* Bounding boxes are tested against the blocks first and against pixels of blocks, which do not
+* reject them.
+* Depth is the window depth in [0-1] as with the default depth range. Back faces are culled with
+* counter-clockwise front faces like in the renderers. Does not depend on OpenGL.
+*/
+class COcclusionBuffer
+{
+   public:
+    /**
+    * \brief Creates buffer, the size is rounded up to whole tiles.
+    */
+    COcclusionBuffer(unsigned int width = 256, unsigned int height = 128);
+
+    /**
+    * \brief Sets pool used to rasterize tiles in parallel, nullptr rasterizes on the caller.
+    * The pool must outlive the buffer or be reset.
+    */
+    void setThreadPool(CThreadPool* pool);
+
+    /**
+    * \brief Selects SSE2 or scalar rasterization, SSE2 is used by default if it is available.
+    * Both write identical depth, the scalar path exists for targets without SSE2.
+    */
+    void setSimd(bool enabled);
+
+    /**
+    * \brief Returns whether tiles are rasterized with SSE2.
+    */
+    bool isSimd() const;
+
+    /**
+    * \brief Starts a frame, removes occluders of the previous frame.
+    */
+    void begin(const glm::mat4& viewProjection);
+
+    /**
+    * \brief Transforms and bins occluder triangles.
+    * \param vertices Model space positions with 3 floats per vertex.
+    * \param indices Triangle list indices into the vertices.
+    */
+    void addOccluder(const glm::mat4& model, const std::vector<float>& vertices,
+                     const std::vector<unsigned int>& indices);
+
+    /**
+    * \brief Rasterizes binned triangles and builds the hierarchical depth buffer.
+    */
+    void finish();
+
+    /**
+    * \brief Returns whether a world space bounding box may be visible.
+    * Boxes crossing the near plane are always visible, boxes outside the view are not.
+    */
+    bool isVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+    /**
+    * \brief Returns depth of a pixel, the origin is the bottom left corner.
+    */
+    float getDepth(unsigned int x, unsigned int y) const;
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+
+    /**
+    * \brief Returns number of triangles binned in the current frame after clipping and culling.
+    */
+    unsigned int getTriangleCount() const;
+
+   private:
+    /**
+    * \brief Screen space triangle set up for rasterization.
+    * Edge functions and depth are planes a * x + b * y + c in pixel coordinates.
+    */
+    struct STriangle
+    {
+        float m_edges[3][3]; /**< Edge functions, all positive inside. */
+        float m_depth[3];    /**< Depth plane. */
+        int m_minX;          /**< Bounding box in pixels, inclusive. */
+        int m_minY;
+        int m_maxX;
+        int m_maxY;
+    };
+
+    /**
+    * \brief Sets up triangle from clip space positions and adds it to the bins of its tiles.
+    */
+    void addTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2);
+
+    /**
+    * \brief Clears, rasterizes and reduces a tile.
+    */
+    void rasterizeTile(unsigned int tile);
+
+    static const unsigned int s_tileWidth = 64;  /**< Tile width in pixels. */
+    static const unsigned int s_tileHeight = 32; /**< Tile height in pixels. */
+    static const unsigned int s_blockSize = 8;   /**< Block size of the hierarchical buffer. */
+
+    unsigned int m_width;          /**< Width in pixels. */
+    unsigned int m_height;         /**< Height in pixels. */
+    unsigned int m_tilesX;         /**< Tiles per row. */
+    unsigned int m_tilesY;         /**< Tiles per column. */
+    unsigned int m_blocksX;        /**< Blocks per row. */
+    unsigned int m_blocksY;        /**< Blocks per column. */
+    glm::mat4 m_viewProjection;    /**< Transform of the current frame. */
+    CThreadPool* m_pool = nullptr; /**< Workers for tiles. */
+    bool m_simd = false;           /**< Rasterize with SSE2. */
+
+    std::vector<float> m_depth;                    /**< Pixel depth, rows from bottom. */
+    std::vector<float> m_blockDepth;               /**< Farthest depth per block. */
+    std::vector<STriangle> m_triangles;            /**< Triangles of the frame. */
+    std::vector<std::vector<unsigned int>> m_bins; /**< Triangle indices per tile. */
+    std::vector<glm::vec4> m_clipVertices;         /**< Transformed vertices of an occluder. */
+};
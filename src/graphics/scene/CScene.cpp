@@ -1,10 +1,17 @@
 #include "CScene.h"
 
+#include <cassert>
+
+#include <glm/ext.hpp>
+
 #include "CSceneQuery.h"
 #include "SSceneObject.h"
 #include "SScenePointLight.h"
 #include "SSceneDirectionalLight.h"
 
+#include "graphics/ICamera.h"
+#include "util/CThreadPool.h"
+
 CScene::CScene() {}
 
 CScene::~CScene() {}
@@ -49,6 +56,25 @@ void CScene::setObject(ResourceId id, ResourceId mesh, ResourceId material,
     return;
 }
 
+void CScene::setObjectBounds(SceneObjectId id, const glm::vec3& min, const glm::vec3& max)
+{
+    assert(id >= 0 && ((unsigned int)id) < m_objects.size() && "Invalid scene object id");
+    m_objects[id].m_hasBounds = true;
+    m_objects[id].m_boundsMin = min;
+    m_objects[id].m_boundsMax = max;
+}
+
+void CScene::setOccluder(SceneObjectId id, const std::vector<float>& vertices,
+                         const std::vector<unsigned int>& indices)
+{
+    assert(id >= 0 && ((unsigned int)id) < m_objects.size() && "Invalid scene object id");
+    SOccluder occluder;
+    occluder.m_object = id;
+    occluder.m_vertices = vertices;
+    occluder.m_indices = indices;
+    m_occluders.push_back(std::move(occluder));
+}
+
 SceneObjectId CScene::createPointLight(const glm::vec3& position, float radius,
                                        const glm::vec3& color, float intensity, bool castsShadow)
 {
@@ -149,20 +175,93 @@ ISceneQuery* CScene::createQuery(const ICamera& camera) const
     CSceneQuery* query =
         new CSceneQuery((unsigned int)m_objects.size(), (unsigned int)m_pointLights.size());
 
-    // TODO Frustum culling, occlusion culling, better data structure for objects
-    // For now add all objects
+    // TODO Frustum culling, better data structure for objects
+    // For now add all objects, see createOcclusionCulledQuery
     for (unsigned int i = 0; i < m_objects.size(); ++i)
     {
         // Counter variable is object id
         query->addObject(i);
     }
 
+    addLights(*query);
+
+    // Return query
+    return query;
+}
+
+ISceneQuery* CScene::createOcclusionCulledQuery(const ICamera& camera) const
+{
+    if (m_occluders.empty())
+    {
+        return createQuery(camera);
+    }
+
+    // Workers are started on first use
+    if (m_threadPool == nullptr)
+    {
+        m_threadPool.reset(new CThreadPool());
+        m_occlusionBuffer.setThreadPool(m_threadPool.get());
+    }
+
+    // Occluders are rendered every query, animated occluders stay correct
+    m_occlusionBuffer.begin(camera.getProjection() * camera.getView());
+    for (const SOccluder& occluder : m_occluders)
+    {
+        m_occlusionBuffer.addOccluder(getModelMatrix(m_objects.at(occluder.m_object)),
+                                      occluder.m_vertices, occluder.m_indices);
+    }
+    m_occlusionBuffer.finish();
+
+    CSceneQuery* query =
+        new CSceneQuery((unsigned int)m_objects.size(), (unsigned int)m_pointLights.size());
+    for (unsigned int i = 0; i < m_objects.size(); ++i)
+    {
+        const SSceneObject& object = m_objects[i];
+        if (!object.m_hasBounds)
+        {
+            query->addObject(i);
+            continue;
+        }
+
+        // World space box around the transformed model space box
+        glm::mat4 model = getModelMatrix(object);
+        glm::vec3 min(1e30f);
+        glm::vec3 max(-1e30f);
+        for (unsigned int corner = 0; corner < 8; ++corner)
+        {
+            glm::vec4 position =
+                model * glm::vec4(corner & 1 ? object.m_boundsMax.x : object.m_boundsMin.x,
+                                  corner & 2 ? object.m_boundsMax.y : object.m_boundsMin.y,
+                                  corner & 4 ? object.m_boundsMax.z : object.m_boundsMin.z, 1.f);
+            min = glm::min(min, glm::vec3(position.x, position.y, position.z));
+            max = glm::max(max, glm::vec3(position.x, position.y, position.z));
+        }
+        if (m_occlusionBuffer.isVisible(min, max))
+        {
+            query->addObject(i);
+        }
+    }
+    addLights(*query);
+    return query;
+}
+
+glm::mat4 CScene::getModelMatrix(const SSceneObject& object) const
+{
+    // Same order as the renderers, see CTransformer
+    return glm::translate(object.m_position) *
+           glm::rotate(object.m_rotation.x, glm::vec3(1.f, 0.f, 0.f)) *
+           glm::rotate(object.m_rotation.y, glm::vec3(0.f, 1.f, 0.f)) *
+           glm::rotate(object.m_rotation.z, glm::vec3(0.f, 0.f, 1.f)) * glm::scale(object.m_scale);
+}
+
+void CScene::addLights(CSceneQuery& query) const
+{
     // TODO Light culling
     // For now add all point lights
     for (unsigned int i = 0; i < m_pointLights.size(); ++i)
     {
         // Counter variable is light id
-        query->addPointLight(i);
+        query.addPointLight(i);
     }
 
     // TODO Directional light culling?
@@ -170,9 +269,6 @@ ISceneQuery* CScene::createQuery(const ICamera& camera) const
     for (unsigned int i = 0; i < m_directionalLights.size(); ++i)
     {
         // Counter variable is light id
-        query->addDirectionalLight(i);
+        query.addDirectionalLight(i);
     }
-
-    // Return query
-    return query;
 }
@@ -7,9 +7,13 @@
 
 #include "graphics/IScene.h"
 
+#include "COcclusionBuffer.h"
+
 struct SSceneObject;
 struct SScenePointLight;
 struct SSceneDirectionalLight;
+class CSceneQuery;
+class CThreadPool;
 
 /**
 * \brief Simple scene implementation.
@@ -29,6 +33,11 @@ class CScene : public IScene
     void setObject(ResourceId id, ResourceId mesh, ResourceId material, const glm::vec3& position,
                    const glm::vec3& rotation, const glm::vec3& scale);
 
+    void setObjectBounds(SceneObjectId id, const glm::vec3& min, const glm::vec3& max);
+
+    void setOccluder(SceneObjectId id, const std::vector<float>& vertices,
+                     const std::vector<unsigned int>& indices);
+
     SceneObjectId createPointLight(const glm::vec3& position, float radius, const glm::vec3& color,
                                    float intensity, bool castsShadow);
 
@@ -53,11 +62,42 @@ class CScene : public IScene
 
     ISceneQuery* createQuery(const ICamera& camera) const;
 
+    /**
+    * \brief Rasterizes occluders into a low resolution depth buffer and culls objects, whose
+    * bounding boxes are hidden. Occluders are rasterized on worker threads by screen tile.
+    */
+    ISceneQuery* createOcclusionCulledQuery(const ICamera& camera) const;
+
    private:
+    /**
+    * \brief Occluder geometry of a scene object.
+    */
+    struct SOccluder
+    {
+        SceneObjectId m_object;               /**< Object, which provides the transformation. */
+        std::vector<float> m_vertices;        /**< Model space positions. */
+        std::vector<unsigned int> m_indices; /**< Triangle list indices. */
+    };
+
+    /**
+    * \brief Returns model matrix of an object.
+    */
+    glm::mat4 getModelMatrix(const SSceneObject& object) const;
+
+    /**
+    * \brief Adds all lights to the query.
+    */
+    void addLights(CSceneQuery& query) const;
+
+
     glm::vec3 m_ambientColor; /**< Global ambient light color. */
     float m_ambientIntensity; /**< Global ambient light intensity. */
 
     std::vector<SSceneObject> m_objects;                     /**< Drawable scene objects. */
     std::vector<SScenePointLight> m_pointLights;             /**< Point lights. */
     std::vector<SSceneDirectionalLight> m_directionalLights; /**< Directional lights. */
+
+    std::vector<SOccluder> m_occluders;                 /**< Occluder geometry. */
+    mutable COcclusionBuffer m_occlusionBuffer;         /**< Depth of the occluders. */
+    mutable std::unique_ptr<CThreadPool> m_threadPool; /**< Rasterizes occluder tiles. */
 };
@@ -18,4 +18,7 @@ struct SSceneObject
     glm::vec3 m_position;
     glm::vec3 m_rotation;
     glm::vec3 m_scale;
+    bool m_hasBounds;      /**< Bounding box has been set. */
+    glm::vec3 m_boundsMin; /**< Model space bounding box. */
+    glm::vec3 m_boundsMax;
 };
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "CFileWatcher.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "debug/Log.h"
+
+const unsigned int CFileWatcher::s_pollInterval;
+
+/**
+* \brief Splits file path into directory prefix including the separator and file name.
+*/
+static void splitPath(const std::string& file, std::string& directory, std::string& name)
+{
+    size_t separator = file.find_last_of("/\\");
+    if (separator == std::string::npos)
+    {
+        directory.clear();
+        name = file;
+        return;
+    }
+    directory = file.substr(0, separator + 1);
+    name = file.substr(separator + 1);
+}
+
+CFileWatcher::CFileWatcher() : m_lastPoll(std::chrono::steady_clock::now())
+{
+#ifdef __linux__
+    m_notifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_notifyHandle == -1)
+    {
+        LOG_WARNING("Failed to initialize inotify, polling watched files instead.");
+    }
+#endif
+}
+
+CFileWatcher::~CFileWatcher()
+{
+#ifdef __linux__
+    if (m_notifyHandle != -1)
+    {
+        // Closing the instance removes all watches
+        close(m_notifyHandle);
+    }
+#endif
+}
+
+void CFileWatcher::addFile(const std::string& file)
+{
+    if (file.empty() || m_files.count(file) != 0)
+    {
+        return;
+    }
+    m_files[file] = getFileState(file);
+
+#ifdef __linux__
+    if (m_notifyHandle == -1)
+    {
+        return;
+    }
+    std::string directory;
+    std::string name;
+    splitPath(file, directory, name);
+    if (m_watches.count(directory) != 0)
+    {
+        return;
+    }
+    int watch = inotify_add_watch(m_notifyHandle, directory.empty() ? "." : directory.c_str(),
+                                  IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch == -1)
+    {
+        // Files in packs have no directory on disk
+        LOG_DEBUG("Failed to watch directory %s of file %s.", directory.c_str(), file.c_str());
+        return;
+    }
+    m_watches[directory] = watch;
+    m_directories[watch] = directory;
+#endif
+}
+
+bool CFileWatcher::isWatched(const std::string& file) const { return m_files.count(file) != 0; }
+
+void CFileWatcher::poll(std::vector<std::string>& changed)
+{
+    changed.clear();
+    std::unordered_set<std::string> changedFiles;
+    if (m_notifyHandle != -1)
+    {
+        readEvents(changedFiles);
+    }
+    else
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_lastPoll < std::chrono::milliseconds(s_pollInterval))
+        {
+            return;
+        }
+        m_lastPoll = now;
+
+        for (auto& entry : m_files)
+        {
+            SFileState state = getFileState(entry.first);
+            SFileState& last = entry.second;
+            if (state.m_exists && (!last.m_exists || state.m_modified != last.m_modified ||
+                                   state.m_size != last.m_size))
+            {
+                changedFiles.insert(entry.first);
+            }
+            last = state;
+        }
+    }
+    changed.assign(changedFiles.begin(), changedFiles.end());
+}
+
+bool CFileWatcher::isNative() const { return m_notifyHandle != -1; }
+
+CFileWatcher::SFileState CFileWatcher::getFileState(const std::string& file)
+{
+    SFileState state;
+    struct stat fileStat;
+    state.m_exists = stat(file.c_str(), &fileStat) == 0;
+    state.m_modified = state.m_exists ? fileStat.st_mtime : 0;
+    state.m_size = state.m_exists ? (long long)fileStat.st_size : 0;
+    return state;
+}
+
+void CFileWatcher::readEvents(std::unordered_set<std::string>& changed)
+{
+#ifdef __linux__
+    // Buffer aligned for the event structures
+    alignas(struct inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t length = read(m_notifyHandle, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            if (length == -1 && errno != EAGAIN)
+            {
+                LOG_WARNING("Failed to read file change events.");
+            }
+            return;
+        }
+
+        for (char* position = buffer; position < buffer + length;)
+        {
+            const struct inotify_event* event =
+                reinterpret_cast<const struct inotify_event*>(position);
+            position += sizeof(struct inotify_event) + event->len;
+
+            auto directory = m_directories.find(event->wd);
+            if (event->len == 0 || directory == m_directories.end())
+            {
+                continue;
+            }
+            std::string file = directory->second + event->name;
+            if (m_files.count(file) != 0)
+            {
+                changed.insert(file);
+            }
+        }
+    }
+#else
+    (void)changed;
+#endif
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+* \brief Reports changes of watched files.
+* On Linux the directories of the watched files are observed with inotify, files count as changed
+* once they have been written and closed or moved into place, which covers editors replacing files
+* on save. Other platforms compare the modification time and size of the files in intervals.
+* Files, which do not exist on disk, e.g. files in mounted packs, are ignored.
+*/
+class CFileWatcher
+{
+   public:
+    CFileWatcher();
+    ~CFileWatcher();
+
+    CFileWatcher(const CFileWatcher&) = delete;
+    CFileWatcher& operator=(const CFileWatcher&) = delete;
+
+    /**
+    * \brief Adds file to the watched files.
+    */
+    void addFile(const std::string& file);
+
+    /**
+    * \brief Returns whether the file is watched.
+    */
+    bool isWatched(const std::string& file) const;
+
+    /**
+    * \brief Returns files changed since the last call, each file is reported once.
+    * Does not block.
+    */
+    void poll(std::vector<std::string>& changed);
+
+    /**
+    * \brief Returns whether changes are reported by the operating system instead of polling.
+    */
+    bool isNative() const;
+
+   private:
+    /**
+    * \brief Polled state of a file.
+    */
+    struct SFileState
+    {
+        std::time_t m_modified; /**< Last modification time. */
+        long long m_size;       /**< File size in bytes. */
+        bool m_exists;          /**< File exists on disk. */
+    };
+
+    /**
+    * \brief Returns current state of a file on disk.
+    */
+    static SFileState getFileState(const std::string& file);
+
+    /**
+    * \brief Reads pending inotify events.
+    */
+    void readEvents(std::unordered_set<std::string>& changed);
+
+    int m_notifyHandle = -1; /**< Inotify instance, -1 if polling is used. */
+    std::unordered_map<int, std::string> m_directories; /**< Directory prefix per watch. */
+    std::unordered_map<std::string, int> m_watches;     /**< Watch per directory prefix. */
+    std::unordered_map<std::string, SFileState> m_files; /**< Watched files. */
+    std::chrono::steady_clock::time_point m_lastPoll;    /**< Time of the last polling pass. */
+
+    static const unsigned int s_pollInterval = 500; /**< Polling interval in milliseconds. */
+};
@@ -3,55 +3,29 @@
 #include <fstream>
 #include <sstream>
 
+#include "CVirtualFileSystem.h"
+
 bool CIniFile::load(const std::string& file)
 {
-    d_entries.clear();
-
     std::ifstream ifs(file);
     if (!ifs.is_open())
     {
+        d_entries.clear();
         return false;
     }
-    std::string line;
-    std::string group;
-    while (std::getline(ifs, line))
+    return parse(ifs);
+}
+
+bool CIniFile::load(const std::string& file, const CVirtualFileSystem& fileSystem)
+{
+    std::string text;
+    if (!fileSystem.readFile(file, text))
     {
-        if (line.empty())
-        {
-            // Empty line
-            continue;
-        }
-        else if (line.at(0) == '#')  // Comment
-        {
-            // Ignore
-            continue;
-        }
-        else if (line.at(0) == '[')  // Group
-        {
-            unsigned int pos = line.find(']');
-            if (pos == std::string::npos)
-            {
-                d_entries.clear();
-                ifs.close();
-                return false;
-            }
-            // Set current group
-            group = line.substr(1, pos - 1);
-        }
-        else  // Key/value pair
-        {
-            unsigned int pos = line.find('=');
-            if (pos == std::string::npos)
-            {
-                d_entries.clear();
-                ifs.close();
-                return false;
-            }
-            d_entries[group][line.substr(0, pos)] = line.substr(pos + 1);
-        }
+        d_entries.clear();
+        return false;
     }
-    ifs.close();
-    return true;
+    std::istringstream iss(text);
+    return parse(iss);
 }
 
 bool CIniFile::save(const std::string& file)
@@ -145,3 +119,52 @@ bool CIniFile::hasKey(const std::string& group, const std::string& key) const
 {
     return hasGroup(group) && d_entries.at(group).count(key) == 1;
 }
+
+bool CIniFile::parse(std::istream& stream)
+{
+    d_entries.clear();
+
+    std::string line;
+    std::string group;
+    while (std::getline(stream, line))
+    {
+        // Files read in binary mode keep carriage returns
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        if (line.empty())
+        {
+            // Empty line
+            continue;
+        }
+        else if (line.at(0) == '#')  // Comment
+        {
+            // Ignore
+            continue;
+        }
+        else if (line.at(0) == '[')  // Group
+        {
+            unsigned int pos = line.find(']');
+            if (pos == std::string::npos)
+            {
+                d_entries.clear();
+                return false;
+            }
+            // Set current group
+            group = line.substr(1, pos - 1);
+        }
+        else  // Key/value pair
+        {
+            unsigned int pos = line.find('=');
+            if (pos == std::string::npos)
+            {
+                d_entries.clear();
+                return false;
+            }
+            d_entries[group][line.substr(0, pos)] = line.substr(pos + 1);
+        }
+    }
+    return true;
+}
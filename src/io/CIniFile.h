@@ -2,6 +2,9 @@
 
 #include <string>
 #include <map>
+#include <istream>
+
+class CVirtualFileSystem;
 
 /**
 * \brief Ini file class.
@@ -20,6 +23,11 @@ class CIniFile
     */
     bool load(const std::string& file);
 
+    /**
+    * \brief Loads file data through the virtual file layer.
+    */
+    bool load(const std::string& file, const CVirtualFileSystem& fileSystem);
+
     /**
     * \brief Saves file data.
     */
@@ -51,5 +59,10 @@ class CIniFile
     bool hasKey(const std::string& group, const std::string& key) const;
 
    private:
+    /**
+    * \brief Parses ini data from stream.
+    */
+    bool parse(std::istream& stream);
+
     std::map<std::string, std::map<std::string, std::string>> d_entries; /**< Ini file entries. */
 };
@@ -20,7 +20,11 @@ bool CObjModelLoader::load(const std::string& file)
         LOG_ERROR("The mesh file %s could not be opened.", file.c_str());
         return false;
     }
+    return load(ifs, file);
+}
 
+bool CObjModelLoader::load(std::istream& stream, const std::string& name)
+{
     // Temp data
     std::vector<float> tempVert;
     std::vector<float> tempUV;
@@ -28,11 +32,11 @@ bool CObjModelLoader::load(const std::string& file)
 
     // Parse lines
     std::string line;
-    while (std::getline(ifs, line))
+    while (std::getline(stream, line))
     {
         parseLine(line, tempVert, tempNorm, tempUV);
     }
-    LOG_INFO("Loaded obj model %s with %u triangles.", file.c_str(), d_vertices.size() / 3);
+    LOG_INFO("Loaded obj model %s with %u triangles.", name.c_str(), d_vertices.size() / 3);
     return true;
 }
 
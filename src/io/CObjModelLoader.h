@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <istream>
 
 /*
 * \brief Loads and parses .obj files.
@@ -18,10 +19,16 @@ class CObjModelLoader
     CObjModelLoader();
 
     /**
-    * \brief Loads model from stream.
+    * \brief Loads model from file.
     */
     bool load(const std::string& file);
 
+    /**
+    * \brief Loads model from stream.
+    * The name is used for logging only.
+    */
+    bool load(std::istream& stream, const std::string& name);
+
     /**
     * \brief Returns vertex data.
     */
@@ -0,0 +1,251 @@
+#include "CPackFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "lodepng.h"
+
+#include "debug/Log.h"
+
+CPackFile::CPackFile()
+    : m_data(nullptr),
+      m_size(0),
+      m_header(nullptr),
+      m_entries(nullptr),
+      m_strings(nullptr)
+#ifdef _WIN32
+      ,
+      m_fileHandle(INVALID_HANDLE_VALUE),
+      m_mappingHandle(nullptr)
+#endif
+{
+    return;
+}
+
+CPackFile::~CPackFile() { close(); }
+
+bool CPackFile::open(const std::string& file)
+{
+    close();
+    if (!map(file))
+    {
+        LOG_ERROR("Failed to map pack file %s.", file.c_str());
+        return false;
+    }
+    m_fileName = file;
+
+    // Validate header
+    if (m_size < sizeof(SPackHeader))
+    {
+        LOG_ERROR("The pack file %s is too small to hold a header.", file.c_str());
+        close();
+        return false;
+    }
+    m_header = reinterpret_cast<const SPackHeader*>(m_data);
+    if (std::memcmp(m_header->m_magic, packMagic, sizeof(packMagic)) != 0)
+    {
+        LOG_ERROR("The file %s is not a pack file.", file.c_str());
+        close();
+        return false;
+    }
+    if (m_header->m_version != packVersion)
+    {
+        LOG_ERROR("The pack file %s has version %u, expected version %u.", file.c_str(),
+                  m_header->m_version, packVersion);
+        close();
+        return false;
+    }
+
+    // Validate index and string table bounds
+    uint64_t indexEnd =
+        sizeof(SPackHeader) + static_cast<uint64_t>(m_header->m_entryCount) * sizeof(SPackEntry);
+    if (indexEnd > m_size || m_header->m_stringTableOffset < indexEnd ||
+        m_header->m_stringTableOffset + m_header->m_stringTableSize > m_size)
+    {
+        LOG_ERROR("The pack file %s has a corrupted index.", file.c_str());
+        close();
+        return false;
+    }
+    m_entries = reinterpret_cast<const SPackEntry*>(m_data + sizeof(SPackHeader));
+    m_strings = reinterpret_cast<const char*>(m_data + m_header->m_stringTableOffset);
+
+    // Validate entries
+    for (unsigned int i = 0; i < m_header->m_entryCount; ++i)
+    {
+        const SPackEntry& entry = m_entries[i];
+        if (entry.m_offset + entry.m_storedSize > m_size ||
+            static_cast<uint64_t>(entry.m_pathOffset) + entry.m_pathLength >
+                m_header->m_stringTableSize ||
+            (i > 0 && m_entries[i - 1].m_hash > entry.m_hash))
+        {
+            LOG_ERROR("The pack file %s has a corrupted entry at index %u.", file.c_str(), i);
+            close();
+            return false;
+        }
+    }
+    LOG_INFO("Mapped pack file %s with %u files.", file.c_str(), m_header->m_entryCount);
+    return true;
+}
+
+void CPackFile::close()
+{
+    unmap();
+    m_fileName.clear();
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_strings = nullptr;
+}
+
+bool CPackFile::isOpen() const { return m_header != nullptr; }
+
+bool CPackFile::contains(const std::string& path) const
+{
+    return find(normalizePackPath(path)) != nullptr;
+}
+
+bool CPackFile::read(const std::string& path, std::vector<unsigned char>& data) const
+{
+    const SPackEntry* entry = find(normalizePackPath(path));
+    if (entry == nullptr)
+    {
+        return false;
+    }
+
+    const unsigned char* blob = m_data + entry->m_offset;
+    if ((entry->m_flags & packEntryCompressed) == 0)
+    {
+        data.assign(blob, blob + entry->m_storedSize);
+        return true;
+    }
+
+    data.clear();
+    data.reserve(entry->m_size);
+    unsigned int err = lodepng::decompress(data, blob, entry->m_storedSize);
+    if (err != 0 || data.size() != entry->m_size)
+    {
+        LOG_ERROR("Failed to decompress file %s from pack file %s.", path.c_str(),
+                  m_fileName.c_str());
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+unsigned int CPackFile::getFileCount() const
+{
+    return m_header == nullptr ? 0 : m_header->m_entryCount;
+}
+
+const std::string& CPackFile::getFileName() const { return m_fileName; }
+
+bool CPackFile::map(const std::string& file)
+{
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+    void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+    m_fileHandle = fileHandle;
+    m_mappingHandle = mappingHandle;
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+    return true;
+}
+
+void CPackFile::unmap()
+{
+    if (m_data == nullptr)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = INVALID_HANDLE_VALUE;
+#else
+    munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+const SPackEntry* CPackFile::find(const std::string& normalizedPath) const
+{
+    if (!isOpen())
+    {
+        return nullptr;
+    }
+
+    uint64_t hash = hashPackPath(normalizedPath);
+    const SPackEntry* end = m_entries + m_header->m_entryCount;
+    const SPackEntry* entry =
+        std::lower_bound(m_entries, end, hash,
+                         [](const SPackEntry& lhs, uint64_t rhs) { return lhs.m_hash < rhs; });
+
+    // Resolve hash collisions by comparing the stored path
+    for (; entry != end && entry->m_hash == hash; ++entry)
+    {
+        if (entry->m_pathLength == normalizedPath.size() &&
+            std::memcmp(m_strings + entry->m_pathOffset, normalizedPath.data(),
+                        normalizedPath.size()) == 0)
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
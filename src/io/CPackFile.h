@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "PackFormat.h"
+
+/**
+* \brief Read-only pack file.
+* Maps the whole archive into memory on open and resolves files through the sorted hash index,
+* so reading a file costs a binary search and a copy instead of an open/seek/read sequence.
+*/
+class CPackFile
+{
+   public:
+    CPackFile();
+    ~CPackFile();
+
+    /**
+    * \brief Maps pack file into memory and validates header and index.
+    */
+    bool open(const std::string& file);
+
+    /**
+    * \brief Unmaps pack file.
+    */
+    void close();
+
+    /**
+    * \brief Returns whether a pack file is mapped.
+    */
+    bool isOpen() const;
+
+    /**
+    * \brief Returns whether the pack contains the file.
+    */
+    bool contains(const std::string& path) const;
+
+    /**
+    * \brief Reads and decompresses file data from the pack.
+    * \return True on success and false if the file does not exist or is corrupted.
+    */
+    bool read(const std::string& path, std::vector<unsigned char>& data) const;
+
+    /**
+    * \brief Returns number of files in the pack.
+    */
+    unsigned int getFileCount() const;
+
+    /**
+    * \brief Returns pack file name.
+    */
+    const std::string& getFileName() const;
+
+   private:
+    CPackFile(const CPackFile&) = delete;
+    CPackFile& operator=(const CPackFile&) = delete;
+
+    /**
+    * \brief Maps file into memory.
+    */
+    bool map(const std::string& file);
+
+    /**
+    * \brief Unmaps mapped memory.
+    */
+    void unmap();
+
+    /**
+    * \brief Returns index entry for normalized path or nullptr.
+    */
+    const SPackEntry* find(const std::string& normalizedPath) const;
+
+    std::string m_fileName;      /**< Mapped pack file. */
+    const unsigned char* m_data; /**< Start of mapped memory. */
+    size_t m_size;               /**< Size of mapped memory. */
+    const SPackHeader* m_header; /**< Pack header. */
+    const SPackEntry* m_entries; /**< Sorted index entries. */
+    const char* m_strings;       /**< Path string table. */
+#ifdef _WIN32
+    void* m_fileHandle;    /**< Win32 file handle. */
+    void* m_mappingHandle; /**< Win32 file mapping handle. */
+#endif
+};
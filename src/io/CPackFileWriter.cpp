@@ -0,0 +1,136 @@
+#include "CPackFileWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "lodepng.h"
+
+#include "PackFormat.h"
+
+#include "debug/Log.h"
+
+bool CPackFileWriter::addFile(const std::string& path, const std::vector<unsigned char>& data,
+                              bool compress)
+{
+    SFile file;
+    file.m_path = normalizePackPath(path);
+    file.m_hash = hashPackPath(file.m_path);
+    file.m_size = data.size();
+    file.m_compressed = false;
+
+    for (const auto& other : m_files)
+    {
+        if (other.m_path == file.m_path)
+        {
+            LOG_ERROR("The file %s was already added to the pack.", file.m_path.c_str());
+            return false;
+        }
+    }
+
+    if (compress && !data.empty())
+    {
+        // Only keep compressed data if it actually saves space
+        std::vector<unsigned char> compressed;
+        if (lodepng::compress(compressed, data) == 0 && compressed.size() < data.size())
+        {
+            file.m_blob.swap(compressed);
+            file.m_compressed = true;
+        }
+    }
+    if (!file.m_compressed)
+    {
+        file.m_blob = data;
+    }
+    m_files.push_back(std::move(file));
+    return true;
+}
+
+bool CPackFileWriter::addFile(const std::string& file, bool compress)
+{
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs.is_open())
+    {
+        LOG_ERROR("Failed to open the file %s for packing.", file.c_str());
+        return false;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(ifs)),
+                                    std::istreambuf_iterator<char>());
+    return addFile(file, data, compress);
+}
+
+bool CPackFileWriter::write(const std::string& file) const
+{
+    // Index is sorted by hash for binary search on lookup
+    std::vector<const SFile*> files;
+    for (const auto& entry : m_files)
+    {
+        files.push_back(&entry);
+    }
+    std::sort(files.begin(), files.end(),
+              [](const SFile* lhs, const SFile* rhs) { return lhs->m_hash < rhs->m_hash; });
+
+    // Build string table
+    std::string strings;
+    std::vector<SPackEntry> entries(files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        std::memset(&entries[i], 0, sizeof(SPackEntry));
+        entries[i].m_hash = files[i]->m_hash;
+        entries[i].m_size = files[i]->m_size;
+        entries[i].m_storedSize = files[i]->m_blob.size();
+        entries[i].m_pathOffset = static_cast<uint32_t>(strings.size());
+        entries[i].m_pathLength = static_cast<uint32_t>(files[i]->m_path.size());
+        entries[i].m_flags = files[i]->m_compressed ? packEntryCompressed : 0;
+        strings += files[i]->m_path;
+    }
+
+    SPackHeader header;
+    std::memset(&header, 0, sizeof(SPackHeader));
+    std::memcpy(header.m_magic, packMagic, sizeof(packMagic));
+    header.m_version = packVersion;
+    header.m_entryCount = static_cast<uint32_t>(entries.size());
+    header.m_stringTableOffset = sizeof(SPackHeader) + entries.size() * sizeof(SPackEntry);
+    header.m_stringTableSize = strings.size();
+
+    // Assign aligned blob offsets
+    uint64_t offset = header.m_stringTableOffset + header.m_stringTableSize;
+    for (auto& entry : entries)
+    {
+        offset = (offset + packBlobAlignment - 1) / packBlobAlignment * packBlobAlignment;
+        entry.m_offset = offset;
+        offset += entry.m_storedSize;
+    }
+
+    std::ofstream ofs(file, std::ios::binary);
+    if (!ofs.is_open())
+    {
+        LOG_ERROR("Failed to open the pack file %s for writing.", file.c_str());
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(SPackHeader));
+    ofs.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SPackEntry));
+    ofs.write(strings.data(), strings.size());
+
+    uint64_t position = header.m_stringTableOffset + header.m_stringTableSize;
+    const char padding[packBlobAlignment] = {0};
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        ofs.write(padding, entries[i].m_offset - position);
+        ofs.write(reinterpret_cast<const char*>(files[i]->m_blob.data()),
+                  files[i]->m_blob.size());
+        position = entries[i].m_offset + entries[i].m_storedSize;
+    }
+
+    if (!ofs.good())
+    {
+        LOG_ERROR("An error occured while writing the pack file %s.", file.c_str());
+        return false;
+    }
+    return true;
+}
+
+unsigned int CPackFileWriter::getFileCount() const
+{
+    return static_cast<unsigned int>(m_files.size());
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+* \brief Writes pack files.
+* Collects files in memory, builds the sorted hash index and writes the archive in one go.
+*/
+class CPackFileWriter
+{
+   public:
+    /**
+    * \brief Adds file data under the specified path.
+    * The data is compressed on write, if requested and the compressed blob is smaller.
+    * \return False if a file with the same path was already added.
+    */
+    bool addFile(const std::string& path, const std::vector<unsigned char>& data, bool compress);
+
+    /**
+    * \brief Reads file from disk and adds it under the same path.
+    */
+    bool addFile(const std::string& file, bool compress);
+
+    /**
+    * \brief Writes pack file.
+    */
+    bool write(const std::string& file) const;
+
+    /**
+    * \brief Returns number of added files.
+    */
+    unsigned int getFileCount() const;
+
+   private:
+    /**
+    * \brief Pending pack entry.
+    */
+    struct SFile
+    {
+        std::string m_path;                /**< Normalized path. */
+        uint64_t m_hash;                   /**< Path hash. */
+        uint64_t m_size;                   /**< Uncompressed size. */
+        bool m_compressed;                 /**< Blob holds compressed data. */
+        std::vector<unsigned char> m_blob; /**< Stored blob data. */
+    };
+
+    std::vector<SFile> m_files; /**< Added files. */
+};
@@ -21,6 +21,14 @@ CSceneLoader::CSceneLoader(IResourceManager& resourceManager) : m_resourceManage
     return;
 }
 
+void CSceneLoader::takeResources(std::vector<CResourceHandle>& resources)
+{
+    resources.swap(m_resources);
+    m_resources.clear();
+    // Mesh ids may be reused once the references are released
+    m_occluderMeshes.clear();
+}
+
 bool CSceneLoader::load(const std::string& file, IScene& scene, CAnimationWorld& animationWorld)
 {
     Json::Reader reader;
@@ -44,6 +52,20 @@ bool CSceneLoader::load(const std::string& file, IScene& scene, CAnimationWorld&
     // Read done, close file
     ifs.close();
 
+    // Decode all material textures as a batch, the handles keep the images cached until the
+    // materials referencing them are loaded
+    std::vector<std::string> materials;
+    const Json::Value& objects = root["scene_objects"];
+    for (unsigned int i = 0; objects.isArray() && i < objects.size(); ++i)
+    {
+        if (objects[i]["material"].isString())
+        {
+            materials.push_back(objects[i]["material"].asString());
+        }
+    }
+    std::vector<CResourceHandle> images;
+    m_resourceManager.preloadMaterials(materials, images);
+
     // Load scene objects
     if (!loadSceneObjects(root["scene_objects"], scene, animationWorld))
     {
@@ -144,6 +166,7 @@ bool CSceneLoader::loadSceneObject(const Json::Value& node, IScene& scene,
         LOG_ERROR("Failed to load mesh file %s.", mesh.c_str());
         return false;
     }
+    m_resources.push_back(CResourceHandle(&m_resourceManager, EResourceType::Mesh, meshId));
 
     // Load material file
     ResourceId materialId = m_resourceManager.loadMaterial(material);
@@ -152,10 +175,18 @@ bool CSceneLoader::loadSceneObject(const Json::Value& node, IScene& scene,
         LOG_ERROR("Failed to load material file %s.", material.c_str());
         return false;
     }
+    m_resources.push_back(
+        CResourceHandle(&m_resourceManager, EResourceType::Material, materialId));
 
     // Create object in scene
     SceneObjectId objectId = scene.createObject(meshId, materialId, position, rotation, scale);
 
+    // Bounds and occluder geometry for occlusion culling
+    if (!loadOcclusionData(node, scene, objectId, meshId))
+    {
+        return false;
+    }
+
     // Load optional animation controllers
 	if (!loadAnimationControllers(node["animations"], scene, animationWorld, objectId,
                                   AnimationObjectType::Model))
@@ -167,6 +198,79 @@ bool CSceneLoader::loadSceneObject(const Json::Value& node, IScene& scene,
     return true;
 }
 
+bool CSceneLoader::loadOcclusionData(const Json::Value& node, IScene& scene, SceneObjectId id,
+                                     ResourceId mesh)
+{
+    // Optional occluder flag, the mesh itself is rasterized as occluder
+    bool occluder = false;
+    if (!node["occluder"].isNull() && !load(node, "occluder", occluder))
+    {
+        return false;
+    }
+
+    // Bounds are available without the mesh data
+    float min[3];
+    float max[3];
+    if (!m_resourceManager.getMeshBounds(mesh, min, max))
+    {
+        LOG_WARNING("Bounds of scene object %i are not available, object is never culled.",
+                    (int)id);
+        return true;
+    }
+    scene.setObjectBounds(id, glm::vec3(min[0], min[1], min[2]),
+                          glm::vec3(max[0], max[1], max[2]));
+
+    if (!occluder)
+    {
+        return true;
+    }
+
+    // Objects sharing a mesh share the read geometry
+    auto entry = m_occluderMeshes.find(mesh);
+    if (entry == m_occluderMeshes.end())
+    {
+        entry = m_occluderMeshes.insert(std::make_pair(mesh, SOccluderMesh())).first;
+        loadOccluderMesh(mesh, entry->second);
+    }
+    if (!entry->second.m_indices.empty())
+    {
+        scene.setOccluder(id, entry->second.m_vertices, entry->second.m_indices);
+    }
+    return true;
+}
+
+void CSceneLoader::loadOccluderMesh(ResourceId mesh, SOccluderMesh& occluder)
+{
+    // Occluders are rasterized on the CPU every frame, so their data must not be dropped
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    EPrimitiveType type;
+    if (!m_resourceManager.setResidencyPolicy(EResourceType::Mesh, mesh, EResidencyPolicy::Keep) ||
+        !m_resourceManager.getMesh(mesh, occluder.m_vertices, occluder.m_indices, normals, uvs,
+                                   type))
+    {
+        LOG_WARNING("Data of occluder mesh %lli is not available, it is not rasterized.",
+                    (long long)mesh);
+        occluder = SOccluderMesh();
+        return;
+    }
+    if (type != EPrimitiveType::Triangle)
+    {
+        LOG_WARNING("Occluder mesh %lli is not a triangle mesh and ignored.", (long long)mesh);
+        occluder = SOccluderMesh();
+        return;
+    }
+
+    // Unindexed meshes store triangles in vertex order
+    if (occluder.m_indices.empty())
+    {
+        for (unsigned int i = 0; i < occluder.m_vertices.size() / 3; ++i)
+        {
+            occluder.m_indices.push_back(i);
+        }
+    }
+}
+
 bool CSceneLoader::loadPointLights(const Json::Value& node, IScene& scene,
                                    CAnimationWorld& animationWorld)
 {
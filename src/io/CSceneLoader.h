@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -8,6 +9,7 @@
 
 #include "animation/Animation.h"
 #include "graphics/SceneConfig.h"
+#include "resource/CResourceHandle.h"
 
 namespace Json
 {
@@ -21,7 +23,7 @@ class CAnimationWorld;
 /**
 * \brief Scene loader utility class.
 * Populates scene with static geometry from file.
-* Used for testing only, ids are not stored.
+* References to loaded resources are kept until taken by the caller.
 */
 class CSceneLoader
 {
@@ -32,10 +34,23 @@ class CSceneLoader
     CSceneLoader(IResourceManager& resourceManager);
     bool load(const std::string& file, IScene& scene, CAnimationWorld& animationWorld);
 
+    /**
+    * \brief Moves references to resources used by the loaded scene into the vector.
+    * The resources stay loaded as long as the references are held.
+    */
+    void takeResources(std::vector<CResourceHandle>& resources);
+
    protected:
     bool loadSceneObjects(const Json::Value& node, IScene& scene, CAnimationWorld& animationWorld);
     bool loadSceneObject(const Json::Value& node, IScene& scene, CAnimationWorld& animationWorld);
 
+    /**
+    * \brief Sets bounds of a scene object and its optional occluder geometry from mesh data.
+    * Bounds are provided by the resource manager, occluder geometry is read once per mesh.
+    */
+    bool loadOcclusionData(const Json::Value& node, IScene& scene, SceneObjectId id,
+                           ResourceId mesh);
+
     bool loadPointLights(const Json::Value& node, IScene& scene, CAnimationWorld& animationWorld);
     bool loadPointLight(const Json::Value& node, IScene& scene, CAnimationWorld& animationWorld);
 
@@ -60,5 +75,23 @@ class CSceneLoader
     bool load(const Json::Value& node, const std::string& name, std::string& str);
 
    private:
+    /**
+    * \brief Triangle list of an occluder mesh, empty if the mesh can not be used as occluder.
+    */
+    struct SOccluderMesh
+    {
+        std::vector<float> m_vertices;
+        std::vector<unsigned int> m_indices;
+    };
+
+    /**
+    * \brief Reads occluder geometry of a mesh.
+    * The mesh data is kept resident, so dropped data is read from file again.
+    */
+    void loadOccluderMesh(ResourceId mesh, SOccluderMesh& occluder);
+
     IResourceManager& m_resourceManager;
+    std::vector<CResourceHandle> m_resources; /**< References to loaded scene resources. */
+    std::unordered_map<ResourceId, SOccluderMesh>
+        m_occluderMeshes; /**< Occluder geometry by mesh of the referenced meshes. */
 };
\ No newline at end of file
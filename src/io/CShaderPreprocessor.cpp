@@ -1,90 +1,383 @@
 #include "CShaderPreprocessor.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 
+#include "CVirtualFileSystem.h"
+
 #include "debug/Log.h"
 
+/**
+* \brief Skips spaces and tabs starting at the position.
+*/
+static size_t skipBlanks(const std::string& text, size_t position, size_t end)
+{
+    while (position < end && (text[position] == ' ' || text[position] == '\t'))
+    {
+        ++position;
+    }
+    return position;
+}
+
+/**
+* \brief Compares the word at the position and returns whether it is not followed by more word
+* characters.
+*/
+static bool matchWord(const std::string& text, size_t position, size_t end,
+                      const std::string& word)
+{
+    if (position + word.size() > end || text.compare(position, word.size(), word) != 0)
+    {
+        return false;
+    }
+    size_t next = position + word.size();
+    return next == end || !(std::isalnum((unsigned char)text[next]) || text[next] == '_');
+}
+
+CShaderPreprocessor::CShaderPreprocessor() : m_fileSystem(nullptr)
+{
+    // Source string 0 is the preprocessed file
+    m_sourceNames.push_back("");
+}
+
 void CShaderPreprocessor::setIncludePath(const std::string& includePath)
 {
     m_includePath = includePath;
 }
 
+void CShaderPreprocessor::setFileSystem(const CVirtualFileSystem* fileSystem)
+{
+    m_fileSystem = fileSystem;
+}
+
+void CShaderPreprocessor::setDefines(const std::vector<std::string>& defines)
+{
+    m_defines = defines;
+}
+
 bool CShaderPreprocessor::preprocess(const std::string& shaderCode,
                                      std::string& preprocessedShaderCode)
 {
-    // Final string
-    std::stringstream ss;
+    return preprocess("", shaderCode, preprocessedShaderCode);
+}
 
-    // Include file
-    std::string includeFile;
-    // Current state
-    int state = 0;
+bool CShaderPreprocessor::preprocess(const std::string& file, const std::string& shaderCode,
+                                     std::string& preprocessedShaderCode)
+{
+    // Includes are recorded again
+    if (!file.empty())
+    {
+        m_dependencies.erase(file);
+    }
 
-    for (char c : shaderCode)
+    std::vector<std::string> includeStack;
+    includeStack.push_back(file);
+    std::unordered_set<std::string> onceFiles;
+    std::string output;
+    output.reserve(shaderCode.size());
+    if (!expand(file, shaderCode, 0, includeStack, onceFiles, output))
     {
-        if (c == '#' && state == 0)
+        return false;
+    }
+    preprocessedShaderCode.swap(output);
+    injectDefines(preprocessedShaderCode);
+    return true;
+}
+
+void CShaderPreprocessor::addDependency(const std::string& file, const std::string& dependency)
+{
+    m_dependencies[file].insert(dependency);
+}
+
+void CShaderPreprocessor::getDependents(const std::string& file,
+                                        std::vector<std::string>& dependents) const
+{
+    dependents.clear();
+    // Walk reverse edges
+    std::unordered_set<std::string> visited;
+    visited.insert(file);
+    std::vector<std::string> open(1, file);
+    while (!open.empty())
+    {
+        std::string current = open.back();
+        open.pop_back();
+        for (const auto& entry : m_dependencies)
         {
-            state += 1;
+            if (entry.second.count(current) != 0 && visited.insert(entry.first).second)
+            {
+                dependents.push_back(entry.first);
+                open.push_back(entry.first);
+            }
         }
-        else if (c == 'i' && state == 1)
+    }
+}
+
+void CShaderPreprocessor::getDependencies(const std::string& file,
+                                          std::vector<std::string>& dependencies) const
+{
+    dependencies.clear();
+    std::unordered_set<std::string> visited;
+    visited.insert(file);
+    std::vector<std::string> open(1, file);
+    while (!open.empty())
+    {
+        auto entry = m_dependencies.find(open.back());
+        open.pop_back();
+        if (entry == m_dependencies.end())
         {
-            state += 1;
+            continue;
         }
-        else if (c == 'n' && state == 2)
+        for (const std::string& dependency : entry->second)
         {
-            state += 1;
+            if (visited.insert(dependency).second)
+            {
+                dependencies.push_back(dependency);
+                open.push_back(dependency);
+            }
         }
-        else if (c == 'c' && state == 3)
+    }
+}
+
+void CShaderPreprocessor::invalidate(const std::string& file)
+{
+    m_includeCache.erase(file);
+    m_dependencies.erase(file);
+}
+
+const std::string& CShaderPreprocessor::getSourceName(int sourceNumber) const
+{
+    static const std::string unknown("unknown");
+    if (sourceNumber < 0 || sourceNumber >= (int)m_sourceNames.size())
+    {
+        return unknown;
+    }
+    return m_sourceNames[sourceNumber];
+}
+
+std::string CShaderPreprocessor::mapSourceNames(const std::string& infoLog) const
+{
+    std::string output;
+    size_t start = 0;
+    while (start < infoLog.size())
+    {
+        size_t end = infoLog.find('\n', start);
+        end = end == std::string::npos ? infoLog.size() : end + 1;
+
+        // Location is the first number of the line, optionally after a severity like "ERROR: "
+        size_t position = start;
+        size_t colon = infoLog.find(": ", start);
+        if (colon != std::string::npos && colon < end &&
+            std::all_of(infoLog.begin() + start, infoLog.begin() + colon,
+                        [](char c) { return std::isalpha((unsigned char)c) != 0; }))
         {
-            state += 1;
+            position = colon + 2;
         }
-        else if (c == 'l' && state == 4)
+        size_t digits = position;
+        while (digits < end && std::isdigit((unsigned char)infoLog[digits]))
         {
-            state += 1;
+            ++digits;
         }
-        else if (c == 'u' && state == 5)
+
+        // Source string 0 is the file itself and keeps its number
+        bool isLocation = digits > position && digits + 1 < end &&
+                          (infoLog[digits] == '(' || infoLog[digits] == ':') &&
+                          std::isdigit((unsigned char)infoLog[digits + 1]);
+        int sourceNumber = isLocation ? std::atoi(infoLog.c_str() + position) : 0;
+        if (sourceNumber > 0 && sourceNumber < (int)m_sourceNames.size())
         {
-            state += 1;
+            output.append(infoLog, start, position - start);
+            output.append(m_sourceNames[sourceNumber]);
+            output.append(infoLog, digits, end - digits);
         }
-        else if (c == 'd' && state == 6)
+        else
         {
-            state += 1;
+            output.append(infoLog, start, end - start);
         }
-        else if (c == 'e' && state == 7)
+        start = end;
+    }
+    return output;
+}
+
+const std::string* CShaderPreprocessor::readInclude(const std::string& file)
+{
+    auto iter = m_includeCache.find(file);
+    if (iter != m_includeCache.end())
+    {
+        return &iter->second;
+    }
+
+    std::string text;
+    if (m_fileSystem != nullptr)
+    {
+        if (!m_fileSystem->readFile(file, text))
         {
-            state += 1;
+            LOG_ERROR("Failed to read include file %s.", file.c_str());
+            return nullptr;
         }
-        else if (c == ' ' && state == 8)
+    }
+    else
+    {
+        std::ifstream include(file);
+        if (!include.is_open())
         {
-            state += 1;
+            LOG_ERROR("Failed to open include file %s.", file.c_str());
+            return nullptr;
         }
-        else if (c == '"' && state == 9)
+        std::stringstream ss;
+        ss << include.rdbuf();
+        text = ss.str();
+    }
+    return &(m_includeCache[file] = std::move(text));
+}
+
+bool CShaderPreprocessor::expand(const std::string& file, const std::string& code,
+                                 int sourceNumber, std::vector<std::string>& includeStack,
+                                 std::unordered_set<std::string>& onceFiles, std::string& output)
+{
+    unsigned int line = 0;
+    size_t start = 0;
+    while (start < code.size())
+    {
+        ++line;
+        size_t end = code.find('\n', start);
+        if (end == std::string::npos)
         {
-            state += 1;  // State 10 reads includeFile
-            includeFile.clear();
+            end = code.size();
         }
-        else if (c == '"' && state == 10)
+
+        // Directives start with # as first character of the line
+        size_t position = skipBlanks(code, start, end);
+        if (position < end && code[position] == '#')
         {
-            state = 0;  // Reset state
-            std::ifstream include(m_includePath + includeFile);
-            if (!include.is_open())
+            position = skipBlanks(code, position + 1, end);
+            if (matchWord(code, position, end, "include"))
+            {
+                position = skipBlanks(code, position + 7, end);
+                char close = position < end && code[position] == '<' ? '>' : '"';
+                size_t nameEnd = position < end && (code[position] == '"' || code[position] == '<')
+                                     ? code.find(close, position + 1)
+                                     : std::string::npos;
+                if (nameEnd == std::string::npos || nameEnd > end)
+                {
+                    LOG_ERROR("Malformed include directive in %s, line %u.", file.c_str(), line);
+                    return false;
+                }
+                std::string include =
+                    m_includePath + code.substr(position + 1, nameEnd - position - 1);
+                if (!file.empty())
+                {
+                    addDependency(file, include);
+                }
+
+                if (std::find(includeStack.begin(), includeStack.end(), include) !=
+                    includeStack.end())
+                {
+                    std::string cycle;
+                    for (const std::string& entry : includeStack)
+                    {
+                        cycle += (entry.empty() ? "<source>" : entry) + " -> ";
+                    }
+                    LOG_ERROR("Include cycle %s%s.", cycle.c_str(), include.c_str());
+                    return false;
+                }
+
+                if (onceFiles.count(include) == 0)
+                {
+                    const std::string* text = readInclude(include);
+                    if (text == nullptr)
+                    {
+                        LOG_ERROR("Failed to include file %s in %s, line %u.", include.c_str(),
+                                  file.c_str(), line);
+                        return false;
+                    }
+                    int includeNumber = getSourceNumber(include);
+                    output += "#line 1 " + std::to_string(includeNumber) + "\n";
+
+                    includeStack.push_back(include);
+                    if (!expand(include, *text, includeNumber, includeStack, onceFiles, output))
+                    {
+                        return false;
+                    }
+                    includeStack.pop_back();
+
+                    if (!output.empty() && output.back() != '\n')
+                    {
+                        output += '\n';
+                    }
+                    // Continue with the line after the include
+                    output += "#line " + std::to_string(line + 1) + " " +
+                              std::to_string(sourceNumber) + "\n";
+                }
+                else
+                {
+                    // Keep line count
+                    output += '\n';
+                }
+                start = end + 1;
+                continue;
+            }
+            if (matchWord(code, position, end, "pragma") &&
+                matchWord(code, skipBlanks(code, position + 6, end), end, "once"))
             {
-                LOG_ERROR("Failed to open include file %s.", (m_includePath + includeFile).c_str());
-                return false;
+                onceFiles.insert(file);
+                // Keep line count
+                output += '\n';
+                start = end + 1;
+                continue;
             }
-            ss << include.rdbuf();
-            include.close();
-        }
-        else if (state == 10)
-        {
-            includeFile.push_back(c);
-        }
-        else
-        {
-            state = 0;  // Reset state
-            ss << c;    // Write into buffer
         }
+
+        // Copy line including line break
+        output.append(code, start, std::min(end + 1, code.size()) - start);
+        start = end + 1;
     }
     return true;
-}
\ No newline at end of file
+}
+
+int CShaderPreprocessor::getSourceNumber(const std::string& file)
+{
+    auto iter = m_sourceNumbers.find(file);
+    if (iter != m_sourceNumbers.end())
+    {
+        return iter->second;
+    }
+    int sourceNumber = (int)m_sourceNames.size();
+    m_sourceNumbers[file] = sourceNumber;
+    m_sourceNames.push_back(file);
+    LOG_DEBUG("Shader include file %s is source string %i.", file.c_str(), sourceNumber);
+    return sourceNumber;
+}
+
+void CShaderPreprocessor::injectDefines(std::string& shaderCode) const
+{
+    if (m_defines.empty())
+    {
+        return;
+    }
+    std::string defines;
+    for (const std::string& define : m_defines)
+    {
+        defines += "#define " + define + "\n";
+    }
+
+    // #version must stay the first directive
+    size_t version = shaderCode.find("#version");
+    if (version == std::string::npos)
+    {
+        shaderCode.insert(0, defines + "#line 1 0\n");
+        return;
+    }
+    size_t lineEnd = shaderCode.find('\n', version);
+    if (lineEnd == std::string::npos)
+    {
+        shaderCode += "\n" + defines;
+        return;
+    }
+    // Restore line numbers of the code following the version directive
+    long versionLine = std::count(shaderCode.begin(), shaderCode.begin() + version, '\n') + 1;
+    defines += "#line " + std::to_string(versionLine + 1) + " 0\n";
+    shaderCode.insert(lineEnd + 1, defines);
+}
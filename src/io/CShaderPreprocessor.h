@@ -1,14 +1,116 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+class CVirtualFileSystem;
+
+/**
+* \brief Resolves include directives of shader source code.
+* Include files are read once and cached until invalidated. Nested includes are expanded
+* recursively, include cycles are reported as errors and files with "#pragma once" are only
+* expanded once per shader. #line directives keep compile errors pointing to the original file and
+* line, with the source string number identifying the file, see getSourceName. Every include is
+* recorded in a dependency graph, so the files affected by a changed include can be found.
+*/
 class CShaderPreprocessor
 {
    public:
+    CShaderPreprocessor();
+
     void setIncludePath(const std::string& includePath);
 
+    /**
+    * \brief Sets file system used to read include files.
+    * Include files are read from disk if no file system is set.
+    */
+    void setFileSystem(const CVirtualFileSystem* fileSystem);
+
+    /**
+    * \brief Sets defines injected after the #version directive of preprocessed code.
+    * Each define is a name, optionally followed by a value, e.g. "HAS_NORMAL_MAP" or
+    * "SAMPLES 4".
+    */
+    void setDefines(const std::vector<std::string>& defines);
+
     bool preprocess(const std::string& shaderCode, std::string& preprocessedShaderCode);
 
+    /**
+    * \brief Preprocesses code of a source file and records its includes as dependencies.
+    */
+    bool preprocess(const std::string& file, const std::string& shaderCode,
+                    std::string& preprocessedShaderCode);
+
+    /**
+    * \brief Records that the file depends on another file, e.g. a shader program on its stages.
+    */
+    void addDependency(const std::string& file, const std::string& dependency);
+
+    /**
+    * \brief Returns all files, which depend directly or indirectly on the file.
+    */
+    void getDependents(const std::string& file, std::vector<std::string>& dependents) const;
+
+    /**
+    * \brief Returns all files, which the file depends on directly or indirectly.
+    */
+    void getDependencies(const std::string& file, std::vector<std::string>& dependencies) const;
+
+    /**
+    * \brief Drops the cached contents and dependencies of an include file.
+    * The file is read again on the next include.
+    */
+    void invalidate(const std::string& file);
+
+    /**
+    * \brief Returns file of a source string number used in #line directives.
+    * Source string 0 is the preprocessed file itself.
+    */
+    const std::string& getSourceName(int sourceNumber) const;
+
+    /**
+    * \brief Replaces source string numbers of include files in a compile info log by file names.
+    * Handles the "N(line)" and "N:line" location prefixes of common drivers, e.g.
+    * "2(14) : error" becomes "data/shadersource/include/lighting.glsl(14) : error".
+    */
+    std::string mapSourceNames(const std::string& infoLog) const;
+
    private:
+    /**
+    * \brief Returns cached include file contents, reads the file on first use.
+    */
+    const std::string* readInclude(const std::string& file);
+
+    /**
+    * \brief Appends code with expanded includes to the output.
+    * \param includeStack Files currently being expanded, used for cycle detection.
+    * \param onceFiles Files marked with "#pragma once", which have been expanded.
+    */
+    bool expand(const std::string& file, const std::string& code, int sourceNumber,
+                std::vector<std::string>& includeStack,
+                std::unordered_set<std::string>& onceFiles, std::string& output);
+
+    /**
+    * \brief Returns source string number of an include file.
+    */
+    int getSourceNumber(const std::string& file);
+
+    /**
+    * \brief Inserts defines after the #version line or at the start of the code.
+    */
+    void injectDefines(std::string& shaderCode) const;
+
     std::string m_includePath;
-};
\ No newline at end of file
+    const CVirtualFileSystem* m_fileSystem;
+    std::vector<std::string> m_defines; /**< Injected defines. */
+
+    std::unordered_map<std::string, std::string>
+        m_includeCache; /**< Contents of include files. */
+    std::unordered_map<std::string, std::unordered_set<std::string>>
+        m_dependencies; /**< Direct dependencies per file. */
+    std::unordered_map<std::string, int>
+        m_sourceNumbers;                   /**< Source string numbers of include files. */
+    std::vector<std::string> m_sourceNames; /**< Files per source string number. */
+};
@@ -0,0 +1,75 @@
+#include "CVirtualFileSystem.h"
+
+#include <fstream>
+
+#include "CPackFile.h"
+
+#include "debug/Log.h"
+
+CVirtualFileSystem::CVirtualFileSystem() { return; }
+
+CVirtualFileSystem::~CVirtualFileSystem() { return; }
+
+bool CVirtualFileSystem::mount(const std::string& packFile)
+{
+    std::unique_ptr<CPackFile> pack(new CPackFile);
+    if (!pack->open(packFile))
+    {
+        LOG_ERROR("Failed to mount pack file %s.", packFile.c_str());
+        return false;
+    }
+    m_packs.push_back(std::move(pack));
+    return true;
+}
+
+void CVirtualFileSystem::unmountAll() { m_packs.clear(); }
+
+bool CVirtualFileSystem::exists(const std::string& file) const
+{
+    for (auto iter = m_packs.rbegin(); iter != m_packs.rend(); ++iter)
+    {
+        if ((*iter)->contains(file))
+        {
+            return true;
+        }
+    }
+    std::ifstream ifs(file);
+    return ifs.is_open();
+}
+
+bool CVirtualFileSystem::readFile(const std::string& file, std::vector<unsigned char>& data) const
+{
+    for (auto iter = m_packs.rbegin(); iter != m_packs.rend(); ++iter)
+    {
+        if ((*iter)->read(file, data))
+        {
+            return true;
+        }
+    }
+
+    std::ifstream ifs(file, std::ios::binary | std::ios::ate);
+    if (!ifs.is_open())
+    {
+        return false;
+    }
+    std::streamoff size = ifs.tellg();
+    ifs.seekg(0, std::ios::beg);
+    data.resize(static_cast<size_t>(size));
+    if (size > 0 && !ifs.read(reinterpret_cast<char*>(data.data()), size))
+    {
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CVirtualFileSystem::readFile(const std::string& file, std::string& text) const
+{
+    std::vector<unsigned char> data;
+    if (!readFile(file, data))
+    {
+        return false;
+    }
+    text.assign(data.begin(), data.end());
+    return true;
+}
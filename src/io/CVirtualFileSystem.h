@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class CPackFile;
+
+/**
+* \brief Virtual file layer.
+* Resolves file paths against mounted pack files before falling back to the native file system.
+* Packs mounted later take precedence over earlier ones.
+*/
+class CVirtualFileSystem
+{
+   public:
+    CVirtualFileSystem();
+    ~CVirtualFileSystem();
+
+    /**
+    * \brief Mounts pack file.
+    */
+    bool mount(const std::string& packFile);
+
+    /**
+    * \brief Unmounts all pack files.
+    */
+    void unmountAll();
+
+    /**
+    * \brief Returns whether the file exists in a mounted pack or on disk.
+    */
+    bool exists(const std::string& file) const;
+
+    /**
+    * \brief Reads whole file as binary data.
+    */
+    bool readFile(const std::string& file, std::vector<unsigned char>& data) const;
+
+    /**
+    * \brief Reads whole file as text.
+    */
+    bool readFile(const std::string& file, std::string& text) const;
+
+   private:
+    std::vector<std::unique_ptr<CPackFile>> m_packs; /**< Mounted packs, searched in reverse. */
+};
@@ -0,0 +1,22 @@
+#include "PackFormat.h"
+
+#include "util/Hash.h"
+
+std::string normalizePackPath(const std::string& path)
+{
+    std::string normalized = path;
+    for (char& c : normalized)
+    {
+        if (c == '\\')
+        {
+            c = '/';
+        }
+    }
+    while (normalized.compare(0, 2, "./") == 0)
+    {
+        normalized.erase(0, 2);
+    }
+    return normalized;
+}
+
+uint64_t hashPackPath(const std::string& normalizedPath) { return hashFnv1a(normalizedPath); }
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+* \brief Pack file layout.
+* A pack file bundles asset files into a single archive which is memory mapped on load.
+*
+* [SPackHeader]
+* [SPackEntry x entryCount], sorted by path hash
+* [Path string table], entries reference their path by offset and length
+* [Blob data], each blob starts at a multiple of packBlobAlignment
+*
+* All values are stored little endian.
+*/
+
+static const char packMagic[4] = {'R', 'P', 'A', 'K'}; /**< Pack file magic bytes. */
+static const uint32_t packVersion = 1;                 /**< Current pack file version. */
+static const uint64_t packBlobAlignment = 16;          /**< Blob alignment in bytes. */
+
+/**
+* \brief Pack entry flags.
+*/
+static const uint32_t packEntryCompressed = 1; /**< Blob is zlib compressed. */
+
+/**
+* \brief Pack file header.
+*/
+struct SPackHeader
+{
+    char m_magic[4];              /**< Magic bytes, must match packMagic. */
+    uint32_t m_version;           /**< Pack format version. */
+    uint32_t m_entryCount;        /**< Number of file entries in the index. */
+    uint32_t m_reserved;          /**< Reserved, must be zero. */
+    uint64_t m_stringTableOffset; /**< Offset of the path string table from file start. */
+    uint64_t m_stringTableSize;   /**< Size of the path string table in bytes. */
+};
+
+/**
+* \brief Pack index entry.
+*/
+struct SPackEntry
+{
+    uint64_t m_hash;       /**< Hash of the normalized path. */
+    uint64_t m_offset;     /**< Blob offset from file start. */
+    uint64_t m_size;       /**< Uncompressed blob size in bytes. */
+    uint64_t m_storedSize; /**< Stored blob size in bytes. */
+    uint32_t m_pathOffset; /**< Path offset into string table. */
+    uint32_t m_pathLength; /**< Path length in bytes. */
+    uint32_t m_flags;      /**< Entry flags. */
+    uint32_t m_reserved;   /**< Reserved, must be zero. */
+};
+
+static_assert(sizeof(SPackHeader) == 32, "Unexpected pack header size");
+static_assert(sizeof(SPackEntry) == 48, "Unexpected pack entry size");
+
+/**
+* \brief Normalizes path for pack lookup.
+* Converts backslashes to forward slashes and strips leading "./".
+*/
+std::string normalizePackPath(const std::string& path);
+
+/**
+* \brief Returns hash of normalized pack path.
+*/
+uint64_t hashPackPath(const std::string& normalizedPath);
@@ -0,0 +1,101 @@
+#include "RawImageFormat.h"
+
+#include <cstring>
+
+std::string getRawImageFile(const std::string& file)
+{
+    auto dot = file.find_last_of('.');
+    auto slash = file.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return file + rawImageExtension;
+    }
+    return file.substr(0, dot) + rawImageExtension;
+}
+
+bool encodeRawImage(const std::vector<unsigned char>& pixels, unsigned int width,
+                    unsigned int height, unsigned int channels, std::vector<unsigned char>& file)
+{
+    if (channels != 1 && channels != 3 && channels != 4)
+    {
+        return false;
+    }
+    size_t size = size_t(width) * height * channels;
+    if (pixels.size() != size)
+    {
+        return false;
+    }
+
+    SRawImageHeader header;
+    std::memcpy(header.m_magic, rawImageMagic, sizeof(header.m_magic));
+    header.m_version = rawImageVersion;
+    header.m_width = width;
+    header.m_height = height;
+    header.m_channels = channels;
+    header.m_reserved = 0;
+
+    file.resize(sizeof(header) + size);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), pixels.data(), size);
+    return true;
+}
+
+bool decodeRawImage(const std::vector<unsigned char>& file, unsigned int channels,
+                    std::vector<unsigned char>& pixels, unsigned int& width, unsigned int& height)
+{
+    if (file.size() < sizeof(SRawImageHeader))
+    {
+        return false;
+    }
+    SRawImageHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.m_magic, rawImageMagic, sizeof(header.m_magic)) != 0 ||
+        header.m_version != rawImageVersion)
+    {
+        return false;
+    }
+    unsigned int sourceChannels = header.m_channels;
+    size_t pixelCount = size_t(header.m_width) * header.m_height;
+    if ((sourceChannels != 1 && sourceChannels != 3 && sourceChannels != 4) ||
+        file.size() - sizeof(header) != pixelCount * sourceChannels)
+    {
+        return false;
+    }
+    if (channels != 1 && channels != 3 && channels != 4)
+    {
+        return false;
+    }
+
+    width = header.m_width;
+    height = header.m_height;
+    const unsigned char* source = file.data() + sizeof(header);
+    if (sourceChannels == channels)
+    {
+        pixels.assign(source, source + pixelCount * channels);
+        return true;
+    }
+
+    // Channel conversion
+    pixels.resize(pixelCount * channels);
+    unsigned char* target = pixels.data();
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        const unsigned char* in = source + i * sourceChannels;
+        unsigned char* out = target + i * channels;
+        unsigned char r = in[0];
+        unsigned char g = sourceChannels == 1 ? in[0] : in[1];
+        unsigned char b = sourceChannels == 1 ? in[0] : in[2];
+        unsigned char a = sourceChannels == 4 ? in[3] : 255;
+        out[0] = r;
+        if (channels >= 3)
+        {
+            out[1] = g;
+            out[2] = b;
+        }
+        if (channels == 4)
+        {
+            out[3] = a;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+* \brief Raw image container layout.
+* Stores decoded 8 bit pixel data, so loading is a copy instead of an inflate and unfilter pass.
+* Pre-converted images are created with the RTRImageConverter tool and stored next to the source
+* PNG file with the rawImageExtension, e.g. data/images/wall.png becomes data/images/wall.rimg.
+*
+* [SRawImageHeader]
+* [Pixel data], width * height * channels bytes, rows stored top to bottom
+*
+* All values are stored little endian.
+*/
+
+static const char rawImageMagic[4] = {'R', 'I', 'M', 'G'}; /**< Raw image magic bytes. */
+static const uint32_t rawImageVersion = 1;                 /**< Current raw image version. */
+static const char* const rawImageExtension = ".rimg";      /**< File extension of raw images. */
+
+/**
+* \brief Raw image header.
+*/
+struct SRawImageHeader
+{
+    char m_magic[4];     /**< Magic bytes, must match rawImageMagic. */
+    uint32_t m_version;  /**< Raw image format version. */
+    uint32_t m_width;    /**< Image width in pixels. */
+    uint32_t m_height;   /**< Image height in pixels. */
+    uint32_t m_channels; /**< Number of 8 bit channels, 1, 3 or 4. */
+    uint32_t m_reserved; /**< Reserved, must be zero. */
+};
+
+static_assert(sizeof(SRawImageHeader) == 24, "Unexpected raw image header size");
+
+/**
+* \brief Returns raw image file name for an image file.
+* Replaces the file extension with the raw image extension.
+*/
+std::string getRawImageFile(const std::string& file);
+
+/**
+* \brief Creates raw image file data from pixel data.
+*/
+bool encodeRawImage(const std::vector<unsigned char>& pixels, unsigned int width,
+                    unsigned int height, unsigned int channels, std::vector<unsigned char>& file);
+
+/**
+* \brief Decodes raw image file data.
+* The pixel data is converted to the requested channel count. Like lodepng, grey values are taken
+* from the red channel and a missing alpha channel is opaque.
+*/
+bool decodeRawImage(const std::vector<unsigned char>& file, unsigned int channels,
+                    std::vector<unsigned char>& pixels, unsigned int& width, unsigned int& height);
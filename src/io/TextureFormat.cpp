@@ -0,0 +1,113 @@
+#include "TextureFormat.h"
+
+#include <cstring>
+
+#include "resource/ImageFormat.h"
+
+/**
+* \brief Replaces file extension.
+*/
+static std::string replaceExtension(const std::string& file, const char* extension)
+{
+    auto dot = file.find_last_of('.');
+    auto slash = file.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return file + extension;
+    }
+    return file.substr(0, dot) + extension;
+}
+
+std::string getTextureFile(const std::string& file)
+{
+    return replaceExtension(file, textureExtension);
+}
+
+std::string getTextureCacheFile(const std::string& file)
+{
+    return replaceExtension(file, textureCacheExtension);
+}
+
+uint32_t getTextureSourceHash(const std::vector<unsigned char>& data, EImageContent content,
+                              EMipFilter filter)
+{
+    // FNV-1a, 0 is reserved for uncached textures
+    uint32_t hash = 2166136261u;
+    for (unsigned char value : data)
+    {
+        hash = (hash ^ value) * 16777619u;
+    }
+    hash = (hash ^ static_cast<unsigned char>(content)) * 16777619u;
+    hash = (hash ^ static_cast<unsigned char>(filter)) * 16777619u;
+    return hash == 0 ? 1 : hash;
+}
+
+bool encodeTexture(const std::vector<unsigned char>& data, unsigned int width,
+                   unsigned int height, EColorFormat format, unsigned int mipCount,
+                   std::vector<unsigned char>& file, uint32_t sourceHash)
+{
+    if (getChannelCount(format) == 0 || mipCount == 0 || mipCount > getMipCount(width, height))
+    {
+        return false;
+    }
+    size_t size = getMipChainSize(format, width, height, mipCount);
+    if (data.size() != size)
+    {
+        return false;
+    }
+
+    STextureHeader header;
+    std::memcpy(header.m_magic, textureMagic, sizeof(header.m_magic));
+    header.m_version = textureVersion;
+    header.m_width = width;
+    header.m_height = height;
+    header.m_format = static_cast<uint32_t>(format);
+    header.m_mipCount = mipCount;
+    header.m_sourceHash = sourceHash;
+    header.m_reserved = 0;
+
+    file.resize(sizeof(header) + size);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), data.data(), size);
+    return true;
+}
+
+bool decodeTexture(const std::vector<unsigned char>& file, std::vector<unsigned char>& data,
+                   unsigned int& width, unsigned int& height, EColorFormat& format,
+                   unsigned int& mipCount, uint32_t* sourceHash)
+{
+    if (file.size() < sizeof(STextureHeader))
+    {
+        return false;
+    }
+    STextureHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.m_magic, textureMagic, sizeof(header.m_magic)) != 0 ||
+        header.m_version != textureVersion)
+    {
+        return false;
+    }
+    EColorFormat storedFormat = static_cast<EColorFormat>(header.m_format);
+    if (getChannelCount(storedFormat) == 0 || header.m_mipCount == 0 ||
+        header.m_mipCount > getMipCount(header.m_width, header.m_height))
+    {
+        return false;
+    }
+    size_t size = getMipChainSize(storedFormat, header.m_width, header.m_height,
+                                  header.m_mipCount);
+    if (file.size() - sizeof(header) != size)
+    {
+        return false;
+    }
+
+    width = header.m_width;
+    height = header.m_height;
+    format = storedFormat;
+    mipCount = header.m_mipCount;
+    if (sourceHash != nullptr)
+    {
+        *sourceHash = header.m_sourceHash;
+    }
+    data.assign(file.begin() + sizeof(header), file.end());
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "resource/ResourceConfig.h"
+
+/**
+* \brief Texture container layout.
+* Stores ready to upload texture data with a precomputed mip chain, either uncompressed 8 bit
+* channels or block compressed. Textures are created with the RTRTextureCompressor tool and stored
+* next to the source PNG file with the textureExtension, e.g. data/images/wall.png becomes
+* data/images/wall.rtex. The resource manager prefers textures over raw images and PNG files.
+*
+* The resource manager also caches generated mip chains of uncompressed images as textures with
+* the textureCacheExtension next to the image file. Cached textures store a hash of the source
+* file and are regenerated if the source changes.
+*
+* [STextureHeader]
+* [Mip level 0], level data size is getImageSize(format, width, height)
+* [Mip level 1]
+* ...
+*
+* All values are stored little endian.
+*/
+
+static const char textureMagic[4] = {'R', 'T', 'E', 'X'};      /**< Texture magic bytes. */
+static const uint32_t textureVersion = 1;                      /**< Current texture version. */
+static const char* const textureExtension = ".rtex";           /**< File extension of textures. */
+static const char* const textureCacheExtension = ".mips.rtex"; /**< Extension of mip caches. */
+
+/**
+* \brief Texture header.
+*/
+struct STextureHeader
+{
+    char m_magic[4];       /**< Magic bytes, must match textureMagic. */
+    uint32_t m_version;    /**< Texture format version. */
+    uint32_t m_width;      /**< Width of the first mip level in pixels. */
+    uint32_t m_height;     /**< Height of the first mip level in pixels. */
+    uint32_t m_format;     /**< Color format, value of EColorFormat. */
+    uint32_t m_mipCount;   /**< Number of stored mip levels, at least 1. */
+    uint32_t m_sourceHash; /**< Hash of the source file for cached textures, 0 otherwise. */
+    uint32_t m_reserved;   /**< Reserved, must be zero. */
+};
+
+static_assert(sizeof(STextureHeader) == 32, "Unexpected texture header size");
+
+/**
+* \brief Returns texture file name for an image file.
+* Replaces the file extension with the texture extension.
+*/
+std::string getTextureFile(const std::string& file);
+
+/**
+* \brief Returns mip cache file name for an image file.
+*/
+std::string getTextureCacheFile(const std::string& file);
+
+/**
+* \brief Returns hash of source file data and mip generation settings, stored in cached textures.
+* The content and filter change the generated mip levels, so caches of other settings are stale.
+*/
+uint32_t getTextureSourceHash(const std::vector<unsigned char>& data, EImageContent content,
+                              EMipFilter filter);
+
+/**
+* \brief Creates texture file data from a mip chain.
+* The data contains all mip levels, starting with the largest level.
+*/
+bool encodeTexture(const std::vector<unsigned char>& data, unsigned int width,
+                   unsigned int height, EColorFormat format, unsigned int mipCount,
+                   std::vector<unsigned char>& file, uint32_t sourceHash = 0);
+
+/**
+* \brief Decodes texture file data.
+* Returns the stored mip chain without conversion.
+*/
+bool decodeTexture(const std::vector<unsigned char>& file, std::vector<unsigned char>& data,
+                   unsigned int& width, unsigned int& height, EColorFormat& format,
+                   unsigned int& mipCount, uint32_t* sourceHash = nullptr);
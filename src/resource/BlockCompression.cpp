@@ -0,0 +1,512 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "ImageFormat.h"
+
+static uint16_t packColor565(const float* color)
+{
+    int r = int(std::max(0.f, std::min(255.f, color[0])) * 31.f / 255.f + 0.5f);
+    int g = int(std::max(0.f, std::min(255.f, color[1])) * 63.f / 255.f + 0.5f);
+    int b = int(std::max(0.f, std::min(255.f, color[2])) * 31.f / 255.f + 0.5f);
+    return uint16_t((r << 11) | (g << 5) | b);
+}
+
+static void unpackColor565(uint16_t packed, unsigned char* color)
+{
+    unsigned int r = (packed >> 11) & 31;
+    unsigned int g = (packed >> 5) & 63;
+    unsigned int b = packed & 31;
+    color[0] = (unsigned char)((r << 3) | (r >> 2));
+    color[1] = (unsigned char)((g << 2) | (g >> 4));
+    color[2] = (unsigned char)((b << 3) | (b >> 2));
+}
+
+static uint16_t readUint16(const unsigned char* data)
+{
+    return uint16_t(data[0] | (data[1] << 8));
+}
+
+static void writeUint16(uint16_t value, unsigned char* data)
+{
+    data[0] = (unsigned char)(value & 0xff);
+    data[1] = (unsigned char)(value >> 8);
+}
+
+/**
+* \brief Creates the 4 color palette from two 565 endpoints.
+* The 3 color mode with transparent black is selected if the first endpoint is not greater than
+* the second one and is only used for BC1 blocks.
+*/
+static void createColorPalette(uint16_t c0, uint16_t c1, bool allowThreeColor,
+                               unsigned char palette[4][4])
+{
+    unpackColor565(c0, palette[0]);
+    unpackColor565(c1, palette[1]);
+    palette[0][3] = 255;
+    palette[1][3] = 255;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        if (c0 > c1 || !allowThreeColor)
+        {
+            palette[2][i] = (unsigned char)((2 * palette[0][i] + palette[1][i] + 1) / 3);
+            palette[3][i] = (unsigned char)((palette[0][i] + 2 * palette[1][i] + 1) / 3);
+        }
+        else
+        {
+            palette[2][i] = (unsigned char)((palette[0][i] + palette[1][i] + 1) / 2);
+            palette[3][i] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = (c0 > c1 || !allowThreeColor) ? 255 : 0;
+}
+
+/**
+* \brief Selects nearest palette entry for each texel, returns packed 2 bit indices.
+*/
+static uint32_t selectColorIndices(const unsigned char* rgba, const unsigned char palette[4][4])
+{
+    uint32_t indices = 0;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        const unsigned char* texel = rgba + i * 4;
+        int bestError = 0x7fffffff;
+        uint32_t best = 0;
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            int dr = int(texel[0]) - palette[j][0];
+            int dg = int(texel[1]) - palette[j][1];
+            int db = int(texel[2]) - palette[j][2];
+            int error = dr * dr + dg * dg + db * db;
+            if (error < bestError)
+            {
+                bestError = error;
+                best = j;
+            }
+        }
+        indices |= best << (2 * i);
+    }
+    return indices;
+}
+
+/**
+* \brief Computes endpoints along the principal axis of the block colors.
+*/
+static void computeColorEndpoints(const unsigned char* rgba, float* start, float* end)
+{
+    float mean[3] = {0.f, 0.f, 0.f};
+    float minColor[3] = {255.f, 255.f, 255.f};
+    float maxColor[3] = {0.f, 0.f, 0.f};
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            float value = rgba[i * 4 + c];
+            mean[c] += value;
+            minColor[c] = std::min(minColor[c], value);
+            maxColor[c] = std::max(maxColor[c], value);
+        }
+    }
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+        mean[c] /= 16.f;
+    }
+
+    // Covariance matrix, symmetric
+    float cov[6] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        float r = rgba[i * 4] - mean[0];
+        float g = rgba[i * 4 + 1] - mean[1];
+        float b = rgba[i * 4 + 2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    // Principal axis by power iteration, starting with the bounding box diagonal
+    float axis[3] = {maxColor[0] - minColor[0], maxColor[1] - minColor[1],
+                     maxColor[2] - minColor[2]};
+    for (unsigned int iteration = 0; iteration < 8; ++iteration)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float length = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+        if (length < 1e-6f)
+        {
+            break;
+        }
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+    float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    if (length < 1e-6f)
+    {
+        // Single color block
+        std::copy(mean, mean + 3, start);
+        std::copy(mean, mean + 3, end);
+        return;
+    }
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+        axis[c] /= length;
+    }
+
+    // Project colors onto axis
+    float minProjection = 1e10f;
+    float maxProjection = -1e10f;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        float projection = (rgba[i * 4] - mean[0]) * axis[0] +
+                           (rgba[i * 4 + 1] - mean[1]) * axis[1] +
+                           (rgba[i * 4 + 2] - mean[2]) * axis[2];
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+        start[c] = mean[c] + axis[c] * maxProjection;
+        end[c] = mean[c] + axis[c] * minProjection;
+    }
+}
+
+/**
+* \brief Refits endpoints to the selected indices with a least squares solve.
+* Returns false if the system is degenerate.
+*/
+static bool refitColorEndpoints(const unsigned char* rgba, uint32_t indices, float* start,
+                                float* end)
+{
+    static const float weights[4] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+    float aa = 0.f;
+    float ab = 0.f;
+    float bb = 0.f;
+    float ax[3] = {0.f, 0.f, 0.f};
+    float bx[3] = {0.f, 0.f, 0.f};
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        float a = weights[(indices >> (2 * i)) & 3];
+        float b = 1.f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            ax[c] += a * rgba[i * 4 + c];
+            bx[c] += b * rgba[i * 4 + c];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f)
+    {
+        return false;
+    }
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+        start[c] = (ax[c] * bb - bx[c] * ab) / det;
+        end[c] = (bx[c] * aa - ax[c] * ab) / det;
+    }
+    return true;
+}
+
+static int computeColorError(const unsigned char* rgba, uint32_t indices,
+                             const unsigned char palette[4][4])
+{
+    int error = 0;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        const unsigned char* color = palette[(indices >> (2 * i)) & 3];
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            int d = int(rgba[i * 4 + c]) - color[c];
+            error += d * d;
+        }
+    }
+    return error;
+}
+
+/**
+* \brief Encodes endpoints and indices in 4 color mode.
+*/
+static void encodeColorBlock(const unsigned char* rgba, unsigned char* block)
+{
+    float start[3];
+    float end[3];
+    computeColorEndpoints(rgba, start, end);
+
+    uint16_t c0 = packColor565(start);
+    uint16_t c1 = packColor565(end);
+    unsigned char palette[4][4];
+    createColorPalette(c0, c1, false, palette);
+    uint32_t indices = selectColorIndices(rgba, palette);
+    int error = computeColorError(rgba, indices, palette);
+
+    // Single least squares refinement pass
+    if (c0 != c1 && refitColorEndpoints(rgba, indices, start, end))
+    {
+        uint16_t refitC0 = packColor565(start);
+        uint16_t refitC1 = packColor565(end);
+        unsigned char refitPalette[4][4];
+        createColorPalette(refitC0, refitC1, false, refitPalette);
+        uint32_t refitIndices = selectColorIndices(rgba, refitPalette);
+        int refitError = computeColorError(rgba, refitIndices, refitPalette);
+        if (refitError < error)
+        {
+            c0 = refitC0;
+            c1 = refitC1;
+            indices = refitIndices;
+        }
+    }
+
+    // Order endpoints for 4 color mode, index 0 and 1 swap as well as index 2 and 3
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        indices ^= 0x55555555;
+    }
+    else if (c0 == c1)
+    {
+        indices = 0;
+    }
+
+    writeUint16(c0, block);
+    writeUint16(c1, block + 2);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        block[4 + i] = (unsigned char)((indices >> (8 * i)) & 0xff);
+    }
+}
+
+static void decodeColorBlock(const unsigned char* block, bool allowThreeColor,
+                             unsigned char* rgba)
+{
+    unsigned char palette[4][4];
+    createColorPalette(readUint16(block), readUint16(block + 2), allowThreeColor, palette);
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32_t(block[7]) << 24);
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        std::memcpy(rgba + i * 4, palette[(indices >> (2 * i)) & 3], 4);
+    }
+}
+
+void encodeBlockBC1(const unsigned char* rgba, unsigned char* block)
+{
+    encodeColorBlock(rgba, block);
+}
+
+void encodeBlockBC3(const unsigned char* rgba, unsigned char* block)
+{
+    encodeBlockBC4(rgba, 3, block);
+    encodeColorBlock(rgba, block + 8);
+}
+
+void encodeBlockBC4(const unsigned char* rgba, unsigned int channel, unsigned char* block)
+{
+    unsigned char minValue = 255;
+    unsigned char maxValue = 0;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        minValue = std::min(minValue, rgba[i * 4 + channel]);
+        maxValue = std::max(maxValue, rgba[i * 4 + channel]);
+    }
+
+    // 8 value mode, first endpoint is the maximum
+    block[0] = maxValue;
+    block[1] = minValue;
+    uint64_t indices = 0;
+    if (maxValue != minValue)
+    {
+        // Palette order is max, min and 6 interpolated values from max to min
+        static const unsigned int toPaletteIndex[8] = {1, 7, 6, 5, 4, 3, 2, 0};
+        int range = maxValue - minValue;
+        for (unsigned int i = 0; i < 16; ++i)
+        {
+            // Nearest step between min (0) and max (7)
+            int step = ((rgba[i * 4 + channel] - minValue) * 14 + range) / (2 * range);
+            indices |= uint64_t(toPaletteIndex[step]) << (3 * i);
+        }
+    }
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        block[2 + i] = (unsigned char)((indices >> (8 * i)) & 0xff);
+    }
+}
+
+void encodeBlockBC5(const unsigned char* rgba, unsigned char* block)
+{
+    encodeBlockBC4(rgba, 0, block);
+    encodeBlockBC4(rgba, 1, block + 8);
+}
+
+void decodeBlockBC1(const unsigned char* block, unsigned char* rgba)
+{
+    decodeColorBlock(block, true, rgba);
+}
+
+void decodeBlockBC3(const unsigned char* block, unsigned char* rgba)
+{
+    decodeColorBlock(block + 8, false, rgba);
+    decodeBlockBC4(block, 3, rgba);
+}
+
+void decodeBlockBC4(const unsigned char* block, unsigned int channel, unsigned char* rgba)
+{
+    unsigned int a0 = block[0];
+    unsigned int a1 = block[1];
+    unsigned char palette[8];
+    palette[0] = (unsigned char)a0;
+    palette[1] = (unsigned char)a1;
+    if (a0 > a1)
+    {
+        for (unsigned int i = 1; i < 7; ++i)
+        {
+            palette[1 + i] = (unsigned char)(((7 - i) * a0 + i * a1 + 3) / 7);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 1; i < 5; ++i)
+        {
+            palette[1 + i] = (unsigned char)(((5 - i) * a0 + i * a1 + 2) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        indices |= uint64_t(block[2 + i]) << (8 * i);
+    }
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        rgba[i * 4 + channel] = palette[(indices >> (3 * i)) & 7];
+    }
+}
+
+void decodeBlockBC5(const unsigned char* block, unsigned char* rgba)
+{
+    decodeBlockBC4(block, 0, rgba);
+    decodeBlockBC4(block + 8, 1, rgba);
+}
+
+static size_t getBlockSize(EColorFormat format)
+{
+    return (format == EColorFormat::BC1 || format == EColorFormat::BC4) ? 8 : 16;
+}
+
+bool compressImage(const unsigned char* rgba, unsigned int width, unsigned int height,
+                   EColorFormat format, std::vector<unsigned char>& blocks)
+{
+    if (!isCompressed(format) || width == 0 || height == 0)
+    {
+        return false;
+    }
+    size_t blockSize = getBlockSize(format);
+    blocks.resize(getImageSize(format, width, height));
+    unsigned char* out = blocks.data();
+
+    unsigned char texels[64];
+    for (unsigned int by = 0; by < height; by += 4)
+    {
+        for (unsigned int bx = 0; bx < width; bx += 4)
+        {
+            // Gather block, clamp to edge
+            for (unsigned int y = 0; y < 4; ++y)
+            {
+                unsigned int sy = std::min(by + y, height - 1);
+                for (unsigned int x = 0; x < 4; ++x)
+                {
+                    unsigned int sx = std::min(bx + x, width - 1);
+                    std::memcpy(texels + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+                }
+            }
+
+            switch (format)
+            {
+            case EColorFormat::BC1:
+                encodeBlockBC1(texels, out);
+                break;
+            case EColorFormat::BC3:
+                encodeBlockBC3(texels, out);
+                break;
+            case EColorFormat::BC4:
+                encodeBlockBC4(texels, 0, out);
+                break;
+            case EColorFormat::BC5:
+                encodeBlockBC5(texels, out);
+                break;
+            default:
+                return false;
+            }
+            out += blockSize;
+        }
+    }
+    return true;
+}
+
+bool decompressImage(const unsigned char* blocks, unsigned int width, unsigned int height,
+                     EColorFormat format, std::vector<unsigned char>& rgba)
+{
+    if (!isCompressed(format))
+    {
+        return false;
+    }
+    size_t blockSize = getBlockSize(format);
+    rgba.resize(size_t(width) * height * 4);
+    const unsigned char* in = blocks;
+
+    unsigned char texels[64];
+    for (unsigned int by = 0; by < height; by += 4)
+    {
+        for (unsigned int bx = 0; bx < width; bx += 4)
+        {
+            for (unsigned int i = 0; i < 16; ++i)
+            {
+                texels[i * 4] = 0;
+                texels[i * 4 + 1] = 0;
+                texels[i * 4 + 2] = 0;
+                texels[i * 4 + 3] = 255;
+            }
+
+            switch (format)
+            {
+            case EColorFormat::BC1:
+                decodeBlockBC1(in, texels);
+                break;
+            case EColorFormat::BC3:
+                decodeBlockBC3(in, texels);
+                break;
+            case EColorFormat::BC4:
+                decodeBlockBC4(in, 0, texels);
+                break;
+            case EColorFormat::BC5:
+                decodeBlockBC5(in, texels);
+                break;
+            default:
+                return false;
+            }
+            in += blockSize;
+
+            // Scatter block, skip texels outside of the image
+            for (unsigned int y = 0; y < 4 && by + y < height; ++y)
+            {
+                for (unsigned int x = 0; x < 4 && bx + x < width; ++x)
+                {
+                    std::memcpy(rgba.data() + (size_t(by + y) * width + bx + x) * 4,
+                                texels + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+    return true;
+}
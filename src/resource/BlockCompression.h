@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "ResourceConfig.h"
+
+/**
+* \brief CPU block compression for BC1, BC3, BC4 and BC5 textures.
+* Blocks cover 4x4 texels. Block functions read and write 4x4 RGBA8 texels in row major order,
+* 64 bytes per block. BC4 stores a single channel and BC5 the red and green channel.
+*
+* BC1 is used for diffuse maps, BC3 for diffuse maps with alpha, BC4 for specular, glow and alpha
+* maps and BC5 for normal maps, where the z component is reconstructed in the shader.
+*/
+
+/**
+* \brief Block encoders.
+*/
+void encodeBlockBC1(const unsigned char* rgba, unsigned char* block);
+void encodeBlockBC3(const unsigned char* rgba, unsigned char* block);
+void encodeBlockBC4(const unsigned char* rgba, unsigned int channel, unsigned char* block);
+void encodeBlockBC5(const unsigned char* rgba, unsigned char* block);
+
+/**
+* \brief Block decoders.
+* BC4 and BC5 decoders only write the encoded channels.
+*/
+void decodeBlockBC1(const unsigned char* block, unsigned char* rgba);
+void decodeBlockBC3(const unsigned char* block, unsigned char* rgba);
+void decodeBlockBC4(const unsigned char* block, unsigned int channel, unsigned char* rgba);
+void decodeBlockBC5(const unsigned char* block, unsigned char* rgba);
+
+/**
+* \brief Compresses RGBA8 image into blocks of the compressed format.
+* Texels outside of the image are clamped to the edge for partial blocks.
+*/
+bool compressImage(const unsigned char* rgba, unsigned int width, unsigned int height,
+                   EColorFormat format, std::vector<unsigned char>& blocks);
+
+/**
+* \brief Decompresses blocks into RGBA8 image.
+* Channels not stored by the format are set to 0, alpha to 255.
+*/
+bool decompressImage(const unsigned char* blocks, unsigned int width, unsigned int height,
+                     EColorFormat format, std::vector<unsigned char>& rgba);
@@ -0,0 +1,63 @@
+#include "CResourceHandle.h"
+
+#include <utility>
+
+#include "IResourceManager.h"
+
+CResourceHandle::CResourceHandle()
+    : m_resourceManager(nullptr), m_type(EResourceType::Mesh), m_id(invalidResource)
+{
+    return;
+}
+
+CResourceHandle::CResourceHandle(IResourceManager* resourceManager, EResourceType type,
+                                 ResourceId id)
+    : m_resourceManager(resourceManager), m_type(type), m_id(id)
+{
+    return;
+}
+
+CResourceHandle::CResourceHandle(const CResourceHandle& other)
+    : m_resourceManager(other.m_resourceManager), m_type(other.m_type), m_id(other.m_id)
+{
+    if (isValid())
+    {
+        m_resourceManager->addReference(m_type, m_id);
+    }
+}
+
+CResourceHandle::CResourceHandle(CResourceHandle&& other)
+    : m_resourceManager(other.m_resourceManager), m_type(other.m_type), m_id(other.m_id)
+{
+    other.m_resourceManager = nullptr;
+    other.m_id = invalidResource;
+}
+
+CResourceHandle::~CResourceHandle() { reset(); }
+
+CResourceHandle& CResourceHandle::operator=(CResourceHandle other)
+{
+    std::swap(m_resourceManager, other.m_resourceManager);
+    std::swap(m_type, other.m_type);
+    std::swap(m_id, other.m_id);
+    return *this;
+}
+
+void CResourceHandle::reset()
+{
+    if (isValid())
+    {
+        m_resourceManager->releaseReference(m_type, m_id);
+    }
+    m_resourceManager = nullptr;
+    m_id = invalidResource;
+}
+
+bool CResourceHandle::isValid() const
+{
+    return m_resourceManager != nullptr && m_id != invalidResource;
+}
+
+EResourceType CResourceHandle::getType() const { return m_type; }
+
+ResourceId CResourceHandle::getId() const { return m_id; }
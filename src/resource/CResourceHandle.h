@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ResourceConfig.h"
+
+class IResourceManager;
+
+/**
+* \brief Owning reference to a resource.
+* Adopts a reference returned by a create or load call and releases it on destruction.
+* Copies add a new reference.
+*/
+class CResourceHandle
+{
+   public:
+    CResourceHandle();
+
+    /**
+    * \brief Adopts existing reference to resource.
+    */
+    CResourceHandle(IResourceManager* resourceManager, EResourceType type, ResourceId id);
+
+    CResourceHandle(const CResourceHandle& other);
+    CResourceHandle(CResourceHandle&& other);
+    ~CResourceHandle();
+
+    CResourceHandle& operator=(CResourceHandle other);
+
+    /**
+    * \brief Releases reference and resets handle.
+    */
+    void reset();
+
+    /**
+    * \brief Returns whether the handle references a resource.
+    */
+    bool isValid() const;
+
+    EResourceType getType() const;
+    ResourceId getId() const;
+
+   private:
+    IResourceManager* m_resourceManager; /**< Owning resource manager. */
+    EResourceType m_type;                /**< Resource type. */
+    ResourceId m_id;                     /**< Resource id. */
+};
@@ -2,14 +2,23 @@
 
 #include <vector>
 #include <functional>
+#include <future>
+#include <string>
+#include <cstddef>
 
 #include "ResourceConfig.h"
+#include "SResourceUsage.h"
 
 class IResourceListener; /**< Listener class. */
+class CResourceHandle;   /**< Resource handle class. */
 
 /**
  * \brief Resource manager interface class.
  * Central resource holder and provider.
+ * Resources are reference counted. Every call to a create or load function returns a resource
+ * with one reference owned by the caller, which must be released with releaseReference once the
+ * resource is no longer needed. Unreferenced resources stay cached until they are unloaded
+ * explicitly or evicted to stay within the memory budget.
  */
 class IResourceManager
 {
@@ -39,6 +48,14 @@ class IResourceManager
                          std::vector<unsigned int>& indices, std::vector<float>& normals,
                          std::vector<float>& uvs, EPrimitiveType& type) const = 0;
 
+    /**
+    * \brief Retrieves model space bounding box of the mesh vertices.
+    * Bounds are computed when the data is read and stay available if the data is dropped.
+    * \param min Smallest coordinates, 3 floats.
+    * \param max Largest coordinates, 3 floats.
+    */
+    virtual bool getMeshBounds(ResourceId id, float* min, float* max) const = 0;
+
     /**
      * \brief Creates texture object from image data and returns id.
      * \parm imageData  Raw image data.
@@ -51,14 +68,47 @@ class IResourceManager
 
     /**
     * \brief Loads image from file.
+    * The content selects how the mip chain of uncompressed images is generated.
     */
-    virtual ResourceId loadImage(const std::string& file, EColorFormat format) = 0;
+    virtual ResourceId loadImage(const std::string& file, EColorFormat format,
+                                 EImageContent content) = 0;
 
     /**
     * \brief Retrieves image data.
+    * Images loaded from texture files may be block compressed and contain a precomputed mip
+    * chain, the data then holds mipCount levels starting with the largest level.
     */
     virtual bool getImage(ResourceId id, std::vector<unsigned char>& data, unsigned int& width,
-                          unsigned int& height, EColorFormat& format) const = 0;
+                          unsigned int& height, EColorFormat& format,
+                          unsigned int& mipCount) const = 0;
+
+    /**
+    * \brief Retrieves image data without blocking on file access.
+    * Resident data is copied immediately, dropped data is read from source on a loader thread.
+    * The output arguments are written before the returned future becomes ready and must stay
+    * valid until then. The future holds false if the data is not available.
+    */
+    virtual std::future<bool> readImageAsync(ResourceId id, std::vector<unsigned char>& data,
+                                             unsigned int& width, unsigned int& height,
+                                             EColorFormat& format, unsigned int& mipCount) = 0;
+
+    /**
+    * \brief Loads batch of images and returns ids.
+    * Image files are read and decoded in parallel. Every returned id holds one reference, like
+    * the ids returned by loadImage. Failed loads return an invalid id.
+    */
+    virtual void loadImages(const std::vector<std::string>& files,
+                            const std::vector<EColorFormat>& formats,
+                            const std::vector<EImageContent>& contents,
+                            std::vector<ResourceId>& ids) = 0;
+
+    /**
+    * \brief Loads all images referenced by the material files as a batch.
+    * The images are held by the returned handles, so following loadMaterial calls for the files
+    * find the images in the cache. The handles can be dropped after the materials are loaded.
+    */
+    virtual void preloadMaterials(const std::vector<std::string>& files,
+                                  std::vector<CResourceHandle>& images) = 0;
 
     /**
     * \brief Creates material.
@@ -111,6 +161,13 @@ class IResourceManager
     */
     virtual ResourceId loadShader(const std::string& shaderIniFile) = 0;
 
+    /**
+    * \brief Loads shader program variant with defines injected into all stage sources.
+    * Variants are cached by file and defines, the defines follow the #version directive.
+    */
+    virtual ResourceId loadShader(const std::string& shaderIniFile,
+                                  const std::vector<std::string>& defines) = 0;
+
     /**
     * \brief Creates shader resource.
     */
@@ -120,6 +177,105 @@ class IResourceManager
                            ResourceId& geometryShaderString,
                            ResourceId& fragmentShaderString) const = 0;
 
+    /**
+    * \brief Returns shader program and source files, which include the file directly or
+    * indirectly.
+    */
+    virtual void getShaderDependents(const std::string& file,
+                                     std::vector<std::string>& dependents) const = 0;
+
+    /**
+    * \brief Drops cached contents of a shader include file.
+    * The file is read again by the next shader load, which includes it.
+    */
+    virtual void invalidateShaderInclude(const std::string& file) = 0;
+
+    /**
+    * \brief Replaces source string numbers of shader includes in a compile info log by file names.
+    */
+    virtual std::string mapShaderSourceNames(const std::string& infoLog) const = 0;
+
+    /**
+    * \brief Enables reloading of changed files.
+    * Loaded mesh, image, material and text files and the includes of shader sources are watched
+    * for changes.
+    */
+    virtual void setHotReload(bool enabled) = 0;
+
+    /**
+    * \brief Reloads changed files, called once per frame.
+    * Changed files are read on worker threads. Once read, the resources are replaced and listeners
+    * are notified with change events from the calling thread. A changed shader source or include
+    * also notifies the dependent source strings and shader programs.
+    */
+    virtual void updateHotReload() = 0;
+
+    /**
+    * \brief Adds reference to resource.
+    */
+    virtual void addReference(EResourceType type, ResourceId id) = 0;
+
+    /**
+    * \brief Releases reference to resource.
+    * Unreferenced resources may be evicted if the memory budget is exceeded.
+    */
+    virtual void releaseReference(EResourceType type, ResourceId id) = 0;
+
+    /**
+    * \brief Unloads unreferenced resource.
+    * Listeners receive a delete event for the resource.
+    * \return False if the resource does not exist or is still referenced.
+    */
+    virtual bool unload(EResourceType type, ResourceId id) = 0;
+
+    /**
+    * \brief Unloads all unreferenced resources.
+    */
+    virtual void unloadUnreferenced() = 0;
+
+    /**
+    * \brief Sets memory budget in bytes for CPU and GPU side resource data.
+    * Least recently used unreferenced resources are evicted while a budget is exceeded.
+    * A budget of 0 disables the limit.
+    */
+    virtual void setMemoryBudget(size_t cpuBytes, size_t gpuBytes) = 0;
+
+    /**
+    * \brief Sets residency policy for resources of the type created after the call.
+    * Only mesh and image data is affected, other types are always kept.
+    */
+    virtual void setDefaultResidencyPolicy(EResourceType type, EResidencyPolicy policy) = 0;
+
+    /**
+    * \brief Sets residency policy of a single resource.
+    * Dropped data is re-read if the policy is changed to keep.
+    */
+    virtual bool setResidencyPolicy(EResourceType type, ResourceId id,
+                                    EResidencyPolicy policy) = 0;
+
+    /**
+    * \brief Sets mip generation for images loaded from uncompressed files.
+    * Mip chains are generated on the loading threads. If writeCache is set, generated chains are
+    * written next to the image file and reused while the image file is unchanged.
+    */
+    virtual void setMipGeneration(EMipFilter filter, bool writeCache) = 0;
+
+    /**
+    * \brief Returns CPU memory in bytes used by all resources of the type.
+    */
+    virtual size_t getMemoryUsage(EResourceType type) const = 0;
+
+    /**
+    * \brief Retrieves memory usage of all loaded resources.
+    */
+    virtual void getResourceUsage(std::vector<SResourceUsage>& usage) const = 0;
+
+    /**
+    * \brief Mounts pack file.
+    * Files are resolved against mounted packs before the file system.
+    */
+    virtual bool mountPack(const std::string& packFile) = 0;
+
     /**
      * \brief Adds resource listener.
      */
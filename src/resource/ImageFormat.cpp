@@ -0,0 +1,80 @@
+#include "ImageFormat.h"
+
+bool isCompressed(EColorFormat format)
+{
+    switch (format)
+    {
+    case EColorFormat::BC1:
+    case EColorFormat::BC3:
+    case EColorFormat::BC4:
+    case EColorFormat::BC5:
+        return true;
+    default:
+        return false;
+    }
+}
+
+unsigned int getChannelCount(EColorFormat format)
+{
+    switch (format)
+    {
+    case EColorFormat::GreyScale8:
+    case EColorFormat::BC4:
+        return 1;
+    case EColorFormat::BC5:
+        return 2;
+    case EColorFormat::RGB24:
+    case EColorFormat::BC1:
+        return 3;
+    case EColorFormat::RGBA32:
+    case EColorFormat::BC3:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+size_t getImageSize(EColorFormat format, unsigned int width, unsigned int height)
+{
+    size_t blocks = size_t((width + 3) / 4) * ((height + 3) / 4);
+    switch (format)
+    {
+    case EColorFormat::BC1:
+    case EColorFormat::BC4:
+        return blocks * 8;
+    case EColorFormat::BC3:
+    case EColorFormat::BC5:
+        return blocks * 16;
+    default:
+        return size_t(width) * height * getChannelCount(format);
+    }
+}
+
+unsigned int getMipCount(unsigned int width, unsigned int height)
+{
+    unsigned int count = 1;
+    while (width > 1 || height > 1)
+    {
+        width = getMipSize(width, 1);
+        height = getMipSize(height, 1);
+        ++count;
+    }
+    return count;
+}
+
+unsigned int getMipSize(unsigned int size, unsigned int level)
+{
+    size >>= level;
+    return size == 0 ? 1 : size;
+}
+
+size_t getMipChainSize(EColorFormat format, unsigned int width, unsigned int height,
+                       unsigned int mipCount)
+{
+    size_t size = 0;
+    for (unsigned int level = 0; level < mipCount; ++level)
+    {
+        size += getImageSize(format, getMipSize(width, level), getMipSize(height, level));
+    }
+    return size;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ResourceConfig.h"
+
+/**
+* \brief Returns whether the color format is block compressed.
+*/
+bool isCompressed(EColorFormat format);
+
+/**
+* \brief Returns number of color channels of the format.
+* Formats without channel information return 0.
+*/
+unsigned int getChannelCount(EColorFormat format);
+
+/**
+* \brief Returns size in bytes of a single image level.
+* Block compressed levels are padded to whole 4x4 blocks.
+*/
+size_t getImageSize(EColorFormat format, unsigned int width, unsigned int height);
+
+/**
+* \brief Returns number of mip levels of a full mip chain down to 1x1.
+*/
+unsigned int getMipCount(unsigned int width, unsigned int height);
+
+/**
+* \brief Returns size of the mip level.
+*/
+unsigned int getMipSize(unsigned int size, unsigned int level);
+
+/**
+* \brief Returns size in bytes of the first mip levels.
+*/
+size_t getMipChainSize(EColorFormat format, unsigned int width, unsigned int height,
+                       unsigned int mipCount);
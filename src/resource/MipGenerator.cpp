@@ -0,0 +1,426 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RTR_MIP_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "ImageFormat.h"
+
+/**
+* Filtering works on four float channels per texel. With SSE2 a texel is a single register,
+* otherwise the scalar fallback below is used.
+*/
+#ifdef RTR_MIP_SSE2
+typedef __m128 FloatTexel;
+
+static inline FloatTexel loadTexel(const float* data) { return _mm_loadu_ps(data); }
+static inline void storeTexel(float* data, FloatTexel texel) { _mm_storeu_ps(data, texel); }
+static inline FloatTexel zeroTexel() { return _mm_setzero_ps(); }
+static inline FloatTexel addTexel(FloatTexel a, FloatTexel b) { return _mm_add_ps(a, b); }
+static inline FloatTexel madTexel(FloatTexel a, FloatTexel weight, FloatTexel sum)
+{
+    return _mm_add_ps(_mm_mul_ps(a, weight), sum);
+}
+static inline FloatTexel splatTexel(float value) { return _mm_set1_ps(value); }
+static inline FloatTexel mulTexel(FloatTexel a, FloatTexel b) { return _mm_mul_ps(a, b); }
+#else
+struct FloatTexel
+{
+    float m_value[4];
+};
+
+static inline FloatTexel loadTexel(const float* data)
+{
+    FloatTexel texel = {{data[0], data[1], data[2], data[3]}};
+    return texel;
+}
+static inline void storeTexel(float* data, FloatTexel texel)
+{
+    std::memcpy(data, texel.m_value, sizeof(texel.m_value));
+}
+static inline FloatTexel zeroTexel()
+{
+    FloatTexel texel = {{0.f, 0.f, 0.f, 0.f}};
+    return texel;
+}
+static inline FloatTexel addTexel(FloatTexel a, FloatTexel b)
+{
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        a.m_value[i] += b.m_value[i];
+    }
+    return a;
+}
+static inline FloatTexel madTexel(FloatTexel a, FloatTexel weight, FloatTexel sum)
+{
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        sum.m_value[i] += a.m_value[i] * weight.m_value[i];
+    }
+    return sum;
+}
+static inline FloatTexel splatTexel(float value)
+{
+    FloatTexel texel = {{value, value, value, value}};
+    return texel;
+}
+static inline FloatTexel mulTexel(FloatTexel a, FloatTexel b)
+{
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        a.m_value[i] *= b.m_value[i];
+    }
+    return a;
+}
+#endif
+
+static const unsigned int kaiserTaps = 8;         /**< Filter taps per axis. */
+static const unsigned int linearToSrgbSize = 4096; /**< Size of the sRGB encoding table. */
+
+/**
+* \brief Lookup tables shared by all mip generation calls.
+*/
+struct SMipTables
+{
+    SMipTables()
+    {
+        for (unsigned int i = 0; i < 256; ++i)
+        {
+            float c = i / 255.f;
+            m_srgbToLinear[i] =
+                c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (unsigned int i = 0; i < linearToSrgbSize; ++i)
+        {
+            float c = i / float(linearToSrgbSize - 1);
+            float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+            m_linearToSrgb[i] = (unsigned char)(s * 255.f + 0.5f);
+        }
+
+        // Kaiser windowed sinc for 2x decimation, taps are centered between two source texels
+        const float alpha = 4.f;
+        const float pi = 3.14159265358979f;
+        float sum = 0.f;
+        for (unsigned int i = 0; i < kaiserTaps; ++i)
+        {
+            // Distance in target texels
+            float x = (float(i) - (kaiserTaps - 1) * 0.5f) * 0.5f;
+            float sinc = std::sin(pi * x) / (pi * x);
+            float window = x / 2.f;
+            float kaiser = besselI0(alpha * std::sqrt(1.f - window * window)) / besselI0(alpha);
+            m_kaiserWeights[i] = sinc * kaiser;
+            sum += m_kaiserWeights[i];
+        }
+        for (unsigned int i = 0; i < kaiserTaps; ++i)
+        {
+            m_kaiserWeights[i] /= sum;
+        }
+    }
+
+    /**
+    * \brief Modified Bessel function of the first kind, order 0.
+    */
+    static float besselI0(float x)
+    {
+        float sum = 1.f;
+        float term = 1.f;
+        for (unsigned int k = 1; k < 20; ++k)
+        {
+            term *= (x / (2.f * k)) * (x / (2.f * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    float m_srgbToLinear[256];                       /**< sRGB decoding. */
+    unsigned char m_linearToSrgb[linearToSrgbSize]; /**< sRGB encoding. */
+    float m_kaiserWeights[kaiserTaps];               /**< Normalized filter weights. */
+};
+
+static const SMipTables& getMipTables()
+{
+    static const SMipTables tables;
+    return tables;
+}
+
+/**
+* \brief Parameters of a single downsample step.
+*/
+struct SDownsample
+{
+    const unsigned char* m_source; /**< Source level. */
+    unsigned int m_width;          /**< Source width. */
+    unsigned int m_height;         /**< Source height. */
+    unsigned int m_targetWidth;    /**< Target width. */
+    unsigned int m_channels;       /**< Channel count. */
+    EImageContent m_content;       /**< Content type. */
+    EMipFilter m_filter;           /**< Filter. */
+};
+
+/**
+* \brief Converts 8 bit source row to linear float texels.
+*/
+static void convertRow(const SDownsample& step, unsigned int y, float* out)
+{
+    const SMipTables& tables = getMipTables();
+    const unsigned char* row = step.m_source + size_t(y) * step.m_width * step.m_channels;
+    unsigned int colorChannels = std::min(step.m_channels, 3u);
+    for (unsigned int x = 0; x < step.m_width; ++x)
+    {
+        const unsigned char* in = row + x * step.m_channels;
+        float* texel = out + x * 4;
+        texel[0] = 0.f;
+        texel[1] = 0.f;
+        texel[2] = 0.f;
+        texel[3] = step.m_channels == 4 ? in[3] / 255.f : 1.f;
+        for (unsigned int c = 0; c < colorChannels; ++c)
+        {
+            switch (step.m_content)
+            {
+            case EImageContent::Color:
+                texel[c] = tables.m_srgbToLinear[in[c]];
+                break;
+            case EImageContent::Normal:
+                texel[c] = (in[c] - 128.f) / 127.f;
+                break;
+            default:
+                texel[c] = in[c] / 255.f;
+                break;
+            }
+        }
+    }
+}
+
+/**
+* \brief Filters float row horizontally to the target width.
+*/
+static void filterRow(const SDownsample& step, const float* row, float* out)
+{
+    int lastX = int(step.m_width) - 1;
+    if (step.m_filter == EMipFilter::Box)
+    {
+        const FloatTexel half = splatTexel(0.5f);
+        for (unsigned int x = 0; x < step.m_targetWidth; ++x)
+        {
+            int x0 = std::min(int(x * 2), lastX);
+            int x1 = std::min(int(x * 2 + 1), lastX);
+            FloatTexel sum = addTexel(loadTexel(row + x0 * 4), loadTexel(row + x1 * 4));
+            storeTexel(out + x * 4, mulTexel(sum, half));
+        }
+        return;
+    }
+
+    const SMipTables& tables = getMipTables();
+    FloatTexel weights[kaiserTaps];
+    for (unsigned int i = 0; i < kaiserTaps; ++i)
+    {
+        weights[i] = splatTexel(tables.m_kaiserWeights[i]);
+    }
+    for (unsigned int x = 0; x < step.m_targetWidth; ++x)
+    {
+        FloatTexel sum = zeroTexel();
+        int first = int(x * 2) - int(kaiserTaps / 2 - 1);
+        for (unsigned int i = 0; i < kaiserTaps; ++i)
+        {
+            int sx = std::max(0, std::min(first + int(i), lastX));
+            sum = madTexel(loadTexel(row + sx * 4), weights[i], sum);
+        }
+        storeTexel(out + x * 4, sum);
+    }
+}
+
+/**
+* \brief Ring buffer of horizontally filtered rows.
+* Target rows are produced top to bottom, so the rows needed by the vertical filter form a sliding
+* window and every source row is converted and filtered once.
+*/
+struct SRowCache
+{
+    SRowCache(const SDownsample& step)
+        : m_step(step),
+          m_source(size_t(step.m_width) * 4),
+          m_rows(size_t(step.m_targetWidth) * 4 * kaiserTaps)
+    {
+        std::fill(m_indices, m_indices + kaiserTaps, -1);
+    }
+
+    const float* getRow(int y)
+    {
+        unsigned int slot = unsigned(y) % kaiserTaps;
+        float* row = m_rows.data() + size_t(slot) * m_step.m_targetWidth * 4;
+        if (m_indices[slot] != y)
+        {
+            convertRow(m_step, y, m_source.data());
+            filterRow(m_step, m_source.data(), row);
+            m_indices[slot] = y;
+        }
+        return row;
+    }
+
+    const SDownsample& m_step;
+    std::vector<float> m_source; /**< Converted source row. */
+    std::vector<float> m_rows;   /**< Filtered rows. */
+    int m_indices[kaiserTaps];   /**< Source row index of each slot. */
+};
+
+/**
+* \brief Converts linear float row to 8 bit target row.
+*/
+static void storeRow(const SDownsample& step, float* row, unsigned char* out)
+{
+    const SMipTables& tables = getMipTables();
+    unsigned int colorChannels = std::min(step.m_channels, 3u);
+    for (unsigned int x = 0; x < step.m_targetWidth; ++x)
+    {
+        float* texel = row + x * 4;
+        unsigned char* target = out + x * step.m_channels;
+        if (step.m_content == EImageContent::Normal && colorChannels == 3)
+        {
+            float length = std::sqrt(texel[0] * texel[0] + texel[1] * texel[1] +
+                                     texel[2] * texel[2]);
+            if (length > 1e-6f)
+            {
+                texel[0] /= length;
+                texel[1] /= length;
+                texel[2] /= length;
+            }
+            else
+            {
+                texel[0] = 0.f;
+                texel[1] = 0.f;
+                texel[2] = 1.f;
+            }
+        }
+        for (unsigned int c = 0; c < colorChannels; ++c)
+        {
+            switch (step.m_content)
+            {
+            case EImageContent::Color:
+            {
+                float value = std::max(0.f, std::min(1.f, texel[c]));
+                target[c] = tables.m_linearToSrgb[unsigned(value * (linearToSrgbSize - 1) + 0.5f)];
+                break;
+            }
+            case EImageContent::Normal:
+                target[c] = (unsigned char)std::max(
+                    0.f, std::min(255.f, texel[c] * 127.f + 128.f + 0.5f));
+                break;
+            default:
+                target[c] =
+                    (unsigned char)std::max(0.f, std::min(255.f, texel[c] * 255.f + 0.5f));
+                break;
+            }
+        }
+        if (step.m_channels == 4)
+        {
+            target[3] = (unsigned char)std::max(0.f, std::min(255.f, texel[3] * 255.f + 0.5f));
+        }
+    }
+}
+
+/**
+* \brief Downsamples level to the next mip level.
+*/
+static void downsample(const SDownsample& step, unsigned char* target)
+{
+    unsigned int targetHeight = getMipSize(step.m_height, 1);
+    int lastY = int(step.m_height) - 1;
+    SRowCache cache(step);
+    std::vector<float> row(size_t(step.m_targetWidth) * 4);
+    size_t targetPitch = size_t(step.m_targetWidth) * step.m_channels;
+
+    const SMipTables& tables = getMipTables();
+    FloatTexel weights[kaiserTaps];
+    for (unsigned int i = 0; i < kaiserTaps; ++i)
+    {
+        weights[i] = splatTexel(tables.m_kaiserWeights[i]);
+    }
+    const FloatTexel half = splatTexel(0.5f);
+
+    for (unsigned int y = 0; y < targetHeight; ++y)
+    {
+        if (step.m_filter == EMipFilter::Box)
+        {
+            const float* row0 = cache.getRow(std::min(int(y * 2), lastY));
+            const float* row1 = cache.getRow(std::min(int(y * 2 + 1), lastY));
+            for (unsigned int x = 0; x < step.m_targetWidth; ++x)
+            {
+                FloatTexel sum = addTexel(loadTexel(row0 + x * 4), loadTexel(row1 + x * 4));
+                storeTexel(row.data() + x * 4, mulTexel(sum, half));
+            }
+        }
+        else
+        {
+            const float* rows[kaiserTaps];
+            int first = int(y * 2) - int(kaiserTaps / 2 - 1);
+            for (unsigned int i = 0; i < kaiserTaps; ++i)
+            {
+                rows[i] = cache.getRow(std::max(0, std::min(first + int(i), lastY)));
+            }
+            for (unsigned int x = 0; x < step.m_targetWidth; ++x)
+            {
+                FloatTexel sum = zeroTexel();
+                for (unsigned int i = 0; i < kaiserTaps; ++i)
+                {
+                    sum = madTexel(loadTexel(rows[i] + x * 4), weights[i], sum);
+                }
+                storeTexel(row.data() + x * 4, sum);
+            }
+        }
+        storeRow(step, row.data(), target + y * targetPitch);
+    }
+}
+
+bool generateMipChain(const unsigned char* data, unsigned int width, unsigned int height,
+                      unsigned int channels, EImageContent content, EMipFilter filter,
+                      std::vector<unsigned char>& chain)
+{
+    EColorFormat format;
+    switch (channels)
+    {
+    case 1:
+        format = EColorFormat::GreyScale8;
+        break;
+    case 3:
+        format = EColorFormat::RGB24;
+        break;
+    case 4:
+        format = EColorFormat::RGBA32;
+        break;
+    default:
+        return false;
+    }
+    if (width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    // Every level is filtered from the previous level
+    unsigned int mipCount = getMipCount(width, height);
+    chain.resize(getMipChainSize(format, width, height, mipCount));
+    size_t levelSize = getImageSize(format, width, height);
+    std::memcpy(chain.data(), data, levelSize);
+
+    size_t offset = 0;
+    for (unsigned int level = 1; level < mipCount; ++level)
+    {
+        SDownsample step;
+        step.m_source = chain.data() + offset;
+        step.m_width = getMipSize(width, level - 1);
+        step.m_height = getMipSize(height, level - 1);
+        step.m_targetWidth = getMipSize(width, level);
+        step.m_channels = channels;
+        step.m_content = content;
+        step.m_filter = filter;
+
+        offset += levelSize;
+        downsample(step, chain.data() + offset);
+        levelSize = getImageSize(format, step.m_targetWidth, getMipSize(height, level));
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+
+#include "ResourceConfig.h"
+
+/**
+* \brief Generates full mip chain from 8 bit image data.
+* The chain contains all levels down to 1x1 starting with a copy of the source level, stored
+* like texture file data. Levels are filtered in floating point with SSE2 if available. Color
+* content is converted to linear space for filtering, normals are renormalized on every level.
+*
+* \param data Source level with width * height * channels bytes.
+* \param channels Number of 8 bit channels, 1, 3 or 4.
+* \param chain Generated mip chain, getMipCount(width, height) levels.
+*/
+bool generateMipChain(const unsigned char* data, unsigned int width, unsigned int height,
+                      unsigned int channels, EImageContent content, EMipFilter filter,
+                      std::vector<unsigned char>& chain);
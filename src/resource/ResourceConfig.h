@@ -37,9 +37,44 @@ enum class EColorFormat
     GreyScale8 = 1,
     RGB24 = 3,
     RGBA32 = 4,
+    BC1 = 16, /**< Block compressed RGB, 4 bit per texel. */
+    BC3,      /**< Block compressed RGBA, 8 bit per texel. */
+    BC4,      /**< Block compressed single channel, 4 bit per texel. */
+    BC5,      /**< Block compressed two channel, 8 bit per texel, used for normal maps. */
     Invalid
 };
 
+/**
+* \brief Content of image data.
+* Selects how mip levels are filtered.
+*/
+enum class EImageContent
+{
+    Color,  /**< sRGB encoded color, filtered in linear space, alpha is linear. */
+    Data,   /**< Linear data like specular, glow and alpha maps. */
+    Normal  /**< Tangent space normals, renormalized for each mip level. */
+};
+
+/**
+* \brief Downsampling filter for mip generation.
+*/
+enum class EMipFilter
+{
+    Box,   /**< 2x2 average, fast. */
+    Kaiser /**< Kaiser windowed sinc with 8 taps per axis, sharper and with less aliasing. */
+};
+
+/**
+ * \brief Residency policy for CPU side resource data.
+ * Decides whether mesh and image data is kept after it has been uploaded by a listener.
+ */
+enum class EResidencyPolicy
+{
+    Keep,            /**< Data is kept for the lifetime of the resource. */
+    DropAfterUpload, /**< Data is released after the create event, get calls fail afterwards. */
+    Reload           /**< Data is released after the create event and re-read on demand. */
+};
+
 /**
  * \brief Possible listener events.
  */
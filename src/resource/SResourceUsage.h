@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "ResourceConfig.h"
+
+/**
+ * \brief Memory usage of a single resource.
+ */
+struct SResourceUsage
+{
+    EResourceType m_type;      /**< Resource type. */
+    ResourceId m_id;           /**< Resource id. */
+    std::string m_file;        /**< Source file, empty for created resources. */
+    unsigned int m_references; /**< Number of held references. */
+    size_t m_cpuBytes;         /**< CPU memory used by resource data. */
+};
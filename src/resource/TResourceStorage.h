@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ResourceConfig.h"
+
+/**
+ * \brief Dense resource storage with generation checked ids.
+ * Resources are stored in a slot array. A resource id holds the slot index in the low 32 bits and
+ * the slot generation in the high 32 bits. The generation is incremented whenever a slot is freed,
+ * so stale ids of erased resources are rejected. Resolving an id is a bounds check, a generation
+ * compare and an index.
+ */
+template <typename T>
+class TResourceStorage
+{
+   public:
+    TResourceStorage();
+
+    /**
+     * \brief Stores value in a free slot and returns the new resource id.
+     */
+    ResourceId add(T value);
+
+    /**
+     * \brief Stores value under an id allocated by another storage.
+     * Used to mirror the ids of the resource manager in listeners.
+     * \return False if the id is invalid or already in use.
+     */
+    bool insert(ResourceId id, T value);
+
+    /**
+     * \brief Erases resource and frees its slot.
+     * \return False if the id does not refer to a stored resource.
+     */
+    bool erase(ResourceId id);
+
+    /**
+     * \brief Erases all resources.
+     */
+    void clear();
+
+    /**
+     * \brief Returns stored resource or nullptr for invalid and stale ids.
+     */
+    T* get(ResourceId id);
+    const T* get(ResourceId id) const;
+
+    /**
+     * \brief Returns whether the id refers to a stored resource.
+     */
+    bool contains(ResourceId id) const;
+
+    /**
+     * \brief Returns number of stored resources.
+     */
+    unsigned int size() const;
+
+    /**
+     * \brief Calls function with id and value of every stored resource.
+     * The storage must not be modified from within the function.
+     */
+    template <typename Function>
+    void forEach(Function function);
+    template <typename Function>
+    void forEach(Function function) const;
+
+    /**
+     * \brief Id encoding.
+     */
+    static ResourceId makeId(uint32_t index, uint32_t generation);
+    static uint32_t getIndex(ResourceId id);
+    static uint32_t getGeneration(ResourceId id);
+
+   private:
+    /**
+     * \brief Storage slot.
+     */
+    struct SSlot
+    {
+        T m_value;             /**< Stored value, default constructed for free slots. */
+        uint32_t m_generation; /**< Current generation of the slot. */
+        bool m_used;           /**< Slot holds a resource. */
+    };
+
+    /**
+     * \brief Returns slot referenced by the id or nullptr.
+     */
+    const SSlot* getSlot(ResourceId id) const;
+
+    std::vector<SSlot> m_slots;        /**< Resource slots, indexed by id. */
+    std::vector<uint32_t> m_freeSlots; /**< Indices of free slots, reused in LIFO order. */
+    unsigned int m_size;               /**< Number of used slots. */
+};
+
+template <typename T>
+TResourceStorage<T>::TResourceStorage() : m_size(0)
+{
+    return;
+}
+
+template <typename T>
+ResourceId TResourceStorage<T>::add(T value)
+{
+    uint32_t index;
+    if (m_freeSlots.empty())
+    {
+        index = static_cast<uint32_t>(m_slots.size());
+        m_slots.push_back(SSlot{T(), 0, false});
+    }
+    else
+    {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    SSlot& slot = m_slots[index];
+    slot.m_value = std::move(value);
+    slot.m_used = true;
+    ++m_size;
+    return makeId(index, slot.m_generation);
+}
+
+template <typename T>
+bool TResourceStorage<T>::insert(ResourceId id, T value)
+{
+    if (id < 0)
+    {
+        return false;
+    }
+    uint32_t index = getIndex(id);
+    if (index >= m_slots.size())
+    {
+        // New slots between the old end and the index are free
+        for (uint32_t i = static_cast<uint32_t>(m_slots.size()); i < index; ++i)
+        {
+            m_freeSlots.push_back(i);
+            m_slots.push_back(SSlot{T(), 0, false});
+        }
+        m_slots.push_back(SSlot{T(), 0, false});
+    }
+    else if (m_slots[index].m_used)
+    {
+        return false;
+    }
+    else
+    {
+        // Slot is known to be free, remove from free list
+        for (auto iter = m_freeSlots.begin(); iter != m_freeSlots.end(); ++iter)
+        {
+            if (*iter == index)
+            {
+                m_freeSlots.erase(iter);
+                break;
+            }
+        }
+    }
+
+    SSlot& slot = m_slots[index];
+    slot.m_value = std::move(value);
+    slot.m_generation = getGeneration(id);
+    slot.m_used = true;
+    ++m_size;
+    return true;
+}
+
+template <typename T>
+bool TResourceStorage<T>::erase(ResourceId id)
+{
+    SSlot* slot = const_cast<SSlot*>(getSlot(id));
+    if (slot == nullptr)
+    {
+        return false;
+    }
+    // Release value data immediately
+    slot->m_value = T();
+    slot->m_used = false;
+    // Keep ids positive, generation wraps at 31 bit
+    slot->m_generation = (slot->m_generation + 1) & 0x7fffffff;
+    m_freeSlots.push_back(getIndex(id));
+    --m_size;
+    return true;
+}
+
+template <typename T>
+void TResourceStorage<T>::clear()
+{
+    for (uint32_t i = 0; i < m_slots.size(); ++i)
+    {
+        if (m_slots[i].m_used)
+        {
+            erase(makeId(i, m_slots[i].m_generation));
+        }
+    }
+}
+
+template <typename T>
+T* TResourceStorage<T>::get(ResourceId id)
+{
+    const SSlot* slot = getSlot(id);
+    return slot == nullptr ? nullptr : const_cast<T*>(&slot->m_value);
+}
+
+template <typename T>
+const T* TResourceStorage<T>::get(ResourceId id) const
+{
+    const SSlot* slot = getSlot(id);
+    return slot == nullptr ? nullptr : &slot->m_value;
+}
+
+template <typename T>
+bool TResourceStorage<T>::contains(ResourceId id) const
+{
+    return getSlot(id) != nullptr;
+}
+
+template <typename T>
+unsigned int TResourceStorage<T>::size() const
+{
+    return m_size;
+}
+
+template <typename T>
+template <typename Function>
+void TResourceStorage<T>::forEach(Function function)
+{
+    for (uint32_t i = 0; i < m_slots.size(); ++i)
+    {
+        if (m_slots[i].m_used)
+        {
+            function(makeId(i, m_slots[i].m_generation), m_slots[i].m_value);
+        }
+    }
+}
+
+template <typename T>
+template <typename Function>
+void TResourceStorage<T>::forEach(Function function) const
+{
+    for (uint32_t i = 0; i < m_slots.size(); ++i)
+    {
+        if (m_slots[i].m_used)
+        {
+            function(makeId(i, m_slots[i].m_generation),
+                     static_cast<const T&>(m_slots[i].m_value));
+        }
+    }
+}
+
+template <typename T>
+ResourceId TResourceStorage<T>::makeId(uint32_t index, uint32_t generation)
+{
+    return static_cast<ResourceId>((static_cast<uint64_t>(generation) << 32) | index);
+}
+
+template <typename T>
+uint32_t TResourceStorage<T>::getIndex(ResourceId id)
+{
+    return static_cast<uint32_t>(static_cast<uint64_t>(id) & 0xffffffff);
+}
+
+template <typename T>
+uint32_t TResourceStorage<T>::getGeneration(ResourceId id)
+{
+    return static_cast<uint32_t>(static_cast<uint64_t>(id) >> 32);
+}
+
+template <typename T>
+const typename TResourceStorage<T>::SSlot* TResourceStorage<T>::getSlot(ResourceId id) const
+{
+    if (id < 0)
+    {
+        return nullptr;
+    }
+    uint32_t index = getIndex(id);
+    if (index >= m_slots.size())
+    {
+        return nullptr;
+    }
+    const SSlot& slot = m_slots[index];
+    if (!slot.m_used || slot.m_generation != getGeneration(id))
+    {
+        return nullptr;
+    }
+    return &slot;
+}
@@ -1,12 +1,28 @@
 #include "CResourceManager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
+#include <functional>
+#include <map>
 #include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include <sys/stat.h>
 
 #include "lodepng.h"
 #include "tiny_obj_loader.h"
 
 #include "resource/IResourceListener.h"
+#include "resource/CResourceHandle.h"
+#include "resource/ImageFormat.h"
+#include "resource/MipGenerator.h"
+
+#include "io/CVirtualFileSystem.h"
+#include "io/RawImageFormat.h"
+#include "io/TextureFormat.h"
 
 #include "io/CIniFile.h"
 #include "io/CObjModelLoader.h"
@@ -14,10 +30,175 @@
 
 #include "debug/Log.h"
 
+/**
+* \brief Returns CPU memory size of mesh data in bytes.
+*/
+static size_t getMemorySize(const SMesh& mesh)
+{
+    return sizeof(SMesh) +
+           (mesh.m_vertices.capacity() + mesh.m_normals.capacity() + mesh.m_uvs.capacity()) *
+               sizeof(float) +
+           mesh.m_indices.capacity() * sizeof(unsigned int);
+}
+
+/**
+* \brief Returns CPU memory size of image data in bytes.
+*/
+static size_t getMemorySize(const SImage& image)
+{
+    return sizeof(SImage) + image.m_data.capacity();
+}
+
+/**
+* \brief Returns estimated GPU memory size of mesh data in bytes.
+* Vertex data is uploaded as is, so GPU size matches the data size.
+*/
+static size_t getGpuMemorySize(const SMesh& mesh)
+{
+    return (mesh.m_vertices.size() + mesh.m_normals.size() + mesh.m_uvs.size()) * sizeof(float) +
+           mesh.m_indices.size() * sizeof(unsigned int);
+}
+
+/**
+* \brief Returns estimated GPU memory size of image data in bytes.
+* Textures are created with full mip chain, which adds a third of the base level size.
+*/
+static size_t getGpuMemorySize(const SImage& image)
+{
+    return image.m_mipCount > 1 ? image.m_data.size() : image.m_data.size() * 4 / 3;
+}
+
+/**
+* \brief Returns name of a shader source or program variant, the file for no defines.
+*/
+static std::string getVariantName(const std::string& file, const std::vector<std::string>& defines)
+{
+    std::string variant = file;
+    for (size_t i = 0; i < defines.size(); ++i)
+    {
+        variant += (i == 0 ? "?" : ",") + defines.at(i);
+    }
+    return variant;
+}
+
+/**
+* \brief Returns file of a shader source or program variant name.
+*/
+static std::string getVariantFile(const std::string& variant)
+{
+    return variant.substr(0, variant.find('?'));
+}
+
+/**
+* \brief Returns whether a converted file on disk is older than its source file.
+* Files in packs are never stale, packs are built from converted files.
+*/
+static bool isStale(const std::string& converted, const std::string& source)
+{
+    struct stat convertedStat;
+    struct stat sourceStat;
+    return stat(converted.c_str(), &convertedStat) == 0 && stat(source.c_str(), &sourceStat) == 0 &&
+           convertedStat.st_mtime < sourceStat.st_mtime;
+}
+
+/**
+* \brief Writes a file, which is read concurrently by other threads.
+* The data is written to a temporary file of the calling thread and renamed over the file, so
+* readers see either the previous or the complete file.
+*/
+static bool replaceFile(const std::string& file, const std::vector<unsigned char>& data)
+{
+    std::string temporary =
+        file + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+        ".tmp";
+    {
+        std::ofstream ofs(temporary, std::ios::binary);
+        if (!ofs.is_open() ||
+            !ofs.write(reinterpret_cast<const char*>(data.data()), data.size()))
+        {
+            ofs.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    // Renaming over an existing file fails on some platforms
+    if (std::rename(temporary.c_str(), file.c_str()) != 0 &&
+        (std::remove(file.c_str()) != 0 || std::rename(temporary.c_str(), file.c_str()) != 0))
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+* \brief Returns whether texture data with the stored format can be used for the requested format.
+* Compressed formats may store fewer channels, e.g. normal maps only store x and y. Two channel
+* data is only accepted for normal maps, as the shaders reconstruct z for those only.
+*/
+static bool isCompatibleFormat(EColorFormat requested, EColorFormat stored, EImageContent content)
+{
+    if (requested == stored)
+    {
+        return true;
+    }
+    switch (requested)
+    {
+    case EColorFormat::GreyScale8:
+        return stored == EColorFormat::BC4;
+    case EColorFormat::RGB24:
+        return stored == EColorFormat::BC1 || stored == EColorFormat::BC3 ||
+               (stored == EColorFormat::BC5 && content == EImageContent::Normal);
+    case EColorFormat::RGBA32:
+        return stored == EColorFormat::BC3;
+    default:
+        return false;
+    }
+}
+
+/**
+* \brief Texture groups of material files and the color format they are loaded with.
+*/
+static const struct
+{
+    const char* m_group;     /**< Ini group name. */
+    EColorFormat m_format;   /**< Color format of the texture. */
+    EImageContent m_content; /**< Content of the texture. */
+} s_materialTextures[] = {{"diffuse", EColorFormat::RGB24, EImageContent::Color},
+                          {"normal", EColorFormat::RGB24, EImageContent::Normal},
+                          {"specular", EColorFormat::GreyScale8, EImageContent::Data},
+                          {"glow", EColorFormat::GreyScale8, EImageContent::Data},
+                          {"alpha", EColorFormat::GreyScale8, EImageContent::Data}};
+
+/**
+* \brief Material reader for tinyobj which skips referenced .mtl files.
+* Materials are specified separately through material files, so .mtl files are never read.
+*/
+struct SIgnoreMaterialReader : public tinyobj::MaterialReader
+{
+    std::string operator()(const std::string& /* matId */,
+                           std::vector<tinyobj::material_t>& /* materials */,
+                           std::map<std::string, int>& /* matMap */)
+    {
+        return "";
+    }
+};
+
 CResourceManager::CResourceManager()
-    : m_nextMeshId(0), m_nextImageId(0), m_nextMaterialId(0), m_nextStringId(0), m_nextShaderId(0)
+    : m_useTick(0),
+      m_cpuMemoryUsage(0),
+      m_gpuMemoryUsage(0),
+      m_cpuMemoryBudget(0),
+      m_gpuMemoryBudget(0),
+      m_mipFilter(EMipFilter::Kaiser),
+      m_writeMipCache(true)
 {
-    return;
+    for (unsigned int i = 0; i < s_resourceTypeCount; ++i)
+    {
+        m_residencyPolicy[i] = EResidencyPolicy::Keep;
+    }
+    m_shaderPreprocessor.setIncludePath("data/shadersource/include/");
+    m_shaderPreprocessor.setFileSystem(&m_fileSystem);
 }
 
 ResourceId CResourceManager::createMesh(const std::vector<float>& vertices,
@@ -25,16 +206,8 @@ ResourceId CResourceManager::createMesh(const std::vector<float>& vertices,
                                         const std::vector<float>& normals,
                                         const std::vector<float>& uvs, EPrimitiveType type)
 {
-    // Create mesh id
-    ResourceId id = m_nextMeshId;
-    ++m_nextMeshId;
-
-    // Add mesh
-    m_meshes[id] = SMesh(vertices, indices, normals, uvs, type);
-
-    // Notify listener with create event
-    notifyResourceListeners(EResourceType::Mesh, id, EListenerEvent::Create);
-    return id;
+    SMesh mesh(vertices, indices, normals, uvs, type);
+    return addMesh(mesh, "");
 }
 
 ResourceId CResourceManager::loadMesh(const std::string& file)
@@ -42,70 +215,24 @@ ResourceId CResourceManager::loadMesh(const std::string& file)
     auto entry = m_meshFiles.find(file);
     if (entry != m_meshFiles.end())
     {
+        addReference(EResourceType::Mesh, entry->second);
         return entry->second;
     }
 
-    // Retrieve file extension
-    auto pos = file.find_last_of('.');
-    if (pos == std::string::npos)
+    SMesh mesh;
+    if (!readMesh(file, mesh))
     {
-        LOG_ERROR("The mesh file %s does not have a file extension and could not be loaded.",
-                  file.c_str());
         return -1;
     }
-    std::string extension = file.substr(file.find_last_of('.') + 1);
-
-    // Mesh resource id
-    ResourceId meshId = -1;
-
-    // Decide loading method based on extension
-    // TODO Register loader functions for extensions
-    if (extension == "obj")
-    {
-        // Wavefront OBJ file format loaded with tinyobj
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        // Load as obj
-        std::string err = tinyobj::LoadObj(shapes, materials, file.c_str());
-
-        if (!err.empty())
-        {
-            LOG_ERROR("%s.", err.c_str());
-            return -1;
-        }
-        if (shapes.size() > 1)
-        {
-            LOG_WARNING("Multple meshes in obj files not supported.");
-        }
-        if (shapes.empty())
-        {
-            LOG_ERROR("No mesh data loaded from file %s.", file.c_str());
-            return -1;
-        }
-        // Create mesh resource
-        meshId = createMesh(shapes.at(0).mesh.positions, shapes.at(0).mesh.indices,
-                            shapes.at(0).mesh.normals, shapes.at(0).mesh.texcoords,
-                            EPrimitiveType::Triangle);
-    }
-    else if (extension == "oni")
-    {
-        // Load without building index buffer
-        CObjModelLoader objLoader;
-        if (!objLoader.load(file))
-        {
-            LOG_ERROR("Failed to load mesh file %s as non-indexed obj file.", file.c_str());
-            return -1;
-        }
-        meshId = createMesh(objLoader.getVertices(), {}, objLoader.getNormals(), objLoader.getUV(),
-                            EPrimitiveType::Triangle);
-    }
 
+    ResourceId meshId = addMesh(mesh, file);
     if (meshId == -1)
     {
         LOG_ERROR("Failed to create mesh resource id from file %s.", file.c_str());
         return -1;
     }
     m_meshFiles[file] = meshId;
+    watchFile(file);
     return meshId;
 }
 
@@ -113,18 +240,50 @@ bool CResourceManager::getMesh(ResourceId id, std::vector<float>& vertices,
                                std::vector<unsigned int>& indices, std::vector<float>& normals,
                                std::vector<float>& uvs, EPrimitiveType& type) const
 {
-    // Retrieve from map
-    auto iter = m_meshes.find(id);
-    if (iter == m_meshes.end())
+    // Retrieve from storage
+    const SMesh* mesh = m_meshes.get(id);
+    if (mesh == nullptr)
     {
         return false;
     }
+    touch(EResourceType::Mesh, id);
+
+    const SResourceInfo& info = *getResourceInfo(EResourceType::Mesh).get(id);
+    if (!info.m_resident)
+    {
+        // CPU copy was dropped after upload, re-read from source if allowed
+        SMesh reloaded;
+        if (info.m_policy != EResidencyPolicy::Reload || !readMesh(info.m_file, reloaded))
+        {
+            LOG_ERROR("The data of mesh id %lli is not resident.", (long long)id);
+            return false;
+        }
+        vertices.swap(reloaded.m_vertices);
+        indices.swap(reloaded.m_indices);
+        normals.swap(reloaded.m_normals);
+        uvs.swap(reloaded.m_uvs);
+        type = reloaded.m_type;
+        return true;
+    }
+
     // Copy data
-    vertices = iter->second.m_vertices;
-    indices = iter->second.m_indices;
-    normals = iter->second.m_normals;
-    uvs = iter->second.m_uvs;
-    type = iter->second.m_type;
+    vertices = mesh->m_vertices;
+    indices = mesh->m_indices;
+    normals = mesh->m_normals;
+    uvs = mesh->m_uvs;
+    type = mesh->m_type;
+    return true;
+}
+
+bool CResourceManager::getMeshBounds(ResourceId id, float* min, float* max) const
+{
+    const SMesh* mesh = m_meshes.get(id);
+    if (mesh == nullptr)
+    {
+        return false;
+    }
+    std::copy(mesh->m_min, mesh->m_min + 3, min);
+    std::copy(mesh->m_max, mesh->m_max + 3, max);
     return true;
 }
 
@@ -132,105 +291,320 @@ ResourceId CResourceManager::createImage(const std::vector<unsigned char>& image
                                          unsigned int width, unsigned int height,
                                          EColorFormat format)
 {
-    // Create image
-    ResourceId id = m_nextImageId;
-    ++m_nextImageId;
-
-    // TODO Sanity check if mesh id exists?
-    // Add mesh
-    m_images[id] = SImage(imageData, width, height, format);
-
-    // Notify listener with create event
-    notifyResourceListeners(EResourceType::Image, id, EListenerEvent::Create);
-    return id;
+    SImage image(imageData, width, height, format);
+    return addImage(image, "");
 }
 
-ResourceId CResourceManager::loadImage(const std::string& file, EColorFormat format)
+ResourceId CResourceManager::loadImage(const std::string& file, EColorFormat format,
+                                       EImageContent content)
 {
     auto entry = m_imageFiles.find(file);
     if (entry != m_imageFiles.end())
     {
+        addReference(EResourceType::Image, entry->second);
         return entry->second;
     }
 
-    // TODO Check extension, png format assumed
-    std::vector<unsigned char> data;
-    unsigned int width;
-    unsigned int height;
-
-	// PNG type check
-	if (file.find(".png") == std::string::npos)
-	{
-		LOG_ERROR("Unknown file format encountered while loading image file %s.", file.c_str());
-		return false;
-	}
-
-    // Map color type
-    LodePNGColorType colorType;
-    switch (format)
-    {
-    case EColorFormat::GreyScale8:
-        colorType = LCT_GREY;
-        break;
-    case EColorFormat::RGB24:
-        colorType = LCT_RGB;
-        break;
-    case EColorFormat::RGBA32:
-        colorType = LCT_RGBA;
-        break;
-    default:
-        LOG_ERROR("Unknown color format encountered while loading image file %s.", file.c_str());
-        return -1;
-        break;
-    }
-
-    // Decode image data
-    unsigned int err = lodepng::decode(data, width, height, file, colorType);
-    if (err != 0)
+    SImage image;
+    if (!readImage(file, format, content, image))
     {
-        LOG_ERROR("An error occured while decoding the image file %s: %s", file.c_str(),
-                  lodepng_error_text(err));
         return -1;
     }
 
-    ResourceId imageId = createImage(data, width, height, format);
+    ResourceId imageId = addImage(image, file);
     if (imageId == -1)
     {
         LOG_ERROR("Failed to create image resource id from file %s.", file.c_str());
         return -1;
     }
     m_imageFiles[file] = imageId;
+    watchFile(file);
     return imageId;
 }
 
 bool CResourceManager::getImage(ResourceId id, std::vector<unsigned char>& data,
                                 unsigned int& width, unsigned int& height,
-                                EColorFormat& format) const
+                                EColorFormat& format, unsigned int& mipCount) const
 {
-    // Retrieve from map
-    auto iter = m_images.find(id);
-    if (iter == m_images.end())
+    // Retrieve from storage
+    const SImage* image = m_images.get(id);
+    if (image == nullptr)
     {
         return false;
     }
+    touch(EResourceType::Image, id);
+
+    const SResourceInfo& info = *getResourceInfo(EResourceType::Image).get(id);
+    if (!info.m_resident)
+    {
+        // CPU copy was dropped after upload, re-read from source if allowed
+        SImage reloaded;
+        if (info.m_policy != EResidencyPolicy::Reload ||
+            !readImage(info.m_file, image->m_format, image->m_content, reloaded))
+        {
+            LOG_ERROR("The data of image id %lli is not resident.", (long long)id);
+            return false;
+        }
+        data.swap(reloaded.m_data);
+        width = reloaded.m_width;
+        height = reloaded.m_height;
+        format = reloaded.m_format;
+        mipCount = reloaded.m_mipCount;
+        return true;
+    }
+
     // Copy data
-    data = iter->second.m_data;
-    width = iter->second.m_width;
-    height = iter->second.m_height;
-    format = iter->second.m_format;
+    data = image->m_data;
+    width = image->m_width;
+    height = image->m_height;
+    format = image->m_format;
+    mipCount = image->m_mipCount;
     return true;
 }
 
+std::future<bool> CResourceManager::readImageAsync(ResourceId id,
+                                                   std::vector<unsigned char>& data,
+                                                   unsigned int& width, unsigned int& height,
+                                                   EColorFormat& format, unsigned int& mipCount)
+{
+    std::shared_ptr<std::promise<bool>> result = std::make_shared<std::promise<bool>>();
+    std::future<bool> future = result->get_future();
+
+    const SImage* image = m_images.get(id);
+    const SResourceInfo* info = getResourceInfo(EResourceType::Image).get(id);
+    if (image == nullptr || info->m_resident || info->m_policy != EResidencyPolicy::Reload)
+    {
+        // Resident or unavailable data does not touch the file system
+        result->set_value(getImage(id, data, width, height, format, mipCount));
+        return future;
+    }
+    touch(EResourceType::Image, id);
+
+    // Reading does not modify shared state, see loadImages
+    std::string file = info->m_file;
+    EColorFormat requestedFormat = image->m_format;
+    EImageContent content = image->m_content;
+    std::vector<unsigned char>* dataOut = &data;
+    unsigned int* widthOut = &width;
+    unsigned int* heightOut = &height;
+    EColorFormat* formatOut = &format;
+    unsigned int* mipCountOut = &mipCount;
+    m_threadPool.addTask(
+        [this, result, file, requestedFormat, content, dataOut, widthOut, heightOut, formatOut,
+         mipCountOut]()
+        {
+            SImage reloaded;
+            if (!readImage(file, requestedFormat, content, reloaded))
+            {
+                LOG_ERROR("Failed to read image data from file %s.", file.c_str());
+                result->set_value(false);
+                return;
+            }
+            dataOut->swap(reloaded.m_data);
+            *widthOut = reloaded.m_width;
+            *heightOut = reloaded.m_height;
+            *formatOut = reloaded.m_format;
+            *mipCountOut = reloaded.m_mipCount;
+            result->set_value(true);
+        });
+    return future;
+}
+
+void CResourceManager::loadImages(const std::vector<std::string>& files,
+                                  const std::vector<EColorFormat>& formats,
+                                  const std::vector<EImageContent>& contents,
+                                  std::vector<ResourceId>& ids)
+{
+    ids.assign(files.size(), invalidResource);
+    if (files.size() != formats.size() || files.size() != contents.size())
+    {
+        LOG_ERROR("Image file, format and content count mismatch in batched image load.");
+        return;
+    }
+
+    /**
+    * \brief Pending image decode.
+    */
+    struct SDecodeTask
+    {
+        std::string m_file;      /**< Image file. */
+        EColorFormat m_format;   /**< Requested color format. */
+        EImageContent m_content; /**< Image content. */
+        SImage m_image;          /**< Decoded image. */
+        SImageDecodeInfo m_info; /**< Decode statistics. */
+        bool m_success;          /**< Decoding succeeded. */
+        bool m_referenceTaken;   /**< Creation reference has been handed out. */
+    };
+
+    // Cached images are referenced directly, each uncached file is decoded once
+    std::vector<SDecodeTask> tasks;
+    std::unordered_map<std::string, size_t> taskIndices;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        auto entry = m_imageFiles.find(files.at(i));
+        if (entry != m_imageFiles.end())
+        {
+            addReference(EResourceType::Image, entry->second);
+            ids.at(i) = entry->second;
+        }
+        else if (taskIndices.count(files.at(i)) == 0)
+        {
+            taskIndices[files.at(i)] = tasks.size();
+            SDecodeTask task;
+            task.m_file = files.at(i);
+            task.m_format = formats.at(i);
+            task.m_content = contents.at(i);
+            task.m_success = false;
+            task.m_referenceTaken = false;
+            tasks.push_back(std::move(task));
+        }
+    }
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    // Read and decode in parallel, the file system and decoders do not modify shared state
+    auto start = std::chrono::steady_clock::now();
+    for (auto& task : tasks)
+    {
+        SDecodeTask* decodeTask = &task;
+        m_threadPool.addTask([this, decodeTask]()
+                             {
+                                 decodeTask->m_success =
+                                     readImage(decodeTask->m_file, decodeTask->m_format,
+                                               decodeTask->m_content, decodeTask->m_image,
+                                               &decodeTask->m_info);
+                             });
+    }
+    m_threadPool.wait();
+    double wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    /**
+    * \brief Accumulated decode statistics per container format.
+    */
+    struct SDecodeStats
+    {
+        unsigned int m_count; /**< Number of decoded images. */
+        size_t m_fileBytes;   /**< Size of the read files. */
+        size_t m_imageBytes;  /**< Size of the decoded pixel data. */
+        double m_seconds;     /**< Summed read and decode time of all threads. */
+    };
+
+    // Listeners upload on creation, which has to happen on the calling thread
+    std::map<std::string, SDecodeStats> stats;
+    size_t totalImageBytes = 0;
+    std::vector<ResourceId> createdIds(tasks.size(), invalidResource);
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        SDecodeTask& task = tasks.at(i);
+        if (!task.m_success)
+        {
+            continue;
+        }
+        auto statEntry = stats.find(task.m_info.m_container);
+        if (statEntry == stats.end())
+        {
+            SDecodeStats empty = {0, 0, 0, 0.0};
+            statEntry = stats.insert(std::make_pair(task.m_info.m_container, empty)).first;
+        }
+        SDecodeStats& stat = statEntry->second;
+        ++stat.m_count;
+        stat.m_fileBytes += task.m_info.m_fileBytes;
+        stat.m_imageBytes += task.m_image.m_data.size();
+        stat.m_seconds += task.m_info.m_seconds;
+        totalImageBytes += task.m_image.m_data.size();
+
+        createdIds.at(i) = addImage(task.m_image, task.m_file);
+        m_imageFiles[task.m_file] = createdIds.at(i);
+        watchFile(task.m_file);
+    }
+
+    // First request of a file takes the creation reference, duplicates add references
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (ids.at(i) != invalidResource)
+        {
+            continue;
+        }
+        size_t index = taskIndices.at(files.at(i));
+        ids.at(i) = createdIds.at(index);
+        if (tasks.at(index).m_referenceTaken)
+        {
+            addReference(EResourceType::Image, ids.at(i));
+        }
+        tasks.at(index).m_referenceTaken = true;
+    }
+
+    // Throughput is measured in decoded pixel data
+    for (const auto& stat : stats)
+    {
+        const SDecodeStats& s = stat.second;
+        LOG_INFO("Decoded %u %s images, %.2f MB to %.2f MB at %.2f MB/s per thread.", s.m_count,
+                 stat.first.c_str(), s.m_fileBytes / (1024.0 * 1024.0),
+                 s.m_imageBytes / (1024.0 * 1024.0), s.m_imageBytes / (1024.0 * 1024.0) / s.m_seconds);
+    }
+    LOG_INFO("Loaded %u images, %.2f MB in %.1f ms with %u threads (%.2f MB/s).",
+             (unsigned int)tasks.size(), totalImageBytes / (1024.0 * 1024.0), wallSeconds * 1000.0,
+             m_threadPool.getThreadCount(), totalImageBytes / (1024.0 * 1024.0) / wallSeconds);
+}
+
+void CResourceManager::preloadMaterials(const std::vector<std::string>& files,
+                                        std::vector<CResourceHandle>& images)
+{
+    std::vector<std::string> imageFiles;
+    std::vector<EColorFormat> imageFormats;
+    std::vector<EImageContent> imageContents;
+    for (const auto& file : files)
+    {
+        if (m_materialFiles.count(file) != 0)
+        {
+            continue;
+        }
+        CIniFile ini;
+        if (!ini.load(file, m_fileSystem))
+        {
+            // Reported by the following material load
+            continue;
+        }
+        for (const auto& texture : s_materialTextures)
+        {
+            if (ini.hasKey(texture.m_group, "file"))
+            {
+                imageFiles.push_back(ini.getValue(texture.m_group, "file", "error"));
+                imageFormats.push_back(texture.m_format);
+                imageContents.push_back(texture.m_content);
+            }
+        }
+    }
+
+    std::vector<ResourceId> ids;
+    loadImages(imageFiles, imageFormats, imageContents, ids);
+    for (ResourceId id : ids)
+    {
+        if (id != invalidResource)
+        {
+            images.push_back(CResourceHandle(this, EResourceType::Image, id));
+        }
+    }
+}
+
 ResourceId CResourceManager::createMaterial(ResourceId diffuse, ResourceId normal,
                                             ResourceId specular, ResourceId glow, ResourceId alpha,
                                             ResourceId customShader)
 {
-    // Create material
-    ResourceId id = m_nextMaterialId;
-    ++m_nextMaterialId;
-
     // Add material
-    m_materials[id] = SMaterial(diffuse, normal, specular, glow, alpha, customShader);
+    ResourceId id = m_materials.add(SMaterial(diffuse, normal, specular, glow, alpha, customShader));
+
+    // Material keeps referenced resources alive
+    addReference(EResourceType::Image, diffuse);
+    addReference(EResourceType::Image, normal);
+    addReference(EResourceType::Image, specular);
+    addReference(EResourceType::Image, glow);
+    addReference(EResourceType::Image, alpha);
+    addReference(EResourceType::Shader, customShader);
+    registerResource(EResourceType::Material, id, sizeof(SMaterial), 0);
 
     // Notify listener with create event
     notifyResourceListeners(EResourceType::Material, id, EListenerEvent::Create);
@@ -242,131 +616,153 @@ ResourceId CResourceManager::loadMaterial(const std::string& file)
     auto entry = m_materialFiles.find(file);
     if (entry != m_materialFiles.end())
     {
+        addReference(EResourceType::Material, entry->second);
         return entry->second;
     }
 
 	LOG_DEBUG("Loading material from file %s.", file.c_str());
     CIniFile ini;
-    if (!ini.load(file))
+    if (!ini.load(file, m_fileSystem))
     {
         LOG_ERROR("Failed to load material file %s as ini file.", file.c_str());
         return -1;
     }
 
-    ResourceId diffuseId = -1;
+    SMaterial material;
+    std::vector<CResourceHandle> handles;
+    if (!loadMaterialFiles(ini, file, material, handles))
+    {
+        return -1;
+    }
+
+    ResourceId materialId =
+        createMaterial(material.m_diffuse, material.m_normal, material.m_specular,
+                       material.m_glow, material.m_alpha, material.m_customShader);
+    if (materialId == -1)
+    {
+        LOG_ERROR("Failed to create material resource id for material file %s.", file.c_str());
+        return -1;
+    }
+    m_materialFiles[file] = materialId;
+    watchFile(file);
+    setResourceFile(EResourceType::Material, materialId, file);
+    return materialId;
+}
+
+bool CResourceManager::loadMaterialFiles(const CIniFile& ini, const std::string& file,
+                                         SMaterial& material,
+                                         std::vector<CResourceHandle>& handles)
+{
     if (ini.hasKey("diffuse", "file"))
     {
         // Diffuse texture is RGB format, ignore alpha
-        diffuseId = loadImage(ini.getValue("diffuse", "file", "error"), EColorFormat::RGB24);
-        if (diffuseId == -1)
+        material.m_diffuse = loadImage(ini.getValue("diffuse", "file", "error"),
+                                       EColorFormat::RGB24, EImageContent::Color);
+        if (material.m_diffuse == -1)
         {
             LOG_ERROR("Failed to load diffuse texture specified in material file %s.",
                       file.c_str());
-            return -1;
+            return false;
         }
+        handles.emplace_back(this, EResourceType::Image, material.m_diffuse);
     }
 
-    ResourceId normalId = -1;
     if (ini.hasKey("normal", "file"))
     {
         // Normal texture is RGB format
-        normalId = loadImage(ini.getValue("normal", "file", "error"), EColorFormat::RGB24);
-        if (normalId == -1)
+        material.m_normal = loadImage(ini.getValue("normal", "file", "error"),
+                                      EColorFormat::RGB24, EImageContent::Normal);
+        if (material.m_normal == -1)
         {
             LOG_ERROR("Failed to load normal texture specified in material file %s.", file.c_str());
-            return -1;
+            return false;
         }
+        handles.emplace_back(this, EResourceType::Image, material.m_normal);
     }
 
-    ResourceId specularId = -1;
     if (ini.hasKey("specular", "file"))
     {
         // Specular texture is grey-scale format
-        specularId = loadImage(ini.getValue("specular", "file", "error"), EColorFormat::GreyScale8);
-        if (specularId == -1)
+        material.m_specular = loadImage(ini.getValue("specular", "file", "error"),
+                                        EColorFormat::GreyScale8, EImageContent::Data);
+        if (material.m_specular == -1)
         {
             LOG_ERROR("Failed to load specular texture specified in material file %s.",
                       file.c_str());
-            return -1;
+            return false;
         }
+        handles.emplace_back(this, EResourceType::Image, material.m_specular);
     }
 
-    ResourceId glowId = -1;
     if (ini.hasKey("glow", "file"))
     {
         // Glow texture is grey-scale format
-        glowId = loadImage(ini.getValue("glow", "file", "error"), EColorFormat::GreyScale8);
-        if (glowId == -1)
+        material.m_glow = loadImage(ini.getValue("glow", "file", "error"),
+                                    EColorFormat::GreyScale8, EImageContent::Data);
+        if (material.m_glow == -1)
         {
             LOG_ERROR("Failed to load glow texture specified in material file %s.", file.c_str());
-            return -1;
+            return false;
         }
+        handles.emplace_back(this, EResourceType::Image, material.m_glow);
     }
 
-    ResourceId alphaId = -1;
     if (ini.hasKey("alpha", "file"))
     {
         // Alpha texture is grey-scale format
-        alphaId = loadImage(ini.getValue("alpha", "file", "error"), EColorFormat::GreyScale8);
-        if (alphaId == -1)
+        material.m_alpha = loadImage(ini.getValue("alpha", "file", "error"),
+                                     EColorFormat::GreyScale8, EImageContent::Data);
+        if (material.m_alpha == -1)
         {
             LOG_ERROR("Failed to load alpha texture specified in material file %s.", file.c_str());
-            return -1;
+            return false;
         }
+        handles.emplace_back(this, EResourceType::Image, material.m_alpha);
     }
 
-    ResourceId customShaderId = -1;
     if (ini.hasKey("shader", "file"))
     {
         // Has custom shader file specified
-        customShaderId = loadShader(ini.getValue("shader", "file", "error"));
-        if (customShaderId == -1)
+        material.m_customShader = loadShader(ini.getValue("shader", "file", "error"));
+        if (material.m_customShader == -1)
         {
             LOG_ERROR("Failed to load custom shader file specified in material file %s.",
                       file.c_str());
-            return -1;
+            return false;
         }
+        handles.emplace_back(this, EResourceType::Shader, material.m_customShader);
     }
 
-    ResourceId materialId =
-        createMaterial(diffuseId, normalId, specularId, glowId, alphaId, customShaderId);
-    if (materialId == -1)
-    {
-        LOG_ERROR("Failed to create material resource id for material file %s.", file.c_str());
-        return -1;
-    }
-    m_materialFiles[file] = materialId;
-    return materialId;
+    return true;
 }
 
 bool CResourceManager::getMaterial(ResourceId id, ResourceId& diffuse, ResourceId& normal,
                                    ResourceId& specular, ResourceId& glow, ResourceId& alpha,
                                    ResourceId& customShader) const
 {
-    // Retrieve from map
-    auto iter = m_materials.find(id);
-    if (iter == m_materials.end())
+    // Retrieve from storage
+    const SMaterial* material = m_materials.get(id);
+    if (material == nullptr)
     {
         return false;
     }
+    touch(EResourceType::Material, id);
     // Copy data
-    diffuse = iter->second.m_diffuse;
-    normal = iter->second.m_normal;
-    specular = iter->second.m_specular;
-    glow = iter->second.m_glow;
-    alpha = iter->second.m_alpha;
-    customShader = iter->second.m_customShader;
+    diffuse = material->m_diffuse;
+    normal = material->m_normal;
+    specular = material->m_specular;
+    glow = material->m_glow;
+    alpha = material->m_alpha;
+    customShader = material->m_customShader;
     return true;
 }
 
 ResourceId CResourceManager::createString(const std::string& text)
 {
-    // Create string
-    ResourceId id = m_nextStringId;
-    ++m_nextStringId;
-
     // Add string
-    m_strings[id] = text;
+    ResourceId id = m_strings.add(text);
+    registerResource(EResourceType::String, id, sizeof(std::string) + m_strings.get(id)->capacity(),
+                     0);
 
     // Notify listener with create event
     notifyResourceListeners(EResourceType::String, id, EListenerEvent::Create);
@@ -375,19 +771,20 @@ ResourceId CResourceManager::createString(const std::string& text)
 
 ResourceId CResourceManager::loadString(const std::string& file)
 {
-	return loadString(file, false);
+	return loadString(file, false, std::vector<std::string>());
 }
 
 bool CResourceManager::getString(ResourceId id, std::string& text) const
 {
-    // Retrieve from map
-    auto iter = m_strings.find(id);
-    if (iter == m_strings.end())
+    // Retrieve from storage
+    const std::string* string = m_strings.get(id);
+    if (string == nullptr)
     {
         return false;
     }
+    touch(EResourceType::String, id);
     // Copy data
-    text = iter->second;
+    text = *string;
     return true;
 }
 
@@ -395,12 +792,16 @@ ResourceId CResourceManager::createShader(ResourceId vertex, ResourceId tessCtrl
                                           ResourceId tessEval, ResourceId geometry,
                                           ResourceId fragment)
 {
-    // Create shader
-    ResourceId id = m_nextShaderId;
-    ++m_nextShaderId;
-
     // Add shader
-    m_shaders[id] = SShader(vertex, tessCtrl, tessEval, geometry, fragment);
+    ResourceId id = m_shaders.add(SShader(vertex, tessCtrl, tessEval, geometry, fragment));
+
+    // Shader keeps referenced source strings alive
+    addReference(EResourceType::String, vertex);
+    addReference(EResourceType::String, tessCtrl);
+    addReference(EResourceType::String, tessEval);
+    addReference(EResourceType::String, geometry);
+    addReference(EResourceType::String, fragment);
+    registerResource(EResourceType::Shader, id, sizeof(SShader), 0);
 
     // Notify listener with create event
     notifyResourceListeners(EResourceType::Shader, id, EListenerEvent::Create);
@@ -411,35 +812,44 @@ bool CResourceManager::getShader(ResourceId id, ResourceId& vertex, ResourceId&
                                  ResourceId& tessEval, ResourceId& geometry,
                                  ResourceId& fragment) const
 {
-    // Retrieve from map
-    auto iter = m_shaders.find(id);
-    if (iter == m_shaders.end())
+    // Retrieve from storage
+    const SShader* shader = m_shaders.get(id);
+    if (shader == nullptr)
     {
         return false;
     }
+    touch(EResourceType::Shader, id);
     // Copy data
-    vertex = iter->second.m_vertex;
-    tessCtrl = iter->second.m_tessCtrl;
-    tessEval = iter->second.m_tessEval;
-    geometry = iter->second.m_geometry;
-    fragment = iter->second.m_fragment;
+    vertex = shader->m_vertex;
+    tessCtrl = shader->m_tessCtrl;
+    tessEval = shader->m_tessEval;
+    geometry = shader->m_geometry;
+    fragment = shader->m_fragment;
     return true;
 }
 
 ResourceId CResourceManager::loadShader(const std::string& file)
 {
-    // Check if shader exists
-    auto entry = m_shaderFiles.find(file);
+    return loadShader(file, std::vector<std::string>());
+}
+
+ResourceId CResourceManager::loadShader(const std::string& file,
+                                        const std::vector<std::string>& defines)
+{
+    // Check if shader variant exists
+    std::string variant = getVariantName(file, defines);
+    auto entry = m_shaderFiles.find(variant);
     if (entry != m_shaderFiles.end())
     {
+        addReference(EResourceType::Shader, entry->second);
         return entry->second;
     }
 
-	LOG_DEBUG("Loading shader from file %s.", file.c_str());
+	LOG_DEBUG("Loading shader from file %s.", variant.c_str());
 
     // Load shader ini
     CIniFile ini;
-    if (!ini.load(file))
+    if (!ini.load(file, m_fileSystem))
     {
         LOG_ERROR("Failed to load shader program file %s", file.c_str());
         return -1;
@@ -455,7 +865,8 @@ ResourceId CResourceManager::loadShader(const std::string& file)
         return -1;
     }
 
-    ResourceId vertexId = loadString(ini.getValue("vertex", "file", "error"), true);
+    ResourceId vertexId = loadString(ini.getValue("vertex", "file", "error"), true,
+                            defines);
     if (vertexId == -1)
     {
         LOG_ERROR(
@@ -464,8 +875,10 @@ ResourceId CResourceManager::loadShader(const std::string& file)
             ini.getValue("vertex", "file", "error").c_str(), file.c_str());
         return -1;
     }
+    CResourceHandle vertexHandle(this, EResourceType::String, vertexId);
 
-	ResourceId fragmentId = loadString(ini.getValue("fragment", "file", "error"), true);
+	ResourceId fragmentId = loadString(ini.getValue("fragment", "file", "error"), true,
+                            defines);
     if (fragmentId == -1)
     {
         LOG_ERROR(
@@ -474,12 +887,15 @@ ResourceId CResourceManager::loadShader(const std::string& file)
             ini.getValue("fragment", "file", "error").c_str(), file.c_str());
         return -1;
     }
+    CResourceHandle fragmentHandle(this, EResourceType::String, fragmentId);
 
+    CResourceHandle tessCtrlHandle;
     ResourceId tessCtrlId = -1;
     // Check for and load tessellation control shader source
     if (ini.hasKey("tessellation_control", "file"))
     {
-		tessCtrlId = loadString(ini.getValue("tessellation_control", "file", "error"), true);
+		tessCtrlId = loadString(ini.getValue("tessellation_control", "file", "error"), true,
+                            defines);
         if (tessCtrlId == -1)
         {
             LOG_ERROR(
@@ -488,13 +904,16 @@ ResourceId CResourceManager::loadShader(const std::string& file)
                 ini.getValue("tessellation_control", "file", "error").c_str(), file.c_str());
             return -1;
         }
+        tessCtrlHandle = CResourceHandle(this, EResourceType::String, tessCtrlId);
     }
 
+    CResourceHandle tessEvalHandle;
     ResourceId tessEvalId = -1;
     // Check for and load tessellation evaluation shader source
     if (ini.hasKey("tessellation_evaluation", "file"))
     {
-		tessEvalId = loadString(ini.getValue("tessellation_evaluation", "file", "error"), true);
+		tessEvalId = loadString(ini.getValue("tessellation_evaluation", "file", "error"), true,
+                            defines);
         if (tessEvalId == -1)
         {
             LOG_ERROR(
@@ -503,13 +922,16 @@ ResourceId CResourceManager::loadShader(const std::string& file)
                 ini.getValue("tessellation_evaluation", "file", "error").c_str(), file.c_str());
             return -1;
         }
+        tessEvalHandle = CResourceHandle(this, EResourceType::String, tessEvalId);
     }
 
+    CResourceHandle geometryHandle;
     ResourceId geometryId = -1;
     // Check for and load geometry shader source
     if (ini.hasKey("geometry", "file"))
     {
-		geometryId = loadString(ini.getValue("geometry", "file", "error"), true);
+		geometryId = loadString(ini.getValue("geometry", "file", "error"), true,
+                            defines);
         if (geometryId == -1)
         {
             LOG_ERROR(
@@ -518,6 +940,7 @@ ResourceId CResourceManager::loadShader(const std::string& file)
                 ini.getValue("geometry", "file", "error").c_str(), file.c_str());
             return -1;
         }
+        geometryHandle = CResourceHandle(this, EResourceType::String, geometryId);
     }
 
     ResourceId shaderId = -1;
@@ -528,59 +951,624 @@ ResourceId CResourceManager::loadShader(const std::string& file)
         LOG_ERROR("Failed to create reasource id for shader file %s.", file.c_str());
         return -1;
     }
-    m_shaderFiles[file] = shaderId;
+    m_shaderFiles[variant] = shaderId;
+    setResourceFile(EResourceType::Shader, shaderId, variant);
+
+    // Record stage sources for finding shaders affected by changed files
+    const char* stages[] = {"vertex", "tessellation_control", "tessellation_evaluation",
+                            "geometry", "fragment"};
+    for (const char* stage : stages)
+    {
+        if (ini.hasKey(stage, "file"))
+        {
+            m_shaderPreprocessor.addDependency(file, ini.getValue(stage, "file", "error"));
+        }
+    }
     return shaderId;
 }
 
-void CResourceManager::addResourceListener(IResourceListener* listener)
+void CResourceManager::getShaderDependents(const std::string& file,
+                                           std::vector<std::string>& dependents) const
 {
-    m_resourceListeners.push_back(listener);
-    listener->onAttach(this);
+    m_shaderPreprocessor.getDependents(file, dependents);
 }
 
-void CResourceManager::removeResourceListener(IResourceListener* listener)
+void CResourceManager::invalidateShaderInclude(const std::string& file)
 {
-    m_resourceListeners.remove(listener);
-    listener->onDetach(this);
+    m_shaderPreprocessor.invalidate(file);
 }
 
-void CResourceManager::notifyResourceListeners(EResourceType type, ResourceId id,
-                                               EListenerEvent event)
+std::string CResourceManager::mapShaderSourceNames(const std::string& infoLog) const
 {
-    for (const auto& listener : m_resourceListeners)
-    {
-        listener->notify(type, id, event, this);
-    }
+    return m_shaderPreprocessor.mapSourceNames(infoLog);
 }
 
-ResourceId CResourceManager::loadString(const std::string& file, bool preprocess)
+void CResourceManager::setHotReload(bool enabled)
 {
-	auto iter = m_textFiles.find(file);
+    if (!enabled)
+    {
+        m_fileWatcher.reset();
+        return;
+    }
+    if (m_fileWatcher != nullptr)
+    {
+        return;
+    }
+    m_fileWatcher.reset(new CFileWatcher);
+
+    // Watch files loaded so far
+    for (const auto& entry : m_meshFiles)
+    {
+        watchFile(entry.first);
+    }
+    for (const auto& entry : m_imageFiles)
+    {
+        watchFile(entry.first);
+    }
+    for (const auto& entry : m_materialFiles)
+    {
+        watchFile(entry.first);
+    }
+    for (const auto& entry : m_textFiles)
+    {
+        watchFile(getVariantFile(entry.first));
+    }
+    LOG_INFO("Hot reloading enabled, %s.",
+             m_fileWatcher->isNative() ? "watching file events" : "polling files");
+}
+
+void CResourceManager::updateHotReload()
+{
+    if (m_fileWatcher != nullptr)
+    {
+        std::vector<std::string> changed;
+        m_fileWatcher->poll(changed);
+        for (const std::string& file : changed)
+        {
+            startReload(file);
+        }
+    }
+
+    // Apply in reading order, so the last change of a file is applied last
+    while (!m_reloads.empty() &&
+           m_reloads.front()->m_ready.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready)
+    {
+        std::shared_ptr<SReload> reload = m_reloads.front();
+        m_reloads.pop_front();
+        if (!reload->m_ready.get())
+        {
+            LOG_ERROR("Failed to reload changed file %s.", reload->m_file.c_str());
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        applyReload(*reload);
+        LOG_INFO("Reloaded file %s in %.2f ms.", reload->m_file.c_str(),
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                           start).count());
+    }
+}
+
+void CResourceManager::watchFile(const std::string& file)
+{
+    if (m_fileWatcher == nullptr || file.empty())
+    {
+        return;
+    }
+    m_fileWatcher->addFile(file);
+
+    // Changed includes reload the including shader sources
+    std::vector<std::string> includes;
+    m_shaderPreprocessor.getDependencies(file, includes);
+    for (const std::string& include : includes)
+    {
+        m_fileWatcher->addFile(include);
+    }
+}
+
+void CResourceManager::startReload(const std::string& file)
+{
+    std::shared_ptr<SReload> reload = std::make_shared<SReload>();
+    reload->m_file = file;
+    reload->m_id = invalidResource;
+    std::shared_ptr<std::promise<bool>> result = std::make_shared<std::promise<bool>>();
+    reload->m_ready = result->get_future();
+
+    // Reading does not modify shared state, see loadImages
+    auto mesh = m_meshFiles.find(file);
+    auto image = m_imageFiles.find(file);
+    auto material = m_materialFiles.find(file);
+    if (mesh != m_meshFiles.end())
+    {
+        reload->m_type = EResourceType::Mesh;
+        reload->m_id = mesh->second;
+        m_threadPool.addTask([this, reload, result]()
+                             {
+                                 result->set_value(readMesh(reload->m_file, reload->m_mesh));
+                             });
+    }
+    else if (image != m_imageFiles.end())
+    {
+        reload->m_type = EResourceType::Image;
+        reload->m_id = image->second;
+        EColorFormat format = m_images.get(image->second)->m_format;
+        EImageContent content = m_images.get(image->second)->m_content;
+        m_threadPool.addTask([this, reload, result, format, content]()
+                             {
+                                 result->set_value(readImage(reload->m_file, format, content,
+                                                             reload->m_image));
+                             });
+    }
+    else if (material != m_materialFiles.end())
+    {
+        reload->m_type = EResourceType::Material;
+        reload->m_id = material->second;
+        m_threadPool.addTask([this, reload, result]()
+                             {
+                                 result->set_value(
+                                     reload->m_material.load(reload->m_file, m_fileSystem));
+                             });
+    }
+    else
+    {
+        // Changed text file or include, dependent text files are preprocessed again
+        std::unordered_set<std::string> textFiles;
+        for (const auto& entry : m_textFiles)
+        {
+            textFiles.insert(getVariantFile(entry.first));
+        }
+        std::vector<std::string> files;
+        m_shaderPreprocessor.getDependents(file, files);
+        files.push_back(file);
+        for (const std::string& textFile : files)
+        {
+            if (textFiles.count(textFile) != 0)
+            {
+                reload->m_texts[textFile];
+            }
+        }
+        if (reload->m_texts.empty())
+        {
+            // Neither a loaded file nor an include of one
+            return;
+        }
+
+        reload->m_type = EResourceType::String;
+        m_threadPool.addTask([this, reload, result]()
+                             {
+                                 for (auto& entry : reload->m_texts)
+                                 {
+                                     if (!m_fileSystem.readFile(entry.first, entry.second))
+                                     {
+                                         result->set_value(false);
+                                         return;
+                                     }
+                                 }
+                                 result->set_value(true);
+                             });
+    }
+    LOG_DEBUG("Reading changed file %s.", file.c_str());
+    m_reloads.push_back(reload);
+}
+
+void CResourceManager::applyReload(SReload& reload)
+{
+    ResourceId id = reload.m_id;
+    switch (reload.m_type)
+    {
+    case EResourceType::Mesh:
+    {
+        SMesh* mesh = m_meshes.get(id);
+        if (mesh == nullptr)
+        {
+            // Unloaded while reading
+            return;
+        }
+        resizeResource(EResourceType::Mesh, id, getMemorySize(reload.m_mesh),
+                       getGpuMemorySize(reload.m_mesh));
+        *mesh = std::move(reload.m_mesh);
+        notifyResourceListeners(EResourceType::Mesh, id, EListenerEvent::Change);
+        applyResidencyPolicy(EResourceType::Mesh, id);
+    }
+    break;
+    case EResourceType::Image:
+    {
+        SImage* image = m_images.get(id);
+        if (image == nullptr)
+        {
+            return;
+        }
+        resizeResource(EResourceType::Image, id, getMemorySize(reload.m_image),
+                       getGpuMemorySize(reload.m_image));
+        *image = std::move(reload.m_image);
+        notifyResourceListeners(EResourceType::Image, id, EListenerEvent::Change);
+        applyResidencyPolicy(EResourceType::Image, id);
+    }
+    break;
+    case EResourceType::Material:
+    {
+        if (!m_materials.contains(id))
+        {
+            return;
+        }
+        SMaterial reloaded;
+        std::vector<CResourceHandle> handles;
+        if (!loadMaterialFiles(reload.m_material, reload.m_file, reloaded, handles))
+        {
+            LOG_ERROR("Failed to reload material file %s, keeping the previous material.",
+                      reload.m_file.c_str());
+            return;
+        }
+
+        // Material keeps the new resources alive and releases the previous ones
+        addReference(EResourceType::Image, reloaded.m_diffuse);
+        addReference(EResourceType::Image, reloaded.m_normal);
+        addReference(EResourceType::Image, reloaded.m_specular);
+        addReference(EResourceType::Image, reloaded.m_glow);
+        addReference(EResourceType::Image, reloaded.m_alpha);
+        addReference(EResourceType::Shader, reloaded.m_customShader);
+        SMaterial previous = *m_materials.get(id);
+        *m_materials.get(id) = reloaded;
+        notifyResourceListeners(EResourceType::Material, id, EListenerEvent::Change);
+        release(EResourceType::Image, previous.m_diffuse);
+        release(EResourceType::Image, previous.m_normal);
+        release(EResourceType::Image, previous.m_specular);
+        release(EResourceType::Image, previous.m_glow);
+        release(EResourceType::Image, previous.m_alpha);
+        release(EResourceType::Shader, previous.m_customShader);
+    }
+    break;
+    case EResourceType::String:
+        applyTextReload(reload);
+        break;
+    default:
+        break;
+    }
+}
+
+void CResourceManager::applyTextReload(SReload& reload)
+{
+    // Changed includes are read again by the preprocessor
+    m_shaderPreprocessor.invalidate(reload.m_file);
+
+    std::unordered_set<ResourceId> changed;
+    for (const auto& entry : m_textFiles)
+    {
+        auto source = reload.m_texts.find(getVariantFile(entry.first));
+        std::string* string = m_strings.get(entry.second);
+        if (source == reload.m_texts.end() || string == nullptr)
+        {
+            continue;
+        }
+
+        std::string text = source->second;
+        auto defines = m_textDefines.find(entry.first);
+        if (defines != m_textDefines.end())
+        {
+            m_shaderPreprocessor.setDefines(defines->second);
+            if (!m_shaderPreprocessor.preprocess(source->first, text, text))
+            {
+                LOG_ERROR("Failed to preprocess the text file %s, keeping the previous text.",
+                          entry.first.c_str());
+                continue;
+            }
+        }
+        if (text == *string)
+        {
+            continue;
+        }
+        string->swap(text);
+        resizeResource(EResourceType::String, entry.second,
+                       sizeof(std::string) + string->capacity(), 0);
+        notifyResourceListeners(EResourceType::String, entry.second, EListenerEvent::Change);
+        changed.insert(entry.second);
+        // Watch new includes
+        watchFile(source->first);
+    }
+    if (changed.empty())
+    {
+        return;
+    }
+
+    // Shader programs are rebuilt from the changed sources
+    std::vector<ResourceId> shaders;
+    m_shaders.forEach([&changed, &shaders](ResourceId id, const SShader& shader)
+                      {
+                          if (changed.count(shader.m_vertex) != 0 ||
+                              changed.count(shader.m_tessCtrl) != 0 ||
+                              changed.count(shader.m_tessEval) != 0 ||
+                              changed.count(shader.m_geometry) != 0 ||
+                              changed.count(shader.m_fragment) != 0)
+                          {
+                              shaders.push_back(id);
+                          }
+                      });
+    for (ResourceId id : shaders)
+    {
+        notifyResourceListeners(EResourceType::Shader, id, EListenerEvent::Change);
+    }
+}
+
+void CResourceManager::resizeResource(EResourceType type, ResourceId id, size_t cpuBytes,
+                                      size_t gpuBytes)
+{
+    SResourceInfo* info = getResourceInfo(type).get(id);
+    if (info == nullptr)
+    {
+        return;
+    }
+    m_cpuMemoryUsage = m_cpuMemoryUsage - info->m_cpuBytes + cpuBytes;
+    m_gpuMemoryUsage = m_gpuMemoryUsage - info->m_gpuBytes + gpuBytes;
+    info->m_cpuBytes = cpuBytes;
+    info->m_gpuBytes = gpuBytes;
+    info->m_resident = true;
+    info->m_lastUse = ++m_useTick;
+}
+
+void CResourceManager::addReference(EResourceType type, ResourceId id)
+{
+    if (id == invalidResource)
+    {
+        return;
+    }
+    SResourceInfo* info = getResourceInfo(type).get(id);
+    if (info == nullptr)
+    {
+        LOG_WARNING("Failed to add reference to unknown resource id %lli.", (long long)id);
+        return;
+    }
+    ++info->m_references;
+    info->m_lastUse = ++m_useTick;
+}
+
+void CResourceManager::releaseReference(EResourceType type, ResourceId id)
+{
+    release(type, id);
+    enforceMemoryBudget();
+}
+
+bool CResourceManager::unload(EResourceType type, ResourceId id)
+{
+    auto& infos = getResourceInfo(type);
+    const SResourceInfo* entry = infos.get(id);
+    if (entry == nullptr)
+    {
+        LOG_WARNING("Failed to unload unknown resource id %lli.", (long long)id);
+        return false;
+    }
+    if (entry->m_references != 0)
+    {
+        LOG_WARNING("Failed to unload resource id %lli with %u remaining references.",
+                    (long long)id, entry->m_references);
+        return false;
+    }
+
+    SResourceInfo info = *entry;
+    infos.erase(id);
+    m_cpuMemoryUsage -= info.m_cpuBytes;
+    m_gpuMemoryUsage -= info.m_gpuBytes;
+    LOG_DEBUG("Unloading resource id %lli from file %s.", (long long)id, info.m_file.c_str());
+
+    // Listeners release dependent objects before the data is removed
+    notifyResourceListeners(type, id, EListenerEvent::Delete);
+
+    switch (type)
+    {
+    case EResourceType::Mesh:
+        m_meshes.erase(id);
+        m_meshFiles.erase(info.m_file);
+        break;
+    case EResourceType::Image:
+        m_images.erase(id);
+        m_imageFiles.erase(info.m_file);
+        break;
+    case EResourceType::Material:
+    {
+        SMaterial material = *m_materials.get(id);
+        m_materials.erase(id);
+        m_materialFiles.erase(info.m_file);
+        release(EResourceType::Image, material.m_diffuse);
+        release(EResourceType::Image, material.m_normal);
+        release(EResourceType::Image, material.m_specular);
+        release(EResourceType::Image, material.m_glow);
+        release(EResourceType::Image, material.m_alpha);
+        release(EResourceType::Shader, material.m_customShader);
+    }
+    break;
+    case EResourceType::String:
+        m_strings.erase(id);
+        m_textFiles.erase(info.m_file);
+        m_textDefines.erase(info.m_file);
+        break;
+    case EResourceType::Shader:
+    {
+        SShader shader = *m_shaders.get(id);
+        m_shaders.erase(id);
+        m_shaderFiles.erase(info.m_file);
+        release(EResourceType::String, shader.m_vertex);
+        release(EResourceType::String, shader.m_tessCtrl);
+        release(EResourceType::String, shader.m_tessEval);
+        release(EResourceType::String, shader.m_geometry);
+        release(EResourceType::String, shader.m_fragment);
+    }
+    break;
+    }
+    return true;
+}
+
+void CResourceManager::unloadUnreferenced()
+{
+    // Unloading materials and shaders releases their dependencies, repeat until nothing is left
+    bool unloaded = true;
+    while (unloaded)
+    {
+        unloaded = false;
+        for (unsigned int i = 0; i < s_resourceTypeCount; ++i)
+        {
+            std::vector<ResourceId> ids;
+            m_resourceInfo[i].forEach([&ids](ResourceId id, const SResourceInfo& info)
+                                      {
+                                          if (info.m_references == 0)
+                                          {
+                                              ids.push_back(id);
+                                          }
+                                      });
+            for (ResourceId id : ids)
+            {
+                unloaded |= unload(static_cast<EResourceType>(i), id);
+            }
+        }
+    }
+}
+
+void CResourceManager::setMemoryBudget(size_t cpuBytes, size_t gpuBytes)
+{
+    m_cpuMemoryBudget = cpuBytes;
+    m_gpuMemoryBudget = gpuBytes;
+    LOG_INFO("Resource memory budget set to %lu bytes CPU and %lu bytes GPU.",
+             (unsigned long)cpuBytes, (unsigned long)gpuBytes);
+    enforceMemoryBudget();
+}
+
+void CResourceManager::setDefaultResidencyPolicy(EResourceType type, EResidencyPolicy policy)
+{
+    m_residencyPolicy[(unsigned int)type] = policy;
+}
+
+void CResourceManager::setMipGeneration(EMipFilter filter, bool writeCache)
+{
+    m_mipFilter = filter;
+    m_writeMipCache = writeCache;
+}
+
+bool CResourceManager::setResidencyPolicy(EResourceType type, ResourceId id,
+                                          EResidencyPolicy policy)
+{
+    SResourceInfo* entry = getResourceInfo(type).get(id);
+    if (entry == nullptr)
+    {
+        LOG_WARNING("Failed to set residency policy of unknown resource id %lli.", (long long)id);
+        return false;
+    }
+    SResourceInfo& info = *entry;
+    info.m_policy = policy;
+    if (policy != EResidencyPolicy::Keep)
+    {
+        // Resource has been uploaded on creation already
+        applyResidencyPolicy(type, id);
+        return true;
+    }
+    if (info.m_resident)
+    {
+        return true;
+    }
+
+    // Restore dropped data
+    size_t residentBytes = 0;
+    if (type == EResourceType::Mesh)
+    {
+        SMesh& mesh = *m_meshes.get(id);
+        if (!readMesh(info.m_file, mesh))
+        {
+            return false;
+        }
+        residentBytes = getMemorySize(mesh);
+    }
+    else if (type == EResourceType::Image)
+    {
+        SImage& image = *m_images.get(id);
+        if (!readImage(info.m_file, image.m_format, image.m_content, image))
+        {
+            return false;
+        }
+        residentBytes = getMemorySize(image);
+    }
+    m_cpuMemoryUsage += residentBytes - info.m_cpuBytes;
+    info.m_cpuBytes = residentBytes;
+    info.m_resident = true;
+    return true;
+}
+
+size_t CResourceManager::getMemoryUsage(EResourceType type) const
+{
+    size_t bytes = 0;
+    getResourceInfo(type).forEach([&bytes](ResourceId id, const SResourceInfo& info)
+                                  {
+                                      bytes += info.m_cpuBytes;
+                                  });
+    return bytes;
+}
+
+void CResourceManager::getResourceUsage(std::vector<SResourceUsage>& usage) const
+{
+    usage.clear();
+    for (unsigned int i = 0; i < s_resourceTypeCount; ++i)
+    {
+        m_resourceInfo[i].forEach([&usage, i](ResourceId id, const SResourceInfo& info)
+                                  {
+                                      SResourceUsage resource;
+                                      resource.m_type = static_cast<EResourceType>(i);
+                                      resource.m_id = id;
+                                      resource.m_file = info.m_file;
+                                      resource.m_references = info.m_references;
+                                      resource.m_cpuBytes = info.m_cpuBytes;
+                                      usage.push_back(resource);
+                                  });
+    }
+}
+
+bool CResourceManager::mountPack(const std::string& packFile)
+{
+    return m_fileSystem.mount(packFile);
+}
+
+void CResourceManager::addResourceListener(IResourceListener* listener)
+{
+    m_resourceListeners.push_back(listener);
+    listener->onAttach(this);
+}
+
+void CResourceManager::removeResourceListener(IResourceListener* listener)
+{
+    m_resourceListeners.remove(listener);
+    listener->onDetach(this);
+}
+
+void CResourceManager::notifyResourceListeners(EResourceType type, ResourceId id,
+                                               EListenerEvent event)
+{
+    for (const auto& listener : m_resourceListeners)
+    {
+        listener->notify(type, id, event, this);
+    }
+}
+
+ResourceId CResourceManager::loadString(const std::string& file, bool preprocess,
+	const std::vector<std::string>& defines)
+{
+	std::string variant = getVariantName(file, defines);
+	auto iter = m_textFiles.find(variant);
 	if (iter != m_textFiles.end())
 	{
+		addReference(EResourceType::String, iter->second);
 		return iter->second;
 	}
 
-	LOG_DEBUG("Loading text from file %s.", file.c_str());
-	std::ifstream ifs(file);
-	if (!ifs.is_open())
+	LOG_DEBUG("Loading text from file %s.", variant.c_str());
+	std::string text;
+	if (!m_fileSystem.readFile(file, text))
 	{
 		LOG_ERROR("Failed to open the text file %s.", file.c_str());
 		return -1;
 	}
 
-	// Load file
-	std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-	ifs.close();
-
 	ResourceId stringId = -1;
 
 	if (preprocess)
 	{
 		// Preprocessing of include statements for shader source files
-		CShaderPreprocessor preprocessor;
-		preprocessor.setIncludePath("data/shadersource/include/");
-		if (!preprocessor.preprocess(text, text))
+		m_shaderPreprocessor.setDefines(defines);
+		if (!m_shaderPreprocessor.preprocess(file, text, text))
 		{
 			LOG_ERROR("Failed to preprocess the text file %s.", file.c_str());
 			return -1;
@@ -595,6 +1583,422 @@ ResourceId CResourceManager::loadString(const std::string& file, bool preprocess
 		return -1;
 	}
 
-	m_textFiles[file] = stringId;
+	m_textFiles[variant] = stringId;
+	setResourceFile(EResourceType::String, stringId, variant);
+	if (preprocess)
+	{
+		m_textDefines[variant] = defines;
+	}
+	watchFile(file);
 	return stringId;
-}
\ No newline at end of file
+}
+
+void CResourceManager::registerResource(EResourceType type, ResourceId id, size_t cpuBytes,
+                                        size_t gpuBytes)
+{
+    SResourceInfo info("", cpuBytes, gpuBytes);
+    info.m_lastUse = ++m_useTick;
+    info.m_policy = m_residencyPolicy[(unsigned int)type];
+    getResourceInfo(type).insert(id, info);
+    m_cpuMemoryUsage += cpuBytes;
+    m_gpuMemoryUsage += gpuBytes;
+
+    // New resource is referenced by the caller and can not be evicted
+    enforceMemoryBudget();
+}
+
+void CResourceManager::setResourceFile(EResourceType type, ResourceId id, const std::string& file)
+{
+    SResourceInfo* info = getResourceInfo(type).get(id);
+    if (info != nullptr)
+    {
+        info->m_file = file;
+    }
+}
+
+void CResourceManager::touch(EResourceType type, ResourceId id) const
+{
+    SResourceInfo* info = getResourceInfo(type).get(id);
+    if (info != nullptr)
+    {
+        info->m_lastUse = ++m_useTick;
+    }
+}
+
+void CResourceManager::release(EResourceType type, ResourceId id)
+{
+    if (id == invalidResource)
+    {
+        return;
+    }
+    SResourceInfo* info = getResourceInfo(type).get(id);
+    if (info == nullptr || info->m_references == 0)
+    {
+        LOG_WARNING("Failed to release reference to resource id %lli.", (long long)id);
+        return;
+    }
+    --info->m_references;
+}
+
+void CResourceManager::enforceMemoryBudget()
+{
+    while (isOverBudget())
+    {
+        // Find least recently used unreferenced resource
+        EResourceType lruType = EResourceType::Mesh;
+        ResourceId lruId = invalidResource;
+        uint64_t lruTick = 0;
+        for (unsigned int i = 0; i < s_resourceTypeCount; ++i)
+        {
+            m_resourceInfo[i].forEach([&, i](ResourceId id, const SResourceInfo& info)
+                                      {
+                                          if (info.m_references == 0 &&
+                                              (lruId == invalidResource || info.m_lastUse < lruTick))
+                                          {
+                                              lruType = static_cast<EResourceType>(i);
+                                              lruId = id;
+                                              lruTick = info.m_lastUse;
+                                          }
+                                      });
+        }
+
+        if (lruId == invalidResource)
+        {
+            // Everything left is in use
+            return;
+        }
+        unload(lruType, lruId);
+    }
+}
+
+bool CResourceManager::isOverBudget() const
+{
+    return (m_cpuMemoryBudget != 0 && m_cpuMemoryUsage > m_cpuMemoryBudget) ||
+           (m_gpuMemoryBudget != 0 && m_gpuMemoryUsage > m_gpuMemoryBudget);
+}
+
+TResourceStorage<SResourceInfo>& CResourceManager::getResourceInfo(EResourceType type) const
+{
+    return m_resourceInfo[static_cast<unsigned int>(type)];
+}
+
+ResourceId CResourceManager::addMesh(SMesh& mesh, const std::string& file)
+{
+    size_t gpuBytes = getGpuMemorySize(mesh);
+
+    // Add mesh
+    size_t cpuBytes = getMemorySize(mesh);
+    ResourceId id = m_meshes.add(std::move(mesh));
+    registerResource(EResourceType::Mesh, id, cpuBytes, gpuBytes);
+    setResourceFile(EResourceType::Mesh, id, file);
+
+    // Notify listener with create event
+    notifyResourceListeners(EResourceType::Mesh, id, EListenerEvent::Create);
+    applyResidencyPolicy(EResourceType::Mesh, id);
+    return id;
+}
+
+ResourceId CResourceManager::addImage(SImage& image, const std::string& file)
+{
+    size_t gpuBytes = getGpuMemorySize(image);
+
+    // Add image
+    size_t cpuBytes = getMemorySize(image);
+    ResourceId id = m_images.add(std::move(image));
+    registerResource(EResourceType::Image, id, cpuBytes, gpuBytes);
+    setResourceFile(EResourceType::Image, id, file);
+
+    // Notify listener with create event
+    notifyResourceListeners(EResourceType::Image, id, EListenerEvent::Create);
+    applyResidencyPolicy(EResourceType::Image, id);
+    return id;
+}
+
+bool CResourceManager::readMesh(const std::string& file, SMesh& mesh) const
+{
+    // Retrieve file extension
+    auto pos = file.find_last_of('.');
+    if (pos == std::string::npos)
+    {
+        LOG_ERROR("The mesh file %s does not have a file extension and could not be loaded.",
+                  file.c_str());
+        return false;
+    }
+    std::string extension = file.substr(pos + 1);
+
+    std::string text;
+    if (!m_fileSystem.readFile(file, text))
+    {
+        LOG_ERROR("The mesh file %s could not be opened.", file.c_str());
+        return false;
+    }
+    std::istringstream stream(text);
+
+    // Decide loading method based on extension
+    // TODO Register loader functions for extensions
+    if (extension == "obj")
+    {
+        // Wavefront OBJ file format loaded with tinyobj
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        SIgnoreMaterialReader materialReader;
+        // Load as obj
+        std::string err = tinyobj::LoadObj(shapes, materials, stream, materialReader);
+
+        if (!err.empty())
+        {
+            LOG_ERROR("%s.", err.c_str());
+            return false;
+        }
+        if (shapes.size() > 1)
+        {
+            LOG_WARNING("Multple meshes in obj files not supported.");
+        }
+        if (shapes.empty())
+        {
+            LOG_ERROR("No mesh data loaded from file %s.", file.c_str());
+            return false;
+        }
+        tinyobj::mesh_t& objMesh = shapes.at(0).mesh;
+        mesh.m_vertices.swap(objMesh.positions);
+        mesh.m_indices.swap(objMesh.indices);
+        mesh.m_normals.swap(objMesh.normals);
+        mesh.m_uvs.swap(objMesh.texcoords);
+        mesh.m_type = EPrimitiveType::Triangle;
+        mesh.updateBounds();
+        return true;
+    }
+    else if (extension == "oni")
+    {
+        // Load without building index buffer
+        CObjModelLoader objLoader;
+        if (!objLoader.load(stream, file))
+        {
+            LOG_ERROR("Failed to load mesh file %s as non-indexed obj file.", file.c_str());
+            return false;
+        }
+        mesh = SMesh(objLoader.getVertices(), {}, objLoader.getNormals(), objLoader.getUV(),
+                     EPrimitiveType::Triangle);
+        return true;
+    }
+
+    LOG_ERROR("Unknown mesh file extension encountered while loading mesh file %s.",
+              file.c_str());
+    return false;
+}
+
+bool CResourceManager::readImage(const std::string& file, EColorFormat format,
+                                 EImageContent content, SImage& image,
+                                 SImageDecodeInfo* info) const
+{
+    // TODO Check extension, png format assumed
+    if (file.find(".png") == std::string::npos)
+    {
+        LOG_ERROR("Unknown file format encountered while loading image file %s.", file.c_str());
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const char* container = "rtex";
+    std::vector<unsigned char> fileData;
+    bool loaded = false;
+    image.m_content = content;
+
+    // Texture file with precomputed mip chain is preferred over the raw image and png file
+    // Converted files are skipped once the png is edited, hot reload only watches the png
+    std::string textureFile = getTextureFile(file);
+    std::string rawImageFile = getRawImageFile(file);
+    bool staleTexture = isStale(textureFile, file);
+    bool staleRawImage = isStale(rawImageFile, file);
+    if (staleTexture)
+    {
+        LOG_WARNING("The texture file %s is older than image %s and ignored, convert it again.",
+                    textureFile.c_str(), file.c_str());
+    }
+    if (staleRawImage)
+    {
+        LOG_WARNING("The raw image file %s is older than image %s and ignored, convert it again.",
+                    rawImageFile.c_str(), file.c_str());
+    }
+    if (!staleTexture && m_fileSystem.readFile(textureFile, fileData))
+    {
+        EColorFormat storedFormat;
+        if (!decodeTexture(fileData, image.m_data, image.m_width, image.m_height, storedFormat,
+                           image.m_mipCount))
+        {
+            LOG_ERROR("The texture file for image %s is invalid.", file.c_str());
+            return false;
+        }
+        if (isCompatibleFormat(format, storedFormat, content))
+        {
+            image.m_format = storedFormat;
+            loaded = true;
+        }
+        else
+        {
+            // E.g. a diffuse map converted as normal map
+            LOG_WARNING("The texture file for image %s has a color format incompatible with the "
+                        "requested format or content.",
+                        file.c_str());
+        }
+    }
+
+    if (!loaded)
+    {
+        // Map color type
+        LodePNGColorType colorType;
+        switch (format)
+        {
+        case EColorFormat::GreyScale8:
+            colorType = LCT_GREY;
+            break;
+        case EColorFormat::RGB24:
+            colorType = LCT_RGB;
+            break;
+        case EColorFormat::RGBA32:
+            colorType = LCT_RGBA;
+            break;
+        default:
+            LOG_ERROR("Unknown color format encountered while loading image file %s.",
+                      file.c_str());
+            return false;
+        }
+
+        // Pre-converted raw image is preferred over the png file
+        container = "rimg";
+        bool isRawImage = !staleRawImage && m_fileSystem.readFile(rawImageFile, fileData);
+        if (!isRawImage)
+        {
+            container = "png";
+            if (!m_fileSystem.readFile(file, fileData))
+            {
+                LOG_ERROR("The image file %s could not be opened.", file.c_str());
+                return false;
+            }
+        }
+
+        // Cached mip chain of an unchanged source file, generated with the same content and filter,
+        // skips decoding and mip generation
+        uint32_t sourceHash = getTextureSourceHash(fileData, content, m_mipFilter);
+        std::string cacheFile = getTextureCacheFile(file);
+        std::vector<unsigned char> cacheData;
+        EColorFormat cachedFormat;
+        uint32_t cachedHash = 0;
+        if (m_fileSystem.readFile(cacheFile, cacheData) &&
+            decodeTexture(cacheData, image.m_data, image.m_width, image.m_height, cachedFormat,
+                          image.m_mipCount, &cachedHash) &&
+            cachedHash == sourceHash && cachedFormat == format)
+        {
+            container = "mip cache";
+            image.m_format = format;
+            fileData.swap(cacheData);
+        }
+        else
+        {
+            // Decode image data
+            std::vector<unsigned char> pixels;
+            if (isRawImage)
+            {
+                if (!decodeRawImage(fileData, getChannelCount(format), pixels, image.m_width,
+                                    image.m_height))
+                {
+                    LOG_ERROR("The raw image file for image %s is invalid.", file.c_str());
+                    return false;
+                }
+            }
+            else
+            {
+                unsigned int err =
+                    lodepng::decode(pixels, image.m_width, image.m_height, fileData, colorType);
+                if (err != 0)
+                {
+                    LOG_ERROR("An error occured while decoding the image file %s: %s",
+                              file.c_str(), lodepng_error_text(err));
+                    return false;
+                }
+            }
+
+            // Generate mip chain on the loading thread, texture creation uploads the levels
+            image.m_format = format;
+            if (!generateMipChain(pixels.data(), image.m_width, image.m_height,
+                                  getChannelCount(format), content, m_mipFilter, image.m_data))
+            {
+                LOG_ERROR("Failed to generate mip chain for image %s.", file.c_str());
+                return false;
+            }
+            image.m_mipCount = getMipCount(image.m_width, image.m_height);
+
+            if (m_writeMipCache)
+            {
+                // Images are read on several threads, which may read the cache meanwhile
+                std::vector<unsigned char> texture;
+                if (!encodeTexture(image.m_data, image.m_width, image.m_height, format,
+                                   image.m_mipCount, texture, sourceHash) ||
+                    !replaceFile(cacheFile, texture))
+                {
+                    LOG_DEBUG("Failed to write mip cache file %s.", cacheFile.c_str());
+                }
+            }
+        }
+    }
+
+    if (info != nullptr)
+    {
+        info->m_container = container;
+        info->m_fileBytes = fileData.size();
+        info->m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                              .count();
+    }
+    return true;
+}
+
+void CResourceManager::applyResidencyPolicy(EResourceType type, ResourceId id)
+{
+    SResourceInfo* entry = getResourceInfo(type).get(id);
+    if (entry == nullptr || !entry->m_resident || entry->m_policy == EResidencyPolicy::Keep)
+    {
+        return;
+    }
+    SResourceInfo& info = *entry;
+
+    // Only drop data that has been uploaded and can be restored if needed
+    if (m_resourceListeners.empty())
+    {
+        return;
+    }
+    if (info.m_policy == EResidencyPolicy::Reload && info.m_file.empty())
+    {
+        LOG_DEBUG("Keeping data of created resource id %lli, which can not be reloaded.",
+                  (long long)id);
+        return;
+    }
+
+    size_t residentBytes = 0;
+    switch (type)
+    {
+    case EResourceType::Mesh:
+    {
+        SMesh& mesh = *m_meshes.get(id);
+        std::vector<float>().swap(mesh.m_vertices);
+        std::vector<unsigned int>().swap(mesh.m_indices);
+        std::vector<float>().swap(mesh.m_normals);
+        std::vector<float>().swap(mesh.m_uvs);
+        residentBytes = getMemorySize(mesh);
+    }
+    break;
+    case EResourceType::Image:
+    {
+        SImage& image = *m_images.get(id);
+        std::vector<unsigned char>().swap(image.m_data);
+        residentBytes = getMemorySize(image);
+    }
+    break;
+    default:
+        // Other resource types are small and always kept
+        return;
+    }
+
+    m_cpuMemoryUsage -= info.m_cpuBytes - residentBytes;
+    info.m_cpuBytes = residentBytes;
+    info.m_resident = false;
+}
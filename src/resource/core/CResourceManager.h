@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -7,11 +8,20 @@
 #include <string>
 
 #include "resource/IResourceManager.h"
+#include "resource/TResourceStorage.h"
+
+#include "io/CFileWatcher.h"
+#include "io/CIniFile.h"
+#include "io/CShaderPreprocessor.h"
+#include "io/CVirtualFileSystem.h"
+
+#include "util/CThreadPool.h"
 
 #include "SImage.h"
 #include "SMaterial.h"
 #include "SMesh.h"
 #include "SShader.h"
+#include "SResourceInfo.h"
 
 /**
 * \brief Resource manager implementation.
@@ -31,13 +41,26 @@ class CResourceManager : public IResourceManager
     bool getMesh(ResourceId id, std::vector<float>& vertices, std::vector<unsigned int>& indices,
                  std::vector<float>& normals, std::vector<float>& uvs, EPrimitiveType& type) const;
 
+    bool getMeshBounds(ResourceId id, float* min, float* max) const;
+
     ResourceId createImage(const std::vector<unsigned char>& imageData, unsigned int width,
                            unsigned int height, EColorFormat format);
 
-    ResourceId loadImage(const std::string& file, EColorFormat format);
+    ResourceId loadImage(const std::string& file, EColorFormat format, EImageContent content);
 
     bool getImage(ResourceId id, std::vector<unsigned char>& data, unsigned int& width,
-                  unsigned int& height, EColorFormat& format) const;
+                  unsigned int& height, EColorFormat& format, unsigned int& mipCount) const;
+
+    std::future<bool> readImageAsync(ResourceId id, std::vector<unsigned char>& data,
+                                     unsigned int& width, unsigned int& height,
+                                     EColorFormat& format, unsigned int& mipCount);
+
+    void loadImages(const std::vector<std::string>& files,
+                    const std::vector<EColorFormat>& formats,
+                    const std::vector<EImageContent>& contents, std::vector<ResourceId>& ids);
+
+    void preloadMaterials(const std::vector<std::string>& files,
+                          std::vector<CResourceHandle>& images);
 
     ResourceId createMaterial(ResourceId diffuse, ResourceId normal, ResourceId specular,
                               ResourceId glow, ResourceId alpha, ResourceId customShader);
@@ -57,31 +80,176 @@ class CResourceManager : public IResourceManager
                             ResourceId geometry, ResourceId fragment);
 
     ResourceId loadShader(const std::string& file);
+    ResourceId loadShader(const std::string& file, const std::vector<std::string>& defines);
 
     bool getShader(ResourceId id, ResourceId& vertex, ResourceId& tessCtrl, ResourceId& tessEval,
                    ResourceId& geometry, ResourceId& fragment) const;
 
+    void getShaderDependents(const std::string& file, std::vector<std::string>& dependents) const;
+    void invalidateShaderInclude(const std::string& file);
+    std::string mapShaderSourceNames(const std::string& infoLog) const;
+
+    void setHotReload(bool enabled);
+    void updateHotReload();
+
+    void addReference(EResourceType type, ResourceId id);
+    void releaseReference(EResourceType type, ResourceId id);
+
+    bool unload(EResourceType type, ResourceId id);
+    void unloadUnreferenced();
+
+    void setMemoryBudget(size_t cpuBytes, size_t gpuBytes);
+
+    void setDefaultResidencyPolicy(EResourceType type, EResidencyPolicy policy);
+    bool setResidencyPolicy(EResourceType type, ResourceId id, EResidencyPolicy policy);
+
+    void setMipGeneration(EMipFilter filter, bool writeCache);
+
+    size_t getMemoryUsage(EResourceType type) const;
+    void getResourceUsage(std::vector<SResourceUsage>& usage) const;
+
+    bool mountPack(const std::string& packFile);
+
     void addResourceListener(IResourceListener* listener);
     void removeResourceListener(IResourceListener* listener);
 
    protected:
-    ResourceId loadString(const std::string& file, bool doPreprocessing);
+    ResourceId loadString(const std::string& file, bool doPreprocessing,
+                          const std::vector<std::string>& defines);
 
     void notifyResourceListeners(EResourceType type, ResourceId id, EListenerEvent event);
 
+    /**
+    * \brief Adds bookkeeping entry for new resource with a single reference.
+    */
+    void registerResource(EResourceType type, ResourceId id, size_t cpuBytes, size_t gpuBytes);
+
+    /**
+    * \brief Stores source file of loaded resource.
+    */
+    void setResourceFile(EResourceType type, ResourceId id, const std::string& file);
+
+    /**
+    * \brief Marks resource as used for LRU eviction.
+    */
+    void touch(EResourceType type, ResourceId id) const;
+
+    /**
+    * \brief Releases reference without enforcing the memory budget.
+    */
+    void release(EResourceType type, ResourceId id);
+
+    /**
+    * \brief Evicts least recently used unreferenced resources while over budget.
+    */
+    void enforceMemoryBudget();
+
+    /**
+    * \brief Returns whether CPU or GPU memory budget is exceeded.
+    */
+    bool isOverBudget() const;
+
+    /**
+    * \brief Returns bookkeeping entries for resource type.
+    */
+    TResourceStorage<SResourceInfo>& getResourceInfo(EResourceType type) const;
+
+    /**
+    * \brief Drops CPU side data of uploaded resource according to its residency policy.
+    */
+    void applyResidencyPolicy(EResourceType type, ResourceId id);
+
    private:
-    ResourceId m_nextMeshId;     /**< Next free mesh id. */
-    ResourceId m_nextImageId;    /**< Next free image id. */
-    ResourceId m_nextMaterialId; /**< Next free material id. */
-    ResourceId m_nextStringId;   /**< Next free string id. */
-    ResourceId m_nextShaderId;   /**< Next free shader id. */
-
-    // TODO Change to vector?
-    std::unordered_map<ResourceId, SMesh> m_meshes;        /**< Loaded meshes. */
-    std::unordered_map<ResourceId, SImage> m_images;       /**< Loaded images. */
-    std::unordered_map<ResourceId, SMaterial> m_materials; /**< Loaded materials. */
-    std::unordered_map<ResourceId, std::string> m_strings; /**< Loaded strings. */
-    std::unordered_map<ResourceId, SShader> m_shaders;     /**< Loaded shaders. */
+    /**
+    * \brief Changed file, which is read on a worker thread.
+    */
+    struct SReload
+    {
+        EResourceType m_type;      /**< Type of the reloaded resources. */
+        ResourceId m_id;           /**< Reloaded resource, unused for text files. */
+        std::string m_file;        /**< Changed file. */
+        std::future<bool> m_ready; /**< Becomes ready once the files are read. */
+        SMesh m_mesh;              /**< Mesh data of a mesh file. */
+        SImage m_image;            /**< Image data of an image file. */
+        CIniFile m_material;       /**< Material file. */
+        std::unordered_map<std::string, std::string>
+            m_texts; /**< Unprocessed text of the changed and dependent text files. */
+    };
+
+    /**
+    * \brief Image decode statistics.
+    */
+    struct SImageDecodeInfo
+    {
+        const char* m_container; /**< Container format the image was read from. */
+        size_t m_fileBytes;      /**< Size of the read file. */
+        double m_seconds;        /**< Read and decode time. */
+    };
+
+    /**
+    * \brief Stores mesh data under a new id and notifies listeners.
+    * The mesh data is moved into the storage.
+    */
+    ResourceId addMesh(SMesh& mesh, const std::string& file);
+
+    /**
+    * \brief Stores image data under a new id and notifies listeners.
+    * The image data is moved into the storage.
+    */
+    ResourceId addImage(SImage& image, const std::string& file);
+
+    /**
+    * \brief Loads the images and shader specified by a material file.
+    * The handles own the references added by the loads.
+    */
+    bool loadMaterialFiles(const CIniFile& ini, const std::string& file, SMaterial& material,
+                           std::vector<CResourceHandle>& handles);
+
+    /**
+    * \brief Adds file to the watched files if hot reloading is enabled.
+    * Text files are watched with their includes.
+    */
+    void watchFile(const std::string& file);
+
+    /**
+    * \brief Starts reading a changed file on a worker thread.
+    */
+    void startReload(const std::string& file);
+
+    /**
+    * \brief Replaces the resources of a read file and notifies listeners.
+    */
+    void applyReload(SReload& reload);
+
+    /**
+    * \brief Replaces text variants of the read text files and notifies dependent shaders.
+    */
+    void applyTextReload(SReload& reload);
+
+    /**
+    * \brief Updates memory bookkeeping of a resource with replaced data.
+    */
+    void resizeResource(EResourceType type, ResourceId id, size_t cpuBytes, size_t gpuBytes);
+
+    /**
+    * \brief Reads and parses mesh file.
+    */
+    bool readMesh(const std::string& file, SMesh& mesh) const;
+
+    /**
+    * \brief Reads and decodes image file.
+    * A texture or pre-converted raw image next to the file is used instead of the file, if it
+    * exists. Uncompressed images get a generated or cached mip chain.
+    * Safe to call from worker threads.
+    */
+    bool readImage(const std::string& file, EColorFormat format, EImageContent content,
+                   SImage& image, SImageDecodeInfo* info = nullptr) const;
+
+    TResourceStorage<SMesh> m_meshes;        /**< Loaded meshes. */
+    TResourceStorage<SImage> m_images;       /**< Loaded images. */
+    TResourceStorage<SMaterial> m_materials; /**< Loaded materials. */
+    TResourceStorage<std::string> m_strings; /**< Loaded strings. */
+    TResourceStorage<SShader> m_shaders;     /**< Loaded shaders. */
 
     std::unordered_map<std::string, ResourceId>
         m_meshFiles; /**< Maps mesh file to string resource id. */
@@ -93,6 +261,30 @@ class CResourceManager : public IResourceManager
         m_textFiles; /**< Maps text file to string resource id. */
     std::unordered_map<std::string, ResourceId>
         m_shaderFiles; /**< Maps shader program file to shader resource id. */
+    std::unordered_map<std::string, std::vector<std::string>>
+        m_textDefines; /**< Defines of preprocessed text variants. */
+
+    CVirtualFileSystem m_fileSystem; /**< Resolves files against packs and file system. */
+    CShaderPreprocessor m_shaderPreprocessor; /**< Caches includes and shader dependencies. */
+
+    static const unsigned int s_resourceTypeCount = 5; /**< Number of resource types. */
+    mutable TResourceStorage<SResourceInfo>
+        m_resourceInfo[s_resourceTypeCount]; /**< Bookkeeping per resource type. */
+    mutable uint64_t m_useTick;              /**< Current use tick for LRU tracking. */
+    size_t m_cpuMemoryUsage;                 /**< Total CPU memory of loaded resources. */
+    size_t m_gpuMemoryUsage;                 /**< Total estimated GPU memory of resources. */
+    size_t m_cpuMemoryBudget;                /**< CPU memory budget, 0 for unlimited. */
+    size_t m_gpuMemoryBudget;                /**< GPU memory budget, 0 for unlimited. */
+    EResidencyPolicy
+        m_residencyPolicy[s_resourceTypeCount]; /**< Default residency policy per type. */
+
+    EMipFilter m_mipFilter; /**< Filter for generated mip chains. */
+    bool m_writeMipCache;   /**< Generated mip chains are written to cache files. */
+
+    std::unique_ptr<CFileWatcher> m_fileWatcher; /**< Watches loaded files for hot reloading. */
+    std::list<std::shared_ptr<SReload>> m_reloads; /**< Changed files in reading order. */
+
+    CThreadPool m_threadPool; /**< Worker threads for batched and asynchronous loading. */
 
     std::list<IResourceListener*> m_resourceListeners; /**< Registered listeners. */
 };
@@ -1,10 +1,25 @@
 #include "SImage.h"
 
+#include <utility>
+
 SImage::SImage(std::vector<unsigned char> data, unsigned int width, unsigned int height,
-               EColorFormat format)
-    : m_data(data), m_width(width), m_height(height), m_format(format)
+               EColorFormat format, unsigned int mipCount)
+    : m_data(std::move(data)),
+      m_width(width),
+      m_height(height),
+      m_format(format),
+      m_mipCount(mipCount),
+      m_content(EImageContent::Color)
 {
     return;
 }
 
-SImage::SImage() : m_width(0), m_height(0), m_format(EColorFormat::Invalid) { return; }
+SImage::SImage()
+    : m_width(0),
+      m_height(0),
+      m_format(EColorFormat::Invalid),
+      m_mipCount(1),
+      m_content(EImageContent::Color)
+{
+    return;
+}
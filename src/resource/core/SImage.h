@@ -11,9 +11,11 @@ struct SImage
 {
     SImage();
     SImage(std::vector<unsigned char> data, unsigned int width, unsigned int height,
-           EColorFormat format);
-    std::vector<unsigned char> m_data;
+           EColorFormat format, unsigned int mipCount = 1);
+    std::vector<unsigned char> m_data; /**< Image data, all mip levels starting with the largest. */
     unsigned int m_width;
     unsigned int m_height;
     EColorFormat m_format;
+    unsigned int m_mipCount; /**< Number of stored mip levels. */
+    EImageContent m_content; /**< Image content, used to regenerate mip levels on reload. */
 };
@@ -1,10 +1,34 @@
 #include "SMesh.h"
 
+#include <algorithm>
+#include <utility>
+
 SMesh::SMesh(std::vector<float> vertices, std::vector<unsigned int> indices,
              std::vector<float> normals, std::vector<float> uvs, EPrimitiveType type)
-    : m_vertices(vertices), m_indices(indices), m_normals(normals), m_uvs(uvs), m_type(type)
+    : m_vertices(std::move(vertices)),
+      m_indices(std::move(indices)),
+      m_normals(std::move(normals)),
+      m_uvs(std::move(uvs)),
+      m_type(type)
 {
-    return;
+    updateBounds();
 }
 
-SMesh::SMesh() : m_type(EPrimitiveType::Invalid) { return; }
+SMesh::SMesh() : m_type(EPrimitiveType::Invalid) { updateBounds(); }
+
+void SMesh::updateBounds()
+{
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+        m_min[axis] = m_vertices.size() < 3 ? 0.f : m_vertices[axis];
+        m_max[axis] = m_min[axis];
+    }
+    for (unsigned int i = 3; i + 2 < m_vertices.size(); i += 3)
+    {
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            m_min[axis] = std::min(m_min[axis], m_vertices[i + axis]);
+            m_max[axis] = std::max(m_max[axis], m_vertices[i + axis]);
+        }
+    }
+}
@@ -12,9 +12,17 @@ struct SMesh
     SMesh();
     SMesh(std::vector<float> vertices, std::vector<unsigned int> indices,
           std::vector<float> normals, std::vector<float> uvs, EPrimitiveType type);
+
+    /**
+    * \brief Computes bounds from the vertices.
+    */
+    void updateBounds();
+
     std::vector<float> m_vertices;
     std::vector<unsigned int> m_indices;
     std::vector<float> m_normals;
     std::vector<float> m_uvs;
     EPrimitiveType m_type;
+    float m_min[3]; /**< Smallest vertex coordinates, kept if the data is dropped. */
+    float m_max[3]; /**< Largest vertex coordinates, kept if the data is dropped. */
 };
@@ -0,0 +1,21 @@
+#include "SResourceInfo.h"
+
+SResourceInfo::SResourceInfo(const std::string& file, size_t cpuBytes, size_t gpuBytes)
+    : m_file(file), m_references(1), m_lastUse(0), m_cpuBytes(cpuBytes),
+      m_gpuBytes(gpuBytes),
+      m_policy(EResidencyPolicy::Keep),
+      m_resident(true)
+{
+    return;
+}
+
+SResourceInfo::SResourceInfo()
+    : m_references(0),
+      m_lastUse(0),
+      m_cpuBytes(0),
+      m_gpuBytes(0),
+      m_policy(EResidencyPolicy::Keep),
+      m_resident(true)
+{
+    return;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "resource/ResourceConfig.h"
+
+/**
+ * \brief Bookkeeping data for a single resource.
+ */
+struct SResourceInfo
+{
+    SResourceInfo();
+    SResourceInfo(const std::string& file, size_t cpuBytes, size_t gpuBytes);
+    std::string m_file;        /**< Source file, empty for created resources. */
+    unsigned int m_references; /**< Number of references held by users. */
+    uint64_t m_lastUse;        /**< Use tick of the last access, used for LRU eviction. */
+    size_t m_cpuBytes;         /**< CPU memory used by resource data. */
+    size_t m_gpuBytes;         /**< Estimated GPU memory used by resource data. */
+    EResidencyPolicy m_policy; /**< Residency policy for CPU side data. */
+    bool m_resident;           /**< CPU side data is loaded. */
+};
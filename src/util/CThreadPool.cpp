@@ -0,0 +1,86 @@
+#include "CThreadPool.h"
+
+CThreadPool::CThreadPool(unsigned int threadCount) : m_pendingTasks(0), m_stop(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+        // Hardware thread count is not computable on all platforms
+        if (threadCount == 0)
+        {
+            threadCount = 1;
+        }
+    }
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        m_threads.push_back(std::thread(&CThreadPool::run, this));
+    }
+}
+
+CThreadPool::~CThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskCondition.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void CThreadPool::addTask(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+        ++m_pendingTasks;
+    }
+    m_taskCondition.notify_one();
+}
+
+void CThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]()
+                         {
+                             return m_pendingTasks == 0;
+                         });
+}
+
+unsigned int CThreadPool::getThreadCount() const { return m_threads.size(); }
+
+void CThreadPool::run()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskCondition.wait(lock, [this]()
+                                 {
+                                     return m_stop || !m_tasks.empty();
+                                 });
+            if (m_tasks.empty())
+            {
+                // Stopped and nothing left to do
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pendingTasks;
+            if (m_pendingTasks != 0)
+            {
+                continue;
+            }
+        }
+        m_doneCondition.notify_all();
+    }
+}
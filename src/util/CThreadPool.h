@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* \brief Fixed size worker thread pool.
+* Tasks are executed in submission order by the first free worker. Tasks must not throw and must
+* not submit further tasks to the pool they run on.
+*/
+class CThreadPool
+{
+   public:
+    /**
+    * \brief Starts worker threads.
+    * A thread count of 0 uses the number of hardware threads.
+    */
+    CThreadPool(unsigned int threadCount = 0);
+
+    /**
+    * \brief Finishes queued tasks and joins worker threads.
+    */
+    ~CThreadPool();
+
+    /**
+    * \brief Queues task for execution.
+    */
+    void addTask(std::function<void()> task);
+
+    /**
+    * \brief Blocks until all queued tasks have finished.
+    */
+    void wait();
+
+    /**
+    * \brief Returns number of worker threads.
+    */
+    unsigned int getThreadCount() const;
+
+   private:
+    /**
+    * \brief Worker thread loop.
+    */
+    void run();
+
+    std::vector<std::thread> m_threads;        /**< Worker threads. */
+    std::deque<std::function<void()>> m_tasks; /**< Queued tasks. */
+    std::mutex m_mutex;                        /**< Guards task queue and counters. */
+    std::condition_variable m_taskCondition;   /**< Signals queued tasks or shutdown. */
+    std::condition_variable m_doneCondition;   /**< Signals finished tasks. */
+    unsigned int m_pendingTasks;               /**< Queued and running tasks. */
+    bool m_stop;                               /**< Workers exit once the queue is empty. */
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+* \brief 64 bit FNV-1a offset basis, used as initial hash value.
+*/
+static const uint64_t fnv1aOffsetBasis = 14695981039346656037ULL;
+
+/**
+* \brief Computes 64 bit FNV-1a hash over raw bytes.
+* The previous hash value can be passed to hash multiple buffers sequentially.
+*/
+inline uint64_t hashFnv1a(const void* data, size_t size, uint64_t hash = fnv1aOffsetBasis)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+* \brief Computes 64 bit FNV-1a hash over a string.
+*/
+inline uint64_t hashFnv1a(const std::string& text, uint64_t hash = fnv1aOffsetBasis)
+{
+    return hashFnv1a(text.data(), text.size(), hash);
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <glm/glm.hpp>
+
+#include "graphics/renderer/GBufferEncoding.h"
+
+/**
+* \brief G-buffer encoding self test.
+* Round-trips normals and specular values through the CPU reference of the compact g-buffer
+* encoding in gbuffer_encoding.glsl without a GPU.
+*     RTRGBufferEncodingTest
+*/
+
+/**
+* \brief Maximum angle between normals after octahedral encoding without quantization.
+*/
+static const double s_maxOctahedralError = 0.001;
+
+/**
+* \brief Maximum angle between normals after packing into 12 bit per axis.
+* 12 bit octahedral coordinates have a worst case error of about 0.065 degrees.
+*/
+static const double s_maxPackedError = 0.1;
+
+static bool check(bool condition, const char* name, int& failures)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", name);
+        ++failures;
+    }
+    return condition;
+}
+
+/**
+* \brief Returns angle between vectors in degrees.
+* Computed in double precision from sine and cosine, acos of a float dot product is not precise
+* enough for small angles.
+*/
+static double getAngle(const glm::vec3& a, const glm::vec3& b)
+{
+    double cx = (double)a.y * b.z - (double)a.z * b.y;
+    double cy = (double)a.z * b.x - (double)a.x * b.z;
+    double cz = (double)a.x * b.y - (double)a.y * b.x;
+    double cosine = (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z;
+    return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), cosine) * 180.0 /
+           3.14159265358979323846;
+}
+
+/**
+* \brief Round-trips a normal, updates the largest errors of both encodings.
+*/
+static void roundTrip(const glm::vec3& normal, double& octahedralError, double& packedError)
+{
+    glm::vec3 decoded = decodeOctahedral(encodeOctahedral(normal));
+    octahedralError = std::max(octahedralError, getAngle(normal, decoded));
+
+    float specular = 0.f;
+    unpackNormalSpecular(packNormalSpecular(normal, 0.5f), decoded, specular);
+    packedError = std::max(packedError, getAngle(normal, decoded));
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Axes and diagonals, which lie on the edges and folds of the octahedron
+    {
+        double octahedralError = 0.0;
+        double packedError = 0.0;
+        for (int x = -1; x <= 1; ++x)
+        {
+            for (int y = -1; y <= 1; ++y)
+            {
+                for (int z = -1; z <= 1; ++z)
+                {
+                    if (x != 0 || y != 0 || z != 0)
+                    {
+                        roundTrip(glm::normalize(glm::vec3(x, y, z)), octahedralError,
+                                  packedError);
+                    }
+                }
+            }
+        }
+        std::printf("Axis aligned normals: %.4f degrees octahedral, %.4f degrees packed\n",
+                    octahedralError, packedError);
+        check(octahedralError <= s_maxOctahedralError, "Axis aligned octahedral round trip",
+              failures);
+        check(packedError <= s_maxPackedError, "Axis aligned packed round trip", failures);
+    }
+
+    // Uniformly distributed random normals
+    {
+        std::mt19937 generator(42);
+        std::normal_distribution<float> distribution;
+        double octahedralError = 0.0;
+        double packedError = 0.0;
+        for (unsigned int i = 0; i < 100000; ++i)
+        {
+            glm::vec3 normal(distribution(generator), distribution(generator),
+                             distribution(generator));
+            if (glm::dot(normal, normal) < 1e-6f)
+            {
+                continue;
+            }
+            roundTrip(glm::normalize(normal), octahedralError, packedError);
+        }
+        std::printf("Random normals: %.4f degrees octahedral, %.4f degrees packed\n",
+                    octahedralError, packedError);
+        check(octahedralError <= s_maxOctahedralError, "Random octahedral round trip", failures);
+        check(packedError <= s_maxPackedError, "Random packed round trip", failures);
+    }
+
+    // Specular values are stored with 8 bit and must come back exactly
+    {
+        const glm::vec3 normals[3] = {glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 0.f, -1.f),
+                                      glm::normalize(glm::vec3(0.3f, -0.8f, 0.5f))};
+        bool exact = true;
+        bool normalized = true;
+        for (const glm::vec3& normal : normals)
+        {
+            for (unsigned int i = 0; i < 256; ++i)
+            {
+                glm::vec2 packed = packNormalSpecular(normal, i / 255.f);
+                normalized = normalized && packed.x >= 0.f && packed.x <= 1.f && packed.y >= 0.f &&
+                             packed.y <= 1.f;
+                glm::vec3 decoded;
+                float specular = -1.f;
+                unpackNormalSpecular(packed, decoded, specular);
+                exact = exact && specular == i / 255.f;
+            }
+        }
+        check(normalized, "Packed channels in [0-1]", failures);
+        check(exact, "All 256 specular values round trip exactly", failures);
+    }
+
+    if (failures != 0)
+    {
+        std::printf("Self test failed with %i errors.\n", failures);
+        return 1;
+    }
+    std::printf("Self test passed.\n");
+    return 0;
+}
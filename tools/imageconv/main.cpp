@@ -0,0 +1,179 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "lodepng.h"
+
+#include "io/RawImageFormat.h"
+
+/**
+* \brief Image conversion tool.
+* Converts PNG images to the raw image container, which the resource manager prefers over the PNG
+* file. The raw file is written next to the source file, e.g.:
+*     RTRImageConverter data/images/wall.png
+* writes data/images/wall.rimg. Raw images can be bundled into a pack file with RTRPacker.
+*/
+
+static void printUsage()
+{
+    std::printf("Usage: RTRImageConverter <file.png|@listfile>...\n");
+    std::printf("  @listfile  Converts all files listed in listfile, one file per line.\n");
+}
+
+static bool readFileList(const std::string& listFile, std::vector<std::string>& files)
+{
+    std::ifstream ifs(listFile);
+    if (!ifs.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty() && line.at(0) != '#')
+        {
+            files.push_back(line);
+        }
+    }
+    return true;
+}
+
+static bool readFile(const std::string& file, std::vector<unsigned char>& data)
+{
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs.is_open())
+    {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool writeFile(const std::string& file, const std::vector<unsigned char>& data)
+{
+    std::ofstream ofs(file, std::ios::binary);
+    if (!ofs.is_open())
+    {
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return ofs.good();
+}
+
+/**
+* \brief Returns number of channels needed to store the png without loss.
+*/
+static unsigned int getChannelCount(const std::vector<unsigned char>& png)
+{
+    unsigned int width;
+    unsigned int height;
+    lodepng::State state;
+    if (lodepng_inspect(&width, &height, &state, png.data(), png.size()) != 0)
+    {
+        return 0;
+    }
+    switch (state.info_png.color.colortype)
+    {
+    case LCT_GREY:
+        return 1;
+    case LCT_RGB:
+        return 3;
+    default:
+        // Palette and alpha formats
+        return 4;
+    }
+}
+
+static bool convert(const std::string& file, size_t& pngSize, size_t& rawSize)
+{
+    std::vector<unsigned char> png;
+    if (!readFile(file, png) || png.empty())
+    {
+        std::printf("Failed to read file %s.\n", file.c_str());
+        return false;
+    }
+    unsigned int channels = getChannelCount(png);
+    LodePNGColorType colorType = channels == 1 ? LCT_GREY : (channels == 3 ? LCT_RGB : LCT_RGBA);
+
+    std::vector<unsigned char> pixels;
+    unsigned int width;
+    unsigned int height;
+    unsigned int err = lodepng::decode(pixels, width, height, png, colorType);
+    if (channels == 0 || err != 0)
+    {
+        std::printf("Failed to decode file %s: %s\n", file.c_str(), lodepng_error_text(err));
+        return false;
+    }
+
+    std::vector<unsigned char> raw;
+    encodeRawImage(pixels, width, height, channels, raw);
+    std::string rawFile = getRawImageFile(file);
+    if (!writeFile(rawFile, raw))
+    {
+        std::printf("Failed to write file %s.\n", rawFile.c_str());
+        return false;
+    }
+
+    // Validate written file
+    std::vector<unsigned char> readBack;
+    std::vector<unsigned char> decoded;
+    unsigned int readWidth;
+    unsigned int readHeight;
+    if (!readFile(rawFile, readBack) ||
+        !decodeRawImage(readBack, channels, decoded, readWidth, readHeight) ||
+        decoded != pixels)
+    {
+        std::printf("Failed to validate written file %s.\n", rawFile.c_str());
+        return false;
+    }
+
+    pngSize += png.size();
+    rawSize += raw.size();
+    return true;
+}
+
+int main(int argc, const char** argv)
+{
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i][0] == '@')
+        {
+            if (!readFileList(argv[i] + 1, files))
+            {
+                std::printf("Failed to read file list %s.\n", argv[i] + 1);
+                return 1;
+            }
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    size_t pngSize = 0;
+    size_t rawSize = 0;
+    for (const auto& file : files)
+    {
+        if (!convert(file, pngSize, rawSize))
+        {
+            return 1;
+        }
+    }
+    std::printf("Converted %lu images, %lu bytes png to %lu bytes raw.\n",
+                static_cast<unsigned long>(files.size()), static_cast<unsigned long>(pngSize),
+                static_cast<unsigned long>(rawSize));
+    return 0;
+}
@@ -0,0 +1,299 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "graphics/scene/COcclusionBuffer.h"
+#include "util/CThreadPool.h"
+
+/**
+* \brief Software occlusion culling benchmark.
+* Rasterizes a row of wall occluders into the CPU depth buffer used by the scene and tests random
+* bounding boxes placed in front of and behind the walls against it. Rasterization is measured
+* on the calling thread and on a thread pool, both must cull the same boxes.
+*     RTROcclusionBenchmark [box count] [frame count]
+*     RTROcclusionBenchmark --selftest
+*/
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/**
+* \brief Adds a box with outward facing, counter-clockwise triangles to the mesh.
+*/
+static void addBox(const glm::vec3& min, const glm::vec3& max, std::vector<float>& vertices,
+                   std::vector<unsigned int>& indices)
+{
+    unsigned int base = vertices.size() / 3;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        vertices.push_back(i & 1 ? max.x : min.x);
+        vertices.push_back(i & 2 ? max.y : min.y);
+        vertices.push_back(i & 4 ? max.z : min.z);
+    }
+    static const unsigned int faces[36] = {0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 1, 5, 0, 5, 4,
+                                           2, 6, 7, 2, 7, 3, 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5};
+    for (unsigned int index : faces)
+    {
+        indices.push_back(base + index);
+    }
+}
+
+/**
+* \brief Renders occluders for a number of frames and returns the time per frame in milliseconds.
+*/
+static double runFrames(COcclusionBuffer& buffer, const glm::mat4& viewProjection,
+                        const std::vector<float>& vertices,
+                        const std::vector<unsigned int>& indices, unsigned int frameCount)
+{
+    auto start = Clock::now();
+    for (unsigned int i = 0; i < frameCount; ++i)
+    {
+        buffer.begin(viewProjection);
+        buffer.addOccluder(glm::mat4(1.f), vertices, indices);
+        buffer.finish();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frameCount;
+}
+
+/**
+* \brief Tests boxes, returns the number of culled boxes and the test time in milliseconds.
+*/
+static unsigned int runTests(const COcclusionBuffer& buffer, const std::vector<glm::vec3>& boxes,
+                             double& time)
+{
+    unsigned int culled = 0;
+    auto start = Clock::now();
+    for (unsigned int i = 0; i + 1 < boxes.size(); i += 2)
+    {
+        if (!buffer.isVisible(boxes[i], boxes[i + 1]))
+        {
+            ++culled;
+        }
+    }
+    time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return culled;
+}
+
+static bool check(bool condition, const char* name, int& failures)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", name);
+        ++failures;
+    }
+    return condition;
+}
+
+/**
+* \brief Returns window depth of a point at a distance in front of a perspective camera.
+*/
+static float getWindowDepth(float distance, float near, float far)
+{
+    float ndc = (far + near) / (far - near) - 2.f * far * near / ((far - near) * distance);
+    return ndc * 0.5f + 0.5f;
+}
+
+/**
+* \brief Checks depth, clipping and box tests against scenes with known results without a GPU.
+*/
+static int runSelfTest()
+{
+    int failures = 0;
+
+    // Camera at the origin looks down the negative z axis, 90 degrees cover 10 units at z = -5
+    const float near = 1.f;
+    const float far = 100.f;
+    COcclusionBuffer buffer(256, 128);
+    glm::mat4 viewProjection =
+        glm::perspective(glm::radians(90.f), 2.f, near, far) *
+        glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+
+    // Square facing the camera at z = -10 covers pixels [96-159] x [32-95]
+    {
+        const std::vector<float> vertices = {-5.f, -5.f, -10.f, 5.f,  -5.f, -10.f,
+                                             5.f,  5.f,  -10.f, -5.f, 5.f,  -10.f};
+        const std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+        runFrames(buffer, viewProjection, vertices, indices, 1);
+        check(buffer.getTriangleCount() == 2, "Square triangle count", failures);
+
+        float expected = getWindowDepth(10.f, near, far);
+        bool coverage = true;
+        bool depth = true;
+        for (unsigned int y = 0; y < buffer.getHeight(); ++y)
+        {
+            for (unsigned int x = 0; x < buffer.getWidth(); ++x)
+            {
+                bool inside = x >= 96 && x <= 159 && y >= 32 && y <= 95;
+                float value = buffer.getDepth(x, y);
+                coverage = coverage && inside == (value < 1.f);
+                depth = depth && (!inside || std::abs(value - expected) < 1e-5f);
+            }
+        }
+        check(coverage, "Square coverage", failures);
+        check(depth, "Square depth", failures);
+
+        // Boxes behind, in front of, beside and across the edge of the square
+        check(!buffer.isVisible(glm::vec3(-1.f, -1.f, -30.f), glm::vec3(1.f, 1.f, -20.f)),
+              "Box behind the square is occluded", failures);
+        check(buffer.isVisible(glm::vec3(-1.f, -1.f, -6.f), glm::vec3(1.f, 1.f, -5.f)),
+              "Box in front of the square is visible", failures);
+        check(buffer.isVisible(glm::vec3(12.f, -1.f, -12.f), glm::vec3(14.f, 1.f, -11.f)),
+              "Box beside the square is visible", failures);
+        check(buffer.isVisible(glm::vec3(4.f, -1.f, -12.f), glm::vec3(6.f, 1.f, -11.f)),
+              "Box across the edge of the square is visible", failures);
+        check(buffer.isVisible(glm::vec3(-1.f, -1.f, -30.f), glm::vec3(1.f, 1.f, 0.5f)),
+              "Box across the near plane is visible", failures);
+
+        // Back faces are culled
+        const std::vector<unsigned int> backIndices = {0, 2, 1, 0, 3, 2};
+        runFrames(buffer, viewProjection, vertices, backIndices, 1);
+        check(buffer.getTriangleCount() == 0 && buffer.getDepth(128, 64) == 1.f,
+              "Back faces culled", failures);
+    }
+
+    // Floor below the camera reaches from behind the camera to z = -20
+    {
+        const std::vector<float> vertices = {-5.f, -1.f, 5.f,   5.f,  -1.f, 5.f,
+                                             5.f,  -1.f, -20.f, -5.f, -1.f, -20.f};
+        const std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+        runFrames(buffer, viewProjection, vertices, indices, 1);
+        // The first triangle keeps a triangle, the second a quad
+        check(buffer.getTriangleCount() == 3, "Clipped triangle count", failures);
+
+        // Row 32 sees the floor at a distance of 1 / 0.4921875
+        float expected = getWindowDepth(1.f / 0.4921875f, near, far);
+        check(std::abs(buffer.getDepth(128, 32) - expected) < 1e-4f, "Clipped depth", failures);
+        check(buffer.getDepth(128, 0) < 0.05f, "Clipped floor reaches the near plane", failures);
+        check(buffer.getDepth(128, 100) == 1.f, "Clipped floor ends at its far edge", failures);
+        check(!buffer.isVisible(glm::vec3(-1.f, -6.f, -10.f), glm::vec3(1.f, -5.f, -5.f)),
+              "Box below the floor is occluded", failures);
+    }
+
+    // SSE2 and scalar rasterization write identical depth
+    {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> position(-40.f, 40.f);
+        std::uniform_real_distribution<float> size(0.5f, 20.f);
+        for (unsigned int i = 0; i < 200; ++i)
+        {
+            glm::vec3 min(position(generator), position(generator), position(generator) - 45.f);
+            addBox(min, min + glm::vec3(size(generator), size(generator), size(generator)),
+                   vertices, indices);
+        }
+        glm::mat4 rotated =
+            viewProjection * glm::rotate(glm::radians(17.f), glm::vec3(0.3f, 1.f, 0.2f));
+
+        COcclusionBuffer simd;
+        COcclusionBuffer scalar;
+        scalar.setSimd(false);
+        if (!simd.isSimd())
+        {
+            std::printf("SSE2 is not available, comparing the scalar path with itself.\n");
+        }
+        runFrames(simd, rotated, vertices, indices, 1);
+        runFrames(scalar, rotated, vertices, indices, 1);
+
+        bool identical = true;
+        unsigned int covered = 0;
+        for (unsigned int y = 0; y < simd.getHeight(); ++y)
+        {
+            for (unsigned int x = 0; x < simd.getWidth(); ++x)
+            {
+                identical = identical && simd.getDepth(x, y) == scalar.getDepth(x, y);
+                covered += simd.getDepth(x, y) < 1.f ? 1 : 0;
+            }
+        }
+        check(covered > 0, "Random boxes are in view", failures);
+        check(identical, "SSE2 and scalar depth identical", failures);
+    }
+
+    if (failures != 0)
+    {
+        std::printf("Self test failed with %i errors.\n", failures);
+        return 1;
+    }
+    std::printf("Self test passed.\n");
+    return 0;
+}
+
+int main(int argc, const char** argv)
+{
+    if (argc > 1 && std::string(argv[1]) == "--selftest")
+    {
+        return runSelfTest();
+    }
+
+    unsigned int boxCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+    unsigned int frameCount = argc > 2 ? std::atoi(argv[2]) : 200;
+    if (boxCount == 0 || frameCount == 0)
+    {
+        std::printf("Usage: RTROcclusionBenchmark [box count] [frame count]\n");
+        std::printf("       RTROcclusionBenchmark --selftest\n");
+        return 1;
+    }
+
+    // Camera looks down the negative z axis at walls with gaps in between
+    glm::mat4 viewProjection =
+        glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 500.f) *
+        glm::lookAt(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 2.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for (int i = -4; i <= 4; ++i)
+    {
+        addBox(glm::vec3(i * 10.f - 4.f, 0.f, -31.f), glm::vec3(i * 10.f + 4.f, 15.f, -30.f),
+               vertices, indices);
+    }
+
+    // Boxes are scattered in front of and behind the walls
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> x(-60.f, 60.f);
+    std::uniform_real_distribution<float> y(0.f, 12.f);
+    std::uniform_real_distribution<float> z(-200.f, -5.f);
+    std::uniform_real_distribution<float> size(0.2f, 2.f);
+    std::vector<glm::vec3> boxes;
+    for (unsigned int i = 0; i < boxCount; ++i)
+    {
+        glm::vec3 min(x(generator), y(generator), z(generator));
+        boxes.push_back(min);
+        boxes.push_back(min + glm::vec3(size(generator), size(generator), size(generator)));
+    }
+
+    CThreadPool pool;
+    COcclusionBuffer buffer;
+    std::printf("%u occluder triangles, %ux%u depth buffer, %u boxes\n",
+                (unsigned int)indices.size() / 3, buffer.getWidth(), buffer.getHeight(), boxCount);
+
+    // Warm up once, then measure
+    runFrames(buffer, viewProjection, vertices, indices, 1);
+    double serialTime = runFrames(buffer, viewProjection, vertices, indices, frameCount);
+    double serialTestTime = 0.0;
+    unsigned int serialCulled = runTests(buffer, boxes, serialTestTime);
+
+    buffer.setThreadPool(&pool);
+    runFrames(buffer, viewProjection, vertices, indices, 1);
+    double pooledTime = runFrames(buffer, viewProjection, vertices, indices, frameCount);
+    double pooledTestTime = 0.0;
+    unsigned int pooledCulled = runTests(buffer, boxes, pooledTestTime);
+
+    std::printf("  %u binned triangles\n", buffer.getTriangleCount());
+    std::printf("  rasterization, calling thread: %8.3f ms per frame\n", serialTime);
+    std::printf("  rasterization, thread pool:    %8.3f ms per frame\n", pooledTime);
+    std::printf("  box tests:                     %8.3f ms, %6.2f ns per box\n", pooledTestTime,
+                pooledTestTime * 1e6 / boxCount);
+    std::printf("  culled boxes:                  %u of %u\n", pooledCulled, boxCount);
+
+    if (serialCulled != pooledCulled)
+    {
+        std::printf("Culling results differ.\n");
+        return 1;
+    }
+    return 0;
+}
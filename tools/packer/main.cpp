@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "io/CPackFile.h"
+#include "io/CPackFileWriter.h"
+
+/**
+* \brief Pack file tool.
+* Bundles asset files into a single pack file, which is mounted by the demo at startup.
+* Files are stored under the path given on the command line, so the tool should be run from the
+* demo working directory, e.g.:
+*     RTRPacker -c data.pack @files.txt
+* where files.txt lists one file per line, like data/shadersource/deferred/geometry_pass_vs.glsl.
+*/
+
+static void printUsage()
+{
+    std::printf("Usage: RTRPacker [-c] <output pack> <file|@listfile>...\n");
+    std::printf("  -c         Compress files, if it reduces the stored size.\n");
+    std::printf("  @listfile  Adds all files listed in listfile, one file per line.\n");
+}
+
+static bool readFileList(const std::string& listFile, std::vector<std::string>& files)
+{
+    std::ifstream ifs(listFile);
+    if (!ifs.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty() && line.at(0) != '#')
+        {
+            files.push_back(line);
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char** argv)
+{
+    bool compress = false;
+    std::string output;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-c") == 0)
+        {
+            compress = true;
+        }
+        else if (output.empty())
+        {
+            output = argv[i];
+        }
+        else if (argv[i][0] == '@')
+        {
+            if (!readFileList(argv[i] + 1, files))
+            {
+                std::printf("Failed to read file list %s.\n", argv[i] + 1);
+                return 1;
+            }
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (output.empty() || files.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    CPackFileWriter writer;
+    for (const auto& file : files)
+    {
+        if (!writer.addFile(file, compress))
+        {
+            std::printf("Failed to add file %s.\n", file.c_str());
+            return 1;
+        }
+    }
+    if (!writer.write(output))
+    {
+        std::printf("Failed to write pack file %s.\n", output.c_str());
+        return 1;
+    }
+
+    // Read back all files to validate the written pack
+    CPackFile pack;
+    if (!pack.open(output))
+    {
+        std::printf("Failed to open written pack file %s.\n", output.c_str());
+        return 1;
+    }
+    size_t totalSize = 0;
+    for (const auto& file : files)
+    {
+        std::vector<unsigned char> data;
+        if (!pack.read(file, data))
+        {
+            std::printf("Failed to read back file %s.\n", file.c_str());
+            return 1;
+        }
+        totalSize += data.size();
+    }
+
+    std::ifstream packStream(output, std::ios::binary | std::ios::ate);
+    std::printf("Packed %u files, %lu bytes into %s (%lu bytes).\n", writer.getFileCount(),
+                static_cast<unsigned long>(totalSize), output.c_str(),
+                static_cast<unsigned long>(packStream.tellg()));
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "resource/TResourceStorage.h"
+
+/**
+* \brief Resource storage micro benchmark.
+* Compares id lookups in the hash map storage formerly used by the resource managers with the
+* slot based TResourceStorage. Resources are stored as unique pointers, like the GPU side objects
+* in the graphics resource manager.
+*     RTRStorageBenchmark [resource count] [lookup count]
+*/
+
+/**
+* \brief Stand-in for a GPU side resource object.
+*/
+struct SObject
+{
+    unsigned int m_value;
+};
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/**
+* \brief Runs lookups and returns elapsed time in milliseconds.
+* The accumulated sum is returned through the output parameter to keep the loop from being
+* optimized away.
+*/
+template <typename Lookup>
+static double runLookups(const std::vector<ResourceId>& ids, Lookup lookup, unsigned long& sum)
+{
+    auto start = Clock::now();
+    for (ResourceId id : ids)
+    {
+        sum += lookup(id)->m_value;
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned int resourceCount = argc > 1 ? std::atoi(argv[1]) : 4096;
+    unsigned int lookupCount = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    if (resourceCount == 0 || lookupCount == 0)
+    {
+        std::printf("Usage: RTRStorageBenchmark [resource count] [lookup count]\n");
+        return 1;
+    }
+
+    // Fill both storages with the same ids, the slot storage allocates them
+    TResourceStorage<std::unique_ptr<SObject>> storage;
+    std::unordered_map<ResourceId, std::unique_ptr<SObject>> map;
+    std::vector<ResourceId> ids;
+    for (unsigned int i = 0; i < resourceCount; ++i)
+    {
+        ResourceId id = storage.add(std::unique_ptr<SObject>(new SObject{i}));
+        map[id] = std::unique_ptr<SObject>(new SObject{i});
+        ids.push_back(id);
+    }
+
+    // Random access pattern, like draw calls of a scene sorted by something other than id
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<unsigned int> distribution(0, resourceCount - 1);
+    std::vector<ResourceId> lookups(lookupCount);
+    for (auto& id : lookups)
+    {
+        id = ids[distribution(generator)];
+    }
+
+    unsigned long mapSum = 0;
+    unsigned long storageSum = 0;
+    // Warm up caches once, then measure
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        mapSum = 0;
+        storageSum = 0;
+        double mapTime = runLookups(lookups, [&map](ResourceId id)
+                                    {
+                                        return map.find(id)->second.get();
+                                    },
+                                    mapSum);
+        double storageTime = runLookups(lookups, [&storage](ResourceId id)
+                                        {
+                                            return storage.get(id)->get();
+                                        },
+                                        storageSum);
+        if (pass == 1)
+        {
+            std::printf("%u lookups in %u resources\n", lookupCount, resourceCount);
+            std::printf("  unordered_map:    %8.3f ms, %6.2f ns per lookup\n", mapTime,
+                        mapTime * 1e6 / lookupCount);
+            std::printf("  TResourceStorage: %8.3f ms, %6.2f ns per lookup\n", storageTime,
+                        storageTime * 1e6 / lookupCount);
+        }
+    }
+
+    if (mapSum != storageSum)
+    {
+        std::printf("Lookup results differ.\n");
+        return 1;
+    }
+    return 0;
+}
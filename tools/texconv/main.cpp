@@ -0,0 +1,618 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "lodepng.h"
+
+#include "io/TextureFormat.h"
+#include "resource/BlockCompression.h"
+#include "resource/ImageFormat.h"
+#include "resource/MipGenerator.h"
+
+/**
+* \brief Texture compression tool.
+* Converts PNG images to block compressed textures with a precomputed mip chain, which the
+* resource manager prefers over raw images and PNG files. The texture file is written next to the
+* source file, e.g.:
+*     RTRTextureCompressor data/images/wall_diffuse.png
+* writes data/images/wall_diffuse.rtex. Mip levels are filtered before compression, diffuse maps
+* in linear space and normal maps with renormalization.
+*
+* The compression format is selected by the texture type:
+*     diffuse  BC1, color without alpha
+*     alpha    BC3, color with alpha
+*     mask     BC4, single channel for specular, glow and alpha maps
+*     normal   BC5, x and y of the normal, z is reconstructed in the shader
+*     auto     Selected from the file name suffix and the alpha channel of the image
+*/
+
+enum class ETextureType
+{
+    Auto,
+    Diffuse,
+    Alpha,
+    Mask,
+    Normal
+};
+
+static void printUsage()
+{
+    std::printf("Usage: RTRTextureCompressor [-t type] [-f filter] [-v] <file.png|@listfile>...\n");
+    std::printf("       RTRTextureCompressor --selftest\n");
+    std::printf("  -t type     Texture type, auto, diffuse, alpha, mask or normal.\n");
+    std::printf("  -f filter   Mip filter, box or kaiser (default).\n");
+    std::printf("  -v          Verifies written files and prints the error of the first level.\n");
+    std::printf("  @listfile   Converts all files listed in listfile, one file per line.\n");
+    std::printf("  --selftest  Round-trips test blocks through the encoders and decoders.\n");
+}
+
+static bool readFileList(const std::string& listFile, std::vector<std::string>& files)
+{
+    std::ifstream ifs(listFile);
+    if (!ifs.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty() && line.at(0) != '#')
+        {
+            files.push_back(line);
+        }
+    }
+    return true;
+}
+
+static bool readFile(const std::string& file, std::vector<unsigned char>& data)
+{
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs.is_open())
+    {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool writeFile(const std::string& file, const std::vector<unsigned char>& data)
+{
+    std::ofstream ofs(file, std::ios::binary);
+    if (!ofs.is_open())
+    {
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return ofs.good();
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+* \brief Selects compression format for the texture type.
+* Automatic selection uses the material texture naming of the data directory.
+*/
+static EColorFormat selectFormat(ETextureType type, const std::string& file,
+                                 const std::vector<unsigned char>& rgba)
+{
+    if (type == ETextureType::Auto)
+    {
+        std::string name = file.substr(0, file.find_last_of('.'));
+        if (endsWith(name, "_normal"))
+        {
+            type = ETextureType::Normal;
+        }
+        else if (endsWith(name, "_specular") || endsWith(name, "_glow") ||
+                 endsWith(name, "_alpha"))
+        {
+            type = ETextureType::Mask;
+        }
+        else
+        {
+            type = ETextureType::Diffuse;
+            for (size_t i = 3; i < rgba.size(); i += 4)
+            {
+                if (rgba[i] != 255)
+                {
+                    type = ETextureType::Alpha;
+                    break;
+                }
+            }
+        }
+    }
+
+    switch (type)
+    {
+    case ETextureType::Alpha:
+        return EColorFormat::BC3;
+    case ETextureType::Mask:
+        return EColorFormat::BC4;
+    case ETextureType::Normal:
+        return EColorFormat::BC5;
+    default:
+        return EColorFormat::BC1;
+    }
+}
+
+static const char* getFormatName(EColorFormat format)
+{
+    switch (format)
+    {
+    case EColorFormat::BC1:
+        return "BC1";
+    case EColorFormat::BC3:
+        return "BC3";
+    case EColorFormat::BC4:
+        return "BC4";
+    case EColorFormat::BC5:
+        return "BC5";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+* \brief Returns content of the compressed format for mip generation.
+*/
+static EImageContent getContent(EColorFormat format)
+{
+    switch (format)
+    {
+    case EColorFormat::BC4:
+        return EImageContent::Data;
+    case EColorFormat::BC5:
+        return EImageContent::Normal;
+    default:
+        return EImageContent::Color;
+    }
+}
+
+/**
+* \brief Returns peak signal to noise ratio in dB over the channels stored by the format.
+*/
+static double computePsnr(const std::vector<unsigned char>& source,
+                          const std::vector<unsigned char>& decoded, EColorFormat format)
+{
+    unsigned int channels = getChannelCount(format);
+    double error = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < source.size(); i += 4)
+    {
+        for (unsigned int c = 0; c < channels; ++c)
+        {
+            double d = double(source[i + c]) - double(decoded[i + c]);
+            error += d * d;
+            ++count;
+        }
+    }
+    if (error == 0.0)
+    {
+        return 99.0;
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / (error / count));
+}
+
+static bool convert(const std::string& file, ETextureType type, EMipFilter filter, bool verify,
+                    size_t& pngSize, size_t& textureSize)
+{
+    std::vector<unsigned char> png;
+    if (!readFile(file, png) || png.empty())
+    {
+        std::printf("Failed to read file %s.\n", file.c_str());
+        return false;
+    }
+
+    std::vector<unsigned char> base;
+    unsigned int width;
+    unsigned int height;
+    unsigned int err = lodepng::decode(base, width, height, png, LCT_RGBA);
+    if (err != 0)
+    {
+        std::printf("Failed to decode file %s: %s\n", file.c_str(), lodepng_error_text(err));
+        return false;
+    }
+    EColorFormat format = selectFormat(type, file, base);
+
+    // Compress full mip chain
+    unsigned int mipCount = getMipCount(width, height);
+    std::vector<unsigned char> levels;
+    generateMipChain(base.data(), width, height, 4, getContent(format), filter, levels);
+    std::vector<unsigned char> chain;
+    std::vector<unsigned char> blocks;
+    const unsigned char* level = levels.data();
+    for (unsigned int i = 0; i < mipCount; ++i)
+    {
+        unsigned int levelWidth = getMipSize(width, i);
+        unsigned int levelHeight = getMipSize(height, i);
+        compressImage(level, levelWidth, levelHeight, format, blocks);
+        chain.insert(chain.end(), blocks.begin(), blocks.end());
+        level += getImageSize(EColorFormat::RGBA32, levelWidth, levelHeight);
+    }
+
+    std::vector<unsigned char> texture;
+    encodeTexture(chain, width, height, format, mipCount, texture);
+    std::string textureFile = getTextureFile(file);
+    if (!writeFile(textureFile, texture))
+    {
+        std::printf("Failed to write file %s.\n", textureFile.c_str());
+        return false;
+    }
+
+    std::printf("%s: %ux%u %s, %u levels, %lu bytes\n", textureFile.c_str(), width, height,
+                getFormatName(format), mipCount, static_cast<unsigned long>(texture.size()));
+
+    if (verify)
+    {
+        // Validate written file and measure compression error of the first level
+        std::vector<unsigned char> readBack;
+        std::vector<unsigned char> data;
+        std::vector<unsigned char> decoded;
+        unsigned int readWidth;
+        unsigned int readHeight;
+        unsigned int readMipCount;
+        EColorFormat readFormat;
+        if (!readFile(textureFile, readBack) ||
+            !decodeTexture(readBack, data, readWidth, readHeight, readFormat, readMipCount) ||
+            data != chain ||
+            !decompressImage(data.data(), readWidth, readHeight, readFormat, decoded))
+        {
+            std::printf("Failed to validate written file %s.\n", textureFile.c_str());
+            return false;
+        }
+        std::printf("  PSNR %.2f dB\n", computePsnr(base, decoded, format));
+    }
+
+    pngSize += png.size();
+    textureSize += texture.size();
+    return true;
+}
+
+/**
+* \brief Encodes and decodes test block, returns maximum channel error.
+*/
+static int roundTrip(const unsigned char* rgba, EColorFormat format)
+{
+    unsigned char block[16];
+    unsigned char decoded[64];
+    std::memset(decoded, 0, sizeof(decoded));
+    unsigned int channels = getChannelCount(format);
+    switch (format)
+    {
+    case EColorFormat::BC1:
+        encodeBlockBC1(rgba, block);
+        decodeBlockBC1(block, decoded);
+        break;
+    case EColorFormat::BC3:
+        encodeBlockBC3(rgba, block);
+        decodeBlockBC3(block, decoded);
+        break;
+    case EColorFormat::BC4:
+        encodeBlockBC4(rgba, 0, block);
+        decodeBlockBC4(block, 0, decoded);
+        break;
+    case EColorFormat::BC5:
+        encodeBlockBC5(rgba, block);
+        decodeBlockBC5(block, decoded);
+        break;
+    default:
+        return 255;
+    }
+    int maxError = 0;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        for (unsigned int c = 0; c < channels; ++c)
+        {
+            // BC3 stores alpha in the fourth channel, channels 0-2 hold the color
+            int d = std::abs(int(rgba[i * 4 + c]) - int(decoded[i * 4 + c]));
+            maxError = std::max(maxError, d);
+        }
+    }
+    return maxError;
+}
+
+static bool check(bool condition, const char* name, int& failures)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", name);
+        ++failures;
+    }
+    return condition;
+}
+
+/**
+* \brief Round-trips blocks through encoders and decoders without a GPU.
+*/
+static int runSelfTest()
+{
+    int failures = 0;
+    const EColorFormat formats[4] = {EColorFormat::BC1, EColorFormat::BC3, EColorFormat::BC4,
+                                     EColorFormat::BC5};
+
+    // Known block layouts
+    {
+        // Red and blue endpoints, all indices select 2/3 red + 1/3 blue
+        const unsigned char bc1[8] = {0x00, 0xf8, 0x1f, 0x00, 0xaa, 0xaa, 0xaa, 0xaa};
+        unsigned char rgba[64];
+        decodeBlockBC1(bc1, rgba);
+        check(rgba[0] == 170 && rgba[1] == 0 && rgba[2] == 85 && rgba[3] == 255,
+              "BC1 decode interpolated color", failures);
+
+        // 3 color mode, index 3 is transparent black
+        const unsigned char bc1Alpha[8] = {0x1f, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xff, 0xff};
+        decodeBlockBC1(bc1Alpha, rgba);
+        check(rgba[0] == 0 && rgba[1] == 0 && rgba[2] == 0 && rgba[3] == 0,
+              "BC1 decode transparent black", failures);
+
+        // 8 value mode, index 2 is 6/7 of the first endpoint
+        const unsigned char bc4[8] = {255, 0, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49};
+        decodeBlockBC4(bc4, 0, rgba);
+        check(rgba[0] == 219 && rgba[60] == 219, "BC4 decode interpolated value", failures);
+    }
+
+    // Solid blocks are exact up to endpoint quantization
+    for (unsigned int value = 0; value < 256; value += 15)
+    {
+        unsigned char rgba[64];
+        for (unsigned int i = 0; i < 16; ++i)
+        {
+            rgba[i * 4] = (unsigned char)value;
+            rgba[i * 4 + 1] = (unsigned char)(255 - value);
+            rgba[i * 4 + 2] = (unsigned char)(value / 2);
+            rgba[i * 4 + 3] = (unsigned char)(255 - value / 3);
+        }
+        check(roundTrip(rgba, EColorFormat::BC1) <= 4, "BC1 solid block", failures);
+        check(roundTrip(rgba, EColorFormat::BC3) <= 4, "BC3 solid block", failures);
+        check(roundTrip(rgba, EColorFormat::BC4) == 0, "BC4 solid block", failures);
+        check(roundTrip(rgba, EColorFormat::BC5) == 0, "BC5 solid block", failures);
+    }
+
+    // Gradients along a single axis are represented by the interpolated values
+    {
+        unsigned char rgba[64];
+        for (unsigned int i = 0; i < 16; ++i)
+        {
+            unsigned char value = (unsigned char)(i * 17);
+            rgba[i * 4] = value;
+            rgba[i * 4 + 1] = value;
+            rgba[i * 4 + 2] = value;
+            rgba[i * 4 + 3] = (unsigned char)(255 - value);
+        }
+        check(roundTrip(rgba, EColorFormat::BC1) <= 48, "BC1 gradient block", failures);
+        check(roundTrip(rgba, EColorFormat::BC3) <= 48, "BC3 gradient block", failures);
+        check(roundTrip(rgba, EColorFormat::BC4) <= 19, "BC4 gradient block", failures);
+        check(roundTrip(rgba, EColorFormat::BC5) <= 19, "BC5 gradient block", failures);
+    }
+
+    // Random blocks, encoded data decodes to the same block after a second pass
+    std::srand(1);
+    for (unsigned int test = 0; test < 1000; ++test)
+    {
+        unsigned char rgba[64];
+        for (unsigned int i = 0; i < 64; ++i)
+        {
+            rgba[i] = (unsigned char)(std::rand() & 0xff);
+        }
+        for (EColorFormat format : formats)
+        {
+            std::vector<unsigned char> blocks;
+            std::vector<unsigned char> decoded;
+            std::vector<unsigned char> blocks2;
+            std::vector<unsigned char> decoded2;
+            compressImage(rgba, 4, 4, format, blocks);
+            decompressImage(blocks.data(), 4, 4, format, decoded);
+            compressImage(decoded.data(), 4, 4, format, blocks2);
+            decompressImage(blocks2.data(), 4, 4, format, decoded2);
+            double psnr = computePsnr(decoded, decoded2, format);
+            if (!check(psnr > 30.0, "Random block re-encode", failures))
+            {
+                std::printf("  %s, PSNR %.2f dB\n", getFormatName(format), psnr);
+            }
+        }
+    }
+
+    // Mip generation keeps solid images solid
+    for (EMipFilter filter : {EMipFilter::Box, EMipFilter::Kaiser})
+    {
+        std::vector<unsigned char> rgb(5 * 3 * 3, 200);
+        std::vector<unsigned char> chain;
+        bool solid = generateMipChain(rgb.data(), 5, 3, 3, EImageContent::Color, filter, chain) &&
+                     chain.size() == getMipChainSize(EColorFormat::RGB24, 5, 3, getMipCount(5, 3));
+        for (unsigned char value : chain)
+        {
+            solid = solid && value == 200;
+        }
+        check(solid, "Mip chain of solid image", failures);
+    }
+
+    // Color is averaged in linear space, black and white average to sRGB 188
+    {
+        std::vector<unsigned char> checker(2 * 2);
+        checker[0] = 0;
+        checker[1] = 255;
+        checker[2] = 255;
+        checker[3] = 0;
+        std::vector<unsigned char> chain;
+        generateMipChain(checker.data(), 2, 2, 1, EImageContent::Color, EMipFilter::Box, chain);
+        check(chain.size() == 5 && chain[4] == 188, "sRGB correct mip level", failures);
+        generateMipChain(checker.data(), 2, 2, 1, EImageContent::Data, EMipFilter::Box, chain);
+        check(chain.size() == 5 && chain[4] == 128, "Linear mip level", failures);
+    }
+
+    // Normals are renormalized on every level
+    {
+        std::vector<unsigned char> normals(16 * 16 * 3);
+        for (size_t i = 0; i < normals.size(); ++i)
+        {
+            normals[i] = (unsigned char)(i * 97 + 13);
+        }
+        std::vector<unsigned char> chain;
+        generateMipChain(normals.data(), 16, 16, 3, EImageContent::Normal, EMipFilter::Kaiser,
+                         chain);
+        double maxDeviation = 0.0;
+        for (size_t i = normals.size(); i < chain.size(); i += 3)
+        {
+            double x = (chain[i] - 128.0) / 127.0;
+            double y = (chain[i + 1] - 128.0) / 127.0;
+            double z = (chain[i + 2] - 128.0) / 127.0;
+            double length = std::sqrt(x * x + y * y + z * z);
+            maxDeviation = std::max(maxDeviation, std::fabs(length - 1.0));
+        }
+        check(maxDeviation < 0.02, "Normalized normal mip levels", failures);
+    }
+
+    // Partial blocks and texture container
+    {
+        const unsigned int width = 7;
+        const unsigned int height = 3;
+        std::vector<unsigned char> rgba(width * height * 4);
+        for (size_t i = 0; i < rgba.size(); ++i)
+        {
+            rgba[i] = (unsigned char)(i * 7);
+        }
+        for (EColorFormat format : formats)
+        {
+            std::vector<unsigned char> blocks;
+            std::vector<unsigned char> decoded;
+            check(compressImage(rgba.data(), width, height, format, blocks) &&
+                      blocks.size() == getImageSize(format, width, height) &&
+                      decompressImage(blocks.data(), width, height, format, decoded) &&
+                      decoded.size() == rgba.size(),
+                  "Partial block image", failures);
+
+            std::vector<unsigned char> chain(getMipChainSize(format, width, height, 3), 0x5a);
+            std::vector<unsigned char> file;
+            std::vector<unsigned char> data;
+            unsigned int readWidth = 0;
+            unsigned int readHeight = 0;
+            unsigned int readMipCount = 0;
+            EColorFormat readFormat = EColorFormat::Invalid;
+            check(encodeTexture(chain, width, height, format, 3, file) &&
+                      decodeTexture(file, data, readWidth, readHeight, readFormat,
+                                    readMipCount) &&
+                      data == chain && readWidth == width && readHeight == height &&
+                      readFormat == format && readMipCount == 3,
+                  "Texture container round trip", failures);
+        }
+    }
+
+    if (failures != 0)
+    {
+        std::printf("Self test failed with %i errors.\n", failures);
+        return 1;
+    }
+    std::printf("Self test passed.\n");
+    return 0;
+}
+
+int main(int argc, const char** argv)
+{
+    std::vector<std::string> files;
+    ETextureType type = ETextureType::Auto;
+    EMipFilter filter = EMipFilter::Kaiser;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--selftest")
+        {
+            return runSelfTest();
+        }
+        else if (arg == "-v")
+        {
+            verify = true;
+        }
+        else if (arg == "-t" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            if (name == "auto")
+            {
+                type = ETextureType::Auto;
+            }
+            else if (name == "diffuse")
+            {
+                type = ETextureType::Diffuse;
+            }
+            else if (name == "alpha")
+            {
+                type = ETextureType::Alpha;
+            }
+            else if (name == "mask")
+            {
+                type = ETextureType::Mask;
+            }
+            else if (name == "normal")
+            {
+                type = ETextureType::Normal;
+            }
+            else
+            {
+                std::printf("Unknown texture type %s.\n", name.c_str());
+                return 1;
+            }
+        }
+        else if (arg == "-f" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            if (name == "box")
+            {
+                filter = EMipFilter::Box;
+            }
+            else if (name == "kaiser")
+            {
+                filter = EMipFilter::Kaiser;
+            }
+            else
+            {
+                std::printf("Unknown mip filter %s.\n", name.c_str());
+                return 1;
+            }
+        }
+        else if (arg.at(0) == '@')
+        {
+            if (!readFileList(arg.substr(1), files))
+            {
+                std::printf("Failed to read file list %s.\n", arg.c_str() + 1);
+                return 1;
+            }
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    size_t pngSize = 0;
+    size_t textureSize = 0;
+    for (const auto& file : files)
+    {
+        if (!convert(file, type, filter, verify, pngSize, textureSize))
+        {
+            return 1;
+        }
+    }
+    std::printf("Converted %lu images, %lu bytes png to %lu bytes texture.\n",
+                static_cast<unsigned long>(files.size()), static_cast<unsigned long>(pngSize),
+                static_cast<unsigned long>(textureSize));
+    return 0;
+}